@@ -26,12 +26,16 @@ HEADERS +=  cachecleaner.h \
             ../src/strconstants.h \
             ../src/qaesencryption.h \
             ../src/unixcommand.h \
+            ../src/helperprotocol.h \
+            ../src/processtable.h \
             ../src/wmhelper.h \
             ../src/terminal.h \
             ../src/settingsmanager.h \
             ../src/searchlineedit.h \
             ../src/utils.h \
             ../src/package.h \
+            ../src/outputsanitizer.h \
+            ../src/packageinfocache.h \
             ../src/QtSolutions/qtsingleapplication.h \
             ../src/QtSolutions/qtlocalpeer.h \
             ../src/QtSolutions/qtlockedfile.h \
@@ -44,12 +48,16 @@ SOURCES +=  main.cpp \
             ../src/strconstants.cpp \
             ../src/qaesencryption.cpp \
             ../src/unixcommand.cpp \
+            ../src/helperprotocol.cpp \
+            ../src/processtable.cpp \
             ../src/wmhelper.cpp \
             ../src/terminal.cpp \
             ../src/settingsmanager.cpp \
             ../src/searchlineedit.cpp \
             ../src/utils.cpp \
             ../src/package.cpp \
+            ../src/outputsanitizer.cpp \
+            ../src/packageinfocache.cpp \
             ../src/QtSolutions/qtsingleapplication.cpp \
             ../src/QtSolutions/qtlocalpeer.cpp \
             ../src/QtSolutions/qtlockedfile.cpp \
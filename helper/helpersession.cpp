@@ -0,0 +1,471 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2019 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "helpersession.h"
+#include "octopihelper.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * How many parents of octphelper are visited looking for the Octo tool (qt-sudo, sudo...)
+ */
+static const int ctn_MAX_OWNER_SEARCH_DEPTH = 8;
+
+/*
+ * Retrieves the given field ("PPid", "Uid"...) of /proc/<pid>/status
+ */
+static QString readProcStatusField(qint64 pid, const QString &field)
+{
+  QFile status(QLatin1String("/proc/") + QString::number(pid) + QLatin1String("/status"));
+  if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) return QString();
+
+  const QString prefix = field + QLatin1Char(':');
+  while (!status.atEnd())
+  {
+    const QString line = QString::fromLatin1(status.readLine());
+    if (line.startsWith(prefix)) return line.mid(prefix.size()).trimmed();
+  }
+
+  return QString();
+}
+
+ProcessCommandExecutor::ProcessCommandExecutor(OctopiHelper *helper, QObject *parent): CommandExecutor(parent)
+{
+  m_helper = helper;
+  m_exitCode = 0;
+  m_running = false;
+  m_process = new QProcess(this);
+
+  //Octopi gets pacman's output in the order it was printed
+  m_process->setProcessChannelMode(QProcess::MergedChannels);
+
+  connect(m_process, SIGNAL(readyReadStandardOutput()), this, SLOT(onReadyRead()));
+  connect(m_process, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onFinished(int, QProcess::ExitStatus)));
+  connect(m_process, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(onErrorOccurred(QProcess::ProcessError)));
+}
+
+void ProcessCommandExecutor::start(const QList<HelperCommand> &commands)
+{
+  m_commands = commands;
+  m_exitCode = 0;
+  m_running = true;
+  m_process->setProcessEnvironment(m_helper->getTransactionEnvironment());
+
+  emit started();
+  runNextCommand();
+}
+
+/*
+ * Like a shell script, a failing command does not stop the next ones and the last exit code is the result
+ */
+void ProcessCommandExecutor::runNextCommand()
+{
+  while (!m_commands.isEmpty())
+  {
+    const HelperCommand command = m_commands.takeFirst();
+    m_helper->log(QLatin1String("Exec as root: ") + TransactionRequest::toString(command));
+
+    if (TransactionRequest::needsProcess(command))
+    {
+      m_process->start(TransactionRequest::program(command), TransactionRequest::arguments(command));
+      return;
+    }
+
+    //There is no terminal here, so nobody would press a key
+    if (command.operation == ectn_HELPER_OP_PRINT || command.operation == ectn_HELPER_OP_WAIT_FOR_KEY)
+    {
+      emit output(command.text.toLatin1() + '\n');
+      m_exitCode = 0;
+    }
+    else
+    {
+      m_exitCode = m_helper->executeBuiltinCommand(command);
+    }
+  }
+
+  m_running = false;
+  emit finished(m_exitCode);
+}
+
+void ProcessCommandExecutor::write(const QByteArray &input)
+{
+  m_process->write(input);
+}
+
+/*
+ * Drops the remaining commands, then does what "killall pacman; rm db.lck" did
+ */
+void ProcessCommandExecutor::cancel()
+{
+  m_commands.clear();
+  m_process->terminate();
+  QProcess::execute(QStringLiteral("/usr/bin/killall"), QStringList() << QStringLiteral("pacman"));
+  QFile::remove(ctn_PACMAN_DATABASE_LOCK_FILE);
+}
+
+bool ProcessCommandExecutor::isRunning() const
+{
+  return m_running;
+}
+
+void ProcessCommandExecutor::onReadyRead()
+{
+  emit output(m_process->readAllStandardOutput());
+}
+
+void ProcessCommandExecutor::onFinished(int exitCode, QProcess::ExitStatus)
+{
+  m_exitCode = exitCode;
+  runNextCommand();
+}
+
+void ProcessCommandExecutor::onErrorOccurred(QProcess::ProcessError error)
+{
+  if (error == QProcess::FailedToStart)
+  {
+    m_helper->log(QLatin1String("octopi-helper: Could not start ") + m_process->program());
+    m_exitCode = 127;
+    runNextCommand();
+  }
+}
+
+HelperSession::HelperSession(OctopiHelper *helper, CommandExecutor *executor, QObject *parent): QObject(parent)
+{
+  m_helper = helper;
+  m_executor = executor;
+  m_client = nullptr;
+  m_ownerPid = 0;
+  m_ownerUid = 0;
+  m_quitWhenFinished = false;
+
+  m_server = new QLocalServer(this);
+  m_server->setSocketOptions(QLocalServer::UserAccessOption);
+  m_server->setMaxPendingConnections(1);
+
+  m_idleTimer.setSingleShot(true);
+  m_idleTimer.setInterval(ctn_OCTOPI_HELPER_SESSION_IDLE_TIMEOUT);
+
+  connect(m_server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+  connect(&m_idleTimer, SIGNAL(timeout()), this, SLOT(onIdleTimeout()));
+  connect(m_executor, SIGNAL(started()), this, SLOT(onExecutorStarted()));
+  connect(m_executor, SIGNAL(output(QByteArray)), this, SLOT(onExecutorOutput(QByteArray)));
+  connect(m_executor, SIGNAL(finished(int)), this, SLOT(onExecutorFinished(int)));
+}
+
+HelperSession::~HelperSession()
+{
+  setBusy(false);
+  m_server->close();
+}
+
+/*
+ * Finds the Octo tool which started this session: octphelper runs under qt-sudo (and maybe sudo or su)
+ *
+ * Returns its pid, or 0 if octphelper was not started by an Octo tool
+ */
+qint64 HelperSession::findOwnerProcess(QString &ownerPath, uint &ownerUid)
+{
+  qint64 pid = getppid();
+
+  for (int i=0; i<ctn_MAX_OWNER_SEARCH_DEPTH && pid > 1; ++i)
+  {
+    QString exe = QFileInfo(QLatin1String("/proc/") + QString::number(pid) + QLatin1String("/exe")).symLinkTarget();
+    exe.remove(QStringLiteral(" (deleted)"));
+
+    if (exe == QLatin1String("/usr/bin/octopi") || exe == QLatin1String("/usr/bin/octopi-notifier"))
+    {
+      bool ok;
+      //The real uid comes first
+      ownerUid = readProcStatusField(pid, QStringLiteral("Uid")).section(QLatin1Char('\t'), 0, 0).toUInt(&ok);
+      if (!ok) return 0;
+
+      ownerPath = exe;
+      return pid;
+    }
+
+    pid = readProcStatusField(pid, QStringLiteral("PPid")).toLongLong();
+  }
+
+  return 0;
+}
+
+/*
+ * Creates the session socket, which only the owner's user can open
+ *
+ * Returns 0 on success, otherwise an octopi-helper exit code
+ */
+int HelperSession::listen()
+{
+  m_ownerPid = findOwnerProcess(m_ownerPath, m_ownerUid);
+  if (m_ownerPid == 0)
+  {
+    m_helper->log(QLatin1String("octopi-helper[aborted]: Suspicious execution method - session not started by [/usr/bin/octopi-notifier] OR [/usr/bin/octopi]"));
+    return ctn_SUSPICIOUS_EXECUTION_METHOD;
+  }
+
+  if (!QDir().mkpath(ctn_OCTOPI_HELPER_SOCKET_DIR) ||
+      ::chmod(QFile::encodeName(ctn_OCTOPI_HELPER_SOCKET_DIR).constData(), 0755) != 0)
+  {
+    m_helper->log(QLatin1String("octopi-helper[aborted]: Could not create ") + ctn_OCTOPI_HELPER_SOCKET_DIR);
+    return ctn_COULD_NOT_START_SESSION;
+  }
+
+  return listenOn(HelperProtocol::getSocketPath(m_ownerPid), m_ownerPid, m_ownerUid, m_ownerPath);
+}
+
+/*
+ * Serves the given owner on socketPath. listen() calls it with the Octo tool found above octphelper,
+ * while tests can point it to a socket of their own
+ *
+ * Returns 0 on success, otherwise an octopi-helper exit code
+ */
+int HelperSession::listenOn(const QString &socketPath, qint64 ownerPid, uint ownerUid, const QString &ownerPath)
+{
+  m_ownerPid = ownerPid;
+  m_ownerUid = ownerUid;
+  m_ownerPath = ownerPath;
+  QLocalServer::removeServer(socketPath);
+
+  if (!m_server->listen(socketPath))
+  {
+    m_helper->log(QLatin1String("octopi-helper[aborted]: Could not listen on ") + socketPath + QLatin1String(": ") + m_server->errorString());
+    return ctn_COULD_NOT_START_SESSION;
+  }
+
+  if (::chown(QFile::encodeName(socketPath).constData(), m_ownerUid, static_cast<gid_t>(-1)) != 0)
+  {
+    m_helper->log(QLatin1String("octopi-helper[aborted]: Could not hand ") + socketPath + QLatin1String(" to its owner"));
+    m_server->close();
+    return ctn_COULD_NOT_START_SESSION;
+  }
+
+  m_helper->log(QLatin1String("Session of ") + m_ownerPath + QLatin1String(" listening on ") + socketPath);
+  m_idleTimer.start();
+
+  return 0;
+}
+
+/*
+ * The socket file is owned by the right user, but the connecting process must be the owner itself
+ */
+bool HelperSession::isPeerTheOwner(QLocalSocket *socket)
+{
+  struct ucred cred;
+  socklen_t len = sizeof(cred);
+
+  if (getsockopt(static_cast<int>(socket->socketDescriptor()), SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0)
+    return false;
+
+  return (cred.pid == m_ownerPid && cred.uid == m_ownerUid);
+}
+
+/*
+ * Octopi may run anything "octphelper -ts" accepts from it, while the notifier can only upgrade the system.
+ * Every command is checked on its own: the origins of a whole transaction, ORed together, would let
+ * the notifier slip a removal in after its "pacman -Syu"
+ */
+bool HelperSession::isTransactionAllowed(const QList<HelperCommand> &commands)
+{
+  const bool isOctopi = (m_ownerPath == QLatin1String("/usr/bin/octopi"));
+
+  for (const HelperCommand &command: commands)
+  {
+    if (command.operation == ectn_HELPER_OP_CLEAN_CACHE) return false;
+    if (isOctopi) continue;
+
+    //The notifier removes a stale database lock before upgrading, just like Octopi
+    if (command.operation != ectn_HELPER_OP_SYSTEM_UPGRADE &&
+        command.operation != ectn_HELPER_OP_SYNC_FILES &&
+        command.operation != ectn_HELPER_OP_REMOVE_LOCK) return false;
+  }
+
+  return true;
+}
+
+void HelperSession::send(HelperMessageType type, const QByteArray &payload)
+{
+  if (m_client != nullptr && m_client->state() == QLocalSocket::ConnectedState)
+    m_client->write(HelperProtocol::encode(type, payload));
+}
+
+void HelperSession::onNewConnection()
+{
+  while (m_server->hasPendingConnections())
+  {
+    QLocalSocket *socket = m_server->nextPendingConnection();
+
+    //One client per session: the Octo tool which started it
+    if (m_client != nullptr || !isPeerTheOwner(socket))
+    {
+      m_helper->log(QLatin1String("octopi-helper: Refused a session connection which does not come from ") + m_ownerPath);
+      socket->abort();
+      socket->deleteLater();
+      continue;
+    }
+
+    m_client = socket;
+    connect(m_client, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+    connect(m_client, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+  }
+}
+
+void HelperSession::onReadyRead()
+{
+  m_reader.append(m_client->readAll());
+
+  HelperMessage message;
+  while (m_reader.readMessage(message))
+  {
+    switch (message.type)
+    {
+      case ectn_HELPER_EXECUTE:
+        execute(message.payload);
+        break;
+      case ectn_HELPER_CANCEL:
+        if (m_executor->isRunning()) m_executor->cancel();
+        break;
+      case ectn_HELPER_INPUT:
+        if (m_executor->isRunning()) m_executor->write(message.payload);
+        break;
+      default:
+        m_helper->log(QLatin1String("octopi-helper: Unexpected session message ") + QString::number(message.type));
+        break;
+    }
+  }
+
+  if (m_reader.hasError())
+  {
+    m_helper->log(QLatin1String("octopi-helper[aborted]: Malformed session message"));
+    m_client->abort();
+  }
+}
+
+/*
+ * Checks the transaction just like "octphelper -ts" does, but trusts the socket peer instead of
+ * asking the Octo tool over TCP whether it is busy
+ */
+void HelperSession::execute(const QByteArray &payload)
+{
+  if (m_executor->isRunning())
+  {
+    send(ectn_HELPER_REFUSED, HelperProtocol::encodeExitCode(ctn_PACMAN_PROCESS_EXECUTING));
+    return;
+  }
+
+  QList<HelperCommand> commands;
+  int origin;
+  int res = m_helper->checkTransaction(QString::fromLatin1(payload), commands, origin);
+
+  if (res == 0 && !isTransactionAllowed(commands))
+  {
+    m_helper->log(QLatin1String("octopi-helper[aborted]: Suspicious execution method -> transaction not allowed for ") + m_ownerPath);
+    res = ctn_SUSPICIOUS_EXECUTION_METHOD;
+  }
+
+  if (res != 0)
+  {
+    send(ectn_HELPER_REFUSED, HelperProtocol::encodeExitCode(res));
+    return;
+  }
+
+  m_idleTimer.stop();
+  setBusy(true);
+  m_executor->start(commands);
+}
+
+/*
+ * If the Octo tool goes away in the middle of a transaction, pacman is left to finish it
+ */
+void HelperSession::onDisconnected()
+{
+  m_client->deleteLater();
+  m_client = nullptr;
+  m_reader.clear();
+
+  if (m_executor->isRunning())
+    m_quitWhenFinished = true;
+  else
+    quit();
+}
+
+void HelperSession::onIdleTimeout()
+{
+  if (m_executor->isRunning()) return;
+
+  m_helper->log(QLatin1String("Session of ") + m_ownerPath + QLatin1String(" timed out"));
+  quit();
+}
+
+void HelperSession::onExecutorStarted()
+{
+  send(ectn_HELPER_STARTED);
+}
+
+void HelperSession::onExecutorOutput(const QByteArray &data)
+{
+  const int chunkSize = ctn_OCTOPI_HELPER_MAX_MESSAGE_SIZE - 1;
+
+  for (int i=0; i<data.size(); i+=chunkSize)
+    send(ectn_HELPER_OUTPUT, data.mid(i, chunkSize));
+}
+
+void HelperSession::onExecutorFinished(int exitCode)
+{
+  setBusy(false);
+  send(ectn_HELPER_FINISHED, HelperProtocol::encodeExitCode(exitCode));
+
+  if (m_quitWhenFinished)
+    quit();
+  else
+    m_idleTimer.start();
+}
+
+/*
+ * Creates or removes the busy marker UnixCommand::isOctopiHelperRunning() looks for
+ */
+void HelperSession::setBusy(bool busy)
+{
+  QFile marker(HelperProtocol::getBusyMarkerPath(QCoreApplication::applicationPid()));
+
+  if (!busy)
+  {
+    if (marker.exists()) marker.remove();
+  }
+  else if (!marker.open(QIODevice::WriteOnly))
+  {
+    m_helper->log(QLatin1String("octopi-helper: Could not create ") + marker.fileName());
+  }
+}
+
+void HelperSession::quit()
+{
+  setBusy(false);
+  m_server->close();
+  QCoreApplication::exit(0);
+}
@@ -0,0 +1,138 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2019 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef HELPERSESSION_H
+#define HELPERSESSION_H
+
+#include "../src/helperprotocol.h"
+#include "transactionrequest.h"
+
+#include <QObject>
+#include <QProcess>
+#include <QTimer>
+
+class OctopiHelper;
+class QLocalServer;
+class QLocalSocket;
+
+/*
+ * @brief Runs the commands of a session's transactions
+ *
+ * HelperSession only talks to this interface, so the protocol can be driven by a fake executor
+ */
+class CommandExecutor: public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit CommandExecutor(QObject *parent = nullptr): QObject(parent) {}
+
+  //commands come from OctopiHelper::checkTransaction
+  virtual void start(const QList<HelperCommand> &commands) = 0;
+  virtual void write(const QByteArray &input) = 0;
+  virtual void cancel() = 0;
+  virtual bool isRunning() const = 0;
+
+signals:
+  void started();
+  void output(const QByteArray &data);
+  void finished(int exitCode);
+};
+
+/*
+ * @brief Runs the commands one after the other, straight from their argv
+ */
+class ProcessCommandExecutor: public CommandExecutor
+{
+  Q_OBJECT
+
+private:
+  OctopiHelper *m_helper;
+  QProcess *m_process;
+  QList<HelperCommand> m_commands;
+  int m_exitCode;
+  bool m_running;
+
+  void runNextCommand();
+
+private slots:
+  void onReadyRead();
+  void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
+  void onErrorOccurred(QProcess::ProcessError error);
+
+public:
+  explicit ProcessCommandExecutor(OctopiHelper *helper, QObject *parent = nullptr);
+
+  void start(const QList<HelperCommand> &commands) override;
+  void write(const QByteArray &input) override;
+  void cancel() override;
+  bool isRunning() const override;
+};
+
+/*
+ * @brief A root session which serves the transactions of one Octo tool - "octphelper -session"
+ *
+ * The session listens on a Unix socket owned by the user of the Octo tool which started it
+ * (thru qt-sudo) and only accepts connections from that very process, as told by SO_PEERCRED.
+ * It quits when the tool disconnects or after ctn_OCTOPI_HELPER_SESSION_IDLE_TIMEOUT without work.
+ */
+class HelperSession: public QObject
+{
+  Q_OBJECT
+
+private:
+  OctopiHelper *m_helper;
+  CommandExecutor *m_executor;
+  QLocalServer *m_server;
+  QLocalSocket *m_client;
+  HelperMessageReader m_reader;
+  QTimer m_idleTimer;
+  qint64 m_ownerPid;
+  uint m_ownerUid;
+  QString m_ownerPath;
+  bool m_quitWhenFinished;
+
+  bool isPeerTheOwner(QLocalSocket *socket);
+  bool isTransactionAllowed(const QList<HelperCommand> &commands);
+  void send(HelperMessageType type, const QByteArray &payload = QByteArray());
+  void setBusy(bool busy);
+  void execute(const QByteArray &payload);
+  void quit();
+
+private slots:
+  void onNewConnection();
+  void onReadyRead();
+  void onDisconnected();
+  void onIdleTimeout();
+  void onExecutorStarted();
+  void onExecutorOutput(const QByteArray &data);
+  void onExecutorFinished(int exitCode);
+
+public:
+  HelperSession(OctopiHelper *helper, CommandExecutor *executor, QObject *parent = nullptr);
+  virtual ~HelperSession();
+
+  int listen();
+  int listenOn(const QString &socketPath, qint64 ownerPid, uint ownerUid, const QString &ownerPath);
+
+  static qint64 findOwnerProcess(QString &ownerPath, uint &ownerUid);
+};
+
+#endif // HELPERSESSION_H
@@ -19,6 +19,7 @@
 */
 
 #include "octopihelper.h"
+#include "helpersession.h"
 #include "../src/argumentlist.h"
 #include <unistd.h>
 
@@ -58,6 +59,16 @@ int main(int argc, char *argv[])
   {
     return helper.executePkgTransactionWithSharedMem();
   }
+  else if (argList->getSwitch(QStringLiteral("-session")))
+  {
+    ProcessCommandExecutor executor(&helper);
+    HelperSession session(&helper, &executor);
+
+    int res = session.listen();
+    if (res != 0) return res;
+
+    return a.exec();
+  }
   else
   {
     QTextStream qout(stdout);
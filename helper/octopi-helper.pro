@@ -26,12 +26,20 @@ DEFINES += QT_USE_QSTRINGBUILDER \
 
 HEADERS += \
     ../src/argumentlist.h \
-    octopihelper.h
+    ../src/helperprotocol.h \
+    ../src/processtable.h \
+    helpersession.h \
+    octopihelper.h \
+    transactionrequest.h
 
 SOURCES += \
         main.cpp \
     ../src/argumentlist.cpp \
-    octopihelper.cpp
+    ../src/helperprotocol.cpp \
+    ../src/processtable.cpp \
+    helpersession.cpp \
+    octopihelper.cpp \
+    transactionrequest.cpp
 
 # install
 isEmpty(PREFIX) {
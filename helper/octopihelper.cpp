@@ -19,6 +19,7 @@
 */
 
 #include "../src/constants.h"
+#include "../src/processtable.h"
 #include "octopihelper.h"
 
 #include <QProcess>
@@ -34,7 +35,8 @@
 #include <QSettings>
 #include <QDateTime>
 
-QFile *OctopiHelper::m_temporaryFile = nullptr;
+#include <termios.h>
+#include <unistd.h>
 
 /*
  * Removes temporary transaction files
@@ -66,43 +68,21 @@ void removeTemporaryFiles()
   }
 }
 
-/*
- * Returns the SHELL environment variable, if not set defaults to bash.
- */
-QString getShell()
-{
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  QString shell = env.value(QStringLiteral("SHELL"), QStringLiteral("/usr/bin/bash"));
-  QFileInfo fi(shell);
-
-  if (fi.fileName() == QLatin1String("fish"))
-    return QStringLiteral("/usr/bin/bash");
-  else
-    return fi.fileName();
-}
-
 /*
  * If justOneInstance = false (default), returns TRUE if one instance of the app is ALREADY running
  * Otherwise, it returns TRUE if the given app is running.
  */
 bool isAppRunning(const QString &appName, bool justOneInstance)
 {
-  QStringList slParam;
-  QProcess proc;
-  slParam << QStringLiteral("-C");
-  slParam << appName;
-  proc.start(QStringLiteral("/usr/bin/ps"), slParam);
-  proc.waitForFinished();
-  QString out = QString::fromUtf8(proc.readAll());
-  proc.close();
+  int count = ProcessTable::count(appName);
 
   if (justOneInstance)
   {
-    return out.count(appName)>0;
+    return count>0;
   }
   else
   {
-    return out.count(appName)>1;
+    return count>1;
   }
 }
 
@@ -114,8 +94,6 @@ OctopiHelper::OctopiHelper()
 
   m_exitCode = -9999;
   m_process = new QProcess();
-  //m_suspiciousChars = QStringLiteral("(\\s|[][!#$&'()*,;<=+>?\\^`{}|~])");
-  m_suspiciousChars = QStringLiteral("[!#$&'()*,;<=>?\\^`{}|~\\[\\]]");
 
   //These settings enable all "pacman" output go thru QProcess output methods
   m_process->setProcessChannelMode(QProcess::ForwardedChannels);
@@ -129,8 +107,6 @@ OctopiHelper::OctopiHelper()
 OctopiHelper::~OctopiHelper()
 {
   m_process->close();
-  if (m_temporaryFile != nullptr)
-    QFile::remove(m_temporaryFile->fileName());
   removeTemporaryFiles();
 
   if (m_logFile.isOpen())
@@ -182,20 +158,8 @@ bool OctopiHelper::isOctoToolRunning(const QString &octoToolName)
 {
   bool res=false;
 
-  QProcess proc;
-  proc.setProcessEnvironment(getProcessEnvironment());
-  QStringList sl;
-  sl << QStringLiteral("-C");
-  sl << octoToolName;
-  sl << QStringLiteral("-o");
-  sl << QStringLiteral("command");
-  proc.start(QStringLiteral("/usr/bin/ps"), sl);
-  proc.waitForFinished();
-
-  QString out = QString::fromUtf8(proc.readAll().trimmed());
+  QString out = ProcessTable::commandLines(octoToolName).join(QString());
   if (out.contains(QLatin1String("|"))) return false;
-  out=out.remove(QStringLiteral("\n"));
-  out=out.remove(QStringLiteral("COMMAND"));
 
   if (octoToolName==QLatin1String("octopi-cachecle"))
   {
@@ -226,6 +190,147 @@ bool OctopiHelper::isOctoToolRunning(const QString &octoToolName)
   return res;
 }
 
+/*
+ * Environment of the commands of a transaction: getProcessEnvironment() plus Octopi's proxy
+ */
+QProcessEnvironment OctopiHelper::getTransactionEnvironment()
+{
+  QProcessEnvironment env = getProcessEnvironment();
+
+  QString proxySettings = getProxySettings();
+  if (!proxySettings.isEmpty())
+  {
+    if (proxySettings.contains(QLatin1String("ftp://")))
+      env.insert(QStringLiteral("ftp_proxy"), proxySettings);
+    else if (proxySettings.contains(QLatin1String("http://")))
+      env.insert(QStringLiteral("http_proxy"), proxySettings);
+    else if (proxySettings.contains(QLatin1String("https://")))
+      env.insert(QStringLiteral("https_proxy"), proxySettings);
+  }
+
+  return env;
+}
+
+/*
+ * Parses the given transaction, one command per line, into typed commands.
+ * The origin flags tell which Octo tools are allowed to ask for it.
+ *
+ * Returns 0 if the transaction can be executed, otherwise an octopi-helper exit code
+ */
+int OctopiHelper::checkTransaction(const QString &contents, QList<HelperCommand> &commands, int &origin)
+{
+  QString badLine;
+
+  if (!TransactionRequest::parse(contents, commands, origin, badLine))
+  {
+    log(QLatin1String("octopi-helper[aborted]: Suspicious transaction detected -> \"") + badLine + QLatin1String("\""));
+    return ctn_SUSPICIOUS_ACTIONS_FILE;
+  }
+
+  //If there is a "pacman" process executing elsewhere, let's abort octopi-helper (unless we came to kill it)!
+  bool justCancelling = true;
+  for (const HelperCommand &command: std::as_const(commands))
+  {
+    if (command.operation != ectn_HELPER_OP_KILL_PACMAN && command.operation != ectn_HELPER_OP_REMOVE_LOCK)
+    {
+      justCancelling = false;
+      break;
+    }
+  }
+
+  //A session may get its next transaction right after the last pacman has exited
+  ProcessTable::invalidate();
+  if (!justCancelling && isAppRunning(QStringLiteral("pacman"), true))
+  {
+    log(QLatin1String("octopi-helper[aborted]: Pacman process already running"));
+    return ctn_PACMAN_PROCESS_EXECUTING;
+  }
+
+  return 0;
+}
+
+/*
+ * Does what the commands done by octopi-helper itself (see TransactionRequest::needsProcess) did in a shell
+ *
+ * Returns the command's exit code
+ */
+int OctopiHelper::executeBuiltinCommand(const HelperCommand &command)
+{
+  QTextStream qout(stdout);
+
+  switch (command.operation)
+  {
+    case ectn_HELPER_OP_REMOVE_LOCK:
+      return (QFile::remove(ctn_PACMAN_DATABASE_LOCK_FILE) ? 0 : 1);
+
+    case ectn_HELPER_OP_PRINT:
+      qout << command.text << Qt::endl;
+      return 0;
+
+    case ectn_HELPER_OP_WAIT_FOR_KEY:
+    {
+      qout << command.text;
+      qout.flush();
+
+      //Like "read -n 1": one key, without waiting for Enter nor echoing it
+      struct termios oldSettings;
+      bool isTerminal = (tcgetattr(STDIN_FILENO, &oldSettings) == 0);
+      if (isTerminal)
+      {
+        struct termios newSettings = oldSettings;
+        newSettings.c_lflag &= ~(ICANON | ECHO);
+        newSettings.c_cc[VMIN] = 1;
+        newSettings.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &newSettings);
+      }
+
+      char key;
+      ssize_t res = read(STDIN_FILENO, &key, 1);
+
+      if (isTerminal) tcsetattr(STDIN_FILENO, TCSANOW, &oldSettings);
+      return (res == 1 ? 0 : 1);
+    }
+
+    default:
+      return 1;
+  }
+}
+
+/*
+ * Executes the commands one after the other, straight from their argv, just like the shell ran the
+ * old transaction scripts: a failing command does not stop the next ones
+ *
+ * Returns the exit code of the last command
+ */
+int OctopiHelper::executeCommands(const QList<HelperCommand> &commands)
+{
+  int exitCode = 0;
+  m_process->setProcessEnvironment(getTransactionEnvironment());
+
+  for (const HelperCommand &command: commands)
+  {
+    log(QLatin1String("Exec as root: ") + TransactionRequest::toString(command));
+
+    if (!TransactionRequest::needsProcess(command))
+    {
+      exitCode = executeBuiltinCommand(command);
+      continue;
+    }
+
+    m_process->start(TransactionRequest::program(command), TransactionRequest::arguments(command));
+    if (!m_process->waitForStarted(-1))
+    {
+      exitCode = 127;
+      continue;
+    }
+
+    m_process->waitForFinished(-1);
+    exitCode = m_process->exitCode();
+  }
+
+  return exitCode;
+}
+
 /*
  * Executes all commands inside Octopi's SharedMemory - "octopi-helper -ts"
  */
@@ -257,90 +362,14 @@ int OctopiHelper::executePkgTransactionWithSharedMem()
   sharedMem->detach();
   delete sharedMem;
 
-  bool suspicious = false;
-
-  if (contents.isEmpty() || contents.contains(QRegularExpression(m_suspiciousChars)))
-    suspicious = true;
-
-  if (suspicious)
-  {
-    log(QLatin1String("octopi-helper[aborted]: Suspicious transaction detected -> \"") + contents + QLatin1String("\""));
-    return ctn_SUSPICIOUS_ACTIONS_FILE;
-  }
-
-  const QStringList lines = contents.split(QStringLiteral("\n"), Qt::SkipEmptyParts);
-  bool testCommandFromOctopi=false;
-  bool testCommandFromNotifier=false;
-  bool testCommandFromCacheCleaner=false;
-
-  for(auto line : lines)
-  {
-    line = line.trimmed();
-
-    if ((line == QLatin1String("killall pacman")) ||
-      (line == QLatin1String("rm ") + ctn_PACMAN_DATABASE_LOCK_FILE) ||
-      (line == QLatin1String("echo -e")) ||
-      (line == QLatin1String("echo \"PAKtC\"")) ||
-      (line == QLatin1String("read -n 1 -p \"PAKtC\"")) ||
-      (line == QLatin1String("pkgfile -u")) ||
-      (line == QLatin1String("paccache -r -k 0")) ||
-      (line == QLatin1String("paccache -r -k 1")) ||
-      (line == QLatin1String("paccache -r -k 2")) ||
-      (line == QLatin1String("paccache -r -k 3")) ||
-      (line == QLatin1String("pacman -Fy")) ||
-      (line == QLatin1String("pacman -Syu")) ||
-      (line == QLatin1String("pacman -Syu --noconfirm")) ||
-      (line.startsWith(QLatin1String("pacman -D --asexplicit "))) ||
-      (line.startsWith(QLatin1String("pacman -D --asdeps "))) ||
-      (line.startsWith(QLatin1String("pacman -S "))) ||
-      (line.startsWith(QLatin1String("pacman -R "))))
-    {
-      if (line.startsWith(QLatin1String("pacman -D --asexplicit ")) ||
-          line.startsWith(QLatin1String("pacman -D --asdeps ")) ||
-          line.startsWith(QLatin1String("pacman -S ")) ||
-          line.startsWith(QLatin1String("pacman -R ")))
-      {
-        testCommandFromOctopi=true;
-      }
-      else if (line.startsWith(QLatin1String("pacman -Syu")))
-      {
-        testCommandFromOctopi=true;
-        testCommandFromNotifier=true;
-      }
-      else if (line.startsWith(QLatin1String("paccache -r -k")))
-      {
-        testCommandFromCacheCleaner=true;
-      }
-    }
-    else
-    {
-      suspicious = true;
-    }
-
-    if (suspicious)
-    {
-      log(QLatin1String("octopi-helper[aborted]: Suspicious transaction detected -> \"") + line + QLatin1String("\""));
-      return ctn_SUSPICIOUS_ACTIONS_FILE;
-    }
-  }
+  QList<HelperCommand> commands;
+  int origin;
+  int res = checkTransaction(contents, commands, origin);
+  if (res != 0) return res;
 
-  //Using full path binaries
-  contents = contents.replace(QLatin1String("killall pacman"), QLatin1String("/usr/bin/killall pacman"));
-  contents = contents.replace(QLatin1String("rm ") + ctn_PACMAN_DATABASE_LOCK_FILE, QLatin1String("/usr/bin/rm ") + ctn_PACMAN_DATABASE_LOCK_FILE);
-  contents = contents.replace(QLatin1String("pkgfile -u"), QLatin1String("/usr/bin/pkgfile -u"));
-  contents = contents.replace(QLatin1String("paccache -r"), QLatin1String("/usr/bin/paccache -r"));
-  contents = contents.replace(QLatin1String("pacman -Fy"), QLatin1String("/usr/bin/pacman -Fy"));
-  contents = contents.replace(QLatin1String("pacman -Syu"), QLatin1String("/usr/bin/pacman -Syu"));
-  contents = contents.replace(QLatin1String("pacman -D "), QLatin1String("/usr/bin/pacman -D "));
-  contents = contents.replace(QLatin1String("pacman -S "), QLatin1String("/usr/bin/pacman -S "));
-  contents = contents.replace(QLatin1String("pacman -R "), QLatin1String("/usr/bin/pacman -R "));
-
-  //If there is a "pacman" process executing elsewhere, let's abort octopi-helper!
-  if (contents != QLatin1String("/usr/bin/killall pacman\n/usr/bin/rm ") + ctn_PACMAN_DATABASE_LOCK_FILE +QLatin1Char('\n') && isAppRunning(QStringLiteral("pacman"), true))
-  {
-    log(QLatin1String("octopi-helper[aborted]: Pacman process already running"));
-    return ctn_PACMAN_PROCESS_EXECUTING;
-  }
+  bool testCommandFromOctopi=(origin & ectn_ORIGIN_OCTOPI);
+  bool testCommandFromNotifier=(origin & ectn_ORIGIN_NOTIFIER);
+  bool testCommandFromCacheCleaner=(origin & ectn_ORIGIN_CACHECLEANER);
 
   if (testCommandFromOctopi)
   {
@@ -474,32 +503,5 @@ int OctopiHelper::executePkgTransactionWithSharedMem()
     }
   }
 
-  //Let's construct the root owned execution file
-  QFile *ftemp = generateTemporaryFile();
-  QTextStream out(ftemp);
-
-  QString proxySettings = getProxySettings();
-  if (!proxySettings.isEmpty())
-  {
-    if (proxySettings.contains(QLatin1String("ftp://")))
-      out << QLatin1String("export ftp_proxy=") + proxySettings + QLatin1Char('\n');
-    else if (proxySettings.contains(QLatin1String("http://")))
-      out << QLatin1String("export http_proxy=") + proxySettings + QLatin1Char('\n');
-    else if (proxySettings.contains(QLatin1String("https://")))
-      out << QLatin1String("export https_proxy=") + proxySettings + QLatin1Char('\n');
-  }
-
-  out << QLatin1String("unalias -a\n") << contents;
-
-  log(QLatin1String("Exec as root: ") + contents.trimmed());
-
-  out.flush();
-  ftemp->close();
-
-  m_process->setProcessEnvironment(getProcessEnvironment());
-  m_process->start(getShell(), QStringList() << m_temporaryFile->fileName());
-  m_process->waitForStarted(-1);
-  m_process->waitForFinished(-1);
-
-  return m_process->exitCode();
+  return executeCommands(commands);
 }
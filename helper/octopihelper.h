@@ -22,11 +22,13 @@
 #define OCTOPIHELPER_H
 
 #include "../src/constants.h"
+#include "transactionrequest.h"
 
 #include <QString>
 #include <QProcess>
 #include <QFile>
-#include <QRandomGenerator>
+
+bool isAppRunning(const QString &appName, bool justOneInstance = false);
 
 class OctopiHelper: QObject
 {
@@ -35,28 +37,20 @@ Q_OBJECT
 private:
   int m_exitCode;
   QProcess *m_process;
-  QProcessEnvironment getProcessEnvironment();
-  QString m_suspiciousChars;
   QFile m_logFile;
 
-  static QFile *m_temporaryFile;
-
   static QString getProxySettings();
 
-  static QFile* generateTemporaryFile(){
-    quint32 gen = QRandomGenerator::global()->generate();
-    m_temporaryFile = new QFile(ctn_TEMP_ACTIONS_FILE + QString::number(gen));
-    m_temporaryFile->open(QIODevice::ReadWrite|QIODevice::Text);
-    m_temporaryFile->setPermissions(QFile::Permissions(QFile::ExeOwner|QFile::ReadOwner));
-
-    return m_temporaryFile;
-  }
-
 public:
   OctopiHelper();
   virtual ~OctopiHelper();
 
   void log(const QString &str);
+  QProcessEnvironment getProcessEnvironment();
+  QProcessEnvironment getTransactionEnvironment();
+  int checkTransaction(const QString &contents, QList<HelperCommand> &commands, int &origin);
+  int executeBuiltinCommand(const HelperCommand &command);
+  int executeCommands(const QList<HelperCommand> &commands);
   int executePkgTransactionWithSharedMem();
   inline int getExitCode() { return m_exitCode; }
   bool isOctoToolRunning(const QString &octoToolName);
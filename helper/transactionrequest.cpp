@@ -0,0 +1,307 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2019 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "transactionrequest.h"
+#include "../src/constants.h"
+
+#include <QRegularExpression>
+
+/*
+ * What StrConstants::getPressAnyKey() returns: Octopi's terminal waits for it
+ */
+static const QString ctn_PRESS_ANY_KEY(QStringLiteral("PAKtC"));
+
+/*
+ * Parses every line of contents. On failure, badLine holds the offending line
+ */
+bool TransactionRequest::parse(const QString &contents, QList<HelperCommand> &commands, int &origin, QString &badLine)
+{
+  commands.clear();
+  origin = 0;
+
+  const QStringList lines = contents.split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+  for (const QString &line: lines)
+  {
+    const QString simplifiedLine = line.simplified();
+    if (simplifiedLine.isEmpty()) continue;
+
+    HelperCommand command;
+    if (!parseLine(simplifiedLine.split(QLatin1Char(' ')), command))
+    {
+      badLine = line;
+      return false;
+    }
+
+    switch (command.operation)
+    {
+      case ectn_HELPER_OP_INSTALL:
+      case ectn_HELPER_OP_REMOVE:
+      case ectn_HELPER_OP_MARK_EXPLICIT:
+      case ectn_HELPER_OP_MARK_AS_DEPS:
+        origin |= ectn_ORIGIN_OCTOPI;
+        break;
+      case ectn_HELPER_OP_SYSTEM_UPGRADE:
+        origin |= ectn_ORIGIN_OCTOPI | ectn_ORIGIN_NOTIFIER;
+        break;
+      case ectn_HELPER_OP_CLEAN_CACHE:
+        origin |= ectn_ORIGIN_CACHECLEANER;
+        break;
+      default:
+        break;
+    }
+
+    commands.append(command);
+  }
+
+  if (commands.isEmpty())
+  {
+    badLine = contents;
+    return false;
+  }
+
+  return true;
+}
+
+bool TransactionRequest::parseLine(const QStringList &tokens, HelperCommand &command)
+{
+  command.flags = 0;
+  command.keep = 0;
+
+  const QString &program = tokens.at(0);
+  const int count = tokens.count();
+  const QString quotedPressAnyKey = QLatin1Char('"') + ctn_PRESS_ANY_KEY + QLatin1Char('"');
+
+  if (program == QLatin1String("killall"))
+  {
+    command.operation = ectn_HELPER_OP_KILL_PACMAN;
+    return (count == 2 && tokens.at(1) == QLatin1String("pacman"));
+  }
+  else if (program == QLatin1String("rm"))
+  {
+    command.operation = ectn_HELPER_OP_REMOVE_LOCK;
+    return (count == 2 && tokens.at(1) == ctn_PACMAN_DATABASE_LOCK_FILE);
+  }
+  else if (program == QLatin1String("echo"))
+  {
+    command.operation = ectn_HELPER_OP_PRINT;
+    if (count != 2) return false;
+
+    //"echo -e" just prints a new line
+    if (tokens.at(1) == QLatin1String("-e")) return true;
+
+    command.text = ctn_PRESS_ANY_KEY;
+    return (tokens.at(1) == quotedPressAnyKey);
+  }
+  else if (program == QLatin1String("read"))
+  {
+    command.operation = ectn_HELPER_OP_WAIT_FOR_KEY;
+    command.text = ctn_PRESS_ANY_KEY;
+    return (count == 5 && tokens.at(1) == QLatin1String("-n") && tokens.at(2) == QLatin1String("1") &&
+            tokens.at(3) == QLatin1String("-p") && tokens.at(4) == quotedPressAnyKey);
+  }
+  else if (program == QLatin1String("pkgfile"))
+  {
+    command.operation = ectn_HELPER_OP_UPDATE_PKGFILE;
+    return (count == 2 && tokens.at(1) == QLatin1String("-u"));
+  }
+  else if (program == QLatin1String("paccache"))
+  {
+    command.operation = ectn_HELPER_OP_CLEAN_CACHE;
+    if (count != 4 || tokens.at(1) != QLatin1String("-r") || tokens.at(2) != QLatin1String("-k")) return false;
+
+    static const QRegularExpression reKeep(QStringLiteral("^[0-3]$"));
+    if (!reKeep.match(tokens.at(3)).hasMatch()) return false;
+
+    command.keep = tokens.at(3).toInt();
+    return true;
+  }
+  else if (program != QLatin1String("pacman") || count < 2)
+  {
+    return false;
+  }
+
+  const QString &operation = tokens.at(1);
+
+  if (operation == QLatin1String("-Fy"))
+  {
+    command.operation = ectn_HELPER_OP_SYNC_FILES;
+    return (count == 2);
+  }
+  else if (operation == QLatin1String("-Syu"))
+  {
+    command.operation = ectn_HELPER_OP_SYSTEM_UPGRADE;
+    if (count == 2) return true;
+
+    command.flags |= ectn_HELPER_FLAG_NOCONFIRM;
+    return (count == 3 && tokens.at(2) == QLatin1String("--noconfirm"));
+  }
+  else if (operation == QLatin1String("-D"))
+  {
+    if (count < 3) return false;
+
+    if (tokens.at(2) == QLatin1String("--asexplicit"))
+      command.operation = ectn_HELPER_OP_MARK_EXPLICIT;
+    else if (tokens.at(2) == QLatin1String("--asdeps"))
+      command.operation = ectn_HELPER_OP_MARK_AS_DEPS;
+    else
+      return false;
+
+    return parsePackages(tokens, 3, false, command);
+  }
+  else if (operation == QLatin1String("-S") || operation == QLatin1String("-R"))
+  {
+    command.operation = (operation == QLatin1String("-S") ? ectn_HELPER_OP_INSTALL : ectn_HELPER_OP_REMOVE);
+
+    int i=2;
+    for (; i<count && tokens.at(i).startsWith(QLatin1String("--")); ++i)
+    {
+      if (tokens.at(i) == QLatin1String("--noconfirm"))
+        command.flags |= ectn_HELPER_FLAG_NOCONFIRM;
+      else if (tokens.at(i) == QLatin1String("--asdeps") && command.operation == ectn_HELPER_OP_INSTALL)
+        command.flags |= ectn_HELPER_FLAG_ASDEPS;
+      else
+        return false;
+    }
+
+    return parsePackages(tokens, i, command.operation == ectn_HELPER_OP_INSTALL, command);
+  }
+
+  return false;
+}
+
+/*
+ * At least one package, and all of them with valid names
+ */
+bool TransactionRequest::parsePackages(const QStringList &tokens, int from, bool allowRepository, HelperCommand &command)
+{
+  if (from >= tokens.count()) return false;
+
+  for (int i=from; i<tokens.count(); ++i)
+  {
+    if (!isValidPackageName(tokens.at(i), allowRepository)) return false;
+    command.packages.append(tokens.at(i));
+  }
+
+  return true;
+}
+
+/*
+ * Package names as makepkg accepts them. If allowRepository, they may be qualified with their repository: "extra/octopi"
+ */
+bool TransactionRequest::isValidPackageName(const QString &name, bool allowRepository)
+{
+  static const QRegularExpression reName(QStringLiteral("^[A-Za-z0-9@_+][A-Za-z0-9@._+-]*$"));
+  static const QRegularExpression reQualifiedName(
+        QStringLiteral("^(?:[A-Za-z0-9][A-Za-z0-9_.-]*/)?[A-Za-z0-9@_+][A-Za-z0-9@._+-]*$"));
+
+  return (allowRepository ? reQualifiedName : reName).match(name).hasMatch();
+}
+
+/*
+ * PRINT, WAIT_FOR_KEY and REMOVE_LOCK are done by octopi-helper itself
+ */
+bool TransactionRequest::needsProcess(const HelperCommand &command)
+{
+  return (command.operation != ectn_HELPER_OP_REMOVE_LOCK && command.operation != ectn_HELPER_OP_PRINT &&
+          command.operation != ectn_HELPER_OP_WAIT_FOR_KEY);
+}
+
+QString TransactionRequest::program(const HelperCommand &command)
+{
+  switch (command.operation)
+  {
+    case ectn_HELPER_OP_KILL_PACMAN: return QStringLiteral("/usr/bin/killall");
+    case ectn_HELPER_OP_UPDATE_PKGFILE: return QStringLiteral("/usr/bin/pkgfile");
+    case ectn_HELPER_OP_CLEAN_CACHE: return QStringLiteral("/usr/bin/paccache");
+    case ectn_HELPER_OP_SYNC_FILES:
+    case ectn_HELPER_OP_SYSTEM_UPGRADE:
+    case ectn_HELPER_OP_INSTALL:
+    case ectn_HELPER_OP_REMOVE:
+    case ectn_HELPER_OP_MARK_EXPLICIT:
+    case ectn_HELPER_OP_MARK_AS_DEPS: return QStringLiteral("/usr/bin/pacman");
+    default: return QString();
+  }
+}
+
+/*
+ * Package names come after "--", so pacman never takes them as options
+ */
+QStringList TransactionRequest::arguments(const HelperCommand &command)
+{
+  QStringList res;
+
+  switch (command.operation)
+  {
+    case ectn_HELPER_OP_KILL_PACMAN:
+      res << QStringLiteral("pacman");
+      break;
+    case ectn_HELPER_OP_UPDATE_PKGFILE:
+      res << QStringLiteral("-u");
+      break;
+    case ectn_HELPER_OP_CLEAN_CACHE:
+      res << QStringLiteral("-r") << QStringLiteral("-k") << QString::number(command.keep);
+      break;
+    case ectn_HELPER_OP_SYNC_FILES:
+      res << QStringLiteral("-Fy");
+      break;
+    case ectn_HELPER_OP_SYSTEM_UPGRADE:
+      res << QStringLiteral("-Syu");
+      break;
+    case ectn_HELPER_OP_INSTALL:
+      res << QStringLiteral("-S");
+      if (command.flags & ectn_HELPER_FLAG_ASDEPS) res << QStringLiteral("--asdeps");
+      break;
+    case ectn_HELPER_OP_REMOVE:
+      res << QStringLiteral("-R");
+      break;
+    case ectn_HELPER_OP_MARK_EXPLICIT:
+      res << QStringLiteral("-D") << QStringLiteral("--asexplicit");
+      break;
+    case ectn_HELPER_OP_MARK_AS_DEPS:
+      res << QStringLiteral("-D") << QStringLiteral("--asdeps");
+      break;
+    default:
+      return res;
+  }
+
+  if (command.flags & ectn_HELPER_FLAG_NOCONFIRM) res << QStringLiteral("--noconfirm");
+
+  if (!command.packages.isEmpty())
+  {
+    res << QStringLiteral("--");
+    res << command.packages;
+  }
+
+  return res;
+}
+
+/*
+ * The command as it is logged
+ */
+QString TransactionRequest::toString(const HelperCommand &command)
+{
+  switch (command.operation)
+  {
+    case ectn_HELPER_OP_REMOVE_LOCK: return QLatin1String("rm ") + ctn_PACMAN_DATABASE_LOCK_FILE;
+    case ectn_HELPER_OP_PRINT: return QLatin1String("echo ") + command.text;
+    case ectn_HELPER_OP_WAIT_FOR_KEY: return QLatin1String("read ") + command.text;
+    default: return program(command) + QLatin1Char(' ') + arguments(command).join(QLatin1Char(' '));
+  }
+}
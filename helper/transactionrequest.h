@@ -0,0 +1,81 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2019 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef TRANSACTIONREQUEST_H
+#define TRANSACTIONREQUEST_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/*
+ * Which Octo tools may ask for a transaction
+ */
+enum TransactionOrigin { ectn_ORIGIN_OCTOPI=1, ectn_ORIGIN_NOTIFIER=2, ectn_ORIGIN_CACHECLEANER=4 };
+
+/*
+ * Everything octopi-helper knows how to do
+ */
+enum HelperOperation { ectn_HELPER_OP_KILL_PACMAN, ectn_HELPER_OP_REMOVE_LOCK, ectn_HELPER_OP_PRINT,
+                       ectn_HELPER_OP_WAIT_FOR_KEY, ectn_HELPER_OP_UPDATE_PKGFILE, ectn_HELPER_OP_CLEAN_CACHE,
+                       ectn_HELPER_OP_SYNC_FILES, ectn_HELPER_OP_SYSTEM_UPGRADE, ectn_HELPER_OP_INSTALL,
+                       ectn_HELPER_OP_REMOVE, ectn_HELPER_OP_MARK_EXPLICIT, ectn_HELPER_OP_MARK_AS_DEPS };
+
+enum HelperCommandFlag { ectn_HELPER_FLAG_NOCONFIRM=1, ectn_HELPER_FLAG_ASDEPS=2 };
+
+struct HelperCommand
+{
+  HelperOperation operation;
+  int flags;              // HelperCommandFlag bits
+  int keep;               // versions paccache keeps
+  QString text;           // what PRINT and WAIT_FOR_KEY show
+  QStringList packages;
+};
+
+/*
+ * @brief Parses the commands Octo tools send to octopi-helper into typed ones
+ *
+ * Each line must be one of the commands below, written just like Octopi does, and package names must
+ * follow the ALPM grammar. Only "pacman -S" takes a "repository/" prefix, as pacman does.
+ * Commands are then executed with argv, without any shell:
+ *
+ *   killall pacman                    rm /var/lib/pacman/db.lck
+ *   echo -e                           echo "PAKtC"
+ *   read -n 1 -p "PAKtC"              pkgfile -u
+ *   paccache -r -k <0-3>              pacman -Fy
+ *   pacman -Syu [--noconfirm]         pacman -S [--noconfirm] [--asdeps] <packages>
+ *   pacman -R [--noconfirm] <pkgs>    pacman -D --asexplicit|--asdeps <packages>
+ */
+class TransactionRequest
+{
+public:
+  static bool parse(const QString &contents, QList<HelperCommand> &commands, int &origin, QString &badLine);
+  static bool isValidPackageName(const QString &name, bool allowRepository = false);
+  static bool needsProcess(const HelperCommand &command);
+  static QString program(const HelperCommand &command);
+  static QStringList arguments(const HelperCommand &command);
+  static QString toString(const HelperCommand &command);
+
+private:
+  static bool parseLine(const QStringList &tokens, HelperCommand &command);
+  static bool parsePackages(const QStringList &tokens, int from, bool allowRepository, HelperCommand &command);
+};
+
+#endif // TRANSACTIONREQUEST_H
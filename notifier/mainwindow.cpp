@@ -23,6 +23,7 @@
 #include "../src/strconstants.h"
 #include "../src/uihelper.h"
 #include "../src/package.h"
+#include "../src/packageinfocache.h"
 #include "../src/transactiondialog.h"
 #include "../src/optionsdialog.h"
 #include "../src/utils.h"
@@ -65,6 +66,9 @@ MainWindow::MainWindow(QWidget *parent) :
 
   connect(m_pacmanDatabaseSystemWatcher,
           SIGNAL(directoryChanged(QString)), this, SLOT(refreshAppIcon()));
+  //Unlike the one above, this connection is never dropped while the icon is being refreshed
+  connect(m_pacmanDatabaseSystemWatcher,
+          SIGNAL(directoryChanged(QString)), this, SLOT(onPacmanDatabaseChanged()));
 
   m_tcpServer = new QTcpServer(this);
   connect(m_tcpServer, &QTcpServer::newConnection, this, &MainWindow::onSendInfoToOctopiHelper);
@@ -719,6 +723,9 @@ void MainWindow::doSystemUpgradeFinished(int exitCode)
   m_outputDialog = nullptr;
   m_commandExecuting = ectn_NONE;
 
+  //Even a failed upgrade may have changed some packages
+  PackageInfoCache::clear();
+
   if (exitCode == 0)
   {
     m_checkUpdatesStringList.clear();
@@ -733,6 +740,14 @@ void MainWindow::doSystemUpgradeFinished(int exitCode)
   }
 }
 
+/*
+ * Whenever there is a change in the pacman database, the package info kept by PackageInfoCache is stale
+ */
+void MainWindow::onPacmanDatabaseChanged()
+{
+  PackageInfoCache::clear();
+}
+
 /*
  * After a second upgrade window was closed...
  */
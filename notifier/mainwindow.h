@@ -68,6 +68,7 @@ private slots:
 
   void refreshOutdatedPkgsTooltip();
   void refreshAppIcon();
+  void onPacmanDatabaseChanged();
   void runOctopi(ExecOpt execOptions = ectn_SYSUPGRADE_EXEC_OPT);
   void runOctopiCheckUpdates();
   void runOctopiSysUpgrade();
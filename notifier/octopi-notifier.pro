@@ -55,13 +55,21 @@ HEADERS  += \
     ../src/uihelper.h \
     ../src/terminal.h \
     ../src/unixcommand.h \
+    ../src/processtable.h \
     ../src/wmhelper.h \
     ../src/strconstants.h \
     ../src/package.h \
+    ../src/outputsanitizer.h \
+    ../src/packageinfocache.h \
     ../src/utils.h \
     ../src/transactiondialog.h \
     ../src/argumentlist.h \
     ../src/pacmanexec.h \
+    ../src/recentstringset.h \
+    ../src/transactionprogressparser.h \
+    ../src/transactiontimeline.h \
+    ../src/helperprotocol.h \
+    ../src/helperclient.h \
     ../src/searchlineedit.h \
     ../src/searchbar.h \
     ../src/optionsdialog.h \
@@ -80,7 +88,10 @@ SOURCES += main.cpp \
     ../src/QtSolutions/qtlocalpeer.cpp \
     ../src/terminal.cpp \
     ../src/unixcommand.cpp \
+    ../src/processtable.cpp \
     ../src/package.cpp \
+    ../src/outputsanitizer.cpp \
+    ../src/packageinfocache.cpp \
     ../src/wmhelper.cpp \
     ../src/strconstants.cpp \
     ../src/settingsmanager.cpp \
@@ -88,6 +99,11 @@ SOURCES += main.cpp \
     ../src/transactiondialog.cpp \
     ../src/argumentlist.cpp \
     ../src/pacmanexec.cpp \
+    ../src/recentstringset.cpp \
+    ../src/transactionprogressparser.cpp \
+    ../src/transactiontimeline.cpp \
+    ../src/helperprotocol.cpp \
+    ../src/helperclient.cpp \
     ../src/searchlineedit.cpp \
     ../src/searchbar.cpp \
     ../src/optionsdialog.cpp \
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT += core gui network xml widgets
+QT += core gui network xml widgets concurrent
 DEFINES += OCTOPI_EXTENSIONS ALPM_BACKEND
 
 # Disable automatic string conversions
@@ -18,7 +18,7 @@ CONFIG += qt warn_on debug link_pkgconfig ALPM_BACKEND USE_QTERMWIDGET6
 
 ALPM_BACKEND {
   QMAKE_CXXFLAGS += -std=c++17
-  PKGCONFIG += glib-2.0 libalpm
+  PKGCONFIG += glib-2.0 libalpm libarchive
   LIBS += -lalpm_octopi_utils
 } else {
   QMAKE_CXXFLAGS += -std=c++17
@@ -51,7 +51,9 @@ HEADERS += src/QtSolutions/qtsingleapplication.h \
         src/settingsmanager.h \
         src/uihelper.h \
         src/package.h \
+        src/outputsanitizer.h \
         src/unixcommand.h \
+        src/processtable.h \
         src/wmhelper.h \
         src/treeviewpackagesitemdelegate.h \
         src/searchbar.h \
@@ -60,14 +62,28 @@ HEADERS += src/QtSolutions/qtsingleapplication.h \
         src/multiselectiondialog.h \
         src/packagerepository.h \
         src/model/packagemodel.h \
+        src/model/fuzzymatcher.h \
+        src/model/packagequery.h \
+        src/model/packagefilemodel.h \
         src/ui/octopitabinfo.h \
         src/utils.h \
         src/terminal.h \
         src/pacmanexec.h \
+        src/recentstringset.h \
+        src/transactionprogressparser.h \
+        src/transactiontimeline.h \
+        src/helperprotocol.h \
+        src/helperclient.h \
         src/constants.h \
         src/optionsdialog.h \
         src/packagetreeview.h \
-        src/termwidget.h
+        src/termwidget.h \
+        src/trigramindex.h \
+        src/packagebitset.h \
+        src/packageinfocache.h \
+        src/packageprefetcher.h \
+        src/fileownershipindex.h \
+        src/syncfilessearcher.h
 
 ALPM_BACKEND{
   HEADERS += src/alpmbackend.h
@@ -87,7 +103,9 @@ SOURCES += src/QtSolutions/qtsingleapplication.cpp \
         src/argumentlist.cpp \
         src/settingsmanager.cpp \
         src/package.cpp \
+        src/outputsanitizer.cpp \
         src/unixcommand.cpp \
+        src/processtable.cpp \
         src/wmhelper.cpp \
         src/treeviewpackagesitemdelegate.cpp \
         src/mainwindow_init.cpp \
@@ -103,13 +121,27 @@ SOURCES += src/QtSolutions/qtsingleapplication.cpp \
         src/multiselectiondialog.cpp \
         src/packagerepository.cpp \
         src/model/packagemodel.cpp \
+        src/model/fuzzymatcher.cpp \
+        src/model/packagequery.cpp \
+        src/model/packagefilemodel.cpp \
         src/ui/octopitabinfo.cpp \
         src/utils.cpp \
         src/terminal.cpp \
         src/pacmanexec.cpp \
+        src/recentstringset.cpp \
+        src/transactionprogressparser.cpp \
+        src/transactiontimeline.cpp \
+        src/helperprotocol.cpp \
+        src/helperclient.cpp \
         src/optionsdialog.cpp \
         src/packagetreeview.cpp \
-        src/termwidget.cpp
+        src/termwidget.cpp \
+        src/trigramindex.cpp \
+        src/packagebitset.cpp \
+        src/packageinfocache.cpp \
+        src/packageprefetcher.cpp \
+        src/fileownershipindex.cpp \
+        src/syncfilessearcher.cpp
 
 ALPM_BACKEND{
   SOURCES += src/alpmbackend.cpp
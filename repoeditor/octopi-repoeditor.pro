@@ -29,6 +29,8 @@ HEADERS += addrepo.h \
            repoentry.h \
            ../src/qaesencryption.h \
            ../src/unixcommand.h \
+           ../src/helperprotocol.h \
+           ../src/processtable.h \
            ../src/strconstants.h \
            ../src/wmhelper.h \
            ../src/terminal.h \
@@ -36,6 +38,8 @@ HEADERS += addrepo.h \
            ../src/searchlineedit.h \
            ../src/utils.h \
            ../src/package.h \
+           ../src/outputsanitizer.h \
+           ../src/packageinfocache.h \
            ../src/QtSolutions/qtsingleapplication.h \
            ../src/QtSolutions/qtlocalpeer.h \
            ../src/QtSolutions/qtlockedfile.h \
@@ -50,6 +54,8 @@ SOURCES += addrepo.cpp \
            repoentry.cpp \
            ../src/qaesencryption.cpp \
            ../src/unixcommand.cpp \
+           ../src/helperprotocol.cpp \
+           ../src/processtable.cpp \
            ../src/strconstants.cpp \
            ../src/wmhelper.cpp \
            ../src/terminal.cpp \
@@ -57,6 +63,8 @@ SOURCES += addrepo.cpp \
            ../src/searchlineedit.cpp \
            ../src/utils.cpp \
            ../src/package.cpp \
+           ../src/outputsanitizer.cpp \
+           ../src/packageinfocache.cpp \
            ../src/QtSolutions/qtsingleapplication.cpp \
            ../src/QtSolutions/qtlocalpeer.cpp \
            ../src/QtSolutions/qtlockedfile.cpp \
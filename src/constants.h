@@ -145,7 +145,11 @@ const QString ctn_KEY_TERMINAL_COLOR_SCHEME(QStringLiteral("Terminal_Color_Schem
 const QString ctn_KEY_TERMINAL_FONT_FAMILY(QStringLiteral("Terminal_Font_Family"));
 const QString ctn_KEY_TERMINAL_FONT_POINT_SIZE(QStringLiteral("Terminal_Font_Point_Size"));
 const QString ctn_KEY_INSTANT_SEARCH(QStringLiteral("Instant_Search"));
+const QString ctn_KEY_FUZZY_SEARCH(QStringLiteral("Fuzzy_Search"));
 const QString ctn_KEY_PROXY_SETTINGS(QStringLiteral("Proxy_Settings"));
+const QString ctn_KEY_PARALLEL_FILTER_THRESHOLD(QStringLiteral("Parallel_Filter_Threshold"));
+const QString ctn_KEY_FILTER_DELAY(QStringLiteral("Filter_Delay"));
+const QString ctn_KEY_OUTPUT_MAX_LINES(QStringLiteral("Output_Max_Lines"));
 const QString ctn_AUTOMATIC(QStringLiteral("automatic"));
 
 //SettingsManager - Notifier related
@@ -195,6 +199,24 @@ const QString ctn_CHASER_TOOL(QStringLiteral("chaser"));
 //TransactionDialog related
 const int ctn_RUN_IN_TERMINAL(328);
 
+//Number of packages merged into the package list at a time while it loads
+const int ctn_PACKAGE_LIST_BATCH_SIZE(1000);
+
+//Memory bound of the package information cache, in KB
+const int ctn_PACKAGE_INFO_CACHE_SIZE(4096);
+
+//Number of package tooltips kept ready to be shown again
+const int ctn_TOOLTIP_CACHE_SIZE(256);
+
+//Milliseconds transaction output is gathered before being written to the Output tab
+const int ctn_OUTPUT_FLUSH_INTERVAL(50);
+
+//Number of packages after and before the selected one whose details are fetched in advance
+const int ctn_PREFETCH_NEIGHBOURS(4);
+
+//Number of paths suggested while searching by file
+const int ctn_FILE_SUGGESTION_COUNT(10);
+
 //WMHelper related
 const QString ctn_NO_SU_COMMAND(QStringLiteral("none"));
 const QString ctn_ROOT_SH(QStringLiteral("/bin/sh -c "));
@@ -289,5 +311,15 @@ const int ctn_TIMEOUT_CONNECTING(5);
 const int ctn_NO_TRANSACTION_EXECUTING(6);
 const int ctn_SUSPICIOUS_EXECUTION_METHOD(7);
 const int ctn_COULD_NOT_ATTACH_TO_MEM(8);
+const int ctn_COULD_NOT_START_SESSION(9);
+
+//Persistent octopi-helper sessions listen on "<dir>/helper-<pid of the Octo tool>.sock"
+const QString ctn_OCTOPI_HELPER_SOCKET_DIR(QStringLiteral("/run/octopi"));
+//Milliseconds an idle octopi-helper session waits for another transaction before exiting
+const int ctn_OCTOPI_HELPER_SESSION_IDLE_TIMEOUT(5 * 60 * 1000);
+//Milliseconds a new session has to accept connections (the password is asked meanwhile)
+const int ctn_OCTOPI_HELPER_SESSION_CONNECT_TIMEOUT(120 * 1000);
+//Largest message of the octopi-helper session protocol, in bytes
+const int ctn_OCTOPI_HELPER_MAX_MESSAGE_SIZE(1024 * 1024);
 
 #endif // CONSTANTS
@@ -0,0 +1,420 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "fileownershipindex.h"
+#include "constants.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+/*
+ * This index answers "search by file" and its path completion without running pacman -Qo or slocate
+ */
+
+static const int ctn_RESTART_INTERVAL = 16;
+static const quint32 ctn_INDEX_MAGIC = 0x4F46494E; //"OFIN"
+static const quint32 ctn_INDEX_VERSION = 2;
+
+namespace {
+
+struct EntryHeader
+{
+  quint16 shared;      // bytes taken from the previous path
+  quint16 suffixSize;  // bytes which follow this header
+  quint32 package;     // position in Index::packages
+};
+
+struct Entry
+{
+  QByteArray path;
+  quint32 package;
+};
+
+}
+
+QMutex FileOwnershipIndex::s_mutex;
+QAtomicInt FileOwnershipIndex::s_ready;
+QAtomicInt FileOwnershipIndex::s_loading;
+QAtomicInt FileOwnershipIndex::s_generation;
+FileOwnershipIndex::Index FileOwnershipIndex::s_index;
+
+/*
+ * Rebuilds in path the entry stored at pos, and returns the position of the next one
+ */
+static int decodeEntry(const QByteArray &entries, int pos, QByteArray &path, quint32 &package)
+{
+  EntryHeader header;
+  std::memcpy(&header, entries.constData() + pos, sizeof(header));
+  pos += static_cast<int>(sizeof(header));
+
+  path.truncate(header.shared);
+  path.append(entries.constData() + pos, header.suffixSize);
+  package = header.package;
+
+  return pos + header.suffixSize;
+}
+
+/*
+ * Fills owners with the packages which own filePath: every one of them for a directory, like pacman -Qo
+ *
+ * Returns false, and starts loading the index in the background, if the index is not ready yet.
+ * Like pacman -Qo, the directory part of the path is also tried with its symbolic links resolved
+ */
+bool FileOwnershipIndex::getOwners(const QString &filePath, QStringList &owners)
+{
+  owners.clear();
+
+  if (!s_ready.loadAcquire())
+  {
+    loadInBackground();
+    return false;
+  }
+
+  QMutexLocker locker(&s_mutex);
+  if (!s_ready.loadAcquire()) return false;
+
+  QList<int> packages = lookup(filePath.toUtf8());
+
+  if (packages.isEmpty() && !filePath.endsWith(QLatin1Char('/')))
+  {
+    packages = lookup((filePath + QLatin1Char('/')).toUtf8());
+  }
+
+  if (packages.isEmpty())
+  {
+    QFileInfo fi(filePath);
+    QString canonicalDir = QFileInfo(fi.path()).canonicalFilePath();
+
+    if (!canonicalDir.isEmpty())
+    {
+      if (!canonicalDir.endsWith(QLatin1Char('/'))) canonicalDir += QLatin1Char('/');
+      packages = lookup((canonicalDir + fi.fileName()).toUtf8());
+    }
+  }
+
+  for (int package: std::as_const(packages))
+  {
+    owners << s_index.packages.at(package);
+  }
+
+  return true;
+}
+
+/*
+ * Returns up to maxCount installed paths which start with prefix, in order
+ * Returns nothing while the index is not loaded
+ */
+QStringList FileOwnershipIndex::getCompletions(const QString &prefix, int maxCount)
+{
+  QStringList res;
+  if (!s_ready.loadAcquire()) return res;
+
+  QMutexLocker locker(&s_mutex);
+  if (!s_ready.loadAcquire() || s_index.count == 0) return res;
+
+  const QByteArray target = prefix.toUtf8();
+  int pos = static_cast<int>(s_index.restarts[findRestart(target)]);
+  QByteArray path, previous;
+  quint32 package;
+
+  while (pos < s_index.entries.size() && res.count() < maxCount)
+  {
+    pos = decodeEntry(s_index.entries, pos, path, package);
+
+    if (path < target) continue;
+    if (!path.startsWith(target)) break;
+
+    //A directory has one entry per owner
+    if (path == previous) continue;
+
+    res << QString::fromUtf8(path);
+    previous = path;
+  }
+
+  return res;
+}
+
+/*
+ * Never waits: the GUI thread calls it on every keystroke
+ */
+bool FileOwnershipIndex::isReady()
+{
+  return s_ready.loadAcquire() != 0;
+}
+
+/*
+ * Reads the saved index, or builds it again if the local database changed since it was saved
+ *
+ * The index is read or built without holding s_mutex, which is only taken to swap it in.
+ * If invalidate() ran meanwhile, the result describes an older database and is thrown away
+ */
+void FileOwnershipIndex::load()
+{
+  if (s_ready.loadAcquire()) return;
+
+  const int generation = s_generation.loadAcquire();
+  const qint64 stamp = getLocalDatabaseStamp();
+  Index index;
+
+  if (!readFromDisk(stamp, index))
+  {
+    build(index);
+    writeToDisk(stamp, index);
+  }
+
+  {
+    QMutexLocker locker(&s_mutex);
+    if (generation == s_generation.loadAcquire())
+    {
+      std::swap(s_index, index);
+      s_ready.storeRelease(1);
+    }
+  }
+
+  s_loading.storeRelease(0);
+}
+
+void FileOwnershipIndex::loadInBackground()
+{
+  if (s_ready.loadAcquire() || !s_loading.testAndSetOrdered(0, 1)) return;
+
+  QtConcurrent::run(&FileOwnershipIndex::load);
+}
+
+/*
+ * Called whenever the pacman database changes
+ */
+void FileOwnershipIndex::invalidate()
+{
+  Index empty;
+  QMutexLocker locker(&s_mutex);
+  s_generation.fetchAndAddOrdered(1);
+  s_ready.storeRelease(0);
+  std::swap(s_index, empty);
+}
+
+/*
+ * Reads the file list of every package in the local database. Directories are owned by
+ * many packages, so they get an entry per owner, in name order
+ */
+void FileOwnershipIndex::build(Index &index)
+{
+  std::vector<Entry> entries;
+  index.packages.clear();
+
+  QDir localDir(ctn_PACMAN_DATABASE_DIR + QLatin1String("/local"));
+  const QStringList dirs = localDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+
+  for (const QString &dir: dirs)
+  {
+    QFile file(localDir.filePath(dir) + QLatin1String("/files"));
+    if (!file.open(QIODevice::ReadOnly)) continue;
+
+    //Each directory is named <pkgname>-<pkgver>-<pkgrel>
+    int dash = dir.lastIndexOf(QLatin1Char('-'));
+    if (dash > 0) dash = dir.lastIndexOf(QLatin1Char('-'), dash-1);
+    if (dash <= 0) continue;
+
+    const quint32 package = static_cast<quint32>(index.packages.count());
+    index.packages << dir.left(dash);
+
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    bool inFiles = false;
+
+    for (const QByteArray &line: lines)
+    {
+      if (line.startsWith('%'))
+      {
+        inFiles = (line == "%FILES%");
+        continue;
+      }
+
+      if (line.isEmpty())
+      {
+        if (inFiles) break;
+        continue;
+      }
+
+      if (inFiles) entries.push_back(Entry{'/' + line, package});
+    }
+  }
+
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const Entry &a, const Entry &b) { return a.path < b.path; });
+
+  index.entries.clear();
+  index.restarts.clear();
+  index.count = 0;
+  QByteArray previous;
+  int sinceRestart = 0;
+
+  for (const Entry &entry: entries)
+  {
+    int shared = 0;
+
+    //The owners of a directory never straddle two restarts, so lookup() finds all of them in one run
+    if (index.count == 0 || (sinceRestart >= ctn_RESTART_INTERVAL && entry.path != previous))
+    {
+      index.restarts.push_back(static_cast<quint32>(index.entries.size()));
+      sinceRestart = 0;
+    }
+    else
+    {
+      const int maxShared = qMin(qMin(previous.size(), entry.path.size()), 0xFFFF);
+      while (shared < maxShared && previous.at(shared) == entry.path.at(shared)) ++shared;
+    }
+
+    EntryHeader header;
+    header.shared = static_cast<quint16>(shared);
+    header.suffixSize = static_cast<quint16>(entry.path.size() - shared);
+    header.package = entry.package;
+
+    index.entries.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    index.entries.append(entry.path.constData() + shared, header.suffixSize);
+
+    previous = entry.path;
+    ++sinceRestart;
+    ++index.count;
+  }
+}
+
+bool FileOwnershipIndex::readFromDisk(qint64 stamp, Index &index)
+{
+  QFile file(getIndexFilePath());
+  if (!file.open(QIODevice::ReadOnly)) return false;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_15);
+
+  quint32 magic, version, restartCount;
+  qint64 savedStamp;
+  in >> magic >> version >> savedStamp;
+  if (magic != ctn_INDEX_MAGIC || version != ctn_INDEX_VERSION || savedStamp != stamp) return false;
+
+  in >> index.packages >> index.entries >> restartCount;
+  index.restarts.resize(restartCount);
+  for (quint32 &restart: index.restarts) in >> restart;
+  in >> index.count;
+
+  if (in.status() != QDataStream::Ok)
+  {
+    index = Index();
+    return false;
+  }
+
+  return true;
+}
+
+void FileOwnershipIndex::writeToDisk(qint64 stamp, const Index &index)
+{
+  QDir().mkpath(QFileInfo(getIndexFilePath()).path());
+  QSaveFile file(getIndexFilePath());
+  if (!file.open(QIODevice::WriteOnly)) return;
+
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_5_15);
+  out << ctn_INDEX_MAGIC << ctn_INDEX_VERSION << stamp << index.packages << index.entries <<
+         static_cast<quint32>(index.restarts.size());
+  for (quint32 restart: index.restarts) out << restart;
+  out << index.count;
+
+  if (file.commit())
+  {
+    //Where the first versions of the index were saved
+    QFile::remove(QDir::homePath() + QLatin1String("/.config/octopi/file_owners.idx"));
+  }
+}
+
+/*
+ * Installing, upgrading or removing a package adds or removes a directory in the local database
+ */
+qint64 FileOwnershipIndex::getLocalDatabaseStamp()
+{
+  return QFileInfo(ctn_PACMAN_DATABASE_DIR + QLatin1String("/local")).lastModified().toMSecsSinceEpoch();
+}
+
+/*
+ * The index can be rebuilt at any time, so it belongs to the cache directory
+ */
+QString FileOwnershipIndex::getIndexFilePath()
+{
+  return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/octopi/file_owners.idx");
+}
+
+/*
+ * Index of the last restart whose path is not greater than target
+ */
+int FileOwnershipIndex::findRestart(const QByteArray &target)
+{
+  int lo = 0, hi = static_cast<int>(s_index.restarts.size()) - 1, res = 0;
+
+  while (lo <= hi)
+  {
+    const int mid = (lo + hi) / 2;
+    EntryHeader header;
+    std::memcpy(&header, s_index.entries.constData() + s_index.restarts[mid], sizeof(header));
+    const QByteArray first = QByteArray::fromRawData(s_index.entries.constData() + s_index.restarts[mid] + sizeof(header), header.suffixSize);
+
+    if (first <= target)
+    {
+      res = mid;
+      lo = mid + 1;
+    }
+    else hi = mid - 1;
+  }
+
+  return res;
+}
+
+/*
+ * Positions in s_index.packages of the owners of path
+ */
+QList<int> FileOwnershipIndex::lookup(const QByteArray &path)
+{
+  QList<int> res;
+  if (s_index.count == 0) return res;
+
+  const int restart = findRestart(path);
+  int pos = static_cast<int>(s_index.restarts[restart]);
+  const int end = (restart + 1 < static_cast<int>(s_index.restarts.size())) ?
+        static_cast<int>(s_index.restarts[restart+1]) : static_cast<int>(s_index.entries.size());
+  QByteArray current;
+  quint32 package;
+
+  while (pos < end)
+  {
+    pos = decodeEntry(s_index.entries, pos, current, package);
+
+    if (current == path) res << static_cast<int>(package);
+    else if (path < current) break;
+  }
+
+  return res;
+}
@@ -0,0 +1,78 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef FILEOWNERSHIPINDEX_H
+#define FILEOWNERSHIPINDEX_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+/*
+ * @brief Process wide table of every file installed by pacman and the package which owns it
+ *
+ * Paths are kept sorted and prefix compressed: each entry only stores what differs from the
+ * previous path, and every ctn_RESTART_INTERVAL entries a full path allows binary searching.
+ * The table is built from the file lists of the local database and saved in ~/.cache/octopi,
+ * so it is only rebuilt after the local database changes. It is safe to use from any thread: the
+ * table is built without any lock held, and s_mutex only guards the swap and the lookups.
+ */
+class FileOwnershipIndex
+{
+public:
+  static bool getOwners(const QString& filePath, QStringList& owners);
+  static QStringList getCompletions(const QString& prefix, int maxCount);
+
+  static bool isReady();
+  static void load();
+  static void loadInBackground();
+  static void invalidate();
+
+private:
+  struct Index
+  {
+    Index(): count(0) {}
+
+    QStringList packages;
+    QByteArray entries;
+    std::vector<quint32> restarts; // offsets of the entries which hold a full path
+    int count;
+  };
+
+  static void build(Index& index);
+  static bool readFromDisk(qint64 stamp, Index& index);
+  static void writeToDisk(qint64 stamp, const Index& index);
+  static qint64 getLocalDatabaseStamp();
+  static QString getIndexFilePath();
+
+  static int findRestart(const QByteArray& target);
+  static QList<int> lookup(const QByteArray& path);
+
+  static QMutex s_mutex;
+  static QAtomicInt s_ready;
+  static QAtomicInt s_loading;
+  static QAtomicInt s_generation;  // bumped by invalidate(), so a build of an older database is dropped
+  static Index s_index;
+};
+
+#endif // FILEOWNERSHIPINDEX_H
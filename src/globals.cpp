@@ -21,6 +21,7 @@
 #include "globals.h"
 #include "unixcommand.h"
 #include "utils.h"
+#include "fileownershipindex.h"
 
 #include <QFutureWatcher>
 #include <QtConcurrent/QtConcurrentMap>
@@ -32,12 +33,13 @@
  */
 
 /*
- * Given a packageName struct, returns a tooltip with description and size information
+ * Given the description of a package as the repository keeps it ("name description"),
+ * returns the description as tooltips show it: without the name, and at most 120 chars long
  */
-QString showPackageDescriptionExt(PkgDesc pkgDesc)
+QString getShortPackageDescription(const QString &description)
 {
-  int space = pkgDesc.description.indexOf(QLatin1String(" "));
-  QString desc = pkgDesc.description.mid(space+1);
+  int space = description.indexOf(QLatin1String(" "));
+  QString desc = description.mid(space+1);
   int size = desc.size();
 
   if (desc.size() > 120)
@@ -46,7 +48,16 @@ QString showPackageDescriptionExt(PkgDesc pkgDesc)
     desc = desc + QLatin1String(" ...");
   }
 
-  QString installedSize = Package::getInformationInstalledSize(pkgDesc.name, pkgDesc.isForeign);
+  return desc;
+}
+
+/*
+ * Given a packageName struct, returns a tooltip with description and size information
+ */
+QString showPackageDescriptionExt(PkgDesc pkgDesc)
+{
+  QString desc = getShortPackageDescription(pkgDesc.description);
+  QString installedSize = Package::getInformationInstalledSize(pkgDesc.name, pkgDesc.isForeign, pkgDesc.repository);
 
   if (!installedSize.isEmpty() && installedSize != QLatin1String("0.00 Bytes"))
     return desc + QString::fromUtf8(" → ") + installedSize;
@@ -81,16 +92,17 @@ QSet<QString> *searchUnrequiredPacmanPackages()
 /*
  * Starts the non blocking search for a Pacman package that owns the given file...
  */
-QString searchPacmanPackagesByFile(const QString &file)
+QStringList searchPacmanPackagesByFile(const QString &file)
 {
-  QString result;
+  QStringList result;
 
-  if (!file.isEmpty())
+  if (file.isEmpty()) return result;
+
+  //pacman answers until the ownership index has been loaded in the background
+  if (!file.startsWith(QLatin1Char('/')) || !FileOwnershipIndex::getOwners(file, result))
   {
-    result = UnixCommand::getPackageByFilePath(file);
+    result = UnixCommand::getPackagesByFilePath(file);
   }
-  else
-    result = QLatin1String("");
 
   return result;
 }
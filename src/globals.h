@@ -23,12 +23,14 @@
 
 #include "strconstants.h"
 #include "model/packagemodel.h"
+#include "syncfilessearcher.h"
 
 #include <QStandardItem>
 #include <QFutureWatcher>
 
 struct PkgDesc{
   QString name;
+  QString repository;
   QString description;
   bool isForeign;
 };
@@ -41,7 +43,6 @@ struct FTOutdatedPackages //aka ForeignToolOutdatedPackages
 
 typedef std::pair<QString, QStringList*> GroupMemberPair;
 
-inline QFutureWatcher<QString> g_fwToolTip;
 inline QFutureWatcher<QString> g_fwToolTipInfo;
 inline QFutureWatcher<QList<PackageListData> *> g_fwPacman;
 inline QFutureWatcher<QList<PackageListData> *> g_fwForeignPacman;
@@ -50,7 +51,8 @@ inline QFutureWatcher<QList<PackageListData> *> g_fwAUR;
 inline QFutureWatcher<QList<PackageListData> *> g_fwAURMeta;
 inline QFutureWatcher<FTOutdatedPackages *> g_fwOutdatedAURPackages;
 inline QFutureWatcher<QString> g_fwDistroNews;
-inline QFutureWatcher<QString> g_fwPackageOwnsFile;
+inline QFutureWatcher<QStringList> g_fwPackageOwnsFile;
+inline QFutureWatcher<QList<SyncFileMatch> > g_fwSyncFiles;
 inline QFutureWatcher<QList<PackageListData> *> g_fwMarkForeignPackages;
 inline QFutureWatcher<QSet<QString> *> g_fwUnrequiredPacman;
 inline QFutureWatcher<PackageInfoData> g_fwKCPInformation;
@@ -61,13 +63,14 @@ inline QFutureWatcher<QString> g_fwGenerateSysInfo;
 inline QFutureWatcher<bool> g_fwDownloadTempYayHelper;
 
 //QString showPackageDescription(QString pkgName);
+QString getShortPackageDescription(const QString &description);
 QString showPackageDescriptionExt(PkgDesc pkgDesc); //const PackageRepository::PackageData*const package);
 QList<PackageListData> * searchPacmanPackages(const QHash<QString, QString> *checkUpdatesOutdatedPackages);
 QSet<QString> * searchUnrequiredPacmanPackages();
 QList<PackageListData> * searchForeignPackages();
 QList<PackageListData> * markForeignPackagesInPkgList(bool hasAURTool, QStringList *outdatedAURStringList);
 QList<PackageListData> * searchForeignToolPackages(QString searchString);
-QString searchPacmanPackagesByFile(const QString &file);
+QStringList searchPacmanPackagesByFile(const QString &file);
 GroupMemberPair          searchPacmanPackagesFromGroup(QString groupName);
 FTOutdatedPackages * getOutdatedForeignToolPackages();
 QString getLatestDistroNews();
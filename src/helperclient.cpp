@@ -0,0 +1,275 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "helperclient.h"
+#include "constants.h"
+#include "wmhelper.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QLocalSocket>
+
+/*
+ * Milliseconds between attempts to connect to a session which is starting
+ */
+static const int ctn_CONNECT_INTERVAL = 200;
+
+/*
+ * Milliseconds given to a session which timed out to exit before a new one is started
+ */
+static const int ctn_SESSION_EXIT_TIMEOUT = 1000;
+
+HelperClient* HelperClient::m_pinstance = nullptr;
+
+HelperClient::HelperClient()
+{
+  m_running = false;
+  m_dropSession = false;
+
+  m_socket = new QLocalSocket(this);
+  m_sessionProcess = new QProcess(this);
+  m_sessionProcess->setProcessChannelMode(QProcess::ForwardedChannels);
+
+  m_connectTimer.setInterval(ctn_CONNECT_INTERVAL);
+  resetOutputDecoder();
+
+  connect(m_socket, SIGNAL(connected()), this, SLOT(onConnected()));
+  connect(m_socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+  connect(m_socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+  connect(m_sessionProcess, SIGNAL(finished(int, QProcess::ExitStatus)),
+          this, SLOT(onSessionFinished(int, QProcess::ExitStatus)));
+  connect(m_sessionProcess, SIGNAL(errorOccurred(QProcess::ProcessError)),
+          this, SLOT(onSessionErrorOccurred(QProcess::ProcessError)));
+  connect(&m_connectTimer, SIGNAL(timeout()), this, SLOT(onConnectTimer()));
+}
+
+HelperClient* HelperClient::instance()
+{
+  if (m_pinstance == nullptr)
+  {
+    m_pinstance = new HelperClient();
+  }
+
+  return m_pinstance;
+}
+
+/*
+ * Sends the given ";" separated commands to the session, starting one if needed
+ *
+ * Returns false, without emitting anything, if a transaction is already running
+ */
+bool HelperClient::execute(const QString &command)
+{
+  if (m_running) return false;
+
+  QString commands;
+  const QStringList commandList = command.split(QStringLiteral(";"), Qt::SkipEmptyParts);
+  for(const QString& line: commandList)
+  {
+    commands += line.trimmed() + QLatin1Char('\n');
+  }
+
+  const QByteArray request = HelperProtocol::encode(ectn_HELPER_EXECUTE, commands.toLatin1());
+
+  resetOutputDecoder();
+  m_dropSession = false;
+
+  if (m_socket->state() == QLocalSocket::ConnectedState)
+  {
+    m_running = true;
+    m_socket->write(request);
+    return true;
+  }
+
+  //An idle session which has just timed out may still be exiting
+  if (m_sessionProcess->state() != QProcess::NotRunning)
+    m_sessionProcess->waitForFinished(ctn_SESSION_EXIT_TIMEOUT);
+
+  m_running = true;
+  m_pendingRequest = request;
+  startSession();
+
+  return true;
+}
+
+/*
+ * Asks the session to kill pacman and remove the database lock
+ *
+ * Returns 1 if there is no transaction to cancel
+ */
+int HelperClient::cancel()
+{
+  if (!m_running) return 1;
+
+  if (m_pendingRequest.isEmpty())
+  {
+    m_socket->write(HelperProtocol::encode(ectn_HELPER_CANCEL));
+  }
+  else
+  {
+    //The session did not even start yet (maybe the password is being asked). qt-sudo may not pass
+    //SIGTERM on to the elevated session, so one which still shows up is told to quit as it connects.
+    //The transaction ends when qt-sudo exits, the session is dropped or the connect timeout expires
+    m_pendingRequest.clear();
+    m_dropSession = true;
+    m_sessionProcess->terminate();
+  }
+
+  return 0;
+}
+
+void HelperClient::startSession()
+{
+  if (m_sessionProcess->state() == QProcess::NotRunning)
+  {
+    QStringList sl;
+    sl << ctn_OCTOPISUDO_PARAMS;
+    sl << ctn_OCTOPI_HELPER_PATH << QStringLiteral("-session");
+    m_sessionProcess->start(WMHelper::getSUCommand(), sl);
+  }
+
+  m_connectElapsed.start();
+  m_connectTimer.start();
+}
+
+/*
+ * The session socket appears once the user typed the password
+ */
+void HelperClient::onConnectTimer()
+{
+  if (m_socket->state() != QLocalSocket::UnconnectedState) return;
+
+  if (m_connectElapsed.elapsed() > ctn_OCTOPI_HELPER_SESSION_CONNECT_TIMEOUT)
+  {
+    m_connectTimer.stop();
+    m_dropSession = false;
+    m_sessionProcess->terminate();
+    endTransaction(ctn_COULD_NOT_START_SESSION, QProcess::NormalExit);
+    return;
+  }
+
+  const QString socketPath = HelperProtocol::getSocketPath(QCoreApplication::applicationPid());
+  if (QFileInfo::exists(socketPath)) m_socket->connectToServer(socketPath);
+}
+
+void HelperClient::onConnected()
+{
+  m_connectTimer.stop();
+
+  //A session which is disconnected quits
+  if (m_dropSession)
+  {
+    m_dropSession = false;
+    m_socket->disconnectFromServer();
+    endTransaction(-1, QProcess::NormalExit);
+    return;
+  }
+
+  if (!m_pendingRequest.isEmpty())
+  {
+    m_socket->write(m_pendingRequest);
+    m_pendingRequest.clear();
+  }
+}
+
+void HelperClient::onReadyRead()
+{
+  m_reader.append(m_socket->readAll());
+
+  HelperMessage message;
+  while (m_reader.readMessage(message))
+  {
+    switch (message.type)
+    {
+      case ectn_HELPER_STARTED:
+        emit started();
+        break;
+      case ectn_HELPER_OUTPUT:
+        emit output(decodeOutput(message.payload));
+        break;
+      case ectn_HELPER_FINISHED:
+      case ectn_HELPER_REFUSED:
+        endTransaction(HelperProtocol::decodeExitCode(message.payload), QProcess::NormalExit);
+        break;
+      default:
+        break;
+    }
+  }
+
+  if (m_reader.hasError()) m_socket->abort();
+}
+
+void HelperClient::onDisconnected()
+{
+  m_reader.clear();
+
+  //The session died in the middle of a transaction
+  if (m_running && m_pendingRequest.isEmpty()) endTransaction(-1, QProcess::CrashExit);
+}
+
+/*
+ * qt-sudo exited: either the session ended or it never started (wrong password, dialog canceled...)
+ */
+void HelperClient::onSessionFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+  //After a cancel, keep looking for an elevated session which outlived qt-sudo
+  if (!m_dropSession) m_connectTimer.stop();
+
+  if (m_running && m_socket->state() == QLocalSocket::UnconnectedState) endTransaction(exitCode, exitStatus);
+}
+
+/*
+ * qt-sudo could not be started at all, so no finished() will come from it
+ */
+void HelperClient::onSessionErrorOccurred(QProcess::ProcessError error)
+{
+  if (error != QProcess::FailedToStart) return;
+
+  m_connectTimer.stop();
+  m_dropSession = false;
+  endTransaction(ctn_COULD_NOT_START_SESSION, QProcess::CrashExit);
+}
+
+void HelperClient::resetOutputDecoder()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+  m_outputDecoder = QStringDecoder(QStringDecoder::Utf8);
+#else
+  m_outputDecoder.reset(QTextCodec::codecForName("UTF-8")->makeDecoder());
+#endif
+}
+
+QString HelperClient::decodeOutput(const QByteArray &data)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+  return m_outputDecoder.decode(data);
+#else
+  return m_outputDecoder->toUnicode(data);
+#endif
+}
+
+void HelperClient::endTransaction(int exitCode, QProcess::ExitStatus exitStatus)
+{
+  if (!m_running) return;
+
+  m_running = false;
+  m_pendingRequest.clear();
+  emit finished(exitCode, exitStatus);
+}
@@ -0,0 +1,96 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef HELPERCLIENT_H
+#define HELPERCLIENT_H
+
+#include "helperprotocol.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QProcess>
+#include <QTimer>
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QStringDecoder>
+#else
+#include <QScopedPointer>
+#include <QTextCodec>
+#endif
+
+class QLocalSocket;
+
+/*
+ * @brief Runs transactions thru a persistent octopi-helper session ("octphelper -session")
+ *
+ * The session is started with qt-sudo on the first transaction and kept for the next ones, so the
+ * password is asked once. Pacman's output is streamed back on the session socket.
+ */
+class HelperClient : public QObject
+{
+  Q_OBJECT
+
+private:
+  static HelperClient *m_pinstance;
+
+  QLocalSocket *m_socket;
+  QProcess *m_sessionProcess;
+  HelperMessageReader m_reader;
+  QTimer m_connectTimer;
+  QElapsedTimer m_connectElapsed;
+  QByteArray m_pendingRequest;
+  bool m_running;
+  bool m_dropSession;
+
+  //Pacman's output may be cut in the middle of a UTF-8 sequence, so its decoder keeps state between chunks
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+  QStringDecoder m_outputDecoder;
+#else
+  QScopedPointer<QTextDecoder> m_outputDecoder;
+#endif
+
+  HelperClient();
+  void startSession();
+  void resetOutputDecoder();
+  QString decodeOutput(const QByteArray &data);
+  void endTransaction(int exitCode, QProcess::ExitStatus exitStatus);
+
+private slots:
+  void onConnectTimer();
+  void onConnected();
+  void onReadyRead();
+  void onDisconnected();
+  void onSessionFinished(int exitCode, QProcess::ExitStatus exitStatus);
+  void onSessionErrorOccurred(QProcess::ProcessError error);
+
+public:
+  static HelperClient* instance();
+
+  bool execute(const QString &command);
+  int cancel();
+  inline bool isRunning() const { return m_running; }
+
+signals:
+  void started();
+  void output(const QString &output);
+  void finished(int exitCode, QProcess::ExitStatus exitStatus);
+};
+
+#endif // HELPERCLIENT_H
@@ -0,0 +1,115 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "helperprotocol.h"
+#include "constants.h"
+
+#include <QtEndian>
+
+static const int ctn_HEADER_SIZE = 4;
+
+QByteArray HelperProtocol::encode(HelperMessageType type, const QByteArray &payload)
+{
+  QByteArray res(ctn_HEADER_SIZE, '\0');
+  qToBigEndian<quint32>(static_cast<quint32>(payload.size() + 1), res.data());
+  res.append(static_cast<char>(type));
+  res.append(payload);
+
+  return res;
+}
+
+QByteArray HelperProtocol::encodeExitCode(int exitCode)
+{
+  QByteArray res(4, '\0');
+  qToBigEndian<qint32>(exitCode, res.data());
+
+  return res;
+}
+
+int HelperProtocol::decodeExitCode(const QByteArray &payload)
+{
+  if (payload.size() != 4) return -1;
+  return qFromBigEndian<qint32>(payload.constData());
+}
+
+/*
+ * Each Octo tool gets its own session socket
+ */
+QString HelperProtocol::getSocketPath(qint64 ownerPid)
+{
+  return ctn_OCTOPI_HELPER_SOCKET_DIR + QLatin1String("/helper-") + QString::number(ownerPid) + QLatin1String(".sock");
+}
+
+/*
+ * A session holds this file while it runs a transaction, so other Octo tools can tell a busy session from an idle one
+ */
+QString HelperProtocol::getBusyMarkerPath(qint64 sessionPid)
+{
+  return ctn_OCTOPI_HELPER_SOCKET_DIR + QLatin1String("/helper-") + QString::number(sessionPid) + QLatin1String(".busy");
+}
+
+HelperMessageReader::HelperMessageReader()
+{
+  m_error = false;
+}
+
+void HelperMessageReader::append(const QByteArray &data)
+{
+  if (!m_error) m_buffer.append(data);
+}
+
+/*
+ * Retrieves the next complete message, if any. A message which is empty, too big or of an
+ * unknown type puts the reader in error, and the session must be dropped
+ */
+bool HelperMessageReader::readMessage(HelperMessage &message)
+{
+  if (m_error || m_buffer.size() < ctn_HEADER_SIZE) return false;
+
+  const quint32 size = qFromBigEndian<quint32>(m_buffer.constData());
+  if (size == 0 || size > static_cast<quint32>(ctn_OCTOPI_HELPER_MAX_MESSAGE_SIZE))
+  {
+    m_error = true;
+    m_buffer.clear();
+    return false;
+  }
+
+  if (m_buffer.size() - ctn_HEADER_SIZE < static_cast<int>(size)) return false;
+
+  const int type = static_cast<quint8>(m_buffer.at(ctn_HEADER_SIZE));
+  if (type < ectn_HELPER_EXECUTE || type > ectn_HELPER_REFUSED)
+  {
+    m_error = true;
+    m_buffer.clear();
+    return false;
+  }
+
+  message.type = static_cast<HelperMessageType>(type);
+  message.payload = m_buffer.mid(ctn_HEADER_SIZE + 1, static_cast<int>(size) - 1);
+  m_buffer.remove(0, ctn_HEADER_SIZE + static_cast<int>(size));
+
+  return true;
+}
+
+void HelperMessageReader::clear()
+{
+  m_buffer.clear();
+  m_error = false;
+}
@@ -0,0 +1,75 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef HELPERPROTOCOL_H
+#define HELPERPROTOCOL_H
+
+#include <QByteArray>
+#include <QString>
+
+/*
+ * Messages of an octopi-helper session. Octopi sends EXECUTE, CANCEL and INPUT;
+ * the helper answers with STARTED, OUTPUT and FINISHED, or REFUSED if it will not run the commands
+ */
+enum HelperMessageType { ectn_HELPER_EXECUTE=1, ectn_HELPER_CANCEL, ectn_HELPER_INPUT,
+                         ectn_HELPER_STARTED, ectn_HELPER_OUTPUT, ectn_HELPER_FINISHED, ectn_HELPER_REFUSED };
+
+struct HelperMessage
+{
+  HelperMessageType type;
+  QByteArray payload;
+};
+
+/*
+ * @brief Wire format of an octopi-helper session
+ *
+ * Every message is a big endian quint32 with the size of what follows, a type byte and the payload.
+ * EXECUTE carries the commands, one per line; OUTPUT carries what they print; FINISHED and
+ * REFUSED carry a big endian qint32 exit code.
+ */
+class HelperProtocol
+{
+public:
+  static QByteArray encode(HelperMessageType type, const QByteArray& payload = QByteArray());
+  static QByteArray encodeExitCode(int exitCode);
+  static int decodeExitCode(const QByteArray& payload);
+  static QString getSocketPath(qint64 ownerPid);
+  static QString getBusyMarkerPath(qint64 sessionPid);
+};
+
+/*
+ * @brief Splits the bytes read from a session socket into messages
+ */
+class HelperMessageReader
+{
+public:
+  HelperMessageReader();
+
+  void append(const QByteArray& data);
+  bool readMessage(HelperMessage& message);
+  bool hasError() const { return m_error; }
+  void clear();
+
+private:
+  QByteArray m_buffer;
+  bool m_error;
+};
+
+#endif // HELPERPROTOCOL_H
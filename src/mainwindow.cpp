@@ -33,6 +33,11 @@
 #include "termwidget.h"
 #include "aurvote.h"
 #include "alpmbackend.h"
+#include "packageinfocache.h"
+#include "fileownershipindex.h"
+#include "treeviewpackagesitemdelegate.h"
+#include "src/ui/octopitabinfo.h"
+#include "src/model/packagefilemodel.h"
 
 #include <QDropEvent>
 #include <QMimeData>
@@ -49,6 +54,8 @@
 #include <QHash>
 #include <QFutureWatcher>
 #include <QToolTip>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QtConcurrent/QtConcurrentRun>
 #include <QRandomGenerator>
 #include <QTcpServer>
@@ -75,6 +82,7 @@ MainWindow::MainWindow(QWidget *parent) :
   m_systemUpgradeDialog = false;
   m_refreshPackageLists = false;
   m_refreshForeignPackageList = false;
+  m_rebuildPackageListPending = false;
   m_cic = nullptr;
   m_outdatedStringList = new QStringList();
   m_checkupdatesStringList = new QStringList();
@@ -109,6 +117,21 @@ MainWindow::MainWindow(QWidget *parent) :
   m_outdatedAURTimer->setInterval(50);
   m_reconectSlotInvalidateTabs = false;
   connect(m_outdatedAURTimer, SIGNAL(timeout()), this, SLOT(postBuildPackageList()));
+  m_filterDelayTimer = new QTimer(this);
+  m_filterDelayTimer->setSingleShot(true);
+  m_filterDelayTimer->setInterval(SettingsManager::getFilterDelay());
+  connect(m_filterDelayTimer, SIGNAL(timeout()), this, SLOT(asyncPackageFilter()));
+  m_outputFlushTimer = new QTimer(this);
+  m_outputFlushTimer->setSingleShot(true);
+  m_outputFlushTimer->setInterval(ctn_OUTPUT_FLUSH_INTERVAL);
+  connect(m_outputFlushTimer, SIGNAL(timeout()), this, SLOT(flushOutput()));
+  m_outputLineCount = 0;
+  m_outputLog = new QFile(QDir::homePath() + QDir::separator() + QLatin1String(".config/octopi/output.log"), this);
+  m_outputRenderTime = 0;
+  m_outputFlushCount = 0;
+  m_outputHasConflict = false;
+  m_outputHasSyncing = false;
+  connect(m_packageModel.get(), SIGNAL(filterApplied()), this, SLOT(onPackageFilterApplied()));
 
   //Here we try to speed up first pkg list build!
   m_time->start();
@@ -380,6 +403,11 @@ void MainWindow::droppedLocalPackages(const QStringList &packagesToInstallList)
  */
 void MainWindow::onPacmanDatabaseChanged()
 {
+  m_packagePrefetcher.cancel();
+  PackageInfoCache::clear();
+  FileOwnershipIndex::invalidate();
+  SyncFilesSearcher::invalidate();
+  TreeViewPackagesItemDelegate::invalidateToolTips();
   if (m_initializationCompleted) m_refreshPackageLists = true;
 }
 
@@ -488,6 +516,7 @@ void MainWindow::showAnchorDescription(const QUrl &link)
 
     PkgDesc pkgDesc;
     pkgDesc.name = pkgName;
+    pkgDesc.repository = package->repository;
 
     pkgDesc.description = package->description;
     pkgDesc.isForeign = (package->status == ectn_FOREIGN || package->status == ectn_FOREIGN_OUTDATED);
@@ -839,6 +868,14 @@ void MainWindow::outputOutdatedAURPackageList()
  */
 void MainWindow::clearTabOutput()
 {
+  m_outputFlushTimer->stop();
+  m_pendingOutput.clear();
+  m_outputLineCount = 0;
+  m_outputHasConflict = false;
+  m_outputHasSyncing = false;
+  m_outputLog->close();
+  m_outputLog->remove();
+
   QTextBrowser *text = ui->twProperties->widget(ctn_TABINDEX_OUTPUT)->findChild<QTextBrowser*>(QStringLiteral("textBrowser"));
   if (text)
   {
@@ -879,11 +916,19 @@ bool MainWindow::isAURGroupSelected()
 }
 
 /*
- * Helper to retrieve if "Search/By file" is selected
+ * Helper to retrieve if "Search/By file" or "Search/By file (remote)" is selected
  */
 bool MainWindow::isSearchByFileSelected()
 {
-  return ui->actionSearchByFile->isChecked();
+  return ui->actionSearchByFile->isChecked() || ui->actionSearchByRemoteFile->isChecked();
+}
+
+/*
+ * Helper to retrieve if "Search/By file (remote)" is selected
+ */
+bool MainWindow::isSearchByRemoteFileSelected()
+{
+  return ui->actionSearchByRemoteFile->isChecked();
 }
 
 /*
@@ -895,18 +940,29 @@ void MainWindow::toggleInstantSearch()
   {
     SettingsManager::setInstantSearchSelected(true);
     disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(lightPackageFilter()));
-    disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
-    connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
+    disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
+    connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
   }
   else
   {
     SettingsManager::setInstantSearchSelected(false);
     disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(lightPackageFilter()));
-    disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
+    disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
     connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(lightPackageFilter()));
   }
 }
 
+/*
+ * Enables/disables FUZZY SEARCH feature, which ranks packages by how well they match the typed text
+ */
+void MainWindow::toggleFuzzySearch()
+{
+  SettingsManager::setFuzzySearchSelected(ui->actionUseFuzzySearch->isChecked());
+  m_packageModel->setFuzzySearch(ui->actionUseFuzzySearch->isChecked());
+
+  if (!isSearchByFileSelected() && !m_leFilterPackage->text().isEmpty()) reapplyPackageFilter();
+}
+
 /*
  * Switches debugInfo ON!
  */
@@ -966,13 +1022,19 @@ void MainWindow::tvPackagesSearchColumnChanged(QAction *actionSelected)
   if (!isAURGroupSelected())
     m_actionLastSearchMethod = actionSelected;
 
+  //Packages found by a previous "By file (remote)" search are not shown anymore
+  if (actionSelected != ui->actionSearchByRemoteFile)
+  {
+    m_packageModel->clearFileProvidersFilter();
+  }
+
   //We are in the realm of tradictional NAME search
   if (actionSelected->objectName() == ui->actionSearchByName->objectName())
   {
     if (ui->actionUseInstantSearch->isChecked())
     {
-      disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
-      connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
+      disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
+      connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
     }
 
     ui->menuView->setEnabled(true);
@@ -990,8 +1052,8 @@ void MainWindow::tvPackagesSearchColumnChanged(QAction *actionSelected)
   {
     if (ui->actionUseInstantSearch->isChecked())
     {
-      disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
-      connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
+      disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
+      connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
     }
 
     ui->menuView->setEnabled(true);
@@ -1006,7 +1068,7 @@ void MainWindow::tvPackagesSearchColumnChanged(QAction *actionSelected)
   }
   else if (actionSelected->objectName() == ui->actionSearchByFile->objectName())
   {
-    disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
+    disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
 
     //m_leFilterPackage->clear();
     //m_packageModel->applyFilter("");
@@ -1016,6 +1078,18 @@ void MainWindow::tvPackagesSearchColumnChanged(QAction *actionSelected)
 
     ui->twGroups->setEnabled(false);
     m_leFilterPackage->setRefreshValidator(ectn_FILE_VALIDATOR);
+    FileOwnershipIndex::loadInBackground();
+  }
+  else if (actionSelected->objectName() == ui->actionSearchByRemoteFile->objectName())
+  {
+    disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
+
+    ui->actionViewAllPackages->trigger();
+    m_actionRepositoryAll->trigger();
+    ui->menuView->setEnabled(false);
+
+    ui->twGroups->setEnabled(false);
+    m_leFilterPackage->setRefreshValidator(ectn_REMOTE_FILE_VALIDATOR);
   }
 
   /*if (!isSearchByFileSelected() && m_packageModel->getPackageCount() <= 1)
@@ -1039,11 +1113,18 @@ void MainWindow::tvPackagesSearchColumnChanged(QAction *actionSelected)
  */
 void MainWindow::changePackageListModel(ViewOptions viewOptions, QString selectedRepo)
 {  
+  QElapsedTimer viewTime;
+  viewTime.start();
+
   if (m_actionSwitchToForeignTool->isChecked())
     m_packageModel->applyFilter(viewOptions, QLatin1String(""), StrConstants::getForeignToolGroup());
   else
     m_packageModel->applyFilter(viewOptions, selectedRepo, isAllGroupsSelected() ? QLatin1String("") : getSelectedGroup());
 
+  if (m_debugInfo)
+    std::cout << m_packageModel->getPackageCount() << " pkgs => " << "Time elapsed switching view: " <<
+                 viewTime.nsecsElapsed() / 1000 << " micro seconds." << std::endl;
+
   if (m_leFilterPackage->text() != QLatin1String("")) reapplyPackageFilter();
 
   QModelIndex cIcon = m_packageModel->index(0, PackageModel::ctn_PACKAGE_ICON_COLUMN, QModelIndex());
@@ -1523,7 +1604,7 @@ void MainWindow::collapseThisContentItems(){
   {
     tv->repaint(tv->rect());
     QCoreApplication::processEvents();
-    QStandardItemModel *sim = qobject_cast<QStandardItemModel*>(tv->model());
+    QAbstractItemModel *sim = tv->model();
 
     if (sim)
     {
@@ -1555,7 +1636,7 @@ void MainWindow::expandThisContentItems(){
   {
     tv->repaint(tv->rect());
     QCoreApplication::processEvents();
-    QStandardItemModel *sim = qobject_cast<QStandardItemModel*>(tv->model());
+    QAbstractItemModel *sim = tv->model();
 
     if (sim)
     {
@@ -1568,7 +1649,7 @@ void MainWindow::expandThisContentItems(){
 /*
  * This method does the job of collapsing the given item and its children
  */
-void MainWindow::collapseItem(QTreeView* tv, QStandardItemModel* sim, QModelIndex mi){
+void MainWindow::collapseItem(QTreeView* tv, QAbstractItemModel* sim, QModelIndex mi){
   for (int i=0; i<sim->rowCount(mi); i++)
   {
     if (sim->hasChildren(mi))
@@ -1583,7 +1664,7 @@ void MainWindow::collapseItem(QTreeView* tv, QStandardItemModel* sim, QModelInde
 /*
  * This method does the job of expanding the given item and its children
  */
-void MainWindow::expandItem(QTreeView* tv, QStandardItemModel* sim, QModelIndex* mi){
+void MainWindow::expandItem(QTreeView* tv, QAbstractItemModel* sim, QModelIndex* mi){
   for (int i=0; i<sim->rowCount(*mi); i++){
     if (sim->hasChildren(*mi))
     {
@@ -1611,17 +1692,15 @@ void MainWindow::execContextMenuPkgFileList(QPoint point)
   QModelIndex mi = tvPkgFileList->currentIndex();
   QString selectedPath = utils::showFullPathOfItem(mi);
   QMenu menu(this);
-  QStandardItemModel *sim = qobject_cast<QStandardItemModel*>(tvPkgFileList->model());
+  PackageFileModel *model = qobject_cast<PackageFileModel*>(tvPkgFileList->model());
 
-  if (sim)
+  if (model)
   {
-    QStandardItem *si = sim->itemFromIndex(mi);
-
-    if (si == nullptr) return;
-    if (si->hasChildren() && (!tvPkgFileList->isExpanded(mi)))
+    if (!mi.isValid()) return;
+    if (model->hasChildren(mi) && (!tvPkgFileList->isExpanded(mi)))
       menu.addAction(ui->actionExpandItem);
 
-    if (si->hasChildren() && (tvPkgFileList->isExpanded(mi)))
+    if (model->hasChildren(mi) && (tvPkgFileList->isExpanded(mi)))
       menu.addAction(ui->actionCollapseItem);
 
     if (menu.actions().count() > 0)
@@ -1636,8 +1715,7 @@ void MainWindow::execContextMenuPkgFileList(QPoint point)
     QDir d;
     QFile f(selectedPath);
 
-    if (si->icon().pixmap(QSize(22,22)).toImage() ==
-        IconHelper::getIconFolder().pixmap(QSize(22,22)).toImage())
+    if (model->isDirectory(mi))
     {
       if (d.exists(selectedPath))
       {
@@ -1753,21 +1831,6 @@ void MainWindow::closeTabFilesSearchBar()
   }
 }
 
-/*
- * Extracts the base file name from an absolute file name.
- */
-QString MainWindow::extractBaseFileName(const QString &fileName)
-{
-  QString baseFileName(fileName);
-
-  if (fileName.endsWith(QLatin1Char('/')))
-  {
-    baseFileName.remove(baseFileName.size()-1, 1);
-  }
-
-  return baseFileName.right(baseFileName.size() - baseFileName.lastIndexOf(QLatin1Char('/')) -1);
-}
-
 /*
  * Whenever user double clicks the package list items, app shows the contents of the selected package
  */
@@ -1830,6 +1893,8 @@ void MainWindow::changedTabIndex()
  */
 void MainWindow::clearTabsInfoOrFiles()
 {
+  m_packagePrefetcher.cancel();
+
   //disconnect(ui->tvPackages->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)),
   //        this, SLOT(invalidateTabs()));
 
@@ -2074,22 +2139,6 @@ void MainWindow::ensureTabVisible(const int index)
   ui->twProperties->setCurrentIndex(index);
 }
 
-/*
- * Helper method to find the given "findText" in the Output TextEdit
- */
-bool MainWindow::textInTabOutput(const QString& findText)
-{
-  bool res = false;
-  QTextBrowser *text =
-      ui->twProperties->widget(ctn_TABINDEX_OUTPUT)->findChild<QTextBrowser*>(QStringLiteral("textBrowser"));
-  if (text)
-  {
-    res = utils::strInQTextEdit(text,findText);
-  }
-
-  return res;
-}
-
 /*
  * Helper method to find the "Synching repo..." strings
  */
@@ -2278,6 +2327,59 @@ void MainWindow::tvPackagesSelectionChanged(const QItemSelection&, const QItemSe
 
   m_lblTotalCounters->setText(text);
   m_lblSelCounter->setText(newMessage);
+
+  prefetchNeighbourPackages();
+}
+
+/*
+ * Queues the details of the packages next to the current one, the ones the user is likely to
+ * select next with the arrow keys. They only help the Info tab, so nothing is done while it is hidden
+ */
+void MainWindow::prefetchNeighbourPackages()
+{
+  m_packagePrefetcher.cancel();
+
+  if (!m_initializationCompleted || ui->twProperties->currentIndex() != ctn_TABINDEX_INFORMATION ||
+      !isPropertiesTabWidgetVisible() || isAURGroupSelected()) return;
+
+  const QModelIndex current = ui->tvPackages->currentIndex();
+  if (!current.isValid()) return;
+
+  m_packagePrefetcher.prefetch(getNeighbourRequests(current.row()));
+}
+
+/*
+ * The packages up to ctn_PREFETCH_NEIGHBOURS rows away from currentRow, closest first,
+ * asked the way the Info tab will ask for them
+ */
+QList<PackagePrefetcher::Request> MainWindow::getNeighbourRequests(int currentRow) const
+{
+  const int rowCount = m_packageModel->getPackageCount();
+  QList<PackagePrefetcher::Request> requests;
+
+  for (int distance=1; distance<=ctn_PREFETCH_NEIGHBOURS; ++distance)
+  {
+    for (int row: {currentRow + distance, currentRow - distance})
+    {
+      if (row < 0 || row >= rowCount) continue;
+
+      const PackageRepository::PackageData*const package =
+          m_packageModel->getData(m_packageModel->index(row, PackageModel::ctn_PACKAGE_NAME_COLUMN, QModelIndex()));
+      if (package == nullptr) continue;
+
+      PackagePrefetcher::Request request;
+      request.name = package->name;
+      request.foreign = OctopiTabInfo::usesLocalInformation(*package);
+      if (!request.foreign)
+      {
+        request.version = package->version;
+        request.repository = package->repository;
+      }
+      requests.append(request);
+    }
+  }
+
+  return requests;
 }
 
 /*
@@ -39,6 +39,7 @@ class QStandardItemModel;
 class QStandardItem;
 class QModelIndex;
 class QElapsedTimer;
+class QFile;
 class QLabel;
 class QComboBox;
 class QListView;
@@ -58,6 +59,7 @@ class OptionsDialog;
 
 #include "src/model/packagemodel.h"
 #include "src/packagerepository.h"
+#include "src/packageprefetcher.h"
 
 namespace Ui {
   class MainWindow;
@@ -67,6 +69,9 @@ class MainWindow : public QMainWindow
 {
   Q_OBJECT
 
+  friend class TestMainWindow;
+  friend class TestTreeViewPackagesItemDelegate;
+
 signals:
   void buildPackageListDone();
   void buildAURPackageListDone();
@@ -99,6 +104,8 @@ private:
   PackageRepository m_packageRepo;
   // Package Model
   std::unique_ptr<PackageModel> m_packageModel;
+  // Fetches the details of the packages around the selected one
+  PackagePrefetcher m_packagePrefetcher;
 
   QSharedMemory *m_sharedMemory;
 
@@ -135,6 +142,9 @@ private:
   //Controls if foreign pkg list must be refreshed while the main pkg list is being built
   bool m_refreshForeignPackageList;
 
+  //Controls if the pkg list must be built again once the batched load of the current one ends
+  bool m_rebuildPackageListPending;
+
   //Controls if Group Widget needs to regain focus
   bool m_groupWidgetNeedsFocus;
 
@@ -190,6 +200,21 @@ private:
   //This is the timer which controls the outdated AUR pkg list retrieval
   QTimer *m_outdatedAURTimer;
 
+  //This is the timer which waits for the user to stop typing before filtering the package list
+  QTimer *m_filterDelayTimer;
+
+  //Transaction output waits in m_pendingOutput until this timer writes it to the Output tab in one insert
+  QTimer *m_outputFlushTimer;
+  QString m_pendingOutput;
+  int m_outputLineCount;
+  //The Output tab only keeps the last lines, so every line also goes to this file
+  QFile *m_outputLog;
+  qint64 m_outputRenderTime;
+  int m_outputFlushCount;
+  //Markers seen in the output since the tab was cleared, even if trimming already removed them
+  bool m_outputHasConflict;
+  bool m_outputHasSyncing;
+
   QAction *m_dummyAction;
   QAction *m_actionLastSearchMethod;
   QAction *m_actionPackageInfo;
@@ -273,7 +298,6 @@ private:
   //Tab Files related methods
   void closeTabFilesSearchBar();
   void selectFirstItemOfPkgFileList();
-  QString extractBaseFileName(const QString &fileName);
   QString getSelectedDirectory();
 
   void clearStatusBar();
@@ -301,10 +325,9 @@ private:
 
   //Tab Output related methods
   QTextBrowser *getOutputTextBrowser();
-  void collapseItem(QTreeView* tv, QStandardItemModel* sim, QModelIndex mi);
-  void expandItem(QTreeView* tv, QStandardItemModel* sim, QModelIndex* mi);
+  void collapseItem(QTreeView* tv, QAbstractItemModel* sim, QModelIndex mi);
+  void expandItem(QTreeView* tv, QAbstractItemModel* sim, QModelIndex* mi);
   void positionTextEditCursorAtEnd();
-  bool textInTabOutput(const QString& findText);
   bool IsSyncingRepoInTabOutput();
 
   bool searchForKeyVerbs(const QString& msg);
@@ -312,12 +335,15 @@ private:
   void parsePacmanProcessOutput(const QString &pMsg);
   void ensureTabVisible(const int index);
   bool isPropertiesTabWidgetVisible();
+  QList<PackagePrefetcher::Request> getNeighbourRequests(int currentRow) const;
   bool isSUAvailable();
   bool isInternetAvailable();
   void writeToTabOutput(const QString &msg, TreatURLLinks treatURLLinks = ectn_TREAT_URL_LINK);
 
   void initTabOutput();
   void clearTabOutput();
+  void trimTabOutput(QTextBrowser *text);
+  void appendToOutputLog(const QString &html);
 
   QString retrieveDistroNews(bool searchForLatestNews = true);
   QString parseDistroNews();
@@ -334,6 +360,8 @@ private:
 
   bool isAURGroupSelected();
   bool isSearchByFileSelected();
+  bool isSearchByRemoteFileSelected();
+  QString getPackageFilterExpression();
 
   bool isNotifierBusy();
 
@@ -364,9 +392,11 @@ private slots:
   void showPackageInfo();
   void findFileInPackage();
   void incrementPercentage(int);
+  void onTransactionEvent(const TransactionEvent&);
   void outputText(const QString&);
   void tvPackagesSearchColumnChanged(QAction*);
   void tvPackagesSelectionChanged(const QItemSelection&, const QItemSelection&);
+  void prefetchNeighbourPackages();
   void tvTransactionSelectionChanged (const QItemSelection&, const QItemSelection&);
   void tvTransactionRowsInserted(const QModelIndex& parent, int, int);
   void tvTransactionRowsRemoved(const QModelIndex& parent, int, int);
@@ -410,6 +440,10 @@ private slots:
   //SearchLineEdit methods
   void reapplyPackageFilter();
   void lightPackageFilter();
+  void delayPackageFilter();
+  void asyncPackageFilter();
+  void flushOutput();
+  void onPackageFilterApplied();
 
   //TabWidget methods
   void refreshTabInfo(QString pkgName);
@@ -439,6 +473,7 @@ private slots:
   void disableTransactionActions();
   void enableTransactionActions();
   void toggleInstantSearch();
+  void toggleFuzzySearch();
   void toggleTransactionActions(const bool value);
   void toggleSystemActions(const bool value);
   void commitTransaction();
@@ -489,6 +524,7 @@ private slots:
 
   //SearchBar methods
   void positionInPkgListSearchByFile();
+  void showPackagesProvidingFile();
   void positionInFirstMatch();
   void searchBarTextChangedInTextBrowser(const QString &textToSearch);
   void searchBarFindNextInTextBrowser();
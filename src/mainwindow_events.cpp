@@ -184,12 +184,29 @@ void MainWindow::keyPressEvent(QKeyEvent* ke)
       g_fwAUR.setFuture(f);
       connect(&g_fwAUR, SIGNAL(finished()), this, SLOT(preBuildAURPackageList()));
     }
+    //We are searching for packages of the sync repositories that provide some file typed by user...
+    else if (isSearchByRemoteFileSelected() && m_leFilterPackage->hasFocus() && m_cic == nullptr)
+    {
+      if (m_leFilterPackage->text().isEmpty())
+      {
+        m_packageModel->clearFileProvidersFilter();
+        return;
+      }
+
+      m_time->start();
+      QFuture<QList<SyncFileMatch> > f;
+      disconnect(&g_fwSyncFiles, SIGNAL(finished()), this, SLOT(showPackagesProvidingFile()));
+      m_cic = new CPUIntensiveComputing();
+      f = QtConcurrent::run(&SyncFilesSearcher::search, m_leFilterPackage->text());
+      g_fwSyncFiles.setFuture(f);
+      connect(&g_fwSyncFiles, SIGNAL(finished()), this, SLOT(showPackagesProvidingFile()));
+    }
     //We are searching for packages that own some file typed by user...
     else if (isSearchByFileSelected() && m_leFilterPackage->hasFocus() && m_cic == nullptr)
     {
       ui->twGroups->setEnabled(false);
 
-      QFuture<QString> f;
+      QFuture<QStringList> f;
       disconnect(&g_fwPackageOwnsFile, SIGNAL(finished()), this, SLOT(positionInPkgListSearchByFile()));
       m_cic = new CPUIntensiveComputing();
       f = QtConcurrent::run(searchPacmanPackagesByFile, m_leFilterPackage->text());
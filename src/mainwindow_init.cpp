@@ -43,6 +43,7 @@
 #include <QListView>
 #include <QTabBar>
 #include <QProgressBar>
+#include <QScrollBar>
 #include <QSystemTrayIcon>
 #include <QToolButton>
 #include <QActionGroup>
@@ -63,6 +64,8 @@ void MainWindow::loadSettings()
   else assert(false);
 
   ui->actionUseInstantSearch->setChecked(SettingsManager::isInstantSearchSelected());
+  ui->actionUseFuzzySearch->setChecked(SettingsManager::isFuzzySearchSelected());
+  m_packageModel->setFuzzySearch(ui->actionUseFuzzySearch->isChecked());
   ui->twProperties->setFocusPolicy(Qt::NoFocus);
 }
 
@@ -529,6 +532,7 @@ void MainWindow::initPackageTreeView()
   connect(ui->tvPackages, SIGNAL(customContextMenuRequested(QPoint)), this,
           SLOT(execContextMenuPackages(QPoint)));
   connect(ui->tvPackages, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(onDoubleClickPackageList()));
+  connect(ui->tvPackages->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(prefetchNeighbourPackages()));
 }
 
 /*
@@ -545,6 +549,7 @@ void MainWindow::removePackageTreeViewConnections()
   disconnect(ui->tvPackages, SIGNAL(customContextMenuRequested(QPoint)), this,
           SLOT(execContextMenuPackages(QPoint)));
   disconnect(ui->tvPackages, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(onDoubleClickPackageList()));
+  disconnect(ui->tvPackages->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(prefetchNeighbourPackages()));
 }
 
 void MainWindow::resizePackageView()
@@ -766,6 +771,7 @@ void MainWindow::initActions()
   actionGroup->addAction(ui->actionSearchByDescription);
   actionGroup->addAction(ui->actionSearchByName);
   actionGroup->addAction(ui->actionSearchByFile);
+  actionGroup->addAction(ui->actionSearchByRemoteFile);
   ui->actionSearchByName->setChecked(true);
   m_actionLastSearchMethod = ui->actionSearchByName;
   actionGroup->setExclusive(true);
@@ -779,6 +785,7 @@ void MainWindow::initActions()
 
   connect(m_actionChangeInstallReason, SIGNAL(triggered()), this, SLOT(onChangeInstallReason()));
   connect(ui->actionUseInstantSearch, SIGNAL(triggered(bool)), this, SLOT(toggleInstantSearch()));
+  connect(ui->actionUseFuzzySearch, SIGNAL(triggered(bool)), this, SLOT(toggleFuzzySearch()));
   connect(ui->tvPackages->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)),
           this, SLOT(invalidateTabs()));
   connect(ui->actionInstallLocalPackage, SIGNAL(triggered()), this, SLOT(installLocalPackage()));
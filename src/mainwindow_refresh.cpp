@@ -26,6 +26,7 @@
 #include <cassert>
 #include "mainwindow.h"
 #include "src/ui/octopitabinfo.h"
+#include "src/model/packagefilemodel.h"
 #include "searchlineedit.h"
 #include "ui_mainwindow.h"
 #include "strconstants.h"
@@ -33,6 +34,8 @@
 #include "globals.h"
 #include "aurvote.h"
 #include "utils.h"
+#include "packageinfocache.h"
+#include "fileownershipindex.h"
 
 #include <QElapsedTimer>
 #include <QTimer>
@@ -238,15 +241,15 @@ void MainWindow::AURToolSelected()
     if ((UnixCommand::getLinuxDistro() != ectn_KAOS && ui->actionUseInstantSearch->isChecked()) ||
          (UnixCommand::getLinuxDistro() == ectn_KAOS && !ui->actionUseInstantSearch->isChecked()))
     {
-      disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
+      disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
       disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(lightPackageFilter()));
       connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(lightPackageFilter()));
       lightPackageFilterConnected = true;
     }
     else if (UnixCommand::getLinuxDistro() == ectn_KAOS && ui->actionUseInstantSearch->isChecked())
     {
-      disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
-      connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
+      disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
+      connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
       lightPackageFilterConnected = false;
     }
 
@@ -271,14 +274,14 @@ void MainWindow::AURToolSelected()
     if (UnixCommand::getLinuxDistro() != ectn_KAOS && ui->actionUseInstantSearch->isChecked())
     {
       disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(lightPackageFilter()));
-      disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
-      connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
+      disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
+      connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
       lightPackageFilterConnected = false;
     }
     else if (UnixCommand::getLinuxDistro() == ectn_KAOS && !ui->actionUseInstantSearch->isChecked())
     {
       disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(lightPackageFilter()));
-      disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
+      disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
       connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(lightPackageFilter()));
       lightPackageFilterConnected = true;
     }
@@ -354,19 +357,31 @@ void MainWindow::positionInPkgListSearchByFile()
     m_cic = nullptr;
   }
 
-  QString pkgName = g_fwPackageOwnsFile.result();
+  const QStringList pkgNames = g_fwPackageOwnsFile.result();
 
-  if (!pkgName.isEmpty())
+  if (!pkgNames.isEmpty())
   {
     QModelIndex searchColumn = m_packageModel->index(0,
                                                      PackageModel::ctn_PACKAGE_NAME_COLUMN,
                                                      QModelIndex());
-    QModelIndexList fi = m_packageModel->match(searchColumn, Qt::DisplayRole, pkgName, -1, Qt::MatchExactly);
+    bool first = true;
 
-    if (fi.count() >= 1)
+    //A directory may be owned by many packages: all of them are selected
+    for (const QString &pkgName: pkgNames)
     {
-      ui->tvPackages->setCurrentIndex(fi.at(0));
-      ui->tvPackages->scrollTo(fi.at(0), QAbstractItemView::PositionAtCenter);
+      QModelIndexList fi = m_packageModel->match(searchColumn, Qt::DisplayRole, pkgName, -1, Qt::MatchExactly);
+      if (fi.isEmpty()) continue;
+
+      if (first)
+      {
+        ui->tvPackages->setCurrentIndex(fi.at(0));
+        ui->tvPackages->scrollTo(fi.at(0), QAbstractItemView::PositionAtCenter);
+        first = false;
+      }
+      else
+      {
+        ui->tvPackages->selectionModel()->select(fi.at(0), QItemSelectionModel::Select | QItemSelectionModel::Rows);
+      }
     }
   }
   else //The pkg was not found, so we position on the first item of the list!
@@ -375,6 +390,35 @@ void MainWindow::positionInPkgListSearchByFile()
   }
 }
 
+/*
+ * Shows only the packages which provide the file user has just searched in the sync repositories
+ */
+void MainWindow::showPackagesProvidingFile()
+{
+  if (m_cic) {
+    delete m_cic;
+    m_cic = nullptr;
+  }
+
+  const QList<SyncFileMatch> matches = g_fwSyncFiles.result();
+  QSet<QString> providers;
+
+  for (const SyncFileMatch &match: matches)
+  {
+    providers.insert(match.repository + QLatin1Char('/') + match.package);
+  }
+
+  clearTabsInfoOrFiles();
+  m_packageModel->applyFileProvidersFilter(providers);
+
+  if(m_debugInfo)
+    std::cout << matches.count() << " files in " << providers.count() << " pkgs => " << "Time elapsed searching sync files databases: " <<
+                 m_time->elapsed() << " mili seconds." << std::endl;
+
+  ui->tvPackages->setCurrentIndex(m_packageModel->index(0,0,QModelIndex()));
+  refreshStatusBar();
+}
+
 /*
  * Populates the list of available packages from the given groupName
  */
@@ -583,9 +627,19 @@ void MainWindow::metaBuildPackageList()
 {
   static bool firstTime = true;
 
+  //Events are processed between the batches of a load: a rebuild asked meanwhile (ex: by the database watcher)
+  //would drop the packages under the running load, so it is done when that load ends
+  if (m_packageRepo.isLoading())
+  {
+    m_rebuildPackageListPending = true;
+    return;
+  }
+
   if (!firstTime) m_time->start();
 
-  if (isSearchByFileSelected())
+  if (isSearchByRemoteFileSelected())
+    m_leFilterPackage->setRefreshValidator(ectn_REMOTE_FILE_VALIDATOR);
+  else if (isSearchByFileSelected())
     m_leFilterPackage->setRefreshValidator(ectn_FILE_VALIDATOR);
   else if (isAURGroupSelected())
     m_leFilterPackage->setRefreshValidator(ectn_AUR_VALIDATOR);
@@ -600,9 +654,11 @@ void MainWindow::metaBuildPackageList()
   if (ui->twGroups->topLevelItemCount() == 0 || isAllGroupsSelected())
   {        
     ui->actionSearchByFile->setEnabled(true);
+    ui->actionSearchByRemoteFile->setEnabled(true);
     //ui->actionSearchByName->setChecked(true);
     m_actionLastSearchMethod->setChecked(true);
     if (ui->actionSearchByFile->isChecked()) m_leFilterPackage->setRefreshValidator(ectn_FILE_VALIDATOR);
+    else if (ui->actionSearchByRemoteFile->isChecked()) m_leFilterPackage->setRefreshValidator(ectn_REMOTE_FILE_VALIDATOR);
     else if (ui->actionSearchByName->isChecked()) m_leFilterPackage->setRefreshValidator(ectn_DEFAULT_VALIDATOR);
 
     toggleSystemActions(false);
@@ -638,6 +694,7 @@ void MainWindow::metaBuildPackageList()
     m_toolButtonAUR->hide();
     switchToViewAllPackages();
     ui->actionSearchByFile->setEnabled(false);
+    ui->actionSearchByRemoteFile->setEnabled(false);
     m_packageModel->setShowColumnPopularity(true);
 
     if (UnixCommand::getLinuxDistro() == ectn_KAOS)
@@ -672,7 +729,7 @@ void MainWindow::metaBuildPackageList()
     }
 
     toggleSystemActions(false);
-    //disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter())); //WATCH OUT!
+    //disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter())); //WATCH OUT!
     clearStatusBar();
 
     m_cic = new CPUIntensiveComputing();       
@@ -708,6 +765,7 @@ void MainWindow::metaBuildPackageList()
   else
   {
     ui->actionSearchByFile->setEnabled(false);
+    ui->actionSearchByRemoteFile->setEnabled(false);
     toggleSystemActions(false);
     disconnect(&g_fwPacmanGroup, SIGNAL(finished()), this, SLOT(preBuildPackagesFromGroupList()));
 
@@ -831,39 +889,66 @@ void MainWindow::buildPackageList()
     }
   }
 
+  //The treeview shows the packages while they are being merged into the repository
+  if (ui->tvPackages->model() != m_packageModel.get())
+  {
+    ui->tvPackages->setModel(m_packageModel.get());
+    removePackageTreeViewConnections();
+    initPackageTreeView();
+    ui->tvPackages->setColumnHidden(PackageModel::ctn_PACKAGE_POPULARITY_COLUMN, true);
+  }
+
   m_progressWidget->setRange(0, list->count());
   m_progressWidget->setValue(0);
   m_progressWidget->show();
 
-  int counter=0;
-  QList<PackageListData>::const_iterator it = list->cbegin();
+  m_packageRepo.beginData();
 
-  while(it != list->cend())
+  for (int from=0; from<list->count(); from+=ctn_PACKAGE_LIST_BATCH_SIZE)
   {
-    counter++;
-    m_progressWidget->setValue(counter);
-    ++it;
+    m_packageRepo.appendData(list, from, ctn_PACKAGE_LIST_BATCH_SIZE, *m_unrequiredPackageList);
+    m_progressWidget->setValue(qMin(from + ctn_PACKAGE_LIST_BATCH_SIZE, list->count()));
+
+    if (from == 0)
+    {
+      if (m_debugInfo)
+        std::cout << "Time elapsed until the first pkgs are shown: " << m_time->elapsed() << " mili seconds." << std::endl;
+
+      //The rows merged so far can be browsed while the rest of the list arrives
+      if (m_cic != nullptr)
+      {
+        delete m_cic;
+        m_cic = nullptr;
+      }
+    }
+
+    //User input goes through too: filters, sorting and rebuilds asked meanwhile wait for endData(),
+    //as PackageRepository::isLoading() is true until then
+    QCoreApplication::processEvents();
   }
 
   if(m_debugInfo)
-    std::cout << "Time elapsed iterating over all pkgs from  'ALL group' list: " << m_time->elapsed() << " mili seconds." << std::endl;
+    std::cout << "Time elapsed merging all pkgs from 'ALL group' list: " << m_time->elapsed() << " mili seconds." << std::endl;
 
-  counter = list->count();
-  m_progressWidget->setValue(counter);
-  m_progressWidget->close();
+  //The package the user moved to during the load is selected again after the reset sent by endData()
+  const PackageRepository::PackageData* currentPackage = m_packageModel->getData(ui->tvPackages->currentIndex());
+  const QString currentPackageName = (currentPackage != nullptr) ? currentPackage->name : QString();
 
-  m_packageRepo.setData(list, *m_unrequiredPackageList);
+  m_packageRepo.endData();
+  m_progressWidget->close();
 
-  if (ui->tvPackages->model() != m_packageModel.get())
+  if (m_rebuildPackageListPending)
   {
-    ui->tvPackages->setModel(m_packageModel.get());
-    removePackageTreeViewConnections();
-    initPackageTreeView();
-    ui->tvPackages->setColumnHidden(PackageModel::ctn_PACKAGE_POPULARITY_COLUMN, true);
+    m_rebuildPackageListPending = false;
+    QTimer::singleShot(0, this, SLOT(metaBuildPackageList()));
   }
 
   if(m_debugInfo)
-    std::cout << "Time elapsed setting the list to the treeview: " << m_time->elapsed() << " mili seconds." << std::endl;
+  {
+    const TrigramIndex& index = m_packageRepo.getDescriptionIndex();
+    std::cout << "Description index: " << index.documentCount() << " pkgs, " << index.trigramCount() <<
+                 " trigrams, " << index.memoryUsage() / 1024 << " KB - Time elapsed: " << m_time->elapsed() << " mili seconds." << std::endl;
+  }
 
   if (ui->actionSearchByDescription->isChecked())
   {
@@ -883,6 +968,13 @@ void MainWindow::buildPackageList()
     std::cout << "Time elapsed after applying filters to the treeview: " << m_time->elapsed() << " mili seconds." << std::endl;
 
   QModelIndex maux = m_packageModel->index(0, 0, QModelIndex());
+  if (!currentPackageName.isEmpty())
+  {
+    QModelIndexList fi = m_packageModel->match(m_packageModel->index(0, PackageModel::ctn_PACKAGE_NAME_COLUMN, QModelIndex()),
+                                               Qt::DisplayRole, currentPackageName, 1, Qt::MatchExactly);
+    if (!fi.isEmpty()) maux = fi.at(0);
+  }
+
   ui->tvPackages->setCurrentIndex(maux);
   ui->tvPackages->scrollTo(maux, QAbstractItemView::PositionAtCenter);
   ui->tvPackages->setCurrentIndex(maux);
@@ -1600,12 +1692,26 @@ void MainWindow::refreshTabInfo(bool clearContents, bool neverQuit)
     QTextBrowser *text = ui->twProperties->widget(
           ctn_TABINDEX_INFORMATION)->findChild<QTextBrowser*>(QStringLiteral("textBrowser"));
 
+    QElapsedTimer infoTime;
+    infoTime.start();
+
     if (text)
     {
       text->clear();
       text->setHtml(OctopiTabInfo::formatTabInfo(*package, *m_outdatedAURPackagesNameVersion));
       text->scrollToAnchor(OctopiTabInfo::anchorBegin);
     }
+
+    if (m_debugInfo)
+    {
+      std::cout << "Time elapsed showing info of '" << package->name.toLatin1().data() << "': " <<
+                   infoTime.nsecsElapsed() / 1000 << " micro seconds." << std::endl;
+
+      const int hits = PackageInfoCache::getHitCount();
+      const int lookups = hits + PackageInfoCache::getMissCount();
+      std::cout << "Package info cache: " << hits << " hits in " << lookups << " lookups (" <<
+                   (lookups > 0 ? hits * 100 / lookups : 0) << "%), " << PackageInfoCache::getCostInKB() << " KB" << std::endl;
+    }
   }
 
   m_cachedPackageInInfo = package->repository+QLatin1Char('#')+package->name+QLatin1String("#")+package->version;
@@ -1642,7 +1748,7 @@ void MainWindow::refreshTabFiles(bool clearContents, bool neverQuit)
 
     if(tvPkgFileList)
     {
-      QStandardItemModel*const modelPkgFileList = qobject_cast<QStandardItemModel*>(tvPkgFileList->model());
+      PackageFileModel*const modelPkgFileList = qobject_cast<PackageFileModel*>(tvPkgFileList->model());
       modelPkgFileList->clear();
       m_cachedPackageInFiles = QLatin1String("");
       closeTabFilesSearchBar();
@@ -1688,15 +1794,7 @@ void MainWindow::refreshTabFiles(bool clearContents, bool neverQuit)
   if (tvPkgFileList)
   {
     QString pkgName = package->name;
-    QStandardItemModel *fakeModelPkgFileList = new QStandardItemModel(this);
-    QStandardItemModel *modelPkgFileList = qobject_cast<QStandardItemModel*>(tvPkgFileList->model());
-    modelPkgFileList->clear();
-
-    QStandardItem *fakeRoot = fakeModelPkgFileList->invisibleRootItem();
-    QStandardItem *root = modelPkgFileList->invisibleRootItem();
-    QStandardItem *lastDir, *item, *lastItem=root, *parent;
-    bool first=true;
-    lastDir = root;
+    PackageFileModel *modelPkgFileList = qobject_cast<PackageFileModel*>(tvPkgFileList->model());
 
     QEventLoop el;
     QFuture<QStringList> f;
@@ -1709,135 +1807,16 @@ void MainWindow::refreshTabFiles(bool clearContents, bool neverQuit)
     el.exec();
     const QStringList fileList = fwPackageContents.result();
 
-    QString fullPath;
-    int counter = 0;
-    m_progressWidget->setRange(0, fileList.count());
-    m_progressWidget->setValue(0);
-    m_progressWidget->show();
-
-    for (const QString& file: fileList)
-    {
-      bool isDir = file.endsWith(QLatin1Char('/'));
-      bool isSymLinkToDir = false;
-      QString baseFileName = extractBaseFileName(file);
-
-      //Let's test if it is not a symbolic link to a dir
-      if(!isDir)
-      {
-        QFileInfo fiTestForSymLink(file);
-        if(fiTestForSymLink.isSymLink())
-        {
-          QFileInfo fiTestForDir(fiTestForSymLink.symLinkTarget());
-          isSymLinkToDir = fiTestForDir.isDir();
-        }
-      }
-
-      if(isDir)
-      {
-        if (first)
-        {
-          item = new QStandardItem ( IconHelper::getIconFolder(), baseFileName );
-          item->setAccessibleDescription(QLatin1String("directory ") + item->text());
-          fakeRoot->appendRow ( item );
-        }
-        else
-        {
-          fullPath = utils::showFullPathOfItem(lastDir->index());
-          //std::cout << "Testing if " << file.toLatin1().data() << " contains " << fullPath.toLatin1().data() << std::endl;
-          if ( file.contains ( fullPath )) {
-            //std::cout << "It contains !!! So " << fullPath.toLatin1().data() << " is its parent." << std::endl;
-            item = new QStandardItem ( IconHelper::getIconFolder(), baseFileName );
-            item->setAccessibleDescription(QLatin1String("directory ") + item->text());
-            lastDir->appendRow ( item );
-          }
-          else
-          {
-            //std::cout << "It doens't contain..." << std::endl;
-            parent = lastItem->parent();
-            if (parent != nullptr) fullPath = utils::showFullPathOfItem(parent->index());
-
-            do
-            {
-              //if (parent != 0) std::cout << "Testing if " << file.toLatin1().data() << " contains " << fullPath.toLatin1().data() << std::endl;
-              if ( parent == nullptr || file.contains ( fullPath )) break;
-              parent = parent->parent();
-              if (parent != nullptr) fullPath = utils::showFullPathOfItem(parent->index());
-            }
-            while (parent != fakeRoot);
-
-            item = new QStandardItem ( IconHelper::getIconFolder(), baseFileName );
-            item->setAccessibleDescription(QLatin1String("directory ") + item->text());
-
-            if ( parent != nullptr )
-            {
-              //std::cout << item->text().toLatin1().data() << " is son of " << fullPath.toLatin1().data() << std::endl;
-              parent->appendRow ( item );
-            }
-            else
-            {
-              //std::cout << item->text().toLatin1().data() << " is son of <FAKEROOT>" << std::endl;
-              fakeRoot->appendRow ( item );
-            }
-          }
-        }
+    QElapsedTimer buildTime;
+    buildTime.start();
+    modelPkgFileList->setFileList(pkgName, fileList);
 
-        lastDir = item;
-      }            
-      else if (isSymLinkToDir)
-      {
-        item = new QStandardItem ( IconHelper::getIconFolder(), baseFileName );
-        item->setAccessibleDescription(QLatin1String("directory ") + item->text());
-        parent = lastDir;
-        if (parent != nullptr) fullPath = utils::showFullPathOfItem(parent->index());
+    if (m_debugInfo)
+      std::cout << "Time elapsed building the file tree of '" << pkgName.toLatin1().data() << "' (" <<
+                   modelPkgFileList->getNodeCount() << " entries): " << buildTime.nsecsElapsed() / 1000 <<
+                   " micro seconds." << std::endl;
 
-        do
-        {
-          if ( parent == nullptr || file.contains ( fullPath )) break;
-          parent = parent->parent();
-          if (parent != nullptr) fullPath = utils::showFullPathOfItem(parent->index());
-        }
-        while ( parent != fakeRoot );
-
-        if (parent != nullptr)
-        {
-          parent->appendRow ( item );
-        }
-        else
-        {
-          fakeRoot->appendRow ( item );
-        }
-      }
-      else
-      {
-        item = new QStandardItem ( IconHelper::getIconBinary(), baseFileName );
-        item->setAccessibleDescription(QLatin1String("file ") + item->text());
-        parent = lastDir;
-        if (parent != nullptr) fullPath = utils::showFullPathOfItem(parent->index());
-
-        do
-        {
-          if ( parent == nullptr || file.contains ( fullPath )) break;
-          parent = parent->parent();
-          if (parent != nullptr) fullPath = utils::showFullPathOfItem(parent->index());
-        }
-        while ( parent != fakeRoot );
-
-        parent->appendRow ( item );
-      }
-
-      counter++;
-      m_progressWidget->setValue(counter);
-      lastItem = item;
-      first = false;
-    }
-
-    m_progressWidget->close();
-    root = fakeRoot;
-    fakeModelPkgFileList->sort(0);
-    modelPkgFileList = fakeModelPkgFileList;
-    tvPkgFileList->setModel(modelPkgFileList);
     tvPkgFileList->header()->setDefaultAlignment( Qt::AlignCenter );
-    modelPkgFileList->setHorizontalHeaderLabels( QStringList() << StrConstants::getContentsOf().arg(pkgName));
   }
 
   m_cachedPackageInFiles = package->repository+QLatin1Char('#')+package->name+QLatin1Char('#')+package->version;
@@ -1855,56 +1834,131 @@ void MainWindow::refreshTabFiles(bool clearContents, bool neverQuit)
 }
 
 /*
- * This SLOT is called every time we press a key at FilterLineEdit
+ * Filters the package list right away with the text of FilterLineEdit
  */
 void MainWindow::reapplyPackageFilter()
 {
+  m_filterDelayTimer->stop();
   clearTabsInfoOrFiles();
 
   //We are not in a search by filenames...
   if (!isSearchByFileSelected())
   {
-    bool isFilterPackageSelected = m_leFilterPackage->hasFocus();
-    int numPkgs = m_packageModel->getPackageCount();
+    QString search = getPackageFilterExpression();
 
-    if (m_leFilterPackage->text() != QLatin1String(""))
-    {
-      QString search = m_leFilterPackage->text();
-      search = search.replace(QLatin1String("+"), QLatin1String("\\+"));
-      m_packageModel->applyFilter(search);
-      numPkgs = m_packageModel->getPackageCount();
+    QElapsedTimer filterTime;
+    filterTime.start();
+    m_packageModel->applyFilter(search);
 
-      if (numPkgs > 0) m_leFilterPackage->setFoundStyle();
-      else m_leFilterPackage->setNotFoundStyle();
-    }
-    else
-    {
-      m_leFilterPackage->initStyleSheet();
-      m_packageModel->applyFilter(QLatin1String(""));
-    }
+    if(m_debugInfo && !search.isEmpty())
+      std::cout << m_packageModel->getPackageCount() << " pkgs => " << "Time elapsed filtering '" << search.toLatin1().data() <<
+                   "': " << filterTime.nsecsElapsed() / 1000 << " micro seconds." << std::endl;
+
+    onPackageFilterApplied();
+  }
+  //If we are using "Search By file...
+  else
+  {
+    m_leFilterPackage->initStyleSheet();
 
-    if (isFilterPackageSelected || numPkgs == 0)
+    //Path completion only knows about installed files
+    if (isSearchByRemoteFileSelected()) return;
+
+    //We need to provide QCompleter data to the SearchLineEdit...
+    if (!m_leFilterPackage->text().isEmpty())
     {
-      m_leFilterPackage->setFocus();
+      if (FileOwnershipIndex::isReady())
+      {
+        m_leFilterPackage->setCompleterData(
+              FileOwnershipIndex::getCompletions(m_leFilterPackage->text(), ctn_FILE_SUGGESTION_COUNT));
+      }
+      else
+      {
+        FileOwnershipIndex::loadInBackground();
+        m_leFilterPackage->refreshCompleterData();
+      }
     }
+  }
+}
 
-    if (numPkgs == 0)
-      tvPackagesSelectionChanged(QItemSelection(),QItemSelection());
+/*
+ * This SLOT is called every time we press a key at FilterLineEdit, when INSTANT SEARCH is enabled
+ *
+ * The running filter pass, if any, is obsolete now. A new one starts when the user stops typing
+ */
+void MainWindow::delayPackageFilter()
+{
+  m_packagePrefetcher.cancel();
+  m_packageModel->cancelFilter();
+  m_filterDelayTimer->start();
+}
 
-    ui->tvPackages->selectionModel()->clear();
-    QModelIndex mi = m_packageModel->index(0, PackageModel::ctn_PACKAGE_NAME_COLUMN, QModelIndex());
-    ui->tvPackages->setCurrentIndex(mi);
-    ui->tvPackages->scrollTo(mi);
+/*
+ * Filters the package list in the background with the text of FilterLineEdit
+ */
+void MainWindow::asyncPackageFilter()
+{
+  if (isSearchByFileSelected())
+  {
+    reapplyPackageFilter();
+    return;
+  }
+
+  clearTabsInfoOrFiles();
+  QString search = getPackageFilterExpression();
+
+  QElapsedTimer filterTime;
+  filterTime.start();
+  m_packageModel->applyFilterAsync(search);
+
+  if(m_debugInfo)
+    std::cout << "Time blocked dispatching filter '" << search.toLatin1().data() <<
+                 "': " << filterTime.nsecsElapsed() / 1000 << " micro seconds." << std::endl;
+}
+
+/*
+ * Returns the text of FilterLineEdit as the PackageModel expects it
+ */
+QString MainWindow::getPackageFilterExpression()
+{
+  QString search = m_leFilterPackage->text();
+
+  //The fuzzy filter and structured queries take the typed text as is, while the default one takes a regex
+  if (!ui->actionUseFuzzySearch->isChecked() && !PackageQuery::isQuery(search))
+    search = search.replace(QLatin1String("+"), QLatin1String("\\+"));
+
+  return search;
+}
+
+/*
+ * Updates FilterLineEdit's style and the package selection after the package list has been filtered
+ */
+void MainWindow::onPackageFilterApplied()
+{
+  int numPkgs = m_packageModel->getPackageCount();
+
+  if (m_leFilterPackage->text() != QLatin1String(""))
+  {
+    if (numPkgs > 0) m_leFilterPackage->setFoundStyle();
+    else m_leFilterPackage->setNotFoundStyle();
   }
-  //If we are using "Search By file...
   else
   {
     m_leFilterPackage->initStyleSheet();
+  }
 
-    //We need to provide QCompleter data to the SearchLineEdit...
-    if (!m_leFilterPackage->text().isEmpty())
-      m_leFilterPackage->refreshCompleterData();
+  if (m_leFilterPackage->hasFocus() || numPkgs == 0)
+  {
+    m_leFilterPackage->setFocus();
   }
+
+  if (numPkgs == 0)
+    tvPackagesSelectionChanged(QItemSelection(),QItemSelection());
+
+  ui->tvPackages->selectionModel()->clear();
+  QModelIndex mi = m_packageModel->index(0, PackageModel::ctn_PACKAGE_NAME_COLUMN, QModelIndex());
+  ui->tvPackages->setCurrentIndex(mi);
+  ui->tvPackages->scrollTo(mi);
 }
 
 /*
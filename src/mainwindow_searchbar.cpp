@@ -26,8 +26,11 @@
 #include "mainwindow.h"
 #include "searchbar.h"
 #include "utils.h"
+#include "src/model/packagefilemodel.h"
 
 #include <QTextBrowser>
+#include <QElapsedTimer>
+#include <iostream>
 
 /*
  * Every time the user changes the text to search inside a textBrowser...
@@ -97,7 +100,7 @@ void MainWindow::searchBarTextChangedInTreeView(const QString &textToSearch)
     ui->twProperties->getTvPkgFileList();
   if (tvPkgFileList)
   {
-    QStandardItemModel *sim = qobject_cast<QStandardItemModel *>(tvPkgFileList->model());
+    PackageFileModel *sim = qobject_cast<PackageFileModel *>(tvPkgFileList->model());
     if (!sim) return;
     SearchBar *sb = ui->twProperties->currentWidget()->findChild<SearchBar*>(QStringLiteral("searchbar"));
 
@@ -108,7 +111,14 @@ void MainWindow::searchBarTextChangedInTreeView(const QString &textToSearch)
 
     if (textToSearch.isEmpty()) return;
 
-    m_foundFilesInPkgFileList = utils::findFileInTreeView(textToSearch, sim);
+    QElapsedTimer searchTime;
+    searchTime.start();
+    *m_foundFilesInPkgFileList = sim->findFiles(textToSearch);
+
+    if(m_debugInfo)
+      std::cout << m_foundFilesInPkgFileList->count() << " of " << sim->getNodeCount() << " files => " <<
+                   "Time elapsed searching '" << textToSearch.toLatin1().data() << "': " <<
+                   searchTime.nsecsElapsed() / 1000 << " micro seconds." << std::endl;
 
     if (m_foundFilesInPkgFileList->count() > 0)
     {
@@ -38,10 +38,17 @@
 #include "utils.h"
 
 #include <QComboBox>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
 #include <QProgressBar>
 #include <QMessageBox>
 #include <QStandardItem>
+#include <QRegularExpression>
+#include <QTextBlock>
 #include <QTextBrowser>
+#include <QTextCursor>
+#include <QTimer>
 #include <QFutureWatcher>
 #include <QtConcurrent/QtConcurrentRun>
 
@@ -394,6 +401,7 @@ void MainWindow::doChangeInstallReason(const QHash<QString, QString> &listOfTarg
                    this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus) ));
 
   QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+  QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
   QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
   QObject::connect(m_pacmanExec, SIGNAL(canStopTransaction(bool)), this, SLOT(onCanStopTransaction(bool)));
   QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
@@ -820,6 +828,7 @@ void MainWindow::doCheckUpdates()
                    this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus) ));
 
   QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+  QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
   QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
 
   m_pacmanExec->doCheckUpdates();
@@ -846,6 +855,7 @@ void MainWindow::doMirrorCheck()
                    this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus) ));
 
   QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+  QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
   QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
 
   m_pacmanExec->doMirrorCheck();
@@ -881,6 +891,7 @@ void MainWindow::doAURUpgrade()
                    this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus) ));
 
   QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+  QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
   QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
   QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
 
@@ -918,6 +929,7 @@ void MainWindow::doUpdateAURPackage()
                    this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus) ));
 
   QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+  QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
   QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
   QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
 
@@ -947,6 +959,7 @@ bool MainWindow::prepareSystemUpgrade()
                    this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus)));
 
   QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+  QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
   QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
   QObject::connect(m_pacmanExec, SIGNAL(canStopTransaction(bool)), this, SLOT(onCanStopTransaction(bool)));
   QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
@@ -1162,6 +1175,7 @@ void MainWindow::doRemoveAndInstallAUR()
                    this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus) ));
 
   QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+  QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
   QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
   QObject::connect(m_pacmanExec, SIGNAL(canStopTransaction(bool)), this, SLOT(onCanStopTransaction(bool)));
   QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
@@ -1299,6 +1313,7 @@ void MainWindow::doRemoveAndInstall()
                      this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus) ));
 
     QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+    QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
     QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
     QObject::connect(m_pacmanExec, SIGNAL(canStopTransaction(bool)), this, SLOT(onCanStopTransaction(bool)));
     QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
@@ -1373,6 +1388,7 @@ void MainWindow::doRemove()
                      this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus) ));
 
     QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+    QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
     QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
     QObject::connect(m_pacmanExec, SIGNAL(canStopTransaction(bool)), this, SLOT(onCanStopTransaction(bool)));
     QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
@@ -1442,6 +1458,7 @@ void MainWindow::doInstallAURPackage()
                    this, SLOT( pacmanProcessFinished(int,QProcess::ExitStatus) ));
 
   QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+  QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
   QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
   QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
 
@@ -1493,6 +1510,7 @@ void MainWindow::doInstallYayPackage()
                    this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus) ));
 
   QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+  QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
   QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
   QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
 
@@ -1523,6 +1541,7 @@ void MainWindow::doRemoveAUR()
                    this, SLOT(pacmanProcessFinished(int,QProcess::ExitStatus) ));
 
   QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+  QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
   QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
   QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
 
@@ -1564,6 +1583,7 @@ void MainWindow::doRemoveAURPackage()
                    this, SLOT( pacmanProcessFinished(int,QProcess::ExitStatus) ));
 
   QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+  QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
   QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
   QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
 
@@ -1586,8 +1606,8 @@ void MainWindow::onAURToolChanged()
       if (ui->actionUseInstantSearch->isChecked())
       {
         disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(lightPackageFilter()));
-        disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
-        connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
+        disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
+        connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(delayPackageFilter()));
       }
 
       m_packageModel->applyFilter(QLatin1String(""));
@@ -1749,6 +1769,7 @@ void MainWindow::doInstallAUR()
                    this, SLOT( pacmanProcessFinished(int,QProcess::ExitStatus) ));
 
   QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+  QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
   QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
   QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
 
@@ -1847,6 +1868,7 @@ void MainWindow::doInstall()
                      this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus) ));
 
     QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+    QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
     QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
     QObject::connect(m_pacmanExec, SIGNAL(canStopTransaction(bool)), this, SLOT(onCanStopTransaction(bool)));
     QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
@@ -1920,6 +1942,7 @@ void MainWindow::doInstallLocalPackages()
                      this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus) ));
 
     QObject::connect(m_pacmanExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
+    QObject::connect(m_pacmanExec, SIGNAL(transactionEvent(TransactionEvent)), this, SLOT(onTransactionEvent(TransactionEvent)));
     QObject::connect(m_pacmanExec, SIGNAL(textToPrintExt(QString)), this, SLOT(outputText(QString)));
     QObject::connect(m_pacmanExec, SIGNAL(canStopTransaction(bool)), this, SLOT(onCanStopTransaction(bool)));
     QObject::connect(m_pacmanExec, SIGNAL(commandToExecInQTermWidget(QString)), this, SLOT(onExecCommandInTabTerminal(QString)));
@@ -2057,9 +2080,11 @@ void MainWindow::toggleTransactionActions(const bool value)
 
   //Search menu
   ui->actionSearchByFile->setEnabled(value);
+  ui->actionSearchByRemoteFile->setEnabled(value);
   ui->actionSearchByName->setEnabled(value);
   ui->actionSearchByDescription->setEnabled(value);
   ui->actionUseInstantSearch->setEnabled(value);
+  ui->actionUseFuzzySearch->setEnabled(value);
 
   m_leFilterPackage->setEnabled(value);
 
@@ -2202,7 +2227,18 @@ void MainWindow::onCanStopTransaction(bool yesNo)
 void MainWindow::pacmanProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
   bool bRefreshGroups = true;
+  flushOutput();
+
+  if (m_debugInfo)
+  {
+    std::cout << "Output tab: " << m_outputFlushCount << " flushes, " << m_outputLineCount << " lines kept => " <<
+                 "Time elapsed rendering output: " << m_outputRenderTime / 1000000 << " ms" << std::endl;
+  }
+  m_outputRenderTime = 0;
+  m_outputFlushCount = 0;
+
   m_progressWidget->close();
+  m_progressWidget->setFormat(QStringLiteral("%p%"));
   m_progressWidget->setValue(0);
   m_progressWidget->show();
 
@@ -2272,7 +2308,7 @@ void MainWindow::pacmanProcessFinished(int exitCode, QProcess::ExitStatus exitSt
   if(m_commandQueued == ectn_SYSTEM_UPGRADE)
   {
     //Did it synchronize any repo? If so, let's refresh some things...
-    if (textInTabOutput(StrConstants::getSyncing()))
+    if (m_outputHasSyncing)
     {
       bool aurGroup = isAURGroupSelected();
 
@@ -2362,7 +2398,7 @@ void MainWindow::pacmanProcessFinished(int exitCode, QProcess::ExitStatus exitSt
     }
   }
 
-  if (exitCode != 0 && (textInTabOutput(QStringLiteral("conflict")))) //|| _textInTabOutput("could not satisfy dependencies")))
+  if (exitCode != 0 && m_outputHasConflict) //|| _textInTabOutput("could not satisfy dependencies")))
   {
     int res = QMessageBox::question(this, StrConstants::getThereHasBeenATransactionError(),
                                     StrConstants::getConfirmExecuteTransactionInTerminal(),
@@ -2514,7 +2550,10 @@ void MainWindow::writeToTabOutput(const QString &msg, TreatURLLinks treatURLLink
   if (text)
   {
     ensureTabVisible(ctn_TABINDEX_OUTPUT);
-    utils::writeToTextBrowser(text, msg, treatURLLinks);
+
+    //Whatever pacman printed before goes first. Callers expect msg to be in the tab when we return
+    m_pendingOutput += utils::formatForTextBrowser(msg, treatURLLinks);
+    flushOutput();
   }
 }
 
@@ -2531,30 +2570,158 @@ void MainWindow::incrementPercentage(int percentage)
   m_progressWidget->setValue(percentage);
 }
 
+/*
+ * Shows what pacman is doing inside the progress bar, like "(3/12) upgrading linux 40%"
+ */
+void MainWindow::onTransactionEvent(const TransactionEvent &event)
+{
+  QString status;
+
+  switch (event.type)
+  {
+    case ectn_EVENT_PHASE_STARTED:
+      status = event.text;
+      break;
+    case ectn_EVENT_PACKAGE_PROGRESS:
+    case ectn_EVENT_HOOK_RUNNING:
+      status = QStringLiteral("(%1/%2) ").arg(event.current).arg(event.total) + event.text;
+      break;
+    case ectn_EVENT_DOWNLOAD_PROGRESS:
+      if (event.percent < 0) return; //Only the "Total" line moves the bar
+      status = event.text;
+      if (event.total > 0) status += QStringLiteral(" (%1/%2)").arg(event.current).arg(event.total);
+      break;
+    case ectn_EVENT_WARNING:
+    case ectn_EVENT_ERROR:
+      return;
+  }
+
+  m_progressWidget->setFormat(status + QLatin1String(" %p%"));
+}
+
 /*
  * A helper method which writes the given string to OutputTab's textbrowser
  */
 void MainWindow::outputText(const QString &output)
 {
-  QTextBrowser *text = ui->twProperties->widget(ctn_TABINDEX_OUTPUT)->findChild<QTextBrowser*>(QStringLiteral("textBrowser"));
-  if (text)
+  if (m_commandExecuting == ectn_CHECK_UPDATES)
   {
-    if (m_commandExecuting == ectn_CHECK_UPDATES)
-    {
-      QString newstr = output;
-      newstr.replace(QStringLiteral("\n"), QStringLiteral("<br>"));
-      text->insertHtml(newstr);
-      text->ensureCursorVisible();
-      return;
-    }
-    else if ((m_commandExecuting == ectn_RUN_IN_TERMINAL && SettingsManager::getTerminal() != ctn_QTERMWIDGET) ||
+    QString newstr = output;
+    newstr.replace(QStringLiteral("\n"), QStringLiteral("<br>"));
+    m_pendingOutput += newstr;
+  }
+  else
+  {
+    if ((m_commandExecuting == ectn_RUN_IN_TERMINAL && SettingsManager::getTerminal() != ctn_QTERMWIDGET) ||
         (m_commandExecuting != ectn_RUN_IN_TERMINAL && SettingsManager::getTerminal() == ctn_QTERMWIDGET))
     {
-      ensureTabVisible(ctn_TABINDEX_OUTPUT);
-      positionTextEditCursorAtEnd();
+      if (m_pendingOutput.isEmpty()) ensureTabVisible(ctn_TABINDEX_OUTPUT);
     }
 
-    text->insertHtml(output);
+    m_pendingOutput += output;
+  }
+
+  if (!m_outputFlushTimer->isActive()) m_outputFlushTimer->start();
+}
+
+/*
+ * Writes the output gathered since the last flush to OutputTab's textbrowser with a single insert
+ */
+void MainWindow::flushOutput()
+{
+  m_outputFlushTimer->stop();
+  if (m_pendingOutput.isEmpty()) return;
+
+  QElapsedTimer elapsed;
+  elapsed.start();
+
+  QTextBrowser *text = ui->twProperties->widget(ctn_TABINDEX_OUTPUT)->findChild<QTextBrowser*>(QStringLiteral("textBrowser"));
+  if (text)
+  {
+    static const QRegularExpression reLineBreak(QStringLiteral("<br\\s*/?>"), QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression reConflict(QStringLiteral("\\bconflict\\b"), QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression reSyncing(QStringLiteral("\\b") + StrConstants::getSyncing() + QStringLiteral("\\b"),
+                                              QRegularExpression::CaseInsensitiveOption);
+
+    //Latch these before trimming can drop them, pacmanProcessFinished() needs them once the transaction ends
+    if (!m_outputHasConflict) m_outputHasConflict = m_pendingOutput.contains(reConflict);
+    if (!m_outputHasSyncing) m_outputHasSyncing = m_pendingOutput.contains(reSyncing);
+
+    utils::positionTextEditCursorAtEnd(text);
+    text->insertHtml(m_pendingOutput);
+    m_outputLineCount += m_pendingOutput.count(reLineBreak);
+    trimTabOutput(text);
     text->ensureCursorVisible();
   }
+
+  appendToOutputLog(m_pendingOutput);
+  m_pendingOutput.clear();
+
+  m_outputRenderTime += elapsed.nsecsElapsed();
+  ++m_outputFlushCount;
+}
+
+/*
+ * Removes the oldest lines of OutputTab's textbrowser once it has more than SettingsManager::getOutputMaxLines()
+ */
+void MainWindow::trimTabOutput(QTextBrowser *text)
+{
+  const int maxLines = SettingsManager::getOutputMaxLines();
+  if (maxLines == 0 || m_outputLineCount <= maxLines) return;
+
+  //A tenth more than needed goes away, so we do not trim again on the next flush
+  const int excess = m_outputLineCount - maxLines + maxLines / 10;
+  QTextDocument *doc = text->document();
+  int removed = 0;
+  int position = 0;
+
+  //A <br> becomes a line separator inside the block, not a new block
+  for (QTextBlock block = doc->begin(); block.isValid() && removed < excess; block = block.next())
+  {
+    const QString blockText = block.text();
+    int from = 0;
+    int separator;
+
+    while (removed < excess && (separator = blockText.indexOf(QChar(QChar::LineSeparator), from)) != -1)
+    {
+      ++removed;
+      from = separator + 1;
+    }
+
+    position = block.position() + from;
+  }
+
+  if (removed == 0) return;
+
+  QTextCursor cursor(doc);
+  cursor.setPosition(position, QTextCursor::KeepAnchor);
+  cursor.removeSelectedText();
+  m_outputLineCount -= removed;
+}
+
+/*
+ * Appends the text of the given html to ~/.config/octopi/output.log
+ */
+void MainWindow::appendToOutputLog(const QString &html)
+{
+  if (!m_outputLog->isOpen())
+  {
+    QDir().mkpath(QFileInfo(*m_outputLog).path());
+    if (!m_outputLog->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) return;
+  }
+
+  static const QRegularExpression reLineBreak(QStringLiteral("<br\\s*/?>"), QRegularExpression::CaseInsensitiveOption);
+  static const QRegularExpression reTag(QStringLiteral("<[^>]*>"));
+
+  QString str = html;
+  str.replace(reLineBreak, QStringLiteral("\n"));
+  str.remove(reTag);
+  str.replace(QLatin1String("&nbsp;"), QLatin1String(" "));
+  str.replace(QLatin1String("&lt;"), QLatin1String("<"));
+  str.replace(QLatin1String("&gt;"), QLatin1String(">"));
+  str.replace(QLatin1String("&quot;"), QLatin1String("\""));
+  str.replace(QLatin1String("&amp;"), QLatin1String("&"));
+
+  m_outputLog->write(str.toUtf8());
+  m_outputLog->flush();
 }
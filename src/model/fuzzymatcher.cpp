@@ -0,0 +1,137 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "fuzzymatcher.h"
+
+/*
+ * Scores follow the same ideas as fzf's v1 algorithm: a greedy forward scan finds
+ * the end of the match, a backward scan shrinks it, then the window is scored
+ */
+
+static const int ctn_SCORE_MATCH = 16;
+static const int ctn_PENALTY_GAP_START = 3;
+static const int ctn_PENALTY_GAP_EXTENSION = 1;
+static const int ctn_BONUS_BOUNDARY = 8;
+static const int ctn_BONUS_CONSECUTIVE = 6;
+static const int ctn_BONUS_FIRST_CHAR = 8;
+
+FuzzyMatcher::FuzzyMatcher(const QString &pattern): m_pattern(pattern.toCaseFolded())
+{
+}
+
+/*
+ * Returns 0 if the pattern is not a subsequence of text, or a positive score otherwise
+ */
+int FuzzyMatcher::scoreSubsequence(const QString &text) const
+{
+  const int patternSize = m_pattern.size();
+  const int textSize = text.size();
+  if (patternSize == 0 || patternSize > textSize) return 0;
+
+  const QChar *p = m_pattern.constData();
+  const QChar *t = text.constData();
+
+  //Forward scan: where does the leftmost complete match end?
+  int pi = 0;
+  int end = -1;
+  for (int c=0; c<textSize; ++c)
+  {
+    if (t[c].toCaseFolded() == p[pi] && ++pi == patternSize)
+    {
+      end = c;
+      break;
+    }
+  }
+  if (end == -1) return 0;
+
+  //Backward scan: the tightest window which ends there
+  int begin = end;
+  pi = patternSize - 1;
+  for (int c=end; c>=0; --c)
+  {
+    if (t[c].toCaseFolded() == p[pi] && --pi < 0)
+    {
+      begin = c;
+      break;
+    }
+  }
+
+  int score = 0;
+  bool inGap = false;
+  bool prevMatched = false;
+  pi = 0;
+
+  for (int c=begin; c<=end && pi<patternSize; ++c)
+  {
+    if (t[c].toCaseFolded() == p[pi])
+    {
+      int bonus = isWordBoundary(text, c) ? ctn_BONUS_BOUNDARY : 0;
+      if (prevMatched && bonus < ctn_BONUS_CONSECUTIVE) bonus = ctn_BONUS_CONSECUTIVE;
+      if (pi == 0) bonus *= 2;
+
+      score += ctn_SCORE_MATCH + bonus;
+      inGap = false;
+      prevMatched = true;
+      ++pi;
+    }
+    else
+    {
+      score -= (inGap ? ctn_PENALTY_GAP_EXTENSION : ctn_PENALTY_GAP_START);
+      inGap = true;
+      prevMatched = false;
+    }
+  }
+
+  if (begin == 0) score += ctn_BONUS_FIRST_CHAR;
+
+  return (score > 0 ? score : 1);
+}
+
+/*
+ * Returns 0 if text does not contain the pattern, or a positive score otherwise
+ */
+int FuzzyMatcher::scoreSubstring(const QString &text) const
+{
+  if (m_pattern.isEmpty()) return 0;
+
+  const int pos = text.indexOf(m_pattern, 0, Qt::CaseInsensitive);
+  if (pos == -1) return 0;
+
+  return m_pattern.size() * ctn_SCORE_MATCH / 2 + (isWordBoundary(text, pos) ? ctn_BONUS_BOUNDARY : 0);
+}
+
+bool FuzzyMatcher::isPrefixOf(const QString &text) const
+{
+  return !m_pattern.isEmpty() && text.startsWith(m_pattern, Qt::CaseInsensitive);
+}
+
+/*
+ * True if pos starts a word: "qt" in "python-qt" or "QtCreator"
+ */
+bool FuzzyMatcher::isWordBoundary(const QString &text, int pos)
+{
+  if (pos == 0) return true;
+
+  const QChar prev = text.at(pos-1);
+  const QChar curr = text.at(pos);
+
+  if (!prev.isLetterOrNumber()) return true;
+  return (prev.isLower() && curr.isUpper()) || (prev.isLetter() && curr.isDigit());
+}
@@ -0,0 +1,47 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef OCTOPI_FUZZYMATCHER_H
+#define OCTOPI_FUZZYMATCHER_H
+
+#include <QString>
+
+/*
+ * @brief Subsequence matcher with fzf like scoring, used by the fuzzy package search
+ */
+class FuzzyMatcher
+{
+public:
+  explicit FuzzyMatcher(const QString& pattern);
+
+  const QString& pattern() const { return m_pattern; }
+  bool isEmpty() const { return m_pattern.isEmpty(); }
+
+  int scoreSubsequence(const QString& text) const;
+  int scoreSubstring(const QString& text) const;
+  bool isPrefixOf(const QString& text) const;
+
+private:
+  static bool isWordBoundary(const QString& text, int pos);
+
+  QString m_pattern; // case folded
+};
+
+#endif // OCTOPI_FUZZYMATCHER_H
@@ -0,0 +1,362 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "packagefilemodel.h"
+#include "src/uihelper.h"
+#include "src/strconstants.h"
+#include "src/package.h"
+
+#include <QFileInfo>
+#include <QHash>
+#include <QRegularExpression>
+#include <QStringView>
+#include <algorithm>
+
+/*
+ * The model which holds the file tree of the package selected in the main treeview
+ */
+
+PackageFileModel::PackageFileModel(QObject *parent)
+  : QAbstractItemModel(parent),
+    m_iconFolder(IconHelper::getIconFolder()),
+    m_iconBinary(IconHelper::getIconBinary())
+{
+  m_nodes.emplace_back(QString(), -1, true);
+}
+
+QModelIndex PackageFileModel::index(int row, int column, const QModelIndex &parent) const
+{
+  if (!hasIndex(row, column, parent))
+    return QModelIndex();
+
+  const std::vector<int>& children = getSortedChildren(getNode(parent));
+  return createIndex(row, column, static_cast<quintptr>(children[row]));
+}
+
+QModelIndex PackageFileModel::parent(const QModelIndex &child) const
+{
+  if (!child.isValid())
+    return QModelIndex();
+
+  const int parentNode = m_nodes[getNode(child)].parent;
+  if (parentNode <= 0)
+    return QModelIndex();
+
+  return createIndex(m_nodes[parentNode].row, 0, static_cast<quintptr>(parentNode));
+}
+
+int PackageFileModel::rowCount(const QModelIndex &parent) const
+{
+  if (parent.column() > 0) return 0;
+
+  return static_cast<int>(m_nodes[getNode(parent)].children.size());
+}
+
+int PackageFileModel::columnCount(const QModelIndex&) const
+{
+  return (m_pkgName.isEmpty() ? 0 : 1);
+}
+
+bool PackageFileModel::hasChildren(const QModelIndex &parent) const
+{
+  if (parent.column() > 0) return false;
+
+  return !m_nodes[getNode(parent)].children.empty();
+}
+
+QVariant PackageFileModel::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid())
+    return QVariant();
+
+  const int node = getNode(index);
+
+  switch (role) {
+  case Qt::DisplayRole:
+    return QVariant(m_nodes[node].name);
+  case Qt::DecorationRole:
+    return QVariant(isShownAsDirectory(node) ? m_iconFolder : m_iconBinary);
+  case Qt::AccessibleDescriptionRole:
+    return QVariant(QString((isShownAsDirectory(node) ? QLatin1String("directory ") : QLatin1String("file ")) + m_nodes[node].name));
+  default:
+    break;
+  }
+
+  return QVariant();
+}
+
+QVariant PackageFileModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (role == Qt::DisplayRole && orientation == Qt::Horizontal && section == 0 && !m_pkgName.isEmpty())
+    return QVariant(StrConstants::getContentsOf().arg(m_pkgName));
+
+  return QVariant();
+}
+
+void PackageFileModel::clear()
+{
+  beginResetModel();
+  m_nodes.clear();
+  m_nodes.emplace_back(QString(), -1, true);
+  m_pkgName.clear();
+  m_searchPaths.clear();
+  m_searchNodes.clear();
+  endResetModel();
+}
+
+/*
+ * Builds the trie out of the absolute paths returned by Package::getContents
+ *
+ * Consecutive paths share most of their directories, so each path is first matched against
+ * the directories of the previous one. Only when it leaves them the directory table is queried
+ */
+void PackageFileModel::setFileList(const QString &pkgName, const QStringList &fileList)
+{
+  beginResetModel();
+  m_nodes.clear();
+  m_nodes.emplace_back(QString(), -1, true);
+  m_nodes.reserve(fileList.size() + 1);
+  m_pkgName = pkgName;
+  m_searchPaths.clear();
+  m_searchNodes.clear();
+
+  QHash<QString, int> dirNodes;
+  std::vector<int> previousDirs;
+
+  for (const QString& file: fileList)
+  {
+    int start = file.startsWith(QLatin1Char('/')) ? 1 : 0;
+    int parentNode = 0;
+    size_t depth = 0;
+    bool samePrefix = true;
+
+    while (start < file.size())
+    {
+      const int slash = file.indexOf(QLatin1Char('/'), start);
+
+      if (slash == -1)
+      {
+        addChild(parentNode, file.mid(start), false);
+        break;
+      }
+
+      const QStringView component = QStringView(file).mid(start, slash - start);
+      int node;
+
+      if (samePrefix && depth < previousDirs.size() && QStringView(m_nodes[previousDirs[depth]].name) == component)
+      {
+        node = previousDirs[depth];
+      }
+      else
+      {
+        samePrefix = false;
+        previousDirs.resize(depth);
+
+        const QString key = file.left(slash + 1);
+        QHash<QString, int>::const_iterator it = dirNodes.constFind(key);
+
+        if (it != dirNodes.constEnd())
+        {
+          node = it.value();
+        }
+        else
+        {
+          node = addChild(parentNode, component.toString(), true);
+          dirNodes.insert(key, node);
+        }
+
+        previousDirs.push_back(node);
+      }
+
+      parentNode = node;
+      ++depth;
+      start = slash + 1;
+    }
+  }
+
+  m_nodes.shrink_to_fit();
+  endResetModel();
+}
+
+/*
+ * Number of files and directories in the tree
+ */
+int PackageFileModel::getNodeCount() const
+{
+  return static_cast<int>(m_nodes.size()) - 1;
+}
+
+/*
+ * True for directories and for symbolic links to directories
+ */
+bool PackageFileModel::isDirectory(const QModelIndex &index) const
+{
+  if (!index.isValid()) return false;
+
+  return isShownAsDirectory(getNode(index));
+}
+
+QString PackageFileModel::getFullPath(const QModelIndex &index) const
+{
+  if (!index.isValid()) return QString();
+
+  return getFullPath(getNode(index));
+}
+
+/*
+ * Returns the files and directories matched by searchText, in the order they are shown
+ *
+ * Like the package filter, searchText is turned into a case insensitive regex, which is compiled once and
+ * matched against the names, or against the full paths when it has a "/"
+ */
+QModelIndexList PackageFileModel::findFiles(const QString &searchText) const
+{
+  QModelIndexList res;
+  if (searchText.isEmpty() || m_nodes.size() <= 1) return res;
+
+  QRegularExpression regex(Package::parseSearchString(searchText), QRegularExpression::CaseInsensitiveOption);
+  if (!regex.isValid()) return res;
+  regex.optimize();
+
+  if (m_searchNodes.empty()) buildSearchList();
+
+  const bool matchFullPath = searchText.contains(QLatin1Char('/'));
+
+  for (size_t c=0; c<m_searchNodes.size(); ++c)
+  {
+    const int node = m_searchNodes[c];
+
+    if (regex.match(matchFullPath ? m_searchPaths.at(static_cast<int>(c)) : m_nodes[node].name).hasMatch())
+    {
+      res << createIndex(m_nodes[node].row, 0, static_cast<quintptr>(node));
+    }
+  }
+
+  return res;
+}
+
+int PackageFileModel::addChild(int parent, const QString &name, bool isDir)
+{
+  const int node = static_cast<int>(m_nodes.size());
+  m_nodes.emplace_back(name, parent, isDir);
+  m_nodes[parent].children.push_back(node);
+  m_nodes[parent].childrenSorted = false;
+
+  return node;
+}
+
+/*
+ * Children are sorted by name the first time a view asks for one of them
+ */
+const std::vector<int>& PackageFileModel::getSortedChildren(int node) const
+{
+  Node &n = m_nodes[node];
+
+  if (!n.childrenSorted)
+  {
+    std::sort(n.children.begin(), n.children.end(),
+              [this](int a, int b) { return m_nodes[a].name < m_nodes[b].name; });
+
+    for (size_t c=0; c<n.children.size(); ++c)
+    {
+      m_nodes[n.children[c]].row = static_cast<int>(c);
+    }
+
+    n.childrenSorted = true;
+  }
+
+  return n.children;
+}
+
+int PackageFileModel::getNode(const QModelIndex &index) const
+{
+  return (index.isValid() ? static_cast<int>(index.internalId()) : 0);
+}
+
+QString PackageFileModel::getFullPath(int node) const
+{
+  QStringList components;
+
+  for (int n=node; n>0; n=m_nodes[n].parent)
+  {
+    components.prepend(m_nodes[n].name);
+  }
+
+  return QLatin1Char('/') + components.join(QLatin1Char('/'));
+}
+
+/*
+ * Walks the whole trie once, sorting every directory on the way, so the rows of all nodes are known
+ */
+void PackageFileModel::buildSearchList() const
+{
+  m_searchPaths.clear();
+  m_searchNodes.clear();
+  m_searchPaths.reserve(static_cast<int>(m_nodes.size()) - 1);
+  m_searchNodes.reserve(m_nodes.size() - 1);
+
+  // (node, position of its next child) pairs, and the path of each directory in the stack
+  std::vector<std::pair<int, size_t> > stack;
+  QStringList dirPaths;
+  stack.emplace_back(0, 0);
+  dirPaths << QString();
+
+  while (!stack.empty())
+  {
+    const std::vector<int>& children = getSortedChildren(stack.back().first);
+
+    if (stack.back().second == children.size())
+    {
+      stack.pop_back();
+      dirPaths.removeLast();
+      continue;
+    }
+
+    const int child = children[stack.back().second++];
+    const QString path = dirPaths.last() + QLatin1Char('/') + m_nodes[child].name;
+
+    m_searchNodes.push_back(child);
+    m_searchPaths << path;
+
+    if (!m_nodes[child].children.empty())
+    {
+      stack.emplace_back(child, 0);
+      dirPaths << path;
+    }
+  }
+}
+
+/*
+ * A file gets the folder icon if it is a symbolic link to a directory. That is only known
+ * by looking at the file system, so it is tested once, when the row is first painted
+ */
+bool PackageFileModel::isShownAsDirectory(int node) const
+{
+  const Node &n = m_nodes[node];
+  if (n.isDir) return true;
+
+  if (n.symLinkToDir == -1)
+  {
+    QFileInfo fiTestForSymLink(getFullPath(node));
+    n.symLinkToDir = (fiTestForSymLink.isSymLink() && QFileInfo(fiTestForSymLink.symLinkTarget()).isDir()) ? 1 : 0;
+  }
+
+  return (n.symLinkToDir == 1);
+}
@@ -0,0 +1,98 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef OCTOPI_PACKAGEFILEMODEL_H
+#define OCTOPI_PACKAGEFILEMODEL_H
+
+#include <QAbstractItemModel>
+#include <QIcon>
+#include <QStringList>
+#include <vector>
+
+/*
+ * @brief The model of the file tree shown in the Files tab
+ *
+ * The file list of a package is kept as a path trie with one node per path component.
+ * Children of a directory are only sorted when the directory is first shown, and the
+ * symbolic link test of a file only runs when its row is painted.
+ *
+ * Searches run over a flat list of the full paths, in the order they are shown, which is
+ * built on the first search and maps each path back to its trie node.
+ */
+class PackageFileModel : public QAbstractItemModel
+{
+  Q_OBJECT
+
+public:
+  explicit PackageFileModel(QObject* parent = nullptr);
+
+  // QAbstractItemModel interface
+public:
+  virtual QModelIndex index(int row, int column, const QModelIndex& parent) const /*override*/;
+  virtual QModelIndex parent(const QModelIndex& child) const /*override*/;
+  virtual int rowCount(const QModelIndex& parent) const /*override*/;
+  virtual int columnCount(const QModelIndex& parent) const /*override*/;
+  virtual bool hasChildren(const QModelIndex& parent) const /*override*/;
+  virtual QVariant data(const QModelIndex& index, int role) const /*override*/;
+  virtual QVariant headerData(int section, Qt::Orientation orientation, int role) const /*override*/;
+
+  void clear();
+  void setFileList(const QString& pkgName, const QStringList& fileList);
+
+  // Getter
+public:
+  int getNodeCount() const;
+  bool isDirectory(const QModelIndex& index) const;
+  QString getFullPath(const QModelIndex& index) const;
+  QModelIndexList findFiles(const QString& searchText) const;
+
+private:
+  struct Node {
+    Node(const QString& n, int p, bool dir): name(n), parent(p), row(-1), isDir(dir),
+      symLinkToDir(-1), childrenSorted(true) {}
+
+    QString          name;
+    int              parent;
+    mutable int      row;            // position among the sorted children of parent
+    bool             isDir;
+    mutable qint8    symLinkToDir;   // -1 until tested
+    mutable bool     childrenSorted;
+    std::vector<int> children;
+  };
+
+  int addChild(int parent, const QString& name, bool isDir);
+  const std::vector<int>& getSortedChildren(int node) const;
+  int getNode(const QModelIndex& index) const;
+  QString getFullPath(int node) const;
+  bool isShownAsDirectory(int node) const;
+  void buildSearchList() const;
+
+  mutable std::vector<Node> m_nodes; // m_nodes[0] is the invisible root
+  QString m_pkgName;
+
+  // Full paths in display order, and the node of each of them
+  mutable QStringList      m_searchPaths;
+  mutable std::vector<int> m_searchNodes;
+
+  const QIcon m_iconFolder;
+  const QIcon m_iconBinary;
+};
+
+#endif // OCTOPI_PACKAGEFILEMODEL_H
@@ -20,9 +20,16 @@
 
 #include <iostream>
 #include <cassert>
+#include <algorithm>
 #include <QRegularExpression>
+#include <QtConcurrent/QtConcurrentFilter>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QCollator>
+#include <cmath>
+#include <memory>
 
 #include "packagemodel.h"
+#include "fuzzymatcher.h"
 #include "src/uihelper.h"
 #include "src/strconstants.h"
 
@@ -30,11 +37,21 @@
  * The specific model which abstracts the package list data seen in the main treeview
  */
 
+static const int ctn_FILTER_CANCEL_CHECK_INTERVAL = 1024; //packages scanned between two cancellation checks
+
+//Score boosts of the fuzzy search
+static const int ctn_FUZZY_BONUS_PREFIX = 64;
+static const int ctn_FUZZY_BONUS_INSTALLED = 16;
+static const int ctn_FUZZY_BONUS_POPULARITY = 32;
+
 PackageModel::PackageModel(const PackageRepository& repo, QObject *parent)
-: QAbstractItemModel(parent), m_installedPackagesCount(0), m_showColumnPopularity(false), m_packageRepo(repo),
+: QAbstractItemModel(parent), m_installedPackagesCount(0), m_showColumnPopularity(false),
+  m_parallelFilterThreshold(SettingsManager::getParallelFilterThreshold()), m_fuzzySearch(false), m_packageRepo(repo),
+  m_sortCacheGeneration(-1), m_displayStringsGeneration(-1),
   m_sortOrder(Qt::AscendingOrder), m_sortColumn(1), m_filterPackagesInstalled(false),
   m_filterPackagesNotInstalled(false), m_filterPackagesOutdated(false), m_filterPackagesNotInThisGroup(QLatin1String("")),
-  m_filterColumn(-1), m_filterRegExp(QLatin1String(""), QRegularExpression::CaseInsensitiveOption),
+  m_filterPackagesNotProvidingFile(false), m_filterColumn(-1), m_filterRegExp(QLatin1String(""), QRegularExpression::CaseInsensitiveOption),
+  m_filterDeferred(false),
   m_iconNotInstalled(IconHelper::getIconNonInstalled()), m_iconInstalled(IconHelper::getIconInstalled()),
   m_iconInstalledUnrequired(IconHelper::getIconUnrequired()),
   m_iconNewer(IconHelper::getIconNewer()), m_iconOutdated(IconHelper::getIconOutdated()),
@@ -43,6 +60,14 @@ PackageModel::PackageModel(const PackageRepository& repo, QObject *parent)
   m_iconError(IconHelper::getIconWindowClose())
 {
   m_showColumnPopularity = false;
+
+  connect(&m_filterWatcher, SIGNAL(finished()), this, SLOT(onFilterFinished()));
+}
+
+PackageModel::~PackageModel()
+{
+  cancelFilter();
+  m_filterWatcher.waitForFinished();
 }
 
 QModelIndex PackageModel::index(int row, int column, const QModelIndex &parent) const
@@ -105,32 +130,14 @@ QVariant PackageModel::data(const QModelIndex &index, int role) const
             return QVariant(package->version);
           case ctn_PACKAGE_REPOSITORY_COLUMN:
             return QVariant(package->repository);          
-          case ctn_PACKAGE_SIZE_COLUMN: {
-            off_t pkgSize = package->downloadSize;
-            float aux = pkgSize;
-            return QVariant(Package::kbytesToSize(aux));
-          }
-          case ctn_PACKAGE_ISIZE_COLUMN: {
-            off_t pkgISize = package->installedSize;
-            float auxI = pkgISize;
-            return QVariant(Package::kbytesToSize(auxI));
-          }
-          case ctn_PACKAGE_BDATE_COLUMN: {
-            off_t pkgBDate = package->buildDate;
-            if (pkgBDate <= 0) return QVariant(QStringLiteral(""));
-
-            QString dateTimeFormat = QLocale().dateTimeFormat(QLocale::ShortFormat);
-            QDateTime bdt = QDateTime::fromSecsSinceEpoch(pkgBDate);
-            return QVariant(bdt.toString(dateTimeFormat));
-          }
-          case ctn_PACKAGE_IDATE_COLUMN: {
-            off_t pkgIDate = package->installDate;
-            if (pkgIDate <= 0) return QVariant(QStringLiteral(""));
-
-            QString dateTimeFormat = QLocale().dateTimeFormat(QLocale::ShortFormat);
-            QDateTime idt = QDateTime::fromSecsSinceEpoch(pkgIDate);
-            return QVariant(idt.toString(dateTimeFormat));
-          }
+          case ctn_PACKAGE_SIZE_COLUMN:
+            return QVariant(getDisplayStrings(*package).downloadSize);
+          case ctn_PACKAGE_ISIZE_COLUMN:
+            return QVariant(getDisplayStrings(*package).installedSize);
+          case ctn_PACKAGE_BDATE_COLUMN:
+            return QVariant(getDisplayStrings(*package).buildDate);
+          case ctn_PACKAGE_IDATE_COLUMN:
+            return QVariant(getDisplayStrings(*package).installDate);
           case ctn_PACKAGE_LICENSES_COLUMN: {
             return QVariant(package->license);
           }
@@ -209,6 +216,10 @@ void PackageModel::sort(int column, Qt::SortOrder order)
   {
     m_sortColumn = column;
     m_sortOrder  = order;
+
+    //The reset which ends a batched load sorts by the new column
+    if (m_packageRepo.isLoading()) return;
+
     emit layoutAboutToBeChanged();
     sort();
     emit layoutChanged();
@@ -227,6 +238,10 @@ void PackageModel::clear()
 
 void PackageModel::beginResetRepository()
 {
+  //A pending asynchronous filter still points to the packages which are about to change
+  cancelFilter();
+  m_filterWatcher.waitForFinished();
+
   beginResetModel();
   m_listOfPackages.clear();
   qDeleteAll(m_listOfPackages.begin(), m_listOfPackages.end());
@@ -236,64 +251,170 @@ void PackageModel::beginResetRepository()
 
 void PackageModel::endResetRepository()
 {
-  m_installedPackagesCount = 0;
-  const QList<PackageRepository::PackageData*>& data = m_packageRepo.getPackageList(m_filterPackagesNotInThisGroup);
-  m_listOfPackages.reserve(data.size());
-
-  for (QList<PackageRepository::PackageData*>::const_iterator it = data.begin(); it != data.end(); ++it)
+  //During a batched load the repository is shown as it is merged, unfiltered and sorted by name.
+  //Filters and sorting need positions and bitsets, which are only built by PackageRepository::endData()
+  if (m_packageRepo.isLoading())
   {
-    if (m_filterPackagesNotInstalled && (*it)->installed()) continue;
-    else if (m_filterPackagesInstalled && !(*it)->installed()) continue;
-
-    if (m_filterPackagesOutdated && !(*it)->outdated()) continue;
-
-    if (!m_filterPackagesNotInThisRepo.isEmpty() && (*it)->repository != m_filterPackagesNotInThisRepo) continue;
+    m_listOfPackages = m_packageRepo.getPackageList();
+    m_columnSortedlistOfPackages = m_listOfPackages;
 
-    if (m_filterRegExp.pattern().isEmpty()) {
-      m_listOfPackages.push_back(*it);
+    m_installedPackagesCount = 0;
+    for (QList<PackageRepository::PackageData*>::const_iterator it = m_listOfPackages.constBegin(); it != m_listOfPackages.constEnd(); ++it)
+    {
       if ((*it)->installed()) m_installedPackagesCount++;
     }
-    else {
-      QRegularExpressionMatch match;
 
-      switch (m_filterColumn) {
-      case ctn_PACKAGE_NAME_COLUMN:
-        match = m_filterRegExp.match((*it)->name);
-        if (match.hasMatch()) //m_filterRegExp.indexIn((*it)->name) != -1)
-        {
-          m_listOfPackages.push_back(*it);
-          if ((*it)->installed()) m_installedPackagesCount++;
-        }
-        break;
-      case ctn_PACKAGE_DESCRIPTION_FILTER_NO_COLUMN:
-        match = m_filterRegExp.match((*it)->description);
-        if (match.hasMatch()) //(m_filterRegExp.indexIn((*it)->description) != -1)
-        {
-          m_listOfPackages.push_back(*it);
-          if ((*it)->installed()) m_installedPackagesCount++;
-        }
-        break;
-      case ctn_PACKAGE_INSTALL_REASON_COLUMN:
-        match = m_filterRegExp.match((*it)->installReason);
-        if (match.hasMatch()) //(m_filterRegExp.indexIn((*it)->installReason) != -1)
-        {
-          m_listOfPackages.push_back(*it);
-          m_installedPackagesCount++;
-        }
-        break;
-      default:
-        m_listOfPackages.push_back(*it);
-        if ((*it)->installed()) m_installedPackagesCount++;
-      }
-    }
+    endResetModel();
+    return;
+  }
+
+  m_listOfPackages = filterPackages(m_filterGeneration.loadAcquire());
+  finishReset();
+
+  //The filter typed while the packages were loading has just been applied
+  if (m_filterDeferred)
+  {
+    m_filterDeferred = false;
+    QMetaObject::invokeMethod(this, "filterApplied", Qt::QueuedConnection);
+  }
+}
+
+/*
+ * Counts and sorts the packages that passed the filter and ends the model reset
+ */
+void PackageModel::finishReset()
+{
+  m_installedPackagesCount = 0;
+  const bool countAllAsInstalled = (m_filterColumn == ctn_PACKAGE_INSTALL_REASON_COLUMN && !m_filterRegExp.pattern().isEmpty());
+  for (QList<PackageRepository::PackageData*>::const_iterator it = m_listOfPackages.constBegin(); it != m_listOfPackages.constEnd(); ++it)
+  {
+    if (countAllAsInstalled || (*it)->installed()) m_installedPackagesCount++;
   }
 
-  m_columnSortedlistOfPackages.reserve(data.size());
   m_columnSortedlistOfPackages = m_listOfPackages;
   sort();
   endResetModel();
 }
 
+/*
+ * Returns the packages accepted by the current filter, in the order they must be shown
+ *
+ * This runs in worker threads too: it only reads the model state, and gives up returning an
+ * empty list as soon as generation is no longer the current filter generation
+ */
+QList<PackageRepository::PackageData*> PackageModel::filterPackages(int generation) const
+{
+  QList<PackageRepository::PackageData*> result;
+  const QList<PackageRepository::PackageData*>& allPackages = m_packageRepo.getPackageList();
+
+  //View options are resolved with the repository's precomputed sets, so the text filter only sees their survivors
+  PackageBitset viewMask;
+  buildViewMask(viewMask);
+
+  QList<PackageRepository::PackageData*> survivors;
+  survivors.reserve(viewMask.count());
+  for (int pos = viewMask.nextSetBit(0); pos != -1; pos = viewMask.nextSetBit(pos + 1))
+  {
+    survivors.push_back(allPackages.at(pos));
+  }
+
+  if (isFuzzyFilterActive())
+  {
+    rankPackages(survivors, result, generation);
+    return result;
+  }
+
+  if (m_filterRegExp.pattern().isEmpty()) return survivors;
+
+  const QList<PackageRepository::PackageData*>* candidates = &survivors;
+
+  //A structured query replaces the regex
+  std::unique_ptr<PackageQuery> query;
+  if (PackageQuery::isQuery(m_filterRegExp.pattern()))
+    query.reset(new PackageQuery(m_filterRegExp.pattern(), getQueryTextField()));
+
+  //A plain text description search only needs to verify the packages found by the trigram index
+  QList<PackageRepository::PackageData*> indexedCandidates;
+  QString literal;
+  if (!query && m_filterColumn == ctn_PACKAGE_DESCRIPTION_FILTER_NO_COLUMN &&
+      TrigramIndex::extractLiteral(m_filterRegExp.pattern(), literal) &&
+      m_packageRepo.getDescriptionCandidates(literal, indexedCandidates))
+  {
+    QList<PackageRepository::PackageData*>::iterator last = std::remove_if(indexedCandidates.begin(), indexedCandidates.end(),
+      [&viewMask](const PackageRepository::PackageData* package) { return !viewMask.test(package->position); });
+    indexedCandidates.erase(last, indexedCandidates.end());
+    candidates = &indexedCandidates;
+  }
+
+  if (candidates->size() > m_parallelFilterThreshold)
+  {
+    //Regex matching is the expensive part, so we split it among the global thread pool.
+    //blockingFiltered uses an ordered reduce, so the result keeps the repository order.
+    const PackageQuery* q = query.get();
+    result = QtConcurrent::blockingFiltered(*candidates, [this, generation, q](const PackageRepository::PackageData* package) {
+      return !isFilterStale(generation) && matchesTextFilter(package, q);
+    });
+  }
+  else
+  {
+    result.reserve(candidates->size());
+
+    int count = 0;
+    for (QList<PackageRepository::PackageData*>::const_iterator it = candidates->begin(); it != candidates->end(); ++it, ++count)
+    {
+      if ((count % ctn_FILTER_CANCEL_CHECK_INTERVAL) == 0 && isFilterStale(generation)) break;
+      if (matchesTextFilter(*it, query.get())) result.push_back(*it);
+    }
+  }
+
+  if (isFilterStale(generation)) result.clear();
+  return result;
+}
+
+bool PackageModel::isFilterStale(int generation) const
+{
+  return generation != m_filterGeneration.loadAcquire();
+}
+
+/*
+ * Mirrors the packages the repository merged in during a batched load, as new rows in their sorted position
+ *
+ * This only happens while the model shows the whole repository sorted by name. Otherwise the
+ * rows wait for the reset sent at the end of the load
+ */
+void PackageModel::packagesInserted(const PackageRepository::TListOfInsertions& insertions)
+{
+  if (isFiltered() || !m_filterRegExp.pattern().isEmpty() || m_sortColumn != ctn_PACKAGE_NAME_COLUMN ||
+      m_listOfPackages.size() + static_cast<int>(insertions.size()) != m_packageRepo.getPackageList().size())
+    return;
+
+  PackageRepository::TListOfInsertions::const_iterator it = insertions.begin();
+  while (it != insertions.end())
+  {
+    //Packages landing side by side are inserted as one run of rows
+    PackageRepository::TListOfInsertions::const_iterator runEnd = it + 1;
+    while (runEnd != insertions.end() && runEnd->first == (runEnd - 1)->first + 1) ++runEnd;
+
+    const int first = it->first;
+    const int count = static_cast<int>(runEnd - it);
+    const int size = m_listOfPackages.size();
+
+    if (m_sortOrder == Qt::AscendingOrder)
+      beginInsertRows(QModelIndex(), first, first + count - 1);
+    else
+      beginInsertRows(QModelIndex(), size - first, size - first + count - 1);
+
+    for (; it != runEnd; ++it)
+    {
+      m_listOfPackages.insert(it->first, it->second);
+      m_columnSortedlistOfPackages.insert(it->first, it->second);
+      if (it->second->installed()) m_installedPackagesCount++;
+    }
+
+    endInsertRows();
+  }
+}
+
 int PackageModel::getPackageCount() const
 {
   return m_listOfPackages.size();
@@ -309,7 +430,8 @@ bool PackageModel::isFiltered() const
   return (m_filterPackagesInstalled ||
           m_filterPackagesNotInstalled ||
           !m_filterPackagesNotInThisGroup.isEmpty() ||
-          !m_filterPackagesNotInThisRepo.isEmpty());
+          !m_filterPackagesNotInThisRepo.isEmpty() ||
+          m_filterPackagesNotProvidingFile);
 }
 
 const PackageRepository::PackageData* PackageModel::getData(const QModelIndex& index) const
@@ -319,6 +441,10 @@ const PackageRepository::PackageData* PackageModel::getData(const QModelIndex& i
     case Qt::AscendingOrder:
       return m_columnSortedlistOfPackages.at(index.row());
     case Qt::DescendingOrder:
+      //The fuzzy filter puts its ranking in the name column, and the worst matches never come first
+      if (m_sortColumn == ctn_PACKAGE_NAME_COLUMN && isFuzzyFilterActive())
+        return m_columnSortedlistOfPackages.at(index.row());
+
       return m_columnSortedlistOfPackages.at(m_listOfPackages.size() - index.row() - 1);
     }
   }
@@ -366,9 +492,101 @@ void PackageModel::applyFilter(const int filterColumn, const QString& filterExp)
   beginResetRepository();
   m_filterColumn = filterColumn;
   m_filterRegExp.setPattern(filterExp);
+  m_filterRegExp.optimize();
+  endResetRepository();
+}
+
+/*
+ * Filters the packages by filterExp in the global thread pool, keeping the current list on screen meanwhile
+ *
+ * Any previous pending filter is cancelled. The new list replaces the current one only if no other
+ * filter or repository change happened in the meantime, and then filterApplied() is emitted
+ */
+void PackageModel::applyFilterAsync(const QString& filterExp)
+{
+  assert(filterExp.isNull() == false);
+
+  cancelFilter();
+  m_filterWatcher.waitForFinished();
+
+  m_filterRegExp.setPattern(filterExp);
+  m_filterRegExp.optimize();
+
+  //The worker would read the package list while the load swaps it, so the filter waits for endData()
+  if (m_packageRepo.isLoading())
+  {
+    m_filterDeferred = true;
+    return;
+  }
+
+  const int generation = m_filterGeneration.loadAcquire();
+
+  m_filterWatcher.setFuture(QtConcurrent::run([this, generation]() {
+    FilterResult res;
+    res.generation = generation;
+    res.packages = filterPackages(generation);
+    return res;
+  }));
+}
+
+/*
+ * Shows only the packages found by a "By file (remote)" search, given as "repository/name"
+ *
+ * The text typed by the user is a file path here, so the text filter is cleared
+ */
+void PackageModel::applyFileProvidersFilter(const QSet<QString>& providers)
+{
+  beginResetRepository();
+  m_filterPackagesNotProvidingFile = true;
+  m_fileProviders = providers;
+  m_filterRegExp.setPattern(QLatin1String(""));
+  endResetRepository();
+}
+
+void PackageModel::clearFileProvidersFilter()
+{
+  if (!m_filterPackagesNotProvidingFile) return;
+
+  beginResetRepository();
+  m_filterPackagesNotProvidingFile = false;
+  m_fileProviders.clear();
   endResetRepository();
 }
 
+/*
+ * Makes any running asynchronous filter give up as soon as possible, without waiting for it
+ */
+void PackageModel::cancelFilter()
+{
+  m_filterGeneration.fetchAndAddOrdered(1);
+}
+
+/*
+ * Swaps in the result of applyFilterAsync, unless it has been superseded
+ */
+void PackageModel::onFilterFinished()
+{
+  const FilterResult res = m_filterWatcher.result();
+  if (isFilterStale(res.generation)) return;
+
+  beginResetModel();
+  m_listOfPackages = res.packages;
+  finishReset();
+
+  emit filterApplied();
+}
+
+/*
+ * Toggles the fuzzy search mode. The filter is reapplied by the next applyFilter call
+ */
+void PackageModel::setFuzzySearch(bool value)
+{
+  cancelFilter();
+  m_filterWatcher.waitForFinished();
+
+  m_fuzzySearch = value;
+}
+
 /*
  * Toggles the view of column popularity, which shows number of votes for AUR pkgs
  */
@@ -431,12 +649,212 @@ const QIcon& PackageModel::getIconFor(const PackageRepository::PackageData& pack
   }
 }
 
+/*
+ * Returns the formatted sizes and dates of the package, building them on the first paint of its row
+ *
+ * The cache is dropped whenever the repository generation or the default locale changes
+ */
+const PackageModel::DisplayStrings& PackageModel::getDisplayStrings(const PackageRepository::PackageData& package) const
+{
+  if (m_displayStringsGeneration != m_packageRepo.getGeneration() || m_displayLocale != QLocale())
+  {
+    m_displayStrings.clear();
+    m_displayStrings.resize(m_packageRepo.getPackageList().size());
+    m_displayStringsGeneration = m_packageRepo.getGeneration();
+    m_displayLocale = QLocale();
+    m_dateTimeFormat = m_displayLocale.dateTimeFormat(QLocale::ShortFormat);
+  }
+
+  //Packages streamed in during a batched load have no position until the load ends
+  if (package.position < 0)
+  {
+    m_unindexedStrings.valid = false;
+    fillDisplayStrings(package, m_unindexedStrings);
+    return m_unindexedStrings;
+  }
+
+  if (package.position >= static_cast<int>(m_displayStrings.size()))
+    m_displayStrings.resize(package.position + 1);
+
+  DisplayStrings& strings = m_displayStrings[package.position];
+  fillDisplayStrings(package, strings);
+
+  return strings;
+}
+
+void PackageModel::fillDisplayStrings(const PackageRepository::PackageData& package, DisplayStrings& strings) const
+{
+  if (!strings.valid)
+  {
+    strings.downloadSize = Package::kbytesToSize(static_cast<float>(package.downloadSize));
+    strings.installedSize = Package::kbytesToSize(static_cast<float>(package.installedSize));
+
+    if (package.buildDate > 0)
+      strings.buildDate = QDateTime::fromSecsSinceEpoch(static_cast<qint64>(package.buildDate)).toString(m_dateTimeFormat);
+    if (package.installDate > 0)
+      strings.installDate = QDateTime::fromSecsSinceEpoch(static_cast<qint64>(package.installDate)).toString(m_dateTimeFormat);
+
+    strings.valid = true;
+  }
+}
+
+/*
+ * Fills mask with the positions of the packages which match the View menu options (status, repository and group)
+ */
+void PackageModel::buildViewMask(PackageBitset& mask) const
+{
+  mask.fill(m_packageRepo.getPackageList().size(), true);
+
+  if (m_filterPackagesNotInstalled) mask.andWith(m_packageRepo.getNonInstalledBits());
+  else if (m_filterPackagesInstalled) mask.andWith(m_packageRepo.getInstalledBits());
+
+  if (m_filterPackagesOutdated) mask.andWith(m_packageRepo.getOutdatedBits());
+
+  if (!m_filterPackagesNotInThisRepo.isEmpty())
+  {
+    const PackageBitset* repoBits = m_packageRepo.getRepositoryBits(m_filterPackagesNotInThisRepo);
+    if (repoBits != nullptr) mask.andWith(*repoBits);
+    else mask.fill(mask.size(), false);
+  }
+
+  if (!m_filterPackagesNotInThisGroup.isEmpty())
+  {
+    const PackageBitset* groupBits = m_packageRepo.getGroupBits(m_filterPackagesNotInThisGroup);
+    if (groupBits != nullptr) mask.andWith(*groupBits);
+  }
+
+  if (m_filterPackagesNotProvidingFile)
+  {
+    const QList<PackageRepository::PackageData*>& packages = m_packageRepo.getPackageList();
+    PackageBitset providerBits;
+    providerBits.fill(mask.size(), false);
+
+    for (int pos = mask.nextSetBit(0); pos != -1; pos = mask.nextSetBit(pos+1))
+    {
+      const PackageRepository::PackageData* package = packages.at(pos);
+      if (m_fileProviders.contains(package->repository + QLatin1Char('/') + package->name)) providerBits.set(pos);
+    }
+
+    mask.andWith(providerBits);
+  }
+}
+
+/*
+ * Returns true if the given package passes the text filter: query, when given, or the regex otherwise
+ *
+ * It must stay free of side effects, as it can be called from the thread pool
+ */
+bool PackageModel::matchesTextFilter(const PackageRepository::PackageData* package, const PackageQuery* query) const
+{
+  if (query != nullptr) return query->matches(package);
+  if (m_filterRegExp.pattern().isEmpty()) return true;
+
+  switch (m_filterColumn) {
+  case ctn_PACKAGE_NAME_COLUMN:
+    return m_filterRegExp.match(package->name).hasMatch();
+  case ctn_PACKAGE_DESCRIPTION_FILTER_NO_COLUMN:
+    return m_filterRegExp.match(package->description).hasMatch();
+  case ctn_PACKAGE_INSTALL_REASON_COLUMN:
+    return m_filterRegExp.match(package->installReason).hasMatch();
+  default:
+    return true;
+  }
+}
+
+/*
+ * In fuzzy mode the filter text is not a regex, but a subsequence searched in package names
+ * Structured queries are never fuzzy
+ */
+bool PackageModel::isFuzzyFilterActive() const
+{
+  return m_fuzzySearch && !m_filterRegExp.pattern().isEmpty() &&
+      (m_filterColumn == ctn_PACKAGE_NAME_COLUMN || m_filterColumn == ctn_PACKAGE_DESCRIPTION_FILTER_NO_COLUMN) &&
+      !PackageQuery::isQuery(m_filterRegExp.pattern());
+}
+
+/*
+ * The package field searched by the plain words of a structured query, after the filter combo
+ */
+QueryTextField PackageModel::getQueryTextField() const
+{
+  switch (m_filterColumn) {
+  case ctn_PACKAGE_DESCRIPTION_FILTER_NO_COLUMN:
+    return ectn_QUERY_DESCRIPTION;
+  case ctn_PACKAGE_INSTALL_REASON_COLUMN:
+    return ectn_QUERY_INSTALL_REASON;
+  default:
+    return ectn_QUERY_NAME;
+  }
+}
+
+/*
+ * Ranks a package against the fuzzy filter. Zero means the package does not match at all
+ */
+int PackageModel::fuzzyScore(const FuzzyMatcher& matcher, const PackageRepository::PackageData* package) const
+{
+  const int nameScore = matcher.scoreSubsequence(package->name);
+  const int descriptionScore = matcher.scoreSubstring(package->description);
+  if (nameScore == 0 && descriptionScore == 0) return 0;
+
+  int score = nameScore + descriptionScore / 2;
+
+  if (matcher.isPrefixOf(package->name))
+  {
+    score += ctn_FUZZY_BONUS_PREFIX;
+    if (package->name.size() == matcher.pattern().size()) score += ctn_FUZZY_BONUS_PREFIX;
+  }
+
+  if (package->installed()) score += ctn_FUZZY_BONUS_INSTALLED;
+
+  if (package->popularity > 0)
+    score += qMin(ctn_FUZZY_BONUS_POPULARITY, static_cast<int>(4 * std::log2(1.0 + package->popularity)));
+
+  return score;
+}
+
+/*
+ * Fills the package list with every candidate matching the fuzzy filter, best scores first.
+ * Packages with the same score keep the repository (name) order
+ */
+void PackageModel::rankPackages(const QList<PackageRepository::PackageData*>& candidates,
+                                QList<PackageRepository::PackageData*>& result, int generation) const
+{
+  const FuzzyMatcher matcher(m_filterRegExp.pattern());
+  std::vector<std::pair<int, PackageRepository::PackageData*> > ranked;
+  ranked.reserve(candidates.size());
+
+  int count = 0;
+  for (QList<PackageRepository::PackageData*>::const_iterator it = candidates.begin(); it != candidates.end(); ++it, ++count)
+  {
+    if ((count % ctn_FILTER_CANCEL_CHECK_INTERVAL) == 0 && isFilterStale(generation)) return;
+
+    const int score = fuzzyScore(matcher, *it);
+    if (score > 0) ranked.push_back(std::make_pair(score, *it));
+  }
+
+  std::stable_sort(ranked.begin(), ranked.end(),
+                   [](const std::pair<int, PackageRepository::PackageData*>& a,
+                      const std::pair<int, PackageRepository::PackageData*>& b) { return a.first > b.first; });
+
+  result.reserve(static_cast<int>(ranked.size()));
+  for (std::vector<std::pair<int, PackageRepository::PackageData*> >::const_iterator it = ranked.begin(); it != ranked.end(); ++it)
+  {
+    result.push_back(it->second);
+  }
+}
+
+/*
+ * Status order. Names are compared through collation keys built once per repository load
+ */
 struct TSort0 {
+  TSort0(const QString& foreignRepositoryName, const std::vector<QCollatorSortKey>& nameKeys)
+    : m_foreignRepositoryName(foreignRepositoryName), m_nameKeys(nameKeys) {}
+
   bool operator()(const PackageRepository::PackageData* a, const PackageRepository::PackageData* b) const {
     if (a->status < b->status) return true;
     if (a->status == b->status)
     {
-      if (a->repository == b->repository && (a->repository == StrConstants::getForeignRepositoryName()))
+      if (a->repository == b->repository && (a->repository == m_foreignRepositoryName))
       {
         return (a->name < b->name);
       }
@@ -450,17 +868,25 @@ struct TSort0 {
 
       if (a->required == b->required)
       {
-        int cmp = QString::localeAwareCompare(a->name, b->name);
+        int cmp = m_nameKeys[a->position].compare(m_nameKeys[b->position]);
         if (cmp < 0) return true;
       }    
     }
     return false;
   }
+
+  const QString& m_foreignRepositoryName;
+  const std::vector<QCollatorSortKey>& m_nameKeys;
 };
 
+/*
+ * Version order. Versions are converted to latin1 once per repository load
+ */
 struct TSort2 {
+  explicit TSort2(const std::vector<QByteArray>& versionKeys): m_versionKeys(versionKeys) {}
+
   bool operator()(const PackageRepository::PackageData* a, const PackageRepository::PackageData* b) const {
-    const int cmp = Package::alpm_pkg_vercmp(a->version.toLatin1().data(), b->version.toLatin1().data());
+    const int cmp = Package::alpm_pkg_vercmp(m_versionKeys[a->position].constData(), m_versionKeys[b->position].constData());
 
     if (cmp < 0) return true;
     if (cmp == 0)
@@ -470,6 +896,8 @@ struct TSort2 {
 
     return false;
   }
+
+  const std::vector<QByteArray>& m_versionKeys;
 };
 
 struct TSort3 {
@@ -555,43 +983,110 @@ struct TSort10 {
   }
 };
 
-void PackageModel::sort()
+/*
+ * Returns all the repository packages sorted by the given column, or nullptr if the column is not sortable
+ *
+ * Each permutation is built once per repository generation, descending order is just read backwards
+ */
+const QList<PackageRepository::PackageData*>* PackageModel::getSortPermutation(int column)
 {
-  switch (m_sortColumn) {
-  case ctn_PACKAGE_NAME_COLUMN:
-    m_columnSortedlistOfPackages = m_listOfPackages;
-    return;
-  case ctn_PACKAGE_ICON_COLUMN:
-    std::sort(m_columnSortedlistOfPackages.begin(), m_columnSortedlistOfPackages.end(), TSort0());
-    return;
-  case ctn_PACKAGE_VERSION_COLUMN:
-    std::sort(m_columnSortedlistOfPackages.begin(), m_columnSortedlistOfPackages.end(), TSort2());
-    return;
+  if (m_sortCacheGeneration != m_packageRepo.getGeneration())
+  {
+    m_sortPermutations.clear();
+    m_sortCacheGeneration = m_packageRepo.getGeneration();
+  }
+
+  QHash<int, QList<PackageRepository::PackageData*> >::const_iterator cached = m_sortPermutations.constFind(column);
+  if (cached != m_sortPermutations.constEnd()) return &cached.value();
+
+  QList<PackageRepository::PackageData*> permutation = m_packageRepo.getPackageList();
+
+  switch (column) {
+  case ctn_PACKAGE_ICON_COLUMN: {
+    const QCollator collator;
+    std::vector<QCollatorSortKey> nameKeys;
+    nameKeys.reserve(permutation.size());
+    for (QList<PackageRepository::PackageData*>::const_iterator it = permutation.constBegin(); it != permutation.constEnd(); ++it)
+    {
+      nameKeys.push_back(collator.sortKey((*it)->name));
+    }
+
+    std::sort(permutation.begin(), permutation.end(), TSort0(StrConstants::getForeignRepositoryName(), nameKeys));
+    break;
+  }
+  case ctn_PACKAGE_VERSION_COLUMN: {
+    std::vector<QByteArray> versionKeys;
+    versionKeys.reserve(permutation.size());
+    for (QList<PackageRepository::PackageData*>::const_iterator it = permutation.constBegin(); it != permutation.constEnd(); ++it)
+    {
+      versionKeys.push_back((*it)->version.toLatin1());
+    }
+
+    std::sort(permutation.begin(), permutation.end(), TSort2(versionKeys));
+    break;
+  }
   case ctn_PACKAGE_REPOSITORY_COLUMN:
-    std::sort(m_columnSortedlistOfPackages.begin(), m_columnSortedlistOfPackages.end(), TSort3());
-    return;
+    std::sort(permutation.begin(), permutation.end(), TSort3());
+    break;
   case ctn_PACKAGE_POPULARITY_COLUMN:
-    std::sort(m_columnSortedlistOfPackages.begin(), m_columnSortedlistOfPackages.end(), TSort4());
-    return;
+    std::sort(permutation.begin(), permutation.end(), TSort4());
+    break;
   case ctn_PACKAGE_SIZE_COLUMN:
-    std::sort(m_columnSortedlistOfPackages.begin(), m_columnSortedlistOfPackages.end(), TSort5());
-    return;
+    std::sort(permutation.begin(), permutation.end(), TSort5());
+    break;
   case ctn_PACKAGE_ISIZE_COLUMN:
-    std::sort(m_columnSortedlistOfPackages.begin(), m_columnSortedlistOfPackages.end(), TSort6());
-    return;
+    std::sort(permutation.begin(), permutation.end(), TSort6());
+    break;
   case ctn_PACKAGE_BDATE_COLUMN:
-    std::sort(m_columnSortedlistOfPackages.begin(), m_columnSortedlistOfPackages.end(), TSort7());
-    return;
+    std::sort(permutation.begin(), permutation.end(), TSort7());
+    break;
   case ctn_PACKAGE_IDATE_COLUMN:
-    std::sort(m_columnSortedlistOfPackages.begin(), m_columnSortedlistOfPackages.end(), TSort8());
-    return;
+    std::sort(permutation.begin(), permutation.end(), TSort8());
+    break;
   case ctn_PACKAGE_LICENSES_COLUMN:
-    std::sort(m_columnSortedlistOfPackages.begin(), m_columnSortedlistOfPackages.end(), TSort9());
-    return;
+    std::sort(permutation.begin(), permutation.end(), TSort9());
+    break;
   case ctn_PACKAGE_INSTALL_REASON_COLUMN:
-    std::sort(m_columnSortedlistOfPackages.begin(), m_columnSortedlistOfPackages.end(), TSort10());
-    return;
+    std::sort(permutation.begin(), permutation.end(), TSort10());
+    break;
   default:
+    return nullptr;
+  }
+
+  return &m_sortPermutations.insert(column, permutation).value();
+}
+
+/*
+ * Sorts the filtered package list by picking its members from the cached permutation of the sort column
+ */
+void PackageModel::sort()
+{
+  if (m_sortColumn == ctn_PACKAGE_NAME_COLUMN) // or by rank, when the fuzzy filter is active
+  {
+    m_columnSortedlistOfPackages = m_listOfPackages;
+    return;
+  }
+
+  const QList<PackageRepository::PackageData*>*const permutation = getSortPermutation(m_sortColumn);
+  if (permutation == nullptr) return;
+
+  //The filtered list is a subset of the repository list, so the same size means the same packages
+  if (m_listOfPackages.size() == permutation->size())
+  {
+    m_columnSortedlistOfPackages = *permutation;
     return;
   }
+
+  std::vector<bool> selected(permutation->size(), false);
+  for (QList<PackageRepository::PackageData*>::const_iterator it = m_listOfPackages.constBegin(); it != m_listOfPackages.constEnd(); ++it)
+  {
+    if ((*it)->position >= 0 && (*it)->position < permutation->size()) selected[(*it)->position] = true;
+  }
+
+  m_columnSortedlistOfPackages.clear();
+  m_columnSortedlistOfPackages.reserve(m_listOfPackages.size());
+  for (QList<PackageRepository::PackageData*>::const_iterator it = permutation->constBegin(); it != permutation->constEnd(); ++it)
+  {
+    if (selected[(*it)->position]) m_columnSortedlistOfPackages.push_back(*it);
+  }
 }
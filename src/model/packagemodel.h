@@ -22,16 +22,26 @@
 #define OCTOPI_PACKAGEMODEL_H
 
 #include <QAbstractItemModel>
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QHash>
 #include <QIcon>
+#include <QLocale>
 #include <QRegularExpression>
+#include <QSet>
 
 //#include "src/package.h"
 #include "src/packagerepository.h"
+#include "packagequery.h"
+
+class FuzzyMatcher;
 
 class PackageModel : public QAbstractItemModel, public PackageRepository::IDependency
 {
   Q_OBJECT
 
+  friend class TestPackageModel;
+
 public:
   // Column indices for Package's treeview
   static const int ctn_PACKAGE_ICON_COLUMN                  = 0;
@@ -50,11 +60,16 @@ public:
 
 public:
   explicit PackageModel(const PackageRepository& repo, QObject* parent = nullptr);
+  virtual ~PackageModel();
 
 signals:
+  void filterApplied();
 
 public slots:
 
+private slots:
+  void onFilterFinished();
+
   // QAbstractItemModel interface
 public:
   virtual QModelIndex index(int row, int column, const QModelIndex& parent) const /*override*/;
@@ -71,6 +86,7 @@ public:
 public:
   virtual void beginResetRepository() /*override*/;
   virtual void endResetRepository()   /*override*/;
+  virtual void packagesInserted(const PackageRepository::TListOfInsertions& insertions) /*override*/;
 
   // Getter
 public:
@@ -87,21 +103,71 @@ public:
   void applyFilter(const int filterColumn);
   void applyFilter(const QString& filterExp);
   void applyFilter(const int filterColumn, const QString& filterExp);
+  void applyFilterAsync(const QString& filterExp);
+  void applyFileProvidersFilter(const QSet<QString>& providers);
+  void clearFileProvidersFilter();
+  void cancelFilter();
 
   void setShowColumnPopularity(bool value);
+  void setFuzzySearch(bool value);
 
 private:
+  // Formatted column texts of one package, built on demand
+  struct DisplayStrings {
+    DisplayStrings(): valid(false) {}
+
+    bool    valid;
+    QString downloadSize;
+    QString installedSize;
+    QString buildDate;
+    QString installDate;
+  };
+
+  // Outcome of an asynchronous filter pass
+  struct FilterResult {
+    FilterResult(): generation(-1) {}
+
+    int generation;
+    QList<PackageRepository::PackageData*> packages;
+  };
+
   const QIcon& getIconFor(const PackageRepository::PackageData& package) const;
+  const DisplayStrings& getDisplayStrings(const PackageRepository::PackageData& package) const;
+  void fillDisplayStrings(const PackageRepository::PackageData& package, DisplayStrings& strings) const;
+  void buildViewMask(PackageBitset& mask) const;
+  bool matchesTextFilter(const PackageRepository::PackageData* package, const PackageQuery* query) const;
+  bool isFuzzyFilterActive() const;
+  QueryTextField getQueryTextField() const;
+  int  fuzzyScore(const FuzzyMatcher& matcher, const PackageRepository::PackageData* package) const;
+  void rankPackages(const QList<PackageRepository::PackageData*>& candidates,
+                    QList<PackageRepository::PackageData*>& result, int generation) const;
+  QList<PackageRepository::PackageData*> filterPackages(int generation) const;
+  bool isFilterStale(int generation) const;
+  void finishReset();
+  const QList<PackageRepository::PackageData*>* getSortPermutation(int column);
   void sort();
 
 private:
   int                                     m_installedPackagesCount;
   bool                                    m_showColumnPopularity;
+  int                                     m_parallelFilterThreshold; // min candidates to filter in the thread pool
+  bool                                    m_fuzzySearch;
 
   const PackageRepository&                m_packageRepo;
-  QList<PackageRepository::PackageData*>  m_listOfPackages;             // should be provided sorted by name (by repo)
+  QList<PackageRepository::PackageData*>  m_listOfPackages;             // sorted by name (by repo), or by rank when the fuzzy filter is active
   QList<PackageRepository::PackageData*>  m_columnSortedlistOfPackages; // sorted by column
 
+  // Whole repository sorted by column, rebuilt whenever the repository generation changes
+  QHash<int, QList<PackageRepository::PackageData*> > m_sortPermutations;
+  int                                     m_sortCacheGeneration;
+
+  // Display strings indexed by package position, for the repository generation and locale they were built with
+  mutable std::vector<DisplayStrings>     m_displayStrings;
+  mutable int                             m_displayStringsGeneration;
+  mutable QLocale                         m_displayLocale;
+  mutable QString                         m_dateTimeFormat;
+  mutable DisplayStrings                  m_unindexedStrings;
+
   // Filter / Sort attributes
   Qt::SortOrder m_sortOrder;
   int           m_sortColumn;
@@ -110,9 +176,16 @@ private:
   bool    m_filterPackagesOutdated;
   QString m_filterPackagesNotInThisGroup;
   QString m_filterPackagesNotInThisRepo;
+  bool    m_filterPackagesNotProvidingFile;
+  QSet<QString> m_fileProviders; // "repository/name" of the packages which provide the searched file
   int     m_filterColumn;
   QRegularExpression m_filterRegExp;
 
+  // Bumped to cancel the pending asynchronous filter, which only reads the state above
+  QAtomicInt    m_filterGeneration;
+  QFutureWatcher<FilterResult> m_filterWatcher;
+  bool          m_filterDeferred; // applyFilterAsync was called during a batched load of the repository
+
   // Cache
   QIcon   m_iconNotInstalled;
   QIcon   m_iconInstalled;
@@ -0,0 +1,355 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "packagequery.h"
+
+#include <algorithm>
+#include <QRegularExpression>
+#include <QtAlgorithms>
+
+/*
+ * Query terms are evaluated cheapest first, so string searches only run on packages
+ * which already passed the status, repository and size tests
+ */
+
+static const int ctn_COST_STATUS = 0;
+static const int ctn_COST_NUMBER = 1;
+static const int ctn_COST_REPOSITORY = 2;
+static const int ctn_COST_TEXT = 3;
+
+class PackageQuery::Node
+{
+public:
+  virtual ~Node() {}
+  virtual bool matches(const PackageRepository::PackageData* package) const = 0;
+  virtual int cost() const = 0;
+  virtual QString toString() const = 0;
+};
+
+namespace {
+
+class InstalledNode: public PackageQuery::Node
+{
+public:
+  explicit InstalledNode(bool value): m_value(value) {}
+  bool matches(const PackageRepository::PackageData* package) const { return package->installed() == m_value; }
+  int cost() const { return ctn_COST_STATUS; }
+  QString toString() const { return m_value ? QStringLiteral("installed:yes") : QStringLiteral("installed:no"); }
+
+private:
+  const bool m_value;
+};
+
+class OutdatedNode: public PackageQuery::Node
+{
+public:
+  explicit OutdatedNode(bool value): m_value(value) {}
+  bool matches(const PackageRepository::PackageData* package) const { return package->outdated() == m_value; }
+  int cost() const { return ctn_COST_STATUS; }
+  QString toString() const { return m_value ? QStringLiteral("outdated:yes") : QStringLiteral("outdated:no"); }
+
+private:
+  const bool m_value;
+};
+
+class RepositoryNode: public PackageQuery::Node
+{
+public:
+  explicit RepositoryNode(const QString& repository): m_repository(repository) {}
+  bool matches(const PackageRepository::PackageData* package) const {
+    return package->repository.compare(m_repository, Qt::CaseInsensitive) == 0;
+  }
+  int cost() const { return ctn_COST_REPOSITORY; }
+  QString toString() const { return QLatin1String("repo:") + m_repository; }
+
+private:
+  const QString m_repository;
+};
+
+class SizeNode: public PackageQuery::Node
+{
+public:
+  SizeNode(const QString& key, const double PackageRepository::PackageData::* field, const QString& op, double value):
+    m_key(key), m_field(field), m_op(op), m_value(value) {}
+
+  bool matches(const PackageRepository::PackageData* package) const {
+    const double size = package->*m_field;
+
+    if (m_op == QLatin1String(">")) return size > m_value;
+    else if (m_op == QLatin1String(">=")) return size >= m_value;
+    else if (m_op == QLatin1String("<")) return size < m_value;
+    else if (m_op == QLatin1String("<=")) return size <= m_value;
+    else return size == m_value;
+  }
+  int cost() const { return ctn_COST_NUMBER; }
+  QString toString() const { return m_key + m_op + QString::number(m_value, 'f', 0); }
+
+private:
+  const QString m_key;
+  const double PackageRepository::PackageData::* m_field;
+  const QString m_op;
+  const double m_value;
+};
+
+class TextNode: public PackageQuery::Node
+{
+public:
+  TextNode(const QString& key, const QString PackageRepository::PackageData::* field, const QString& text):
+    m_key(key), m_field(field), m_text(text) {}
+  bool matches(const PackageRepository::PackageData* package) const {
+    return (package->*m_field).contains(m_text, Qt::CaseInsensitive);
+  }
+  int cost() const { return ctn_COST_TEXT; }
+  QString toString() const {
+    if (m_text.contains(QLatin1Char(' '))) return m_key + QLatin1String(":\"") + m_text + QLatin1Char('"');
+    return m_key + QLatin1Char(':') + m_text;
+  }
+
+private:
+  const QString m_key;
+  const QString PackageRepository::PackageData::* m_field;
+  const QString m_text;
+};
+
+class NotNode: public PackageQuery::Node
+{
+public:
+  explicit NotNode(PackageQuery::Node* child): m_child(child) {}
+  ~NotNode() { delete m_child; }
+  bool matches(const PackageRepository::PackageData* package) const { return !m_child->matches(package); }
+  int cost() const { return m_child->cost(); }
+  QString toString() const { return QLatin1Char('-') + m_child->toString(); }
+
+private:
+  PackageQuery::Node* m_child;
+};
+
+class AndNode: public PackageQuery::Node
+{
+public:
+  explicit AndNode(std::vector<PackageQuery::Node*>& children): m_children(children) {
+    std::stable_sort(m_children.begin(), m_children.end(),
+                     [](const PackageQuery::Node* a, const PackageQuery::Node* b) { return a->cost() < b->cost(); });
+  }
+  ~AndNode() { qDeleteAll(m_children.begin(), m_children.end()); }
+
+  bool matches(const PackageRepository::PackageData* package) const {
+    for (std::vector<PackageQuery::Node*>::const_iterator it = m_children.begin(); it != m_children.end(); ++it)
+    {
+      if (!(*it)->matches(package)) return false;
+    }
+    return true;
+  }
+  int cost() const { return m_children.empty() ? 0 : m_children.back()->cost(); }
+  QString toString() const {
+    QStringList terms;
+    for (std::vector<PackageQuery::Node*>::const_iterator it = m_children.begin(); it != m_children.end(); ++it)
+    {
+      terms << (*it)->toString();
+    }
+    return terms.join(QLatin1Char(' '));
+  }
+
+private:
+  std::vector<PackageQuery::Node*> m_children;
+};
+
+const QRegularExpression& sizeTermRegExp()
+{
+  static const QRegularExpression re(QStringLiteral("^(size|dsize)(>=|<=|>|<|=)(\\d+(?:\\.\\d+)?)([kmg]?)i?b?$"),
+                                     QRegularExpression::CaseInsensitiveOption);
+  return re;
+}
+
+bool parseBool(const QString& value, bool& result)
+{
+  const QString v = value.toLower();
+
+  if (v == QLatin1String("yes") || v == QLatin1String("true") || v == QLatin1String("1")) result = true;
+  else if (v == QLatin1String("no") || v == QLatin1String("false") || v == QLatin1String("0")) result = false;
+  else return false;
+
+  return true;
+}
+
+QString textFieldKey(QueryTextField field)
+{
+  switch (field)
+  {
+  case ectn_QUERY_DESCRIPTION:
+    return QStringLiteral("desc");
+  case ectn_QUERY_INSTALL_REASON:
+    return QStringLiteral("reason");
+  default:
+    return QStringLiteral("name");
+  }
+}
+
+const QString PackageRepository::PackageData::* textFieldMember(QueryTextField field)
+{
+  switch (field)
+  {
+  case ectn_QUERY_DESCRIPTION:
+    return &PackageRepository::PackageData::description;
+  case ectn_QUERY_INSTALL_REASON:
+    return &PackageRepository::PackageData::installReason;
+  default:
+    return &PackageRepository::PackageData::name;
+  }
+}
+
+} //end of anonymous namespace
+
+PackageQuery::PackageQuery(const QString &text, QueryTextField defaultField)
+{
+  std::vector<Node*> nodes;
+  const QStringList terms = tokenize(text);
+
+  for (const QString& term: terms)
+  {
+    nodes.push_back(parseTerm(term, defaultField));
+  }
+
+  m_root = new AndNode(nodes);
+}
+
+PackageQuery::~PackageQuery()
+{
+  delete m_root;
+}
+
+/*
+ * It must stay free of side effects, as it can be called from the thread pool
+ */
+bool PackageQuery::matches(const PackageRepository::PackageData *package) const
+{
+  return m_root->matches(package);
+}
+
+/*
+ * The query with every term spelled out, in the order the terms are evaluated
+ */
+QString PackageQuery::toString() const
+{
+  return m_root->toString();
+}
+
+/*
+ * Returns true if text uses the query syntax, rather than being a plain search string
+ */
+bool PackageQuery::isQuery(const QString &text)
+{
+  if (!text.contains(QLatin1Char(':')) && !text.contains(QLatin1Char('-')) &&
+      !text.contains(QLatin1Char('<')) && !text.contains(QLatin1Char('>')) && !text.contains(QLatin1Char('=')))
+    return false;
+
+  const QStringList terms = tokenize(text);
+  for (const QString& term: terms)
+  {
+    if (term.size() > 1 && term.startsWith(QLatin1Char('-'))) return true;
+    if (isQualifiedTerm(term)) return true;
+  }
+
+  return false;
+}
+
+/*
+ * Splits text on white spaces, keeping double quoted parts together (without the quotes)
+ */
+QStringList PackageQuery::tokenize(const QString &text)
+{
+  QStringList res;
+  QString current;
+  bool inQuotes = false;
+
+  for (const QChar ch: text)
+  {
+    if (ch == QLatin1Char('"'))
+    {
+      inQuotes = !inQuotes;
+    }
+    else if (ch.isSpace() && !inQuotes)
+    {
+      if (!current.isEmpty()) res.append(current);
+      current.clear();
+    }
+    else current += ch;
+  }
+
+  if (!current.isEmpty()) res.append(current);
+  return res;
+}
+
+/*
+ * True if term is a "key:value" pair or a size comparison this class knows about
+ */
+bool PackageQuery::isQualifiedTerm(const QString &term)
+{
+  if (sizeTermRegExp().match(term).hasMatch()) return true;
+
+  const int colon = term.indexOf(QLatin1Char(':'));
+  if (colon <= 0) return false;
+
+  static const QStringList keys = { QStringLiteral("repo"), QStringLiteral("installed"), QStringLiteral("outdated"),
+                                    QStringLiteral("name"), QStringLiteral("desc"), QStringLiteral("reason") };
+  return keys.contains(term.left(colon), Qt::CaseInsensitive);
+}
+
+PackageQuery::Node* PackageQuery::parseTerm(const QString &term, QueryTextField defaultField)
+{
+  if (term.size() > 1 && term.startsWith(QLatin1Char('-')))
+    return new NotNode(parseTerm(term.mid(1), defaultField));
+
+  QRegularExpressionMatch match = sizeTermRegExp().match(term);
+  if (match.hasMatch())
+  {
+    double value = match.captured(3).toDouble();
+    const QString unit = match.captured(4).toLower();
+
+    if (unit == QLatin1String("k")) value *= 1024;
+    else if (unit == QLatin1String("m")) value *= 1024 * 1024;
+    else if (unit == QLatin1String("g")) value *= 1024 * 1024 * 1024;
+
+    if (match.captured(1).compare(QLatin1String("dsize"), Qt::CaseInsensitive) == 0)
+      return new SizeNode(QStringLiteral("dsize"), &PackageRepository::PackageData::downloadSize, match.captured(2), value);
+    else
+      return new SizeNode(QStringLiteral("size"), &PackageRepository::PackageData::installedSize, match.captured(2), value);
+  }
+
+  if (isQualifiedTerm(term))
+  {
+    const int colon = term.indexOf(QLatin1Char(':'));
+    const QString key = term.left(colon).toLower();
+    const QString value = term.mid(colon + 1);
+    bool flag;
+
+    if (key == QLatin1String("repo")) return new RepositoryNode(value);
+    else if (key == QLatin1String("installed") && parseBool(value, flag)) return new InstalledNode(flag);
+    else if (key == QLatin1String("outdated") && parseBool(value, flag)) return new OutdatedNode(flag);
+    else if (key == QLatin1String("name")) return new TextNode(key, &PackageRepository::PackageData::name, value);
+    else if (key == QLatin1String("desc")) return new TextNode(key, &PackageRepository::PackageData::description, value);
+    else if (key == QLatin1String("reason")) return new TextNode(key, &PackageRepository::PackageData::installReason, value);
+  }
+
+  if (term.compare(QLatin1String("installed"), Qt::CaseInsensitive) == 0) return new InstalledNode(true);
+  if (term.compare(QLatin1String("outdated"), Qt::CaseInsensitive) == 0) return new OutdatedNode(true);
+
+  return new TextNode(textFieldKey(defaultField), textFieldMember(defaultField), term);
+}
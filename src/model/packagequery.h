@@ -0,0 +1,63 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef OCTOPI_PACKAGEQUERY_H
+#define OCTOPI_PACKAGEQUERY_H
+
+#include <QString>
+#include <QStringList>
+
+#include "src/packagerepository.h"
+
+// Package field matched by the query terms which have no "key:"
+enum QueryTextField { ectn_QUERY_NAME, ectn_QUERY_DESCRIPTION, ectn_QUERY_INSTALL_REASON };
+
+/*
+ * @brief Structured package filter, like: repo:extra installed:yes size>50M outdated desc:"wayland compositor" -python
+ *
+ * Terms are ANDed and "-" negates a term. Supported terms:
+ *   repo:NAME, installed:yes|no, outdated[:yes|no], name:TEXT, desc:TEXT, reason:TEXT,
+ *   size and dsize (installed and download sizes) compared with <, <=, =, >= or > to a number with K, M or G suffix,
+ *   the words "installed" and "outdated", and any other word, which is searched in the default text field.
+ */
+class PackageQuery
+{
+public:
+  class Node;
+
+  PackageQuery(const QString& text, QueryTextField defaultField);
+  ~PackageQuery();
+
+  bool matches(const PackageRepository::PackageData* package) const;
+  QString toString() const;
+
+  static bool isQuery(const QString& text);
+
+private:
+  Q_DISABLE_COPY(PackageQuery)
+
+  static QStringList tokenize(const QString& text);
+  static bool isQualifiedTerm(const QString& term);
+  static Node* parseTerm(const QString& term, QueryTextField defaultField);
+
+  Node* m_root;
+};
+
+#endif // OCTOPI_PACKAGEQUERY_H
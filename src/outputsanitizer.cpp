@@ -0,0 +1,121 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "outputsanitizer.h"
+
+#include <QRegularExpression>
+
+/*
+ * Returns the position of the last character of the escape sequence which starts at pos
+ *
+ * Handles CSI sequences (ESC [ params intermediates final), OSC strings ended by BEL or ESC \,
+ * character set designations (ESC ( B) and two character escapes (ESC c)
+ */
+static int skipEscapeSequence(const QString &str, int pos)
+{
+  const int size = str.size();
+  if (pos+1 >= size) return pos;
+
+  const ushort next = str.at(pos+1).unicode();
+  int c = pos+2;
+
+  if (next == '[')
+  {
+    while (c < size && str.at(c).unicode() >= 0x30 && str.at(c).unicode() <= 0x3F) ++c;
+    while (c < size && str.at(c).unicode() >= 0x20 && str.at(c).unicode() <= 0x2F) ++c;
+    return (c < size && str.at(c).unicode() >= 0x40 && str.at(c).unicode() <= 0x7E) ? c : c-1;
+  }
+  else if (next == ']')
+  {
+    for (; c < size; ++c)
+    {
+      if (str.at(c).unicode() == 0x07) return c;
+      if (str.at(c).unicode() == 0x1B && c+1 < size && str.at(c+1) == QLatin1Char('\\')) return c+1;
+    }
+    return size-1;
+  }
+  else if (next == '(' || next == ')')
+  {
+    return qMin(c, size-1);
+  }
+
+  return pos+1;
+}
+
+/*
+ * Removes color codes and other escape sequences from given str parameter
+ *
+ * One pass drops every escape sequence, and the SGR sequences ("[1;31m") whose ESC was lost
+ */
+QString OutputSanitizer::removeEscapeSequences(const QString &str)
+{
+  if (str.indexOf(QLatin1Char('\033')) == -1 && str.indexOf(QLatin1Char('[')) == -1) return str;
+
+  QString ret;
+  ret.reserve(str.size());
+  const int size = str.size();
+
+  for (int c=0; c<size; ++c)
+  {
+    const QChar ch = str.at(c);
+
+    if (ch == QLatin1Char('\033'))
+    {
+      c = skipEscapeSequence(str, c);
+      continue;
+    }
+    else if (ch == QLatin1Char('['))
+    {
+      int end = c+1;
+      while (end < size && (str.at(end).isDigit() || str.at(end) == QLatin1Char(';'))) ++end;
+
+      if (end < size && str.at(end) == QLatin1Char('m'))
+      {
+        c = end;
+        continue;
+      }
+    }
+
+    ret += ch;
+  }
+
+  return ret;
+}
+
+/*
+ * Cleans a chunk of pacman output before it is parsed: drops the [Y/n] questions, the escape sequences
+ * and what is left of those split between two reads
+ */
+QString OutputSanitizer::sanitizePacmanOutput(const QString &output)
+{
+  static const QRegularExpression reYesNoQuestion(QStringLiteral(".+\\[Y/n\\].+"));
+  //What is left of escape sequences split between two reads, and some other terminal leftovers
+  static const QRegularExpression reTerminalLeftovers(
+        QStringLiteral("\\(B\\[m|\\[\\?25[lh]|\\[2F|\\[mo|\\[c|\\[[0-9;]*m|\\[1|;3[127]m|8;5;243m|E |F "));
+  static const QRegularExpression reLoneParenthesis(QStringLiteral("^\\($"));
+
+  QString msg = output;
+  msg.remove(reYesNoQuestion);
+  msg = removeEscapeSequences(msg);
+  msg.remove(reTerminalLeftovers);
+  msg.remove(reLoneParenthesis);
+
+  return msg;
+}
@@ -21,6 +21,8 @@
 #include "package.h"
 #include "unixcommand.h"
 #include "strconstants.h"
+#include "packageinfocache.h"
+#include "outputsanitizer.h"
 
 #ifdef ALPM_BACKEND
   #include "alpmbackend.h"
@@ -334,22 +336,7 @@ QStringList *Package::getOutdatedStringList()
  */
 QString Package::removeColorCodesFromStr(const QString &str)
 {
-  QString ret = str;
-
-  ret = ret.remove(QStringLiteral("\033"));
-  ret = ret.remove(QStringLiteral("[1;31m"));
-  ret = ret.remove(QStringLiteral("[1;32m"));
-  ret = ret.remove(QStringLiteral("[1;33m"));
-  ret = ret.remove(QStringLiteral("[1;34m"));
-  ret = ret.remove(QStringLiteral("[1;35m"));
-  ret = ret.remove(QStringLiteral("[1;36m"));
-  ret = ret.remove(QStringLiteral("[1;39m"));
-  ret = ret.remove(QStringLiteral("[m"));
-  ret = ret.remove(QStringLiteral("[0m"));
-  ret = ret.remove(QStringLiteral("[1m"));
-  ret = ret.remove(QStringLiteral("\u001B"));
-
-  return ret;
+  return OutputSanitizer::removeEscapeSequences(str);
 }
 
 /*
@@ -1788,9 +1775,7 @@ QString Package::getInstallReason(const QString &pkgInfo)
  */
 QString Package::getInstallReasonByPkgName(const QString &pkgName)
 {
-  QString pkgInfo = QString::fromUtf8(UnixCommand::getPackageInformation(pkgName, true));
-  QString instReason = getInstallReason(pkgInfo);
-  return getInstallReason(pkgInfo);
+  return getInformation(pkgName, true).installReason;
 }
 
 /*
@@ -2093,12 +2078,20 @@ PackageInfoData Package::getKCPInformation(const QString &pkgName)
 
 /*
  * Retrieves all information for a given package name
+ * If version is given, cached information about any other version is not used
+ * If repository is given, sync information comes from that repository ("pacman -Si repository/name")
  */
-PackageInfoData Package::getInformation(const QString &pkgName, bool foreignPackage)
+PackageInfoData Package::getInformation(const QString &pkgName, bool foreignPackage, const QString &version,
+                                        const QString &repository)
 {
+  //The local database holds a single package of each name, whatever repository it came from
+  const QString syncRepository = foreignPackage ? QString() : repository;
+
   PackageInfoData res;
+  if (PackageInfoCache::find(pkgName, foreignPackage, syncRepository, version, res)) return res;
 
-  QString pkgInfo = QString::fromUtf8(UnixCommand::getPackageInformation(pkgName, foreignPackage));
+  const QString target = syncRepository.isEmpty() ? pkgName : syncRepository + QLatin1Char('/') + pkgName;
+  QString pkgInfo = QString::fromUtf8(UnixCommand::getPackageInformation(target, foreignPackage));
 
   res.name = pkgName;
   res.version = getVersion(pkgInfo);
@@ -2121,8 +2114,11 @@ PackageInfoData Package::getInformation(const QString &pkgName, bool foreignPack
   res.installedSize = getInstalledSizeAsString(pkgInfo);
   res.downloadSizeAsString = getDownloadSizeAsString(pkgInfo);
   res.installedSizeAsString = getInstalledSizeAsString(pkgInfo);
+  res.downloadBytes = getDownloadSize(pkgInfo);
+  res.installedBytes = getInstalledSize(pkgInfo);
   res.installReason = getInstallReason(pkgInfo);
 
+  PackageInfoCache::insert(pkgName, foreignPackage, syncRepository, res);
   return res;
 }
 
@@ -2131,8 +2127,7 @@ PackageInfoData Package::getInformation(const QString &pkgName, bool foreignPack
  */
 double Package::getDownloadSizeDescription(const QString &pkgName)
 {
-  QString pkgInfo = QString::fromUtf8(UnixCommand::getPackageInformation(pkgName, false));
-  return getDownloadSize(pkgInfo);
+  return getInformation(pkgName, false).downloadBytes;
 }
 
 /*
@@ -2140,17 +2135,15 @@ double Package::getDownloadSizeDescription(const QString &pkgName)
  */
 QString Package::getInformationDescription(const QString &pkgName, bool foreignPackage)
 {
-  QString pkgInfo = QString::fromUtf8(UnixCommand::getPackageInformation(pkgName, foreignPackage));
-  return getDescription(pkgInfo);
+  return getInformation(pkgName, foreignPackage).description;
 }
 
 /*
  * Helper to get only the Installed Size field of package information, for use in tooltips
  */
-QString Package::getInformationInstalledSize(const QString &pkgName, bool foreignPackage)
+QString Package::getInformationInstalledSize(const QString &pkgName, bool foreignPackage, const QString &repository)
 {
-  QString pkgInfo = QString::fromUtf8(UnixCommand::getPackageInformation(pkgName, foreignPackage));
-  return kbytesToSize(getInstalledSize(pkgInfo));
+  return kbytesToSize(static_cast<float>(getInformation(pkgName, foreignPackage, QString(), repository).installedBytes));
 }
 
 /*
@@ -2322,8 +2315,7 @@ QStringList Package::getContents(const QString& pkgName, bool isInstalled)
  */
 QStringList Package::getOptionalDeps(const QString &pkgName)
 {
-  QString pkgInfo = QString::fromUtf8(UnixCommand::getPackageInformation(pkgName, false));
-  QString aux = Package::getOptDepends(pkgInfo);
+  QString aux = getInformation(pkgName, false).optDepends;
   QStringList result = aux.split(QStringLiteral("<br>"), Qt::SkipEmptyParts);
   result.removeAll(QStringLiteral("None"));
 
@@ -154,6 +154,8 @@ struct PackageInfoData{
   QString installedSize;
   QString downloadSizeAsString;
   QString installedSizeAsString;
+  double  downloadBytes = 0;
+  double  installedBytes = 0;
 };
 
 class Result;
@@ -193,10 +195,12 @@ class Package{
     static QHash<QString, QString> getForeignToolOutdatedPackagesNameVersion();    //AUR methods
 
     static PackageInfoData getKCPInformation(const QString &pkgName);
-    static PackageInfoData getInformation(const QString &pkgName, bool foreignPackage = false);
+    static PackageInfoData getInformation(const QString &pkgName, bool foreignPackage = false,
+                                          const QString &version = QString(), const QString &repository = QString());
     static double getDownloadSizeDescription(const QString &pkgName);
     static QString getInformationDescription(const QString &pkgName, bool foreignPackage = false);
-    static QString getInformationInstalledSize(const QString &pkgName, bool foreignPackage = false);
+    static QString getInformationInstalledSize(const QString &pkgName, bool foreignPackage = false,
+                                               const QString &repository = QString());
     static QStringList getContents(const QString &pkgName, bool isInstalled);
     static QStringList getOptionalDeps(const QString &pkgName);
     static QString getName(const QString &pkgInfo);
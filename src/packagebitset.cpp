@@ -0,0 +1,88 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "packagebitset.h"
+
+#include <cassert>
+#include <QtAlgorithms>
+
+PackageBitset::PackageBitset(): m_size(0)
+{
+}
+
+/*
+ * Resizes the set to hold size positions, all of them set to value
+ */
+void PackageBitset::fill(int size, bool value)
+{
+  m_size = size;
+  m_words.assign(static_cast<size_t>((size + 63) / 64), value ? ~quint64(0) : quint64(0));
+
+  //Keeps the bits past the end cleared, so count() and nextSetBit() don't need to mask them
+  if (value && (size & 63) != 0)
+    m_words.back() = (quint64(1) << (size & 63)) - 1;
+}
+
+void PackageBitset::set(int pos)
+{
+  assert(pos >= 0 && pos < m_size);
+  m_words[static_cast<size_t>(pos) >> 6] |= quint64(1) << (pos & 63);
+}
+
+void PackageBitset::andWith(const PackageBitset &other)
+{
+  assert(other.m_size == m_size);
+
+  for (size_t c=0; c<m_words.size(); ++c)
+  {
+    m_words[c] &= other.m_words[c];
+  }
+}
+
+/*
+ * Returns the first set position at or after from, or -1 if there is none
+ */
+int PackageBitset::nextSetBit(int from) const
+{
+  if (from >= m_size) return -1;
+
+  size_t w = static_cast<size_t>(from) >> 6;
+  quint64 word = m_words[w] & (~quint64(0) << (from & 63));
+
+  while (word == 0)
+  {
+    if (++w == m_words.size()) return -1;
+    word = m_words[w];
+  }
+
+  return static_cast<int>(w * 64) + static_cast<int>(qCountTrailingZeroBits(word));
+}
+
+int PackageBitset::count() const
+{
+  int res = 0;
+
+  for (size_t c=0; c<m_words.size(); ++c)
+  {
+    res += static_cast<int>(qPopulationCount(m_words[c]));
+  }
+
+  return res;
+}
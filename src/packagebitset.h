@@ -0,0 +1,54 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef PACKAGEBITSET_H
+#define PACKAGEBITSET_H
+
+#include <vector>
+#include <QtGlobal>
+
+/*
+ * @brief Fixed size set of package positions, packed in 64 bit words
+ *
+ * Used to combine the view filters (status, repository, group) with word-wise ANDs
+ */
+class PackageBitset
+{
+public:
+  PackageBitset();
+
+  void fill(int size, bool value);
+  void set(int pos);
+
+  inline bool test(int pos) const {
+    return (m_words[static_cast<size_t>(pos) >> 6] >> (pos & 63)) & 1;
+  }
+
+  void andWith(const PackageBitset& other);
+  int nextSetBit(int from) const;
+  int count() const;
+  int size() const { return m_size; }
+
+private:
+  std::vector<quint64> m_words;
+  int m_size;
+};
+
+#endif // PACKAGEBITSET_H
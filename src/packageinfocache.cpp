@@ -0,0 +1,109 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "packageinfocache.h"
+#include "constants.h"
+
+#include <QMutexLocker>
+
+/*
+ * This cache spares the pacman calls made each time the Info tab, a tooltip or a transaction
+ * needs the details of a package it has already seen
+ */
+
+QMutex PackageInfoCache::s_mutex;
+QCache<QString, PackageInfoData> PackageInfoCache::s_cache(ctn_PACKAGE_INFO_CACHE_SIZE * 1024);
+QAtomicInt PackageInfoCache::s_hits;
+QAtomicInt PackageInfoCache::s_misses;
+
+/*
+ * Copies the cached information of pkgName into result. An empty version matches any version
+ */
+bool PackageInfoCache::find(const QString &pkgName, bool foreignPackage, const QString &repository, const QString &version,
+                            PackageInfoData &result)
+{
+  QMutexLocker locker(&s_mutex);
+  const PackageInfoData *info = s_cache.object(makeKey(pkgName, foreignPackage, repository));
+
+  if (info == nullptr || (!version.isEmpty() && info->version != version))
+  {
+    s_misses.ref();
+    return false;
+  }
+
+  s_hits.ref();
+  result = *info;
+  return true;
+}
+
+void PackageInfoCache::insert(const QString &pkgName, bool foreignPackage, const QString &repository, const PackageInfoData &info)
+{
+  QMutexLocker locker(&s_mutex);
+  s_cache.insert(makeKey(pkgName, foreignPackage, repository), new PackageInfoData(info), estimateCost(info));
+}
+
+/*
+ * Called whenever the pacman database changes
+ */
+void PackageInfoCache::clear()
+{
+  QMutexLocker locker(&s_mutex);
+  s_cache.clear();
+}
+
+int PackageInfoCache::getHitCount()
+{
+  return s_hits.loadAcquire();
+}
+
+int PackageInfoCache::getMissCount()
+{
+  return s_misses.loadAcquire();
+}
+
+int PackageInfoCache::getCostInKB()
+{
+  QMutexLocker locker(&s_mutex);
+  return static_cast<int>(s_cache.totalCost() / 1024);
+}
+
+/*
+ * "local/name" or "sync/repository/name", where repository may be empty
+ */
+QString PackageInfoCache::makeKey(const QString &pkgName, bool foreignPackage, const QString &repository)
+{
+  if (foreignPackage) return QLatin1String("local/") + pkgName;
+  return QLatin1String("sync/") + repository + QLatin1Char('/') + pkgName;
+}
+
+/*
+ * Approximate number of bytes held by info
+ */
+int PackageInfoCache::estimateCost(const PackageInfoData &info)
+{
+  int chars = info.name.size() + info.repository.size() + info.version.size() + info.url.size() +
+      info.license.size() + info.group.size() + info.provides.size() + info.requiredBy.size() +
+      info.optionalFor.size() + info.dependsOn.size() + info.optDepends.size() + info.conflictsWith.size() +
+      info.replaces.size() + info.packager.size() + info.arch.size() + info.description.size() +
+      info.installReason.size() + info.downloadSize.size() + info.installedSize.size() +
+      info.downloadSizeAsString.size() + info.installedSizeAsString.size();
+
+  return static_cast<int>(sizeof(PackageInfoData)) + chars * static_cast<int>(sizeof(QChar));
+}
@@ -0,0 +1,66 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef PACKAGEINFOCACHE_H
+#define PACKAGEINFOCACHE_H
+
+#include <QAtomicInt>
+#include <QCache>
+#include <QMutex>
+#include <QString>
+
+#include "package.h"
+
+/*
+ * @brief Process wide LRU cache of parsed package information, bounded by memory
+ *
+ * Entries are keyed by package name and by the database they came from: "local", or the sync
+ * repository which was asked for. Sync lookups without a repository get their own entry, as
+ * they hold whatever "pacman -Si name" answers (the first repository which has the package).
+ *
+ * The version is not part of the key, since a database holds a single version of each package.
+ * Each entry remembers its version instead: a caller which knows the version it wants never gets
+ * another one, and the fresh information replaces the old entry. Helpers which pass no version
+ * are safe too, as the whole cache is cleared whenever the pacman database changes.
+ * It is safe to use from any thread.
+ */
+class PackageInfoCache
+{
+public:
+  static bool find(const QString& pkgName, bool foreignPackage, const QString& repository, const QString& version,
+                   PackageInfoData& result);
+  static void insert(const QString& pkgName, bool foreignPackage, const QString& repository, const PackageInfoData& info);
+  static void clear();
+
+  static int getHitCount();
+  static int getMissCount();
+  static int getCostInKB();
+
+private:
+  static QString makeKey(const QString& pkgName, bool foreignPackage, const QString& repository);
+  static int estimateCost(const PackageInfoData& info);
+
+  static QMutex s_mutex;
+  static QCache<QString, PackageInfoData> s_cache; // cost in bytes
+  static QAtomicInt s_hits;
+  static QAtomicInt s_misses;
+};
+
+#endif // PACKAGEINFOCACHE_H
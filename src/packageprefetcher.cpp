@@ -0,0 +1,70 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "packageprefetcher.h"
+#include "package.h"
+
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+
+PackagePrefetcher::PackagePrefetcher()
+{
+  m_pool.setMaxThreadCount(1);
+}
+
+PackagePrefetcher::~PackagePrefetcher()
+{
+  cancel();
+  m_pool.waitForDone();
+}
+
+/*
+ * Replaces the pending requests with the given ones, which are fetched in order
+ */
+void PackagePrefetcher::prefetch(const QList<Request> &requests)
+{
+  cancel();
+  const int generation = m_generation.loadAcquire();
+
+  for (const Request &request: requests)
+  {
+    QtConcurrent::run(&m_pool, &PackagePrefetcher::fetch, request, generation, &m_generation);
+  }
+}
+
+/*
+ * Called whenever the viewport, the filter or the package list changes
+ */
+void PackagePrefetcher::cancel()
+{
+  m_generation.ref();
+  m_pool.clear();
+}
+
+/*
+ * Runs Package::getInformation only to leave its result in PackageInfoCache
+ */
+void PackagePrefetcher::fetch(const Request &request, int generation, const QAtomicInt *currentGeneration)
+{
+  if (currentGeneration->loadAcquire() != generation) return;
+
+  QThread::currentThread()->setPriority(QThread::LowestPriority);
+  Package::getInformation(request.name, request.foreign, request.version, request.repository);
+}
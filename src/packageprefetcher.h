@@ -0,0 +1,60 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef PACKAGEPREFETCHER_H
+#define PACKAGEPREFETCHER_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QString>
+#include <QThreadPool>
+
+/*
+ * @brief Fills PackageInfoCache in the background with the packages the user is likely to select next
+ *
+ * Work runs in a pool of a single low priority thread, so there is never more than one
+ * prefetching pacman query alive. Each call to prefetch() or cancel() drops every request
+ * which has not started yet.
+ */
+class PackagePrefetcher
+{
+public:
+  struct Request
+  {
+    QString name;
+    bool foreign;
+    QString version;
+    QString repository;
+  };
+
+  PackagePrefetcher();
+  ~PackagePrefetcher();
+
+  void prefetch(const QList<Request>& requests);
+  void cancel();
+
+private:
+  static void fetch(const Request& request, int generation, const QAtomicInt* currentGeneration);
+
+  QThreadPool m_pool;
+  QAtomicInt m_generation;
+};
+
+#endif // PACKAGEPREFETCHER_H
@@ -30,7 +30,7 @@
  * Whenever some data changes, a message is sent to all models that are listening to it
  */
 
-PackageRepository::PackageRepository()
+PackageRepository::PackageRepository(): m_generation(0), m_loading(false)
 {
 }
 
@@ -65,7 +65,96 @@ struct EndResetModel {
 void PackageRepository::setData(const QList<PackageListData>*const listOfPackages, const QSet<QString>& unrequiredPackages)
 {
   std::for_each(m_dependingModels.begin(), m_dependingModels.end(), BeginResetModel());
+  clearPackages();
 
+  for (QList<PackageListData>::const_iterator it = listOfPackages->constBegin(); it != listOfPackages->constEnd(); ++it) {
+    m_listOfPackages.push_back(new PackageData(*it, !unrequiredPackages.contains(it->name), false));
+  }
+
+  std::sort(m_listOfPackages.begin(), m_listOfPackages.end(), TSort());
+  reindexPackages();
+  std::for_each(m_dependingModels.begin(), m_dependingModels.end(), EndResetModel());
+}
+
+/*
+ * Starts loading the package list in batches: drops every package, then appendData() and endData() must follow
+ */
+void PackageRepository::beginData()
+{
+  std::for_each(m_dependingModels.begin(), m_dependingModels.end(), BeginResetModel());
+  clearPackages();
+  reindexPackages();
+  std::for_each(m_dependingModels.begin(), m_dependingModels.end(), EndResetModel());
+  m_loading = true;
+}
+
+/*
+ * Merges count packages of listOfPackages, starting at from, into the sorted package list
+ *
+ * Depending models are told the position of every new package, so they can insert them as rows.
+ * Positions, indexes and bitsets are only rebuilt by endData()
+ */
+void PackageRepository::appendData(const QList<PackageListData>*const listOfPackages, int from, int count,
+                                   const QSet<QString>& unrequiredPackages)
+{
+  TListOfPackages batch;
+  batch.reserve(count);
+
+  for (int c=from; c<from+count && c<listOfPackages->count(); ++c)
+  {
+    const PackageListData& pld = listOfPackages->at(c);
+    batch.push_back(new PackageData(pld, !unrequiredPackages.contains(pld.name), false));
+  }
+
+  std::sort(batch.begin(), batch.end(), TSort());
+
+  //One merge pass, recording where each new package lands
+  TListOfPackages merged;
+  TListOfInsertions insertions;
+  merged.reserve(m_listOfPackages.size() + batch.size());
+  insertions.reserve(batch.size());
+
+  TListOfPackages::const_iterator oldIt = m_listOfPackages.constBegin();
+  TListOfPackages::const_iterator newIt = batch.constBegin();
+  TSort lessThan;
+
+  while (oldIt != m_listOfPackages.constEnd() || newIt != batch.constEnd())
+  {
+    if (newIt == batch.constEnd() || (oldIt != m_listOfPackages.constEnd() && !lessThan(*newIt, *oldIt)))
+    {
+      merged.push_back(*oldIt++);
+    }
+    else
+    {
+      insertions.push_back(std::make_pair(merged.size(), *newIt));
+      merged.push_back(*newIt++);
+    }
+  }
+
+  m_listOfPackages.swap(merged);
+
+  for (std::vector<IDependency*>::const_iterator it = m_dependingModels.begin(); it != m_dependingModels.end(); ++it)
+  {
+    (*it)->packagesInserted(insertions);
+  }
+}
+
+/*
+ * Finishes the batched load started by beginData()
+ */
+void PackageRepository::endData()
+{
+  m_loading = false;
+  std::for_each(m_dependingModels.begin(), m_dependingModels.end(), BeginResetModel());
+  reindexPackages();
+  std::for_each(m_dependingModels.begin(), m_dependingModels.end(), EndResetModel());
+}
+
+/*
+ * Deletes every package and invalidates the group lists which point to them
+ */
+void PackageRepository::clearPackages()
+{
   // delete items in groups list
   for (QList<Group*>::const_iterator it = m_listOfGroups.constBegin(); it != m_listOfGroups.constEnd(); ++it) {
     if (*it != nullptr) (*it)->invalidateList();
@@ -76,13 +165,6 @@ void PackageRepository::setData(const QList<PackageListData>*const listOfPackage
   }
   m_listOfAURPackages.clear();
   m_listOfPackages.clear();
-
-  for (QList<PackageListData>::const_iterator it = listOfPackages->constBegin(); it != listOfPackages->constEnd(); ++it) {
-    m_listOfPackages.push_back(new PackageData(*it, !unrequiredPackages.contains(it->name), false));
-  }
-
-  std::sort(m_listOfPackages.begin(), m_listOfPackages.end(), TSort());
-  std::for_each(m_dependingModels.begin(), m_dependingModels.end(), EndResetModel());
 }
 
 void PackageRepository::setAURData(const QList<PackageListData>*const listOfForeignPackages,
@@ -109,6 +191,7 @@ void PackageRepository::setAURData(const QList<PackageListData>*const listOfFore
 
   std::sort(m_listOfPackages.begin(), m_listOfPackages.end(), TSort());
   std::sort(m_listOfAURPackages.begin(), m_listOfAURPackages.end(), TSort());
+  reindexPackages();
   std::for_each(m_dependingModels.begin(), m_dependingModels.end(), EndResetModel());
 }
 
@@ -142,6 +225,7 @@ void PackageRepository::setForeignData(QList<PackageListData>*const listOfForeig
 
   std::sort(m_listOfPackages.begin(), m_listOfPackages.end(), TSort());
   std::sort(m_listOfAURPackages.begin(), m_listOfAURPackages.end(), TSort());
+  reindexPackages();
   std::for_each(m_dependingModels.begin(), m_dependingModels.end(), EndResetModel());
 }
 
@@ -189,6 +273,7 @@ void PackageRepository::setOutdatedData(const QHash<QString, QString> &outdatedP
   }
 
   std::sort(m_listOfPackages.begin(), m_listOfPackages.end(), TSort());
+  reindexPackages();
   std::for_each(m_dependingModels.begin(), m_dependingModels.end(), EndResetModel());
 }
 
@@ -226,6 +311,7 @@ void PackageRepository::setAUROutdatedData(QList<PackageListData>*const listOfFo
 
   std::sort(m_listOfPackages.begin(), m_listOfPackages.end(), TSort());
   std::sort(m_listOfAURPackages.begin(), m_listOfAURPackages.end(), TSort());
+  reindexPackages();
   std::for_each(m_dependingModels.begin(), m_dependingModels.end(), EndResetModel());
 }
 
@@ -248,6 +334,7 @@ void PackageRepository::checkAndSetGroups(const QStringList& listOfGroups)
     {
       m_listOfGroups.push_back(new Group(*it));
     }
+    rebuildGroupBits();
     std::for_each(m_dependingModels.begin(), m_dependingModels.end(), EndResetModel());
   }
 }
@@ -300,6 +387,7 @@ void PackageRepository::checkAndSetMembersOfGroup(const QString& groupName, cons
           }
         }
       }
+      rebuildGroupBits();
       std::for_each(m_dependingModels.begin(), m_dependingModels.end(), EndResetModel());
 
     }
@@ -342,6 +430,79 @@ const QList<PackageRepository::PackageData*>& PackageRepository::getPackageList(
   return m_listOfPackages;
 }
 
+/**
+ * @brief fills %result with the packages whose description contains all the trigrams of %literal
+ * @return false if %literal can't be searched with the index (less than 3 chars)
+ */
+bool PackageRepository::getDescriptionCandidates(const QString& literal, TListOfPackages& result) const
+{
+  TrigramIndex::TPostingList ids;
+  if (!m_descriptionIndex.query(literal, ids)) return false;
+
+  result.clear();
+  result.reserve(static_cast<int>(ids.size()));
+  for (std::vector<quint32>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+  {
+    result.push_back(m_listOfPackages.at(static_cast<int>(*it)));
+  }
+
+  return true;
+}
+
+const TrigramIndex& PackageRepository::getDescriptionIndex() const
+{
+  return m_descriptionIndex;
+}
+
+/**
+ * @brief the generation changes every time the package list changes
+ */
+int PackageRepository::getGeneration() const
+{
+  return m_generation;
+}
+
+/*
+ * Whether a batched load is running: packages have no position yet, so view masks and sort caches can't be built
+ */
+bool PackageRepository::isLoading() const
+{
+  return m_loading;
+}
+
+const PackageBitset& PackageRepository::getInstalledBits() const
+{
+  return m_installedBits;
+}
+
+const PackageBitset& PackageRepository::getNonInstalledBits() const
+{
+  return m_nonInstalledBits;
+}
+
+const PackageBitset& PackageRepository::getOutdatedBits() const
+{
+  return m_outdatedBits;
+}
+
+/*
+ * Returns the packages of the given repository, or nullptr if there is no package from it
+ */
+const PackageBitset* PackageRepository::getRepositoryBits(const QString& repository) const
+{
+  QHash<QString, PackageBitset>::const_iterator it = m_repositoryBits.constFind(repository);
+  return (it != m_repositoryBits.constEnd() ? &it.value() : nullptr);
+}
+
+/*
+ * Returns the members of the given group, or nullptr if they are not loaded (then every package is shown)
+ */
+const PackageBitset* PackageRepository::getGroupBits(const QString& group) const
+{
+  QHash<QString, PackageBitset>::const_iterator it = m_groupBits.constFind(group);
+  return (it != m_groupBits.constEnd() ? &it.value() : nullptr);
+}
+
 PackageRepository::PackageData* PackageRepository::getFirstPackageByName(const QString &name) const
 {
   for (TListOfPackages::const_iterator it = m_listOfPackages.begin(); it != m_listOfPackages.end(); ++it)
@@ -372,6 +533,80 @@ bool PackageRepository::memberListOfGroupsEquals(const QStringList& listOfGroups
   return true;
 }
 
+/**
+ * @brief refreshes the position of every package in the sorted package list and indexes their descriptions
+ *
+ * Must be called whenever m_listOfPackages changes, so models know their cached data is stale
+ */
+void PackageRepository::reindexPackages()
+{
+  m_descriptionIndex.clear();
+
+  const int size = m_listOfPackages.size();
+  m_installedBits.fill(size, false);
+  m_nonInstalledBits.fill(size, false);
+  m_outdatedBits.fill(size, false);
+  m_repositoryBits.clear();
+
+  int position = 0;
+  for (TListOfPackages::const_iterator it = m_listOfPackages.constBegin(); it != m_listOfPackages.constEnd(); ++it, ++position)
+  {
+    (*it)->position = position;
+    m_descriptionIndex.addDocument(static_cast<quint32>(position), (*it)->description);
+
+    if ((*it)->installed()) m_installedBits.set(position);
+    else m_nonInstalledBits.set(position);
+    if ((*it)->outdated()) m_outdatedBits.set(position);
+
+    QHash<QString, PackageBitset>::iterator repoBits = m_repositoryBits.find((*it)->repository);
+    if (repoBits == m_repositoryBits.end())
+    {
+      repoBits = m_repositoryBits.insert((*it)->repository, PackageBitset());
+      repoBits.value().fill(size, false);
+    }
+    repoBits.value().set(position);
+  }
+
+  m_descriptionIndex.squeeze();
+  rebuildGroupBits();
+  ++m_generation;
+}
+
+/*
+ * Rebuilds the position sets of the groups whose member lists are loaded
+ */
+void PackageRepository::rebuildGroupBits()
+{
+  const int size = m_listOfPackages.size();
+  m_groupBits.clear();
+
+  for (QList<Group*>::const_iterator it = m_listOfGroups.constBegin(); it != m_listOfGroups.constEnd(); ++it)
+  {
+    if (*it == nullptr || (*it)->getPackageList() == nullptr) continue;
+
+    PackageBitset& bits = m_groupBits[(*it)->getName()];
+    bits.fill(size, false);
+
+    const TListOfPackages& members = *(*it)->getPackageList();
+    for (TListOfPackages::const_iterator member = members.constBegin(); member != members.constEnd(); ++member)
+    {
+      bits.set((*member)->position);
+    }
+  }
+
+  //Workaround for AUR filter, the same as in getPackageList(group)
+  if (!m_groupBits.contains(StrConstants::getForeignToolGroup()))
+  {
+    PackageBitset& bits = m_groupBits[StrConstants::getForeignToolGroup()];
+    bits.fill(size, false);
+
+    for (TListOfPackages::const_iterator it = m_listOfAURPackages.constBegin(); it != m_listOfAURPackages.constEnd(); ++it)
+    {
+      bits.set((*it)->position);
+    }
+  }
+}
+
 //////// PackageRepository::PackageData //////////////////////////////
 
 /**
@@ -388,7 +623,8 @@ PackageRepository::PackageData::PackageData(const PackageListData& pkg, const bo
            (Package::alpm_pkg_vercmp(pkg.outatedVersion.toLatin1().data(), pkg.version.toLatin1().data()) == 1 ?
              ectn_NEWER : ectn_OUTDATED)),
     popularity(isManagedByAUR ? pkg.popularity : -1),
-    popularityString(isManagedByAUR ? QString::number(pkg.popularity) : QString())
+    popularityString(isManagedByAUR ? QString::number(pkg.popularity) : QString()),
+    position(-1)
 {
 }
 
@@ -21,10 +21,13 @@
 #ifndef OCTOPI_PACKAGEREPOSITORY_H
 #define OCTOPI_PACKAGEREPOSITORY_H
 
+#include <utility>
 #include <vector>
 #include <QList>
 
 #include "package.h"
+#include "trigramindex.h"
+#include "packagebitset.h"
 
 /*
  * @brief Central data storage for package data
@@ -34,6 +37,7 @@ class PackageRepository
 public:
   class PackageData;
   typedef QList<PackageData*> TListOfPackages;
+  typedef std::vector<std::pair<int, PackageData*> > TListOfInsertions; // (position, package), ascending positions
 
   public:
   ////////////////////////
@@ -44,6 +48,7 @@ public:
   public:
     virtual void beginResetRepository() = 0;
     virtual void endResetRepository() = 0;
+    virtual void packagesInserted(const TListOfInsertions& insertions) = 0;
   };
 
   ////////////////////////
@@ -84,6 +89,7 @@ public:
     const PackageStatus status;
     const int     popularity; // -1 for non AUR
     const QString popularityString;
+    int           position;   // index in the repository's sorted package list
   };
 
   ////////////////////////
@@ -111,6 +117,9 @@ public:
 
   void registerDependency(IDependency& depends);
   void setData(const QList<PackageListData>*const listOfPackages, const QSet<QString>& unrequiredPackages);
+  void beginData();
+  void appendData(const QList<PackageListData>*const listOfPackages, int from, int count, const QSet<QString>& unrequiredPackages);
+  void endData();
   void setAURData(const QList<PackageListData>*const listOfForeignPackages, const QSet<QString>& unrequiredPackages);
   void setForeignData(QList<PackageListData>*const listOfForeignPackages, const QStringList& outdatedAURPackages);
   void setOutdatedData(const QHash<QString, QString> &outdatedPackages);
@@ -121,13 +130,37 @@ public:
   const TListOfPackages& getPackageList() const;
   const TListOfPackages& getPackageList(const QString& group) const;
   PackageData*           getFirstPackageByName(const QString &name) const;
+  bool                   getDescriptionCandidates(const QString& literal, TListOfPackages& result) const;
+  const TrigramIndex&    getDescriptionIndex() const;
+  int                    getGeneration() const;
+  bool                   isLoading() const;
+
+  const PackageBitset&   getInstalledBits() const;
+  const PackageBitset&   getNonInstalledBits() const;
+  const PackageBitset&   getOutdatedBits() const;
+  const PackageBitset*   getRepositoryBits(const QString& repository) const;
+  const PackageBitset*   getGroupBits(const QString& group) const;
 
 private:
   std::vector<IDependency*> m_dependingModels;
   TListOfPackages           m_listOfPackages;       // sorted qlist of all packages
   TListOfPackages           m_listOfAURPackages;    // sorted qlist of all AUR packages
   QList<Group*>             m_listOfGroups;         // sorted list of all pacman package groups
+  TrigramIndex              m_descriptionIndex;     // ids are positions in m_listOfPackages
+  int                       m_generation;
+  bool                      m_loading;              // between beginData() and endData(): no positions, indexes or bitsets
+
+  // View filter sets, indexed by position in m_listOfPackages
+  PackageBitset                 m_installedBits;
+  PackageBitset                 m_nonInstalledBits;
+  PackageBitset                 m_outdatedBits;
+  QHash<QString, PackageBitset> m_repositoryBits;
+  QHash<QString, PackageBitset> m_groupBits;      // loaded groups + the AUR workaround group
+
   bool memberListOfGroupsEquals(const QStringList& listOfGroups);
+  void reindexPackages();
+  void clearPackages();
+  void rebuildGroupBits();
 };
 
 #endif // OCTOPI_PACKAGEREPOSITORY_H
@@ -18,22 +18,32 @@
 *
 */
 
+#include <algorithm>
 #include <iostream>
 #include "pacmanexec.h"
+#include "helperclient.h"
+#include "outputsanitizer.h"
 #include "strconstants.h"
 #include "unixcommand.h"
 #include "wmhelper.h"
 
+#include <QDateTime>
+#include <QDir>
 #include <QRegularExpression>
 
 /*
  * This class decouples pacman commands executing and parser code from Octopi's interface
  */
 
+/*
+ * Number of printed strings which are remembered to avoid printing them again
+ */
+static const int ctn_PRINTED_TEXT_WINDOW = 4096;
+
 /*
  * Let's create the needed unixcommand object that will ultimately execute Pacman commands
  */
-PacmanExec::PacmanExec(QObject *parent) : QObject(parent)
+PacmanExec::PacmanExec(QObject *parent) : QObject(parent), m_textPrinted(ctn_PRINTED_TEXT_WINDOW)
 {  
   m_unixCommand = new UnixCommand(parent);
   m_iLoveCandy = UnixCommand::isILoveCandyEnabled();
@@ -43,6 +53,10 @@ PacmanExec::PacmanExec(QObject *parent) : QObject(parent)
   m_numberOfPackages = 0;
   m_packageCounter = 0;
   m_errorRetrievingFileCounter = 0;
+  m_localDatabasePath = ctn_PACMAN_DATABASE_DIR + QLatin1String("/local");
+  m_installedPackagesRead = false;
+  m_transactionStartedAt = 0;
+  m_usingHelperSession = false;
   m_listOfDotPacnewFiles.clear();
 
   m_sharedMemory=nullptr;
@@ -99,7 +113,64 @@ bool PacmanExec::isDatabaseLocked()
 int PacmanExec::cancelProcess()
 {
   m_processWasCanceled = true;
-  return (m_unixCommand->cancelProcess(m_sharedMemory));
+
+  if (m_usingHelperSession && HelperClient::instance()->isRunning())
+    return HelperClient::instance()->cancel();
+  else
+    return (m_unixCommand->cancelProcess(m_sharedMemory));
+}
+
+/*
+ * Runs the given command as root thru the persistent octopi-helper session, which streams its output back
+ */
+void PacmanExec::executeWithHelper(const QString &command)
+{
+  HelperClient *client = HelperClient::instance();
+
+  //Another transaction holds the session: this one fails like the helper refuses a second pacman
+  if (client->isRunning())
+  {
+    QMetaObject::invokeMethod(this, "onFinished", Qt::QueuedConnection,
+                              Q_ARG(int, ctn_PACMAN_PROCESS_EXECUTING), Q_ARG(QProcess::ExitStatus, QProcess::NormalExit));
+    return;
+  }
+
+  m_usingHelperSession = true;
+  QObject::connect(client, SIGNAL(started()), this, SLOT(onStarted()));
+  QObject::connect(client, SIGNAL(output(QString)), this, SLOT(onHelperOutput(QString)));
+  QObject::connect(client, SIGNAL(finished(int, QProcess::ExitStatus)),
+                   this, SLOT(onFinished(int, QProcess::ExitStatus)));
+
+  snapshotInstalledPackages();
+  client->execute(command);
+}
+
+/*
+ * Number of transaction logs kept in ~/.config/octopi/transactions
+ */
+static const int ctn_TRANSACTION_LOG_COUNT = 100;
+
+/*
+ * Number of items listed as the slowest ones in the transaction summary
+ */
+static const int ctn_SLOWEST_ITEMS_COUNT = 3;
+
+/*
+ * "850 ms" or "12.4 s"
+ */
+static QString formatDuration(qint64 msecs)
+{
+  if (msecs < 1000) return QString::number(msecs) + QLatin1String(" ms");
+  else return QString::number(msecs / 1000.0, 'f', 1) + QLatin1String(" s");
+}
+
+/*
+ * Matches the "( 3/12) " order which pacman prints before each package of a transaction
+ */
+static const QRegularExpression& rePackageOrder()
+{
+  static const QRegularExpression re(QStringLiteral("\\(\\s{0,3}[0-9]{1,4}/[0-9]{1,4}\\) "));
+  return re;
 }
 
 /*
@@ -107,15 +178,15 @@ int PacmanExec::cancelProcess()
  */
 bool PacmanExec::searchForKeyVerbs(QString output)
 {
-  return (output.contains(QRegularExpression(QStringLiteral("Arming "))) ||
-          output.contains(QRegularExpression(QStringLiteral("checking "))) ||
-          //output.contains(QRegularExpression("loading ")) ||
-          output.contains(QRegularExpression(QStringLiteral("installing "))) ||
-          output.contains(QRegularExpression(QStringLiteral("upgrading "))) ||
-          output.contains(QRegularExpression(QStringLiteral("downgrading "))) ||
-          //output.contains(QRegularExpression("resolving ")) ||
-          //output.contains(QRegularExpression("looking ")) ||
-          output.contains(QRegularExpression(QStringLiteral("removing "))));
+  return (output.contains(QLatin1String("Arming ")) ||
+          output.contains(QLatin1String("checking ")) ||
+          //output.contains(QLatin1String("loading ")) ||
+          output.contains(QLatin1String("installing ")) ||
+          output.contains(QLatin1String("upgrading ")) ||
+          output.contains(QLatin1String("downgrading ")) ||
+          //output.contains(QLatin1String("resolving ")) ||
+          //output.contains(QLatin1String("looking ")) ||
+          output.contains(QLatin1String("removing ")));
 }
 
 /*
@@ -126,19 +197,29 @@ bool PacmanExec::searchForKeyVerbs(QString output)
  */
 bool PacmanExec::splitOutputStrings(QString output)
 {
+  QElapsedTimer overhead;
+  overhead.start();
   bool res = true;
 
+  if (m_commandExecuting != ectn_RUN_IN_TERMINAL &&
+      m_commandExecuting != ectn_RUN_SYSTEM_UPGRADE_IN_TERMINAL)
+  {
+    QList<TransactionEvent> events;
+    m_progressParser.parse(output, events);
+    emitTransactionEvents(events);
+  }
+
   QString msg = output.trimmed();
-  QStringList msgs = msg.split(QRegularExpression(QStringLiteral("\\n")), Qt::SkipEmptyParts);
+  QStringList msgs = msg.split(QLatin1Char('\n'), Qt::SkipEmptyParts);
 
   for (const QString& m: msgs)
   {
-    QStringList m2 = m.split(QRegularExpression(QStringLiteral("\\(\\s{0,3}[0-9]{1,4}/[0-9]{1,4}\\) ")), Qt::SkipEmptyParts);
+    QStringList m2 = m.split(rePackageOrder(), Qt::SkipEmptyParts);
 
     if (m2.count() == 1)
     {
       //Let's try another test... if it doesn't work, we give up.
-      QStringList maux = m.split(QRegularExpression(QStringLiteral("%")), Qt::SkipEmptyParts);
+      QStringList maux = m.split(QLatin1Char('%'), Qt::SkipEmptyParts);
       if (maux.count() > 1)
       {
         for (QString aux: maux)
@@ -179,6 +260,7 @@ bool PacmanExec::splitOutputStrings(QString output)
     else res = false;
   }
 
+  m_timeline.addOverhead(overhead.nsecsElapsed());
   return res;
 }
 
@@ -198,45 +280,12 @@ void PacmanExec::parsePacmanProcessOutput(const QString &output)
   }
 
   bool continueTesting = false;
-  QString perc;
   QString msg = output;
   QString progressRun;
   QString progressEnd;
 
-  msg.remove(QRegularExpression(QStringLiteral(".+\\[Y/n\\].+")));
-
   //Let's remove color codes from strings...
-  msg.remove(QStringLiteral("\033[0;1m"));
-  msg.remove(QStringLiteral("\033[0m"));
-  msg.remove(QStringLiteral("[1;33m"));
-  msg.remove(QStringLiteral("[00;31m"));
-  msg.remove(QStringLiteral("\033[1;34m"));
-  msg.remove(QStringLiteral("\033[0;1m"));
-  msg.remove(QStringLiteral("[1;1m"));
-  msg.remove(QStringLiteral("[1;0m"));
-  msg.remove(QStringLiteral("[1;m"));
-  msg.remove(QStringLiteral("[1"));
-  msg.remove(QStringLiteral("c"));
-  msg.remove(QStringLiteral("C"));
-  msg.remove(QStringLiteral(""));
-  msg.remove(QStringLiteral("[m[0;37m"));
-  msg.remove(QStringLiteral("o"));
-  msg.remove(QStringLiteral("[m"));
-  msg.remove(QStringLiteral(";31m"));
-  msg.remove(QStringLiteral(";32m"));
-  msg.remove(QStringLiteral(";37m"));
-  msg.remove(QStringLiteral("8;5;243m"));
-  msg.remove(QStringLiteral("[c"));
-  msg.remove(QStringLiteral("[mo"));
-  msg.remove(QStringLiteral("[32m"));
-  msg.remove(QStringLiteral("[33m"));
-  msg.remove(QStringLiteral("(B[m"));
-  msg.remove(QStringLiteral("[?25l"));
-  msg.remove(QStringLiteral("[?25h"));
-  msg.remove(QStringLiteral("[2F"));
-  msg.remove(QStringLiteral("E "));
-  msg.remove(QStringLiteral("F "));
-  msg.remove(QRegularExpression(QStringLiteral("^\\($")));
+  msg = OutputSanitizer::sanitizePacmanOutput(msg);
 
   if (storeMsgCache) msgCache+=msg;
 
@@ -253,12 +302,13 @@ void PacmanExec::parsePacmanProcessOutput(const QString &output)
 
   if (SettingsManager::getShowPackageNumbersOutput())
   {
-    QRegularExpression re(QStringLiteral("Packages? \\(\\d+\\)"));
-    QRegularExpressionMatch match = re.match(msg);
+    static const QRegularExpression rePackageCount(QStringLiteral("Packages? \\(\\d+\\)"));
+    static const QRegularExpression rePackageCountPrefix(QStringLiteral("Packages? \\("));
+    QRegularExpressionMatch match = rePackageCount.match(msg);
     if (match.hasMatch())
     {
       QString aux_packages = match.captured(0);
-      aux_packages.remove(QRegularExpression(QStringLiteral("Packages? \\(")));
+      aux_packages.remove(rePackageCountPrefix);
       aux_packages.remove(QStringLiteral(")"));
       m_numberOfPackages = aux_packages.toInt();
 
@@ -273,7 +323,8 @@ void PacmanExec::parsePacmanProcessOutput(const QString &output)
     msgCache.clear();
 
     //If we ever find a "pacman" package being updated in GUI mode, let's stop this transaction: potential breakage!
-    if (msgCache.contains(QRegularExpression(QStringLiteral(".+Packages? \\(\\d+\\).+pacman-[0-9].+Total Download Size:.+"))))
+    static const QRegularExpression rePacmanUpgrade(QStringLiteral(".+Packages? \\(\\d+\\).+pacman-[0-9].+Total Download Size:.+"));
+    if (msgCache.contains(rePacmanUpgrade))
     {
       cancelProcess();
     }
@@ -302,20 +353,14 @@ void PacmanExec::parsePacmanProcessOutput(const QString &output)
   }
 
   //If it is a percentage, we are talking about curl output...
+  //(the progress bar itself is driven by m_progressParser's events)
   if(msg.indexOf(progressEnd) != -1)
   {
-    perc = QStringLiteral("100%");
-    emit percentage(100);
     continueTesting = true;
   }
 
   if (msg.indexOf(progressRun) != -1 || continueTesting)
   {
-    if (!continueTesting){
-      perc = msg.right(4).trimmed();
-      if (m_debugMode) std::cout << "percentage is: " << perc.toLatin1().data() << std::endl;
-    }
-
     continueTesting = false;
 
     int aux = msg.indexOf(QLatin1String("["));
@@ -328,7 +373,7 @@ void PacmanExec::parsePacmanProcessOutput(const QString &output)
         m_commandExecuting == ectn_REMOVE ||
         m_commandExecuting == ectn_REMOVE_INSTALL)
     {
-      int ini = msg.indexOf(QRegularExpression(QStringLiteral("\\(\\s{0,3}[0-9]{1,4}/[0-9]{1,4}\\) ")));
+      int ini = msg.indexOf(rePackageOrder());
       if (ini == 0)
       {
         int rp = msg.indexOf(QLatin1String(")"));
@@ -393,7 +438,8 @@ void PacmanExec::parsePacmanProcessOutput(const QString &output)
 
             if(!target.isEmpty() && !target.startsWith(QLatin1Char('[')) && !m_textPrinted.contains(target))
             {
-              if (target.indexOf(QRegularExpression(QStringLiteral("[a-z]+"))) != -1)
+              static const QRegularExpression reLowerCaseWord(QStringLiteral("[a-z]+"));
+              if (target.indexOf(reLowerCaseWord) != -1)
               {
                 if(m_commandExecuting == ectn_SYNC_DATABASE && !target.contains(QLatin1String("/")))
                 {
@@ -416,52 +462,28 @@ void PacmanExec::parsePacmanProcessOutput(const QString &output)
       }
     }
 
-    //Here we print the transaction percentage updating
-    if(!perc.isEmpty() && perc.indexOf(QLatin1String("%")) > 0)
-    {
-      int ipercentage = perc.left(perc.size()-1).toInt();
-      emit percentage(ipercentage);
-    }
   }
   //It's another error, so we have to output it
   else
   {
+    static const QRegularExpression reAnnoyingStrings(QStringLiteral(
+          "Don't need password!!|\\(process.+|QXcbConnection: XCB error:.+|Using the fallback.+|Gkr-Message:.+|"
+          "kdesu.+|kbuildsycoca.+|Connecting to deprecated signal.+|QVariant.+|gksu-run.+|GConf Error:.+|:: Do.*|"
+          "org\\.kde\\.|QCommandLineParser|QCoreApplication.+|Fontconfig warning.+|reading configurations from.+|"
+          ".+annot load library.+|libGL error.+|qt5ct:.+|(lxqt|octopi|qt)-sudo:.+|qt.qpa.plugin:.+|qt.qpa.xcb:.+|"
+          "Icon theme \".+|Gtk-Message:.+|\\[K$"));
+    //"[1" is printed when ParallelDownloads is enabled in pacman.conf
+    static const QRegularExpression reTotalAndDownloadNumbers(QStringLiteral("Total|\\[\\d"));
+
     //Let's supress some annoying string bugs...
-    msg.remove(QRegularExpression(QStringLiteral("Don't need password!!")));
-    msg.remove(QRegularExpression(QStringLiteral("\\(process.+")));
-    msg.remove(QRegularExpression(QStringLiteral("QXcbConnection: XCB error:.+")));
-    msg.remove(QRegularExpression(QStringLiteral("Using the fallback.+")));
-    msg.remove(QRegularExpression(QStringLiteral("Gkr-Message:.+")));
-    msg.remove(QRegularExpression(QStringLiteral("kdesu.+")));
-    msg.remove(QRegularExpression(QStringLiteral("kbuildsycoca.+")));
-    msg.remove(QRegularExpression(QStringLiteral("Connecting to deprecated signal.+")));
-    msg.remove(QRegularExpression(QStringLiteral("QVariant.+")));
-    msg.remove(QRegularExpression(QStringLiteral("gksu-run.+")));
-    msg.remove(QRegularExpression(QStringLiteral("GConf Error:.+")));
-    msg.remove(QRegularExpression(QStringLiteral(":: Do.*")));
-    msg.remove(QRegularExpression(QStringLiteral("org\\.kde\\.")));
-    msg.remove(QRegularExpression(QStringLiteral("QCommandLineParser")));
-    msg.remove(QRegularExpression(QStringLiteral("QCoreApplication.+")));
-    msg.remove(QRegularExpression(QStringLiteral("Fontconfig warning.+")));
-    msg.remove(QRegularExpression(QStringLiteral("reading configurations from.+")));
-    msg.remove(QRegularExpression(QStringLiteral(".+annot load library.+")));
-    msg.remove(QRegularExpression(QStringLiteral("libGL error.+")));
-    msg.remove(QRegularExpression(QStringLiteral("qt5ct:.+")));
-    msg.remove(QRegularExpression(QStringLiteral("(lxqt|octopi|qt)-sudo:.+")));
-    msg.remove(QRegularExpression(QStringLiteral("qt.qpa.plugin:.+")));
-    msg.remove(QRegularExpression(QStringLiteral("qt.qpa.xcb:.+")));
-    msg.remove(QRegularExpression(QStringLiteral("Icon theme \".+")));
-    msg.remove(QRegularExpression(QStringLiteral("Gtk-Message:.+")));
-    msg.remove(QRegularExpression(QStringLiteral("\\[K$")));
+    msg.remove(reAnnoyingStrings);
     msg = msg.trimmed();
-    msg.remove(QRegularExpression(QStringLiteral("Total")));
-
-    msg.remove(QRegularExpression(QStringLiteral("\\[\\d"))); //when ParallelDownloads is enabled in pacman.conf
+    msg.remove(reTotalAndDownloadNumbers);
 
     if (m_debugMode) std::cout << "debug: " << msg.toLatin1().data() << std::endl;
 
     QString order;
-    int ini = msg.indexOf(QRegularExpression(QStringLiteral("\\(\\s{0,3}[0-9]{1,4}/[0-9]{1,4}\\) ")));
+    int ini = msg.indexOf(rePackageOrder());
     if (ini == 0)
     {
       int rp = msg.indexOf(QLatin1String(")"));
@@ -473,12 +495,12 @@ void PacmanExec::parsePacmanProcessOutput(const QString &output)
     {
       if (m_textPrinted.contains(msg + QLatin1Char(' '))) return;
 
-      if (msg.contains(QRegularExpression(QStringLiteral("removing")))) //&& !m_textPrinted.contains(msg + " "))
+      if (msg.contains(QLatin1String("removing"))) //&& !m_textPrinted.contains(msg + " "))
       {
         //Does this package exist or is it a proccessOutput buggy string???
         QString pkgName = msg.mid(9).trimmed();
 
-        if (pkgName.indexOf(QLatin1String("...")) != -1 || UnixCommand::isPackageInstalled(pkgName))
+        if (pkgName.indexOf(QLatin1String("...")) != -1 || isPackageInstalled(pkgName))
         {
           m_parsingAPackageChange = true;
           prepareTextToPrint(QLatin1String("<b><font color=\"#E55451\">") + msg + QLatin1String("</font></b>")); //RED
@@ -502,8 +524,6 @@ void PacmanExec::parsePacmanProcessOutput(const QString &output)
           if (m_commandExecuting == ectn_SYNC_DATABASE &&
               msg.contains(QLatin1String("is up to date")) && msg != QLatin1String("is up to date"))
           {
-            emit percentage(100);
-
             int blank = msg.indexOf(QLatin1String(" "));
             QString repo = msg.left(blank);
 
@@ -520,7 +540,8 @@ void PacmanExec::parsePacmanProcessOutput(const QString &output)
           }
           else if (m_commandExecuting == ectn_INSTALL || m_commandExecuting == ectn_REMOVE || m_commandExecuting == ectn_SYSTEM_UPGRADE)
           {
-            if (!altMsg.contains(QRegularExpression(QStringLiteral("\\s"))) && altMsg.contains(QStringLiteral("-")))
+            static const QRegularExpression reSpace(QStringLiteral("\\s"));
+            if (!altMsg.contains(reSpace) && altMsg.contains(QStringLiteral("-")))
             {
               prepareTextToPrint(QLatin1String("<b><font color=\"#b4ab58\">") +
                                 altMsg + QLatin1String("</font></b>")); //#C9BE62
@@ -549,6 +570,164 @@ str.contains(QStringLiteral(":: Running pre-transaction hooks")) ||
 str.contains(QStringLiteral(":: Processing package changes"));
 }
 
+/*
+ * Keeps the names of the packages found in the local database
+ */
+void PacmanExec::readInstalledPackages()
+{
+  m_installedPackages.clear();
+  const QStringList dirs = QDir(m_localDatabasePath).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+
+  for (const QString &dir: dirs)
+  {
+    //Each directory is named <pkgname>-<pkgver>-<pkgrel>
+    int dash = dir.lastIndexOf(QLatin1Char('-'));
+    if (dash > 0) dash = dir.lastIndexOf(QLatin1Char('-'), dash-1);
+    if (dash > 0) m_installedPackages.insert(dir.left(dash));
+  }
+
+  m_installedPackagesRead = true;
+}
+
+/*
+ * Transactions which may remove packages need the installed ones before the command is sent,
+ * as started() may only arrive once pacman is already removing them
+ */
+void PacmanExec::snapshotInstalledPackages()
+{
+  m_installedPackagesRead = false;
+  if (m_commandExecuting == ectn_REMOVE || m_commandExecuting == ectn_REMOVE_INSTALL ||
+      m_commandExecuting == ectn_INSTALL || m_commandExecuting == ectn_SYSTEM_UPGRADE)
+    readInstalledPackages();
+}
+
+/*
+ * Tells whether a "removing" line names a real package, without running "pacman -Q" for each of them
+ *
+ * The names come from the local database as it was before the transaction was sent
+ */
+bool PacmanExec::isPackageInstalled(const QString &pkgName)
+{
+  if (!m_installedPackagesRead) readInstalledPackages();
+
+  return m_installedPackages.contains(pkgName);
+}
+
+/*
+ * Forwards the events of m_progressParser to the UI
+ */
+void PacmanExec::emitTransactionEvents(const QList<TransactionEvent> &events)
+{
+  const qint64 msecs = (m_transactionTimer.isValid() ? m_transactionTimer.elapsed() : 0);
+
+  for (const TransactionEvent &event: events)
+  {
+    m_timeline.addEvent(event, msecs);
+
+    if (m_debugMode) std::cout << "_event: " << event.type << " phase " << event.phase << " (" << event.current << "/" <<
+                                  event.total << ") " << event.percent << "% " << event.text.toLatin1().data() << std::endl;
+
+    if (event.percent >= 0) emit percentage(event.percent);
+    emit transactionEvent(event);
+  }
+}
+
+/*
+ * Prints a table with the time, items, warnings and errors of each phase of the transaction
+ */
+void PacmanExec::printTransactionSummary()
+{
+  const QList<TransactionPhaseTime> &phases = m_timeline.phases();
+  if (phases.isEmpty()) return;
+
+  const QList<TransactionPhaseSummary> &summary = m_progressParser.summary();
+  const QString cell = QStringLiteral("<td align=\"right\">%1</td>");
+
+  QString html = QLatin1String("<br><b>") + StrConstants::getTransactionSummary() + QLatin1String("</b><br>");
+  html += QLatin1String("<table border=\"0\" cellpadding=\"2\"><tr><th align=\"left\">") + StrConstants::getTransactionPhase() +
+      QLatin1String("</th><th align=\"right\">") + StrConstants::getTransactionTime() +
+      QLatin1String("</th><th align=\"right\">") + StrConstants::getTransactionItems() +
+      QLatin1String("</th><th align=\"right\">") + StrConstants::getTransactionWarnings() +
+      QLatin1String("</th><th align=\"right\">") + StrConstants::getTransactionErrors() + QLatin1String("</th></tr>");
+
+  for (const TransactionPhaseTime &phase: phases)
+  {
+    int items = 0, warnings = 0, errors = 0;
+    for (const TransactionPhaseSummary &s: summary)
+    {
+      if (s.phase != phase.phase) continue;
+      items = s.items;
+      warnings = s.warnings;
+      errors = s.errors;
+      break;
+    }
+
+    html += QLatin1String("<tr><td>") + phase.label.toHtmlEscaped() + QLatin1String("</td>") +
+        cell.arg(formatDuration(phase.end - phase.start)) + cell.arg(items) + cell.arg(warnings) + cell.arg(errors) +
+        QLatin1String("</tr>");
+  }
+
+  html += QLatin1String("<tr><td>") + StrConstants::getTransactionOverhead() + QLatin1String("</td>") +
+      cell.arg(formatDuration(m_timeline.overhead())) + QLatin1String("<td></td><td></td><td></td></tr>");
+  html += QLatin1String("<tr><td><b>") + StrConstants::getTransactionTotal() + QLatin1String("</b></td>") +
+      cell.arg(QLatin1String("<b>") + formatDuration(m_timeline.duration()) + QLatin1String("</b>")) +
+      QLatin1String("<td></td><td></td><td></td></tr></table>");
+
+  //The packages, downloads and hooks which took longest
+  QList<TransactionItemTime> items = m_timeline.items();
+  std::sort(items.begin(), items.end(), [](const TransactionItemTime &a, const TransactionItemTime &b) {
+    return (a.end - a.start) > (b.end - b.start);
+  });
+
+  QStringList slowest;
+  for (int i=0; i<items.count() && i<ctn_SLOWEST_ITEMS_COUNT; ++i)
+  {
+    if (items.at(i).end == items.at(i).start) break;
+    slowest << items.at(i).name.toHtmlEscaped() + QLatin1String(" (") + formatDuration(items.at(i).end - items.at(i).start) +
+               QLatin1Char(')');
+  }
+
+  if (!slowest.isEmpty())
+    html += StrConstants::getTransactionSlowestItems() + QLatin1Char(' ') + slowest.join(QLatin1String(", ")) + QLatin1String("<br>");
+
+  prepareTextToPrint(html, ectn_DONT_TREAT_STRING, ectn_DONT_TREAT_URL_LINK);
+}
+
+/*
+ * Returns the name under which the given command is recorded in the transaction logs
+ */
+QString PacmanExec::commandName(CommandExecuting command)
+{
+  switch (command)
+  {
+    case ectn_NONE: return QStringLiteral("none");
+    case ectn_CHECK_UPDATES: return QStringLiteral("check_updates");
+    case ectn_MIRROR_CHECK: return QStringLiteral("mirror_check");
+    case ectn_SYNC_DATABASE: return QStringLiteral("sync_database");
+    case ectn_SYSTEM_UPGRADE: return QStringLiteral("system_upgrade");
+    case ectn_INSTALL: return QStringLiteral("install");
+    case ectn_REMOVE: return QStringLiteral("remove");
+    case ectn_CHANGE_INSTALL_REASON: return QStringLiteral("change_install_reason");
+    case ectn_REMOVE_INSTALL: return QStringLiteral("remove_install");
+    case ectn_REMOVE_KCP_PKG: return QStringLiteral("remove_kcp_pkg");
+    case ectn_RUN_SYSTEM_UPGRADE_IN_TERMINAL: return QStringLiteral("run_system_upgrade_in_terminal");
+    case ectn_RUN_IN_TERMINAL: return QStringLiteral("run_in_terminal");
+    case ectn_INSTALL_YAY: return QStringLiteral("install_yay");
+    case ectn_SYSINFO: return QStringLiteral("sysinfo");
+  }
+
+  return QStringLiteral("unknown");
+}
+
+/*
+ * Writes m_timeline as JSON lines to ~/.config/octopi/transactions/<start time>.jsonl, keeping only the latest logs
+ */
+void PacmanExec::writeTransactionLog(int exitCode)
+{
+  m_timeline.writeLog(QDir::homePath() + QDir::separator() + QLatin1String(".config/octopi/transactions"),
+                      commandName(m_commandExecuting), m_transactionStartedAt, exitCode, ctn_TRANSACTION_LOG_COUNT);
+}
+
 /*
  * Prepares a string parsed from pacman output to be printed by the UI
  */
@@ -563,11 +742,17 @@ void PacmanExec::prepareTextToPrint(QString str, TreatString ts, TreatURLLinks t
   }
 
   //If the string waiting to be printed is from curl status OR any other unwanted string...
-  if (!str.contains(QRegularExpression(QStringLiteral("<font color"))))
-    if ((str.contains(QRegularExpression(QStringLiteral("\\(\\d"))) &&
+  static const QRegularExpression reOpenParenthesisDigit(QStringLiteral("\\(\\d"));
+  static const QRegularExpression reDigitCloseParenthesis(QStringLiteral("\\d\\)"));
+  static const QRegularExpression reRemovingPackage(QStringLiteral("removing \\S+$"));
+  static const QRegularExpression reInstallingPackage(QStringLiteral("(installing|upgrading) \\S+$"));
+  static const QRegularExpression rePacnewFile(QStringLiteral("installed as \\S+.pacnew"));
+
+  if (!str.contains(QLatin1String("<font color")))
+    if ((str.contains(reOpenParenthesisDigit) &&
          (!str.contains(QLatin1String("target"), Qt::CaseInsensitive)) &&
          (!str.contains(QLatin1String("package"), Qt::CaseInsensitive))) ||
-        (str.contains(QRegularExpression(QStringLiteral("\\d\\)"))) &&
+        (str.contains(reDigitCloseParenthesis) &&
          (!str.contains(QLatin1String("target"), Qt::CaseInsensitive)) &&
          (!str.contains(QLatin1String("package"), Qt::CaseInsensitive))) ||
 
@@ -588,7 +773,7 @@ void PacmanExec::prepareTextToPrint(QString str, TreatString ts, TreatURLLinks t
   QString newStr = str;
 
   //If the string has already been colored...
-  if(newStr.contains(QRegularExpression(QStringLiteral("<font color"))))
+  if(newStr.contains(QLatin1String("<font color")))
   {
     newStr += QLatin1String("<br>");
   }
@@ -604,12 +789,12 @@ void PacmanExec::prepareTextToPrint(QString str, TreatString ts, TreatURLLinks t
        newStr.contains(StrConstants::getCommandFinishedWithErrors()))
     {
       newStr = newStr.trimmed();
-      if (newStr.contains(QRegularExpression(QStringLiteral("removing \\S+$"))))
+      if (newStr.contains(reRemovingPackage))
       {
         //Does this package exist or is it a proccessOutput buggy string???
         QString pkgName = newStr.mid(9).trimmed();
 
-        if ((pkgName.indexOf(QLatin1String("...")) == -1) || UnixCommand::isPackageInstalled(pkgName))
+        if ((pkgName.indexOf(QLatin1String("...")) == -1) || isPackageInstalled(pkgName))
         {
           m_parsingAPackageChange = true;
         }
@@ -635,7 +820,7 @@ void PacmanExec::prepareTextToPrint(QString str, TreatString ts, TreatURLLinks t
             newStr.contains("loading "))*/
     {
       newStr = newStr.trimmed();
-      if (newStr.contains(QRegularExpression(QStringLiteral("installing \\S+$"))) || newStr.contains(QRegularExpression(QStringLiteral("upgrading \\S+$"))))
+      if (newStr.contains(reInstallingPackage))
       {
         if (SettingsManager::getShowPackageNumbersOutput())
         {
@@ -669,7 +854,7 @@ void PacmanExec::prepareTextToPrint(QString str, TreatString ts, TreatURLLinks t
         m_packageCounter = 1;
   }
 
-  if (!newStr.contains(QRegularExpression(QStringLiteral("<br")))) //It was an else!
+  if (!newStr.contains(QLatin1String("<br"))) //It was an else!
   {
     newStr += QLatin1String("<br>");
   }
@@ -680,7 +865,7 @@ void PacmanExec::prepareTextToPrint(QString str, TreatString ts, TreatURLLinks t
   if (m_debugMode) std::cout << "_print (end): " << str.toLatin1().data() << std::endl;
 
   //Let's append this string in the list of already printed strings (before we treat package counter code)
-  m_textPrinted.append(str);
+  m_textPrinted.insert(str);
 
   //Package counter code...
   if (SettingsManager::getShowPackageNumbersOutput() && m_commandExecuting != ectn_SYNC_DATABASE && newStr.contains(QLatin1String("#b4ab58")))
@@ -714,7 +899,7 @@ void PacmanExec::prepareTextToPrint(QString str, TreatString ts, TreatURLLinks t
     newStr = QLatin1String("<b><font color=\"#FF8040\">Please check and merge</font></b><br><br>");
 
   //Let's insert in the ".pacnew" messages list if we found one!
-  else if (newStr.contains(QRegularExpression(QStringLiteral("installed as \\S+.pacnew"))))
+  else if (newStr.contains(rePacnewFile))
   {
     if (!m_listOfDotPacnewFiles.contains(newStr))
       m_listOfDotPacnewFiles.append(newStr);
@@ -728,6 +913,11 @@ void PacmanExec::prepareTextToPrint(QString str, TreatString ts, TreatURLLinks t
  */
 void PacmanExec::onStarted()
 {
+  m_progressParser.reset();
+  m_timeline.reset();
+  m_transactionTimer.start();
+  m_transactionStartedAt = QDateTime::currentMSecsSinceEpoch();
+
   //First we output the name of action we are starting to execute!
   if (m_commandExecuting == ectn_CHECK_UPDATES)
   {
@@ -920,6 +1110,19 @@ void PacmanExec::onReadOutputError()
   emit readOutputError();
 }
 
+/*
+ * Output of a transaction run by the octopi-helper session, with stdout and stderr merged
+ */
+void PacmanExec::onHelperOutput(const QString &output)
+{
+  if (!output.trimmed().isEmpty())
+  {
+    splitOutputStrings(output);
+  }
+
+  emit readOutput();
+}
+
 /*
  * Whenever QProcess finishes the pacman command...
  */
@@ -935,6 +1138,36 @@ void PacmanExec::onFinished(int exitCode, QProcess::ExitStatus es)
 
   if (m_processWasCanceled && PacmanExec::isDatabaseLocked()) exitCode = -1;
 
+  //The session outlives this object and serves the next transactions
+  if (m_usingHelperSession)
+  {
+    QObject::disconnect(HelperClient::instance(), nullptr, this, nullptr);
+    m_usingHelperSession = false;
+  }
+
+  QList<TransactionEvent> events;
+  m_progressParser.flush(events);
+  emitTransactionEvents(events);
+
+  if (m_transactionTimer.isValid())
+  {
+    m_timeline.finish(m_transactionTimer.elapsed());
+
+    if (m_commandExecuting == ectn_INSTALL || m_commandExecuting == ectn_REMOVE ||
+        m_commandExecuting == ectn_REMOVE_INSTALL || m_commandExecuting == ectn_SYSTEM_UPGRADE)
+    {
+      printTransactionSummary();
+      writeTransactionLog(exitCode);
+    }
+    else if (m_commandExecuting == ectn_SYNC_DATABASE)
+    {
+      writeTransactionLog(exitCode);
+    }
+
+    if (m_debugMode) std::cout << "Time elapsed in transaction: " << m_timeline.duration() << " ms, reading its output: " <<
+                                  m_timeline.overhead() << " ms" << std::endl;
+  }
+
   emit finished(exitCode, es);
 }
 
@@ -1006,7 +1239,7 @@ void PacmanExec::doChangeInstallReason(const QHash<QString, QString> &listOfPack
   }
 
   m_commandExecuting = ectn_CHANGE_INSTALL_REASON;
-  m_unixCommand->executeCommandWithSharedMemHelper(command, m_sharedMemory);
+  executeWithHelper(command);
 }
 
 /*
@@ -1041,7 +1274,7 @@ void PacmanExec::doInstall(const QString &listOfPackages, const QString &listOfD
   m_lastCommandList.append(QLatin1String("read -n 1 -p \"") + StrConstants::getPressAnyKey() + QLatin1Char('"'));
 
   m_commandExecuting = ectn_INSTALL;
-  m_unixCommand->executeCommandWithSharedMemHelper(command, m_sharedMemory);
+  executeWithHelper(command);
 }
 
 /*
@@ -1112,6 +1345,7 @@ void PacmanExec::doInstallLocal(const QString &listOfPackages)
   m_lastCommandList.append(QLatin1String("read -n 1 -p '") + StrConstants::getPressAnyKey() + QLatin1Char('\''));
 
   m_commandExecuting = ectn_INSTALL;
+  snapshotInstalledPackages();
   m_unixCommand->executeCommand(command);
 }
 
@@ -1185,7 +1419,7 @@ void PacmanExec::doRemove(const QString &listOfPackages)
   m_lastCommandList.append(QLatin1String("read -n 1 -p \"") + StrConstants::getPressAnyKey() + QLatin1Char('"'));
 
   m_commandExecuting = ectn_REMOVE;  
-  m_unixCommand->executeCommandWithSharedMemHelper(command, m_sharedMemory);
+  executeWithHelper(command);
 }
 
 /*
@@ -1242,7 +1476,7 @@ void PacmanExec::doRemoveAndInstall(const QString &listOfPackagestoRemove, const
   m_lastCommandList.append(QLatin1String("read -n 1 -p \"") + StrConstants::getPressAnyKey() + QLatin1Char('"'));
 
   m_commandExecuting = ectn_REMOVE_INSTALL;
-  m_unixCommand->executeCommandWithSharedMemHelper(command, m_sharedMemory);
+  executeWithHelper(command);
 }
 
 /*
@@ -1298,7 +1532,7 @@ void PacmanExec::doSystemUpgrade()
   m_lastCommandList.append(QLatin1String("read -n 1 -p \"") + StrConstants::getPressAnyKey() + QLatin1Char('"'));
 
   m_commandExecuting = ectn_SYSTEM_UPGRADE;
-  m_unixCommand->executeCommandWithSharedMemHelper(command, m_sharedMemory);
+  executeWithHelper(command);
 }
 
 /*
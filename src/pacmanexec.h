@@ -22,9 +22,14 @@
 #define PACMANEXEC_H
 
 #include "constants.h"
+#include "recentstringset.h"
+#include "transactionprogressparser.h"
+#include "transactiontimeline.h"
 #include "unixcommand.h"
 
+#include <QElapsedTimer>
 #include <QObject>
+#include <QSet>
 
 class QSharedMemory;
 
@@ -32,6 +37,8 @@ class PacmanExec : public QObject
 {
   Q_OBJECT
 
+  friend class TestPacmanExec;
+
 private:
   bool m_iLoveCandy;
   bool m_debugMode;
@@ -47,18 +54,38 @@ private:
   UnixCommand *m_unixCommand;
   CommandExecuting m_commandExecuting;
   QStringList m_lastCommandList; //run in terminal commands
-  QStringList m_textPrinted;
+  //Already printed strings, forgotten in printing order once there are too many of them
+  RecentStringSet m_textPrinted;
+  //Packages installed when the transaction started, read from m_localDatabasePath
+  QString m_localDatabasePath;
+  QSet<QString> m_installedPackages;
+  bool m_installedPackagesRead;
+  //Turns pacman's output into the events which drive the progress bar
+  TransactionProgressParser m_progressParser;
+  //Times each phase and package from those events, on a monotonic clock
+  TransactionTimeline m_timeline;
+  QElapsedTimer m_transactionTimer;
+  qint64 m_transactionStartedAt;
   QStringList m_listOfOutatedPackages;
   QStringList m_listOfDotPacnewFiles; //contains the list of "blahblah installed as blahblah.pacnew" occurencies (if any)
 
   bool m_processWasCanceled;
+  //TRUE while the transaction runs thru the persistent octopi-helper session
+  bool m_usingHelperSession;
 
   QSharedMemory *m_sharedMemory;
 
+  void executeWithHelper(const QString &command);
   bool searchForKeyVerbs(QString output);
   bool splitOutputStrings(QString output);
+  void emitTransactionEvents(const QList<TransactionEvent> &events);
+  void printTransactionSummary();
+  void writeTransactionLog(int exitCode);
   void parsePacmanProcessOutput(const QString &output);
   bool criticalPhaseInTransaction(const QString &str);
+  void readInstalledPackages();
+  void snapshotInstalledPackages();
+  bool isPackageInstalled(const QString &pkgName);
   void prepareTextToPrint(QString str, TreatString ts = ectn_TREAT_STRING, TreatURLLinks tl = ectn_TREAT_URL_LINK);
 
 private slots:
@@ -66,6 +93,7 @@ private slots:
   void onStarted();
   void onReadOutput();
   void onReadOutputError();
+  void onHelperOutput(const QString &output);
   void onFinished(int exitCode, QProcess::ExitStatus);
 
 public:
@@ -79,6 +107,7 @@ public:
   void runLatestCommandWithOctopiHelper();
 
   static bool isDatabaseLocked();
+  static QString commandName(CommandExecuting command);
   int cancelProcess();
   void doCheckUpdates();
 
@@ -115,6 +144,7 @@ public:
 
 signals:
   void percentage(int);
+  void transactionEvent(const TransactionEvent&);
   void started();
   void readOutput();
   void readOutputError();
@@ -0,0 +1,158 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "processtable.h"
+
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+
+/*
+ * Milliseconds a scan of /proc is reused
+ */
+static const int ctn_PROCESS_TABLE_MAX_AGE = 250;
+
+QMutex ProcessTable::m_mutex;
+QList<ProcessInfo> ProcessTable::m_processes;
+QElapsedTimer ProcessTable::m_scanTimer;
+
+/*
+ * What "ps -o command" prints: kernel threads have no command line, so their name is shown
+ */
+QString ProcessInfo::commandLine() const
+{
+  if (arguments.isEmpty()) return QLatin1Char('[') + name + QLatin1Char(']');
+  return arguments.join(QLatin1Char(' '));
+}
+
+/*
+ * The processes running now, or at most ctn_PROCESS_TABLE_MAX_AGE ms ago
+ */
+QList<ProcessInfo> ProcessTable::processes()
+{
+  QMutexLocker locker(&m_mutex);
+
+  if (!m_scanTimer.isValid() || m_scanTimer.elapsed() > ctn_PROCESS_TABLE_MAX_AGE)
+  {
+    m_processes = scan(QStringLiteral("/proc"));
+    m_scanTimer.start();
+  }
+
+  return m_processes;
+}
+
+/*
+ * Reads every numeric directory of procRoot ("/proc", or any tree laid out like it)
+ */
+QList<ProcessInfo> ProcessTable::scan(const QString &procRoot)
+{
+  QList<ProcessInfo> res;
+  QDir dir(procRoot);
+  const QStringList entries = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+
+  for (const QString &entry: entries)
+  {
+    bool ok;
+    const qint64 pid = entry.toLongLong(&ok);
+    if (!ok) continue;
+
+    //The process may have exited since the directory was listed
+    QFile comm(procRoot + QLatin1Char('/') + entry + QLatin1String("/comm"));
+    if (!comm.open(QIODevice::ReadOnly)) continue;
+
+    ProcessInfo info;
+    info.pid = pid;
+    info.name = QString::fromUtf8(comm.readAll()).trimmed();
+
+    QFile cmdline(procRoot + QLatin1Char('/') + entry + QLatin1String("/cmdline"));
+    if (cmdline.open(QIODevice::ReadOnly))
+    {
+      QByteArray data = cmdline.readAll();
+      if (data.endsWith('\0')) data.chop(1);
+
+      if (!data.isEmpty())
+      {
+        const QList<QByteArray> parts = data.split('\0');
+        for (const QByteArray &part: parts)
+          info.arguments.append(QString::fromUtf8(part));
+      }
+    }
+
+    res.append(info);
+  }
+
+  return res;
+}
+
+/*
+ * Makes the next query read /proc again
+ */
+void ProcessTable::invalidate()
+{
+  QMutexLocker locker(&m_mutex);
+  m_scanTimer.invalidate();
+}
+
+/*
+ * How many processes are called name, like "ps -C name" lists them
+ */
+int ProcessTable::count(const QString &name)
+{
+  int res = 0;
+  const QList<ProcessInfo> list = processes();
+
+  for (const ProcessInfo &info: list)
+  {
+    if (info.name == name) ++res;
+  }
+
+  return res;
+}
+
+/*
+ * The command lines of the processes called name, like "ps -C name -o command" prints them
+ */
+QStringList ProcessTable::commandLines(const QString &name)
+{
+  QStringList res;
+  const QList<ProcessInfo> list = processes();
+
+  for (const ProcessInfo &info: list)
+  {
+    if (info.name == name) res.append(info.commandLine());
+  }
+
+  return res;
+}
+
+/*
+ * Whether any process has text in its name or command line, like searching "ps -aux" output
+ */
+bool ProcessTable::hasCommandLineContaining(const QString &text)
+{
+  const QList<ProcessInfo> list = processes();
+
+  for (const ProcessInfo &info: list)
+  {
+    if (info.name.contains(text) || info.commandLine().contains(text)) return true;
+  }
+
+  return false;
+}
@@ -0,0 +1,62 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef PROCESSTABLE_H
+#define PROCESSTABLE_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+struct ProcessInfo
+{
+  qint64 pid;
+  QString name;          // /proc/<pid>/comm: what "ps -C" matches, at most 15 chars
+  QStringList arguments; // /proc/<pid>/cmdline
+
+  QString commandLine() const;
+};
+
+/*
+ * @brief The running processes, read straight from /proc instead of spawning "ps"
+ *
+ * The table is read again when it is older than a few hundred milliseconds, so a burst of checks
+ * costs a single scan. Whoever has just started or stopped a process it cares about calls invalidate().
+ */
+class ProcessTable
+{
+private:
+  static QMutex m_mutex;
+  static QList<ProcessInfo> m_processes;
+  static QElapsedTimer m_scanTimer;
+
+public:
+  static QList<ProcessInfo> processes();
+  static QList<ProcessInfo> scan(const QString &procRoot);
+  static void invalidate();
+
+  static int count(const QString &name);
+  static QStringList commandLines(const QString &name);
+  static bool hasCommandLineContaining(const QString &text);
+};
+
+#endif // PROCESSTABLE_H
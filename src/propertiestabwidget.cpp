@@ -25,6 +25,7 @@
 #include "termwidget.h"
 #include "uihelper.h"
 #include "treeviewpackagesitemdelegate.h"
+#include "src/model/packagefilemodel.h"
 
 #include <QObject>
 #include <QTabBar>
@@ -89,7 +90,7 @@ void PropertiesTabWidget::initTabFiles()
   gridLayoutX->setSpacing ( 0 );
   gridLayoutX->setContentsMargins(0, 0, 0, 0);
 
-  QStandardItemModel *modelPkgFileList = new QStandardItemModel(this);
+  PackageFileModel *modelPkgFileList = new PackageFileModel(this);
   m_tvPkgFileList = new QTreeView(tabPkgFileList);
   m_tvPkgFileList->setEditTriggers(QAbstractItemView::NoEditTriggers);
   m_tvPkgFileList->setDropIndicatorShown(false);
@@ -101,10 +102,9 @@ void PropertiesTabWidget::initTabFiles()
   m_tvPkgFileList->setFrameShape(QFrame::NoFrame);
   m_tvPkgFileList->setFrameShadow(QFrame::Plain);
   m_tvPkgFileList->setObjectName(QStringLiteral("tvPkgFileList"));
+  m_tvPkgFileList->setUniformRowHeights(true);
   //m_tvPkgFileList->setStyleSheet(StrConstants::getTreeViewCSS());
 
-  modelPkgFileList->setSortRole(0);
-  modelPkgFileList->setColumnCount(0);
   gridLayoutX->addWidget(m_tvPkgFileList, 0, 0, 1, 1);
   m_tvPkgFileList->setModel(modelPkgFileList);
 
@@ -0,0 +1,47 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "recentstringset.h"
+
+RecentStringSet::RecentStringSet(int capacity): m_capacity(capacity)
+{
+}
+
+/*
+ * Adds str, unless it is already there, forgetting the oldest string when the set is full
+ */
+void RecentStringSet::insert(const QString &str)
+{
+  if (m_strings.contains(str)) return;
+
+  m_strings.insert(str);
+  m_order.enqueue(str);
+
+  if (m_order.count() > m_capacity)
+  {
+    m_strings.remove(m_order.dequeue());
+  }
+}
+
+void RecentStringSet::clear()
+{
+  m_strings.clear();
+  m_order.clear();
+}
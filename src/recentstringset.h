@@ -0,0 +1,51 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef RECENTSTRINGSET_H
+#define RECENTSTRINGSET_H
+
+#include <QQueue>
+#include <QSet>
+#include <QString>
+
+/*
+ * @brief A set which only remembers the latest distinct strings inserted in it
+ *
+ * Once it holds capacity strings, inserting a new one forgets the oldest.
+ */
+class RecentStringSet
+{
+public:
+  explicit RecentStringSet(int capacity);
+
+  bool contains(const QString& str) const { return m_strings.contains(str); }
+  void insert(const QString& str);
+  void clear();
+
+  int count() const { return m_order.count(); }
+  int capacity() const { return m_capacity; }
+
+private:
+  QSet<QString> m_strings;
+  QQueue<QString> m_order;  // m_strings in insertion order
+  int m_capacity;
+};
+
+#endif // RECENTSTRINGSET_H
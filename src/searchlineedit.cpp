@@ -48,6 +48,7 @@ SearchLineEdit::SearchLineEdit(QWidget *parent, bool hasSLocate) :
   m_defaultValidator = new QRegularExpressionValidator(QRegularExpression(QStringLiteral("[a-zA-Z0-9_\\-\\$\\^\\*\\+\\(\\)\\[\\]\\.\\s\\\\]+")), this);
   m_aurValidator = new QRegularExpressionValidator(QRegularExpression(QStringLiteral("[a-zA-Z0-9_\\-\\$\\^\\+\\s]+")), this); //\\\\]+")), this);
   m_fileValidator = new QRegularExpressionValidator(QRegularExpression(QStringLiteral("[a-zA-Z0-9_\\-\\/\\.]+")), this);
+  m_remoteFileValidator = new QRegularExpressionValidator(QRegularExpression(QStringLiteral("[a-zA-Z0-9_\\-\\/\\.\\$\\^\\*\\+\\?\\(\\)\\[\\]\\{\\}\\|\\\\]+")), this);
   setValidator(m_defaultValidator);
 
   // Update the search button when the text changes
@@ -68,6 +69,8 @@ void SearchLineEdit::setRefreshValidator(ValidatorType validatorType)
     setValidator(m_aurValidator);
   else if (validatorType == ectn_FILE_VALIDATOR)
     setValidator(m_fileValidator);
+  else if (validatorType == ectn_REMOTE_FILE_VALIDATOR)
+    setValidator(m_remoteFileValidator);
   else if (validatorType == ectn_DEFAULT_VALIDATOR)
     setValidator(m_defaultValidator);
 
@@ -98,6 +101,17 @@ void SearchLineEdit::refreshCompleterData()
   }
 }
 
+/*
+ * Replaces completer data used in QLineEdit with the given suggestions
+ */
+void SearchLineEdit::setCompleterData(const QStringList &suggestions)
+{
+  if (suggestions.count() > 0)
+  {
+    m_completerModel->setStringList(suggestions);
+  }
+}
+
 void SearchLineEdit::resizeEvent(QResizeEvent *event)
 {
   Q_UNUSED(event)
@@ -16,7 +16,7 @@ class QValidator;
 class QCompleter;
 class QStringListModel;
 
-enum ValidatorType { ectn_AUR_VALIDATOR, ectn_FILE_VALIDATOR, ectn_DEFAULT_VALIDATOR };
+enum ValidatorType { ectn_AUR_VALIDATOR, ectn_FILE_VALIDATOR, ectn_REMOTE_FILE_VALIDATOR, ectn_DEFAULT_VALIDATOR };
 
 class SearchLineEdit : public QLineEdit
 {
@@ -30,6 +30,7 @@ private:
   QValidator *m_defaultValidator;
   QValidator *m_aurValidator;
   QValidator *m_fileValidator;
+  QValidator *m_remoteFileValidator;
   QToolButton *m_SearchButton;
 
   QString styleSheetForCurrentState();
@@ -48,6 +49,7 @@ public:
   inline void initStyleSheet(){ setStyleSheet(styleSheetForCurrentState()); }
   void setRefreshValidator(ValidatorType validatorType);
   void refreshCompleterData();
+  void setCompleterData(const QStringList& suggestions);
 
 public slots:
   void setFoundStyle();
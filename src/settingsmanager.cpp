@@ -722,6 +722,45 @@ bool SettingsManager::isInstantSearchSelected()
   return (p_instance.getSYSsettings()->value(ctn_KEY_INSTANT_SEARCH, true)).toBool();
 }
 
+bool SettingsManager::isFuzzySearchSelected()
+{
+  SettingsManager p_instance;
+  return (p_instance.getSYSsettings()->value(ctn_KEY_FUZZY_SEARCH, false)).toBool();
+}
+
+/*
+ * Number of packages above which the package list filter is split among all CPU cores
+ */
+int SettingsManager::getParallelFilterThreshold()
+{
+  int n = instance()->getSYSsettings()->value(ctn_KEY_PARALLEL_FILTER_THRESHOLD, 4000).toInt();
+  if (n < 0) n = 0;
+
+  return n;
+}
+
+/*
+ * Milliseconds the instant search waits for the user to stop typing before filtering the package list
+ */
+int SettingsManager::getFilterDelay()
+{
+  int n = instance()->getSYSsettings()->value(ctn_KEY_FILTER_DELAY, 150).toInt();
+  if (n < 0) n = 0;
+
+  return n;
+}
+
+/*
+ * Number of lines the Output tab keeps (0 keeps them all). The full output is in ~/.config/octopi/output.log
+ */
+int SettingsManager::getOutputMaxLines()
+{
+  int n = instance()->getSYSsettings()->value(ctn_KEY_OUTPUT_MAX_LINES, 5000).toInt();
+  if (n < 0) n = 0;
+
+  return n;
+}
+
 void SettingsManager::setCurrentTabIndex(int newValue){
   instance()->getSYSsettings()->setValue(ctn_KEY_CURRENT_TAB_INDEX, newValue);
   instance()->getSYSsettings()->sync();
@@ -937,6 +976,12 @@ void SettingsManager::setShowStopTransaction(bool newValue)
   instance()->getSYSsettings()->sync();
 }
 
+void SettingsManager::setOutputMaxLines(int newValue)
+{
+  instance()->getSYSsettings()->setValue(ctn_KEY_OUTPUT_MAX_LINES, newValue);
+  instance()->getSYSsettings()->sync();
+}
+
 void SettingsManager::setAURTool(const QString &newValue)
 {
   instance()->getSYSsettings()->setValue(ctn_KEY_AUR_TOOL, newValue);
@@ -1052,6 +1097,12 @@ void SettingsManager::setInstantSearchSelected(bool newValue)
   instance()->getSYSsettings()->sync();
 }
 
+void SettingsManager::setFuzzySearchSelected(bool newValue)
+{
+  instance()->getSYSsettings()->setValue(ctn_KEY_FUZZY_SEARCH, newValue);
+  instance()->getSYSsettings()->sync();
+}
+
 void SettingsManager::setConsoleFontSize(int newValue)
 {
   instance()->getSYSsettings()->setValue(ctn_KEY_CONSOLE_SIZE, newValue);
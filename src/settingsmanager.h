@@ -138,6 +138,10 @@ class SettingsManager
     static QByteArray getSplitterHorizontalState();
 
     static bool isInstantSearchSelected();
+    static bool isFuzzySearchSelected();
+    static int getParallelFilterThreshold();
+    static int getFilterDelay();
+    static int getOutputMaxLines();
 
     static void setCurrentTabIndex(int newValue);
     static void setPanelOrganizing(int newValue);
@@ -185,6 +189,7 @@ class SettingsManager
 
     static void setShowPackageNumbersOutput(bool newValue);
     static void setShowStopTransaction(bool newValue);
+    static void setOutputMaxLines(int newValue);
 
     static void setAURTool(const QString &newValue);
     static void setAUROverwriteParam(bool newValue);
@@ -201,6 +206,7 @@ class SettingsManager
     static void setEnableInternetChecking(bool newValue);
     static void setSUTool(const QString& newValue);
     static void setInstantSearchSelected(bool newValue);
+    static void setFuzzySearchSelected(bool newValue);
     static void setConsoleFontSize(int newValue);
     static void setTerminalColorScheme(const QString& newValue);
     static void setTerminalFontFamily(const QString& newValue);
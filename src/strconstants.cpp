@@ -574,6 +574,42 @@ QString StrConstants::getIsUpToDate(){
   return QStringLiteral("is up to date");
 }
 
+QString StrConstants::getTransactionSummary(){
+  return QObject::tr("Transaction summary");
+}
+
+QString StrConstants::getTransactionPhase(){
+  return QObject::tr("Phase");
+}
+
+QString StrConstants::getTransactionTime(){
+  return QObject::tr("Time");
+}
+
+QString StrConstants::getTransactionItems(){
+  return QObject::tr("Items");
+}
+
+QString StrConstants::getTransactionWarnings(){
+  return QObject::tr("Warnings");
+}
+
+QString StrConstants::getTransactionErrors(){
+  return QObject::tr("Errors");
+}
+
+QString StrConstants::getTransactionOverhead(){
+  return QObject::tr("Octopi (reading output)");
+}
+
+QString StrConstants::getTransactionTotal(){
+  return QObject::tr("Total");
+}
+
+QString StrConstants::getTransactionSlowestItems(){
+  return QObject::tr("Slowest items:");
+}
+
 QString StrConstants::getSysInfoGenerated()
 {
   return QObject::tr("SysInfo file generated on: %1<br>If you wish, post the output in your distro's forum for help.");
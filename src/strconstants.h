@@ -139,6 +139,15 @@ public:
   static QString getSyncDatabase();
   static QString getSyncDatabases();
   static QString getIsUpToDate();
+  static QString getTransactionSummary();
+  static QString getTransactionPhase();
+  static QString getTransactionTime();
+  static QString getTransactionItems();
+  static QString getTransactionWarnings();
+  static QString getTransactionErrors();
+  static QString getTransactionOverhead();
+  static QString getTransactionTotal();
+  static QString getTransactionSlowestItems();
   static QString getSysInfoGenerated();
   static QString getSystemUpgradeMsg();
   static QString getChangingInstallReason();
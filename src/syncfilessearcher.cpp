@@ -0,0 +1,391 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "syncfilessearcher.h"
+#include "constants.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <archive.h>
+#include <archive_entry.h>
+#include <cstring>
+
+/*
+ * This searcher answers the "By file (remote)" search without running pacman -F
+ */
+
+static const int ctn_ARCHIVE_BLOCK_SIZE = 64 * 1024;
+static const quint32 ctn_INDEX_MAGIC = 0x4F53594E; //"OSYN"
+static const quint32 ctn_INDEX_VERSION = 1;
+
+namespace {
+
+struct EntryHeader
+{
+  quint16 shared;      // bytes taken from the previous path of the same package
+  quint16 suffixSize;  // bytes which follow this header
+};
+
+}
+
+QMutex SyncFilesSearcher::s_mutex;
+QHash<QString, SyncFilesSearcher::TRepositoryIndex> SyncFilesSearcher::s_indexes;
+
+/*
+ * Appends path to entries, sharing its beginning with previous
+ */
+static void encodeEntry(QByteArray &entries, const QByteArray &previous, const QByteArray &path)
+{
+  int shared = 0;
+  const int maxShared = qMin(qMin(previous.size(), path.size()), 0xFFFF);
+  while (shared < maxShared && previous.at(shared) == path.at(shared)) ++shared;
+
+  EntryHeader header;
+  header.shared = static_cast<quint16>(shared);
+  header.suffixSize = static_cast<quint16>(qMin(path.size() - shared, 0xFFFF));
+
+  entries.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  entries.append(path.constData() + shared, header.suffixSize);
+}
+
+/*
+ * Rebuilds in path the entry stored at pos, and returns the position of the next one
+ */
+static int decodeEntry(const QByteArray &entries, int pos, QByteArray &path)
+{
+  EntryHeader header;
+  std::memcpy(&header, entries.constData() + pos, sizeof(header));
+  pos += static_cast<int>(sizeof(header));
+
+  path.truncate(header.shared);
+  path.append(entries.constData() + pos, header.suffixSize);
+
+  return pos + header.suffixSize;
+}
+
+/*
+ * Like pacman -F, anything with a slash is a path ("usr/bin/ls" or "/usr/bin/ls") searched as is,
+ * and a plain name is compared with the file names. Any regex character turns the query into a
+ * regex, matched against the whole path
+ */
+SyncFilesQueryType SyncFilesSearcher::getQueryType(const QString &query)
+{
+  static const QRegularExpression regexChars(QStringLiteral("[\\^\\$\\*\\+\\?\\(\\)\\[\\]\\{\\}\\|\\\\]"));
+
+  if (query.contains(regexChars)) return ectn_REGEX_QUERY;
+  else if (query.contains(QLatin1Char('/'))) return ectn_EXACT_PATH_QUERY;
+  else return ectn_BASENAME_QUERY;
+}
+
+/*
+ * Searches query in every .files database of /var/lib/pacman/sync
+ */
+QList<SyncFileMatch> SyncFilesSearcher::search(const QString &query)
+{
+  return searchDirectory(ctn_PACMAN_DATABASE_DIR + QLatin1String("/sync"), query);
+}
+
+/*
+ * Searches query in every .files database of syncDirPath, each one in a worker of a pool of its own
+ *
+ * This usually runs as a task of the global thread pool, so its workers must not wait for a thread there
+ */
+QList<SyncFileMatch> SyncFilesSearcher::searchDirectory(const QString &syncDirPath, const QString &query)
+{
+  QList<SyncFileMatch> res;
+  if (query.isEmpty()) return res;
+
+  QDir syncDir(syncDirPath);
+  const QStringList databases = syncDir.entryList(QStringList() << QStringLiteral("*.files"), QDir::Files, QDir::Name);
+  QList<QFuture<QList<SyncFileMatch> > > workers;
+  QThreadPool pool;
+
+  for (const QString &database: databases)
+  {
+    workers << QtConcurrent::run(&pool, &SyncFilesSearcher::searchRepository, syncDir.filePath(database), query);
+  }
+
+  for (QFuture<QList<SyncFileMatch> > &worker: workers)
+  {
+    res << worker.result();
+  }
+
+  return res;
+}
+
+/*
+ * Releases the indexes kept in memory, after the sync databases changed. The ones saved in
+ * ~/.cache/octopi are checked against their .files database when they are read again
+ */
+void SyncFilesSearcher::invalidate()
+{
+  QMutexLocker locker(&s_mutex);
+  s_indexes.clear();
+}
+
+QList<SyncFileMatch> SyncFilesSearcher::searchRepository(const QString &filesDatabase, const QString &query)
+{
+  QList<SyncFileMatch> res;
+  const TRepositoryIndex index = getIndex(filesDatabase);
+  if (!index) return res;
+
+  const QString repository = QFileInfo(filesDatabase).completeBaseName();
+  const SyncFilesQueryType type = getQueryType(query);
+  QByteArray target = query.toUtf8();
+  QRegularExpression regex;
+
+  if (type == ectn_EXACT_PATH_QUERY)
+  {
+    if (target.startsWith('/')) target.remove(0, 1);
+  }
+  else if (type == ectn_REGEX_QUERY)
+  {
+    regex.setPattern(query);
+    if (!regex.isValid()) return res;
+    regex.optimize();
+  }
+
+  const std::vector<quint32> &starts = index->packageStarts;
+  size_t package = 0;
+  int pos = 0;
+  QByteArray path;
+
+  while (pos < index->paths.size())
+  {
+    while (package+1 < starts.size() && starts[package+1] <= static_cast<quint32>(pos)) ++package;
+    pos = decodeEntry(index->paths, pos, path);
+
+    bool matched = false;
+
+    switch (type)
+    {
+      case ectn_EXACT_PATH_QUERY:
+        matched = (path == target);
+        break;
+      case ectn_BASENAME_QUERY:
+        matched = (path.endsWith(target) &&
+                   (path.size() == target.size() || path.at(path.size() - target.size() - 1) == '/'));
+        break;
+      case ectn_REGEX_QUERY:
+        matched = regex.match(QLatin1Char('/') + QString::fromUtf8(path)).hasMatch();
+        break;
+    }
+
+    if (matched)
+    {
+      res << SyncFileMatch{repository, index->packages.at(static_cast<int>(package)),
+                           QLatin1Char('/') + QString::fromUtf8(path)};
+    }
+  }
+
+  return res;
+}
+
+/*
+ * Returns the index of the given .files database, building it if the database changed
+ */
+SyncFilesSearcher::TRepositoryIndex SyncFilesSearcher::getIndex(const QString &filesDatabase)
+{
+  const QFileInfo fi(filesDatabase);
+  const QString repository = fi.completeBaseName();
+  const qint64 stamp = fi.lastModified().toMSecsSinceEpoch();
+
+  {
+    QMutexLocker locker(&s_mutex);
+    QHash<QString, TRepositoryIndex>::const_iterator it = s_indexes.constFind(repository);
+    if (it != s_indexes.constEnd() && it.value()->stamp == stamp) return it.value();
+  }
+
+  std::shared_ptr<RepositoryIndex> index = std::make_shared<RepositoryIndex>();
+  index->stamp = stamp;
+
+  if (!readFromDisk(repository, *index))
+  {
+    if (!readArchive(filesDatabase, *index)) return TRepositoryIndex();
+    writeToDisk(repository, *index);
+  }
+
+  QMutexLocker locker(&s_mutex);
+  s_indexes.insert(repository, index);
+  return index;
+}
+
+/*
+ * Streams the .files database, which holds a "<pkgname>-<pkgver>-<pkgrel>/files" entry per package
+ *
+ * Directories are left out, as pacman -F does not match them either
+ */
+bool SyncFilesSearcher::readArchive(const QString &filesDatabase, RepositoryIndex &index)
+{
+  struct archive *archive = archive_read_new();
+  archive_read_support_filter_all(archive);
+  archive_read_support_format_all(archive);
+
+  if (archive_read_open_filename(archive, QFile::encodeName(filesDatabase).constData(), ctn_ARCHIVE_BLOCK_SIZE) != ARCHIVE_OK)
+  {
+    archive_read_free(archive);
+    return false;
+  }
+
+  struct archive_entry *entry;
+  QByteArray buffer(ctn_ARCHIVE_BLOCK_SIZE, '\0');
+  QByteArray content;
+  bool ok = true;
+  int r;
+
+  while ((r = archive_read_next_header(archive, &entry)) == ARCHIVE_OK)
+  {
+    const QByteArray entryName(archive_entry_pathname(entry));
+
+    if (!entryName.endsWith("/files"))
+    {
+      archive_read_data_skip(archive);
+      continue;
+    }
+
+    const QString dir = QString::fromUtf8(entryName.left(entryName.size() - 6));
+    int dash = dir.lastIndexOf(QLatin1Char('-'));
+    if (dash > 0) dash = dir.lastIndexOf(QLatin1Char('-'), dash-1);
+    if (dash <= 0)
+    {
+      archive_read_data_skip(archive);
+      continue;
+    }
+
+    content.clear();
+    la_ssize_t size;
+    while ((size = archive_read_data(archive, buffer.data(), static_cast<size_t>(buffer.size()))) > 0)
+    {
+      content.append(buffer.constData(), static_cast<int>(size));
+    }
+
+    if (size < 0)
+    {
+      ok = false;
+      break;
+    }
+
+    index.packageStarts.push_back(static_cast<quint32>(index.paths.size()));
+    index.packages << dir.left(dash);
+
+    const QList<QByteArray> lines = content.split('\n');
+    QByteArray previous;
+    bool inFiles = false;
+
+    for (const QByteArray &line: lines)
+    {
+      if (line.startsWith('%'))
+      {
+        inFiles = (line == "%FILES%");
+        continue;
+      }
+
+      if (line.isEmpty())
+      {
+        if (inFiles) break;
+        continue;
+      }
+
+      if (inFiles && !line.endsWith('/'))
+      {
+        encodeEntry(index.paths, previous, line);
+        previous = line;
+      }
+    }
+  }
+
+  if (r != ARCHIVE_EOF) ok = false;
+  archive_read_free(archive);
+
+  if (!ok)
+  {
+    index.packages.clear();
+    index.paths.clear();
+    index.packageStarts.clear();
+  }
+
+  return ok;
+}
+
+bool SyncFilesSearcher::readFromDisk(const QString &repository, RepositoryIndex &index)
+{
+  QFile file(getIndexFilePath(repository));
+  if (!file.open(QIODevice::ReadOnly)) return false;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_15);
+
+  quint32 magic, version, startCount;
+  qint64 savedStamp;
+  in >> magic >> version >> savedStamp;
+  if (magic != ctn_INDEX_MAGIC || version != ctn_INDEX_VERSION || savedStamp != index.stamp) return false;
+
+  in >> index.packages >> index.paths >> startCount;
+  index.packageStarts.resize(startCount);
+  for (quint32 &start: index.packageStarts) in >> start;
+
+  if (in.status() != QDataStream::Ok || index.packageStarts.size() != static_cast<size_t>(index.packages.count()))
+  {
+    index.packages.clear();
+    index.paths.clear();
+    index.packageStarts.clear();
+    return false;
+  }
+
+  return true;
+}
+
+void SyncFilesSearcher::writeToDisk(const QString &repository, const RepositoryIndex &index)
+{
+  QDir().mkpath(QFileInfo(getIndexFilePath(repository)).path());
+  QSaveFile file(getIndexFilePath(repository));
+  if (!file.open(QIODevice::WriteOnly)) return;
+
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_5_15);
+  out << ctn_INDEX_MAGIC << ctn_INDEX_VERSION << index.stamp << index.packages << index.paths <<
+         static_cast<quint32>(index.packageStarts.size());
+  for (quint32 start: index.packageStarts) out << start;
+
+  if (file.commit())
+  {
+    //Where the first versions of the index were saved
+    QFile::remove(QDir::homePath() + QLatin1String("/.config/octopi/sync_files/") + repository + QLatin1String(".idx"));
+  }
+}
+
+/*
+ * The indexes can be rebuilt at any time, so they belong to the cache directory
+ */
+QString SyncFilesSearcher::getIndexFilePath(const QString &repository)
+{
+  return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) +
+      QLatin1String("/octopi/sync_files/") + repository + QLatin1String(".idx");
+}
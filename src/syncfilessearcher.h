@@ -0,0 +1,80 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef SYNCFILESSEARCHER_H
+#define SYNCFILESSEARCHER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <vector>
+
+enum SyncFilesQueryType { ectn_EXACT_PATH_QUERY, ectn_BASENAME_QUERY, ectn_REGEX_QUERY };
+
+struct SyncFileMatch
+{
+  QString repository;
+  QString package;
+  QString path;
+};
+
+/*
+ * @brief Finds which packages of the sync repositories provide a file, like "pacman -F"
+ *
+ * The .files databases in /var/lib/pacman/sync are streamed with libarchive, one worker per
+ * repository. The first search of a repository keeps a compact index of its paths, in memory and
+ * in ~/.cache/octopi, which is only rebuilt after "pacman -Fy" downloads a new .files database.
+ */
+class SyncFilesSearcher
+{
+public:
+  static SyncFilesQueryType getQueryType(const QString& query);
+  static QList<SyncFileMatch> search(const QString& query);
+  static QList<SyncFileMatch> searchDirectory(const QString& syncDirPath, const QString& query);
+  static void invalidate();
+
+private:
+  // Paths of a repository, without the leading slash and separated by '\n', grouped by package
+  struct RepositoryIndex
+  {
+    qint64 stamp;
+    QStringList packages;
+    QByteArray paths;
+    std::vector<quint32> packageStarts; // offset in paths of the first path of each package
+  };
+
+  typedef std::shared_ptr<const RepositoryIndex> TRepositoryIndex;
+
+  static QList<SyncFileMatch> searchRepository(const QString& filesDatabase, const QString& query);
+  static TRepositoryIndex getIndex(const QString& filesDatabase);
+  static bool readArchive(const QString& filesDatabase, RepositoryIndex& index);
+  static bool readFromDisk(const QString& repository, RepositoryIndex& index);
+  static void writeToDisk(const QString& repository, const RepositoryIndex& index);
+  static QString getIndexFilePath(const QString& repository);
+
+  static QMutex s_mutex;
+  static QHash<QString, TRepositoryIndex> s_indexes;
+};
+
+#endif // SYNCFILESSEARCHER_H
@@ -0,0 +1,310 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "transactionprogressparser.h"
+#include "outputsanitizer.h"
+
+#include <QRegularExpression>
+
+/*
+ * The patterns below follow what pacman 6 and 7 print with LANG=C, with or without ILoveCandy
+ */
+
+TransactionProgressParser::TransactionProgressParser()
+{
+  reset();
+}
+
+/*
+ * Forgets everything seen so far. Called before every new transaction
+ */
+void TransactionProgressParser::reset()
+{
+  m_pending.clear();
+  m_phase = ectn_PHASE_NONE;
+  m_summary.clear();
+  m_downloadedItems.clear();
+  m_downloadTotalSeen = false;
+  m_hasLastEvent = false;
+}
+
+/*
+ * Appends to events whatever the complete lines of output (plus what was pending) tell
+ */
+void TransactionProgressParser::parse(const QString &output, QList<TransactionEvent> &events)
+{
+  const QString text = m_pending + output;
+  int start = 0;
+
+  for (int i=0; i<text.size(); ++i)
+  {
+    const QChar c = text.at(i);
+    if (c == QLatin1Char('\n') || c == QLatin1Char('\r'))
+    {
+      if (i > start) parseLine(text.mid(start, i - start), events);
+      start = i + 1;
+    }
+  }
+
+  m_pending = text.mid(start);
+}
+
+/*
+ * Parses the last unterminated line, if any. Called when the process finishes
+ */
+void TransactionProgressParser::flush(QList<TransactionEvent> &events)
+{
+  if (!m_pending.isEmpty()) parseLine(m_pending, events);
+  m_pending.clear();
+}
+
+void TransactionProgressParser::parseLine(const QString &rawLine, QList<TransactionEvent> &events)
+{
+  static const QRegularExpression reStep(QStringLiteral("^\\((\\d+)/(\\d+)\\)\\s+(.*)$"));
+  static const QRegularExpression reStepPercentage(QStringLiteral("^(.*?)\\s*(?:\\[[^\\]]*\\])?\\s*(\\d{1,3})%$"));
+  static const QRegularExpression reTotal(
+        QStringLiteral("^Total \\((\\d+)/(\\d+)\\)\\s+(\\d+(?:\\.\\d+)?\\s+[KMGT]?i?B)\\b.*?(\\d{1,3})%$"));
+  static const QRegularExpression reDownload(
+        QStringLiteral("^(\\S+)\\s+(\\d+(?:\\.\\d+)?\\s+[KMGT]?i?B)\\b.*?(\\d{1,3})%$"));
+  static const QRegularExpression reUpToDate(QStringLiteral("^(\\S+) is up to date$"));
+
+  const QString line = OutputSanitizer::removeEscapeSequences(rawLine).trimmed();
+  if (line.isEmpty()) return;
+
+  if (line.startsWith(QLatin1String("warning:")))
+  {
+    ++currentSummary().warnings;
+    appendEvent(ectn_EVENT_WARNING, 0, 0, QString(), -1, line.mid(8).trimmed(), events);
+    return;
+  }
+  else if (line.startsWith(QLatin1String("error:")))
+  {
+    ++currentSummary().errors;
+    appendEvent(ectn_EVENT_ERROR, 0, 0, QString(), -1, line.mid(6).trimmed(), events);
+    return;
+  }
+
+  if (parsePhaseMarker(line, events)) return;
+
+  QRegularExpressionMatch match = reStep.match(line);
+  if (match.hasMatch())
+  {
+    const int current = match.captured(1).toInt();
+    const int total = match.captured(2).toInt();
+    if (total <= 0 || current <= 0 || current > total) return;
+
+    QString step = match.captured(3);
+
+    if (m_phase == ectn_PHASE_PRE_HOOKS || m_phase == ectn_PHASE_POST_HOOKS)
+    {
+      if (step.endsWith(QLatin1String("..."))) step.chop(3);
+      TransactionPhaseSummary &summary = currentSummary();
+      summary.items = qMax(summary.items, total);
+      appendEvent(ectn_EVENT_HOOK_RUNNING, current, total, QString(), current * 100 / total, step, events);
+      return;
+    }
+
+    int stepPercentage = -1;
+    QRegularExpressionMatch percentageMatch = reStepPercentage.match(step);
+    if (percentageMatch.hasMatch())
+    {
+      step = percentageMatch.captured(1);
+      stepPercentage = qMin(percentageMatch.captured(2).toInt(), 100);
+    }
+    if (step.endsWith(QLatin1String("..."))) step.chop(3);
+
+    const TransactionPhase stepPhase = phaseOfStep(step);
+    QString target = step;
+
+    if (stepPhase == ectn_PHASE_PROCESSING_CHANGES)
+    {
+      //"upgrading linux" -> "linux"
+      const int blank = step.indexOf(QLatin1Char(' '));
+      if (blank > 0) target = step.mid(blank + 1);
+      if (m_phase != ectn_PHASE_PROCESSING_CHANGES) startPhase(stepPhase, QStringLiteral("Processing package changes"), events);
+    }
+    else if (stepPhase != ectn_PHASE_NONE && stepPhase != m_phase)
+    {
+      startPhase(stepPhase, step, events);
+    }
+
+    TransactionPhaseSummary &summary = currentSummary();
+    summary.items = qMax(summary.items, total);
+
+    const int done = (current - 1) * 100 + (stepPercentage < 0 ? 0 : stepPercentage);
+    appendEvent(ectn_EVENT_PACKAGE_PROGRESS, current, total, QString(), done / total, target, events);
+    return;
+  }
+
+  match = reTotal.match(line);
+  if (match.hasMatch())
+  {
+    m_downloadTotalSeen = true;
+    const int total = match.captured(2).toInt();
+    TransactionPhaseSummary &summary = currentSummary();
+    summary.items = qMax(summary.items, total);
+    appendEvent(ectn_EVENT_DOWNLOAD_PROGRESS, match.captured(1).toInt(), total, match.captured(3),
+                qMin(match.captured(4).toInt(), 100), QStringLiteral("Total"), events);
+    return;
+  }
+
+  match = reDownload.match(line);
+  if (match.hasMatch())
+  {
+    const QString item = match.captured(1);
+    const int itemPercentage = qMin(match.captured(3).toInt(), 100);
+
+    if (itemPercentage == 100)
+    {
+      m_downloadedItems.insert(item);
+      TransactionPhaseSummary &summary = currentSummary();
+      summary.items = qMax(summary.items, m_downloadedItems.count());
+    }
+
+    //When pacman prints a "Total" line, that is what the progress bar shows
+    appendEvent(ectn_EVENT_DOWNLOAD_PROGRESS, 0, 0, match.captured(2),
+                m_downloadTotalSeen ? -1 : itemPercentage, item, events);
+    return;
+  }
+
+  match = reUpToDate.match(line);
+  if (match.hasMatch() && m_phase == ectn_PHASE_SYNC_DATABASES)
+  {
+    m_downloadedItems.insert(match.captured(1));
+    TransactionPhaseSummary &summary = currentSummary();
+    summary.items = qMax(summary.items, m_downloadedItems.count());
+    appendEvent(ectn_EVENT_DOWNLOAD_PROGRESS, 0, 0, QString(), 100, match.captured(1), events);
+  }
+}
+
+/*
+ * Recognizes the lines which open a new phase of the transaction
+ */
+bool TransactionProgressParser::parsePhaseMarker(const QString &line, QList<TransactionEvent> &events)
+{
+  QString label = line;
+  TransactionPhase phase = ectn_PHASE_NONE;
+
+  if (label.startsWith(QLatin1String(":: ")))
+  {
+    label.remove(0, 3);
+    if (label.endsWith(QLatin1String("..."))) label.chop(3);
+
+    if (label == QLatin1String("Synchronizing package databases")) phase = ectn_PHASE_SYNC_DATABASES;
+    else if (label == QLatin1String("Starting full system upgrade")) phase = ectn_PHASE_RESOLVING;
+    else if (label == QLatin1String("Retrieving packages")) phase = ectn_PHASE_DOWNLOADING;
+    else if (label == QLatin1String("Running pre-transaction hooks")) phase = ectn_PHASE_PRE_HOOKS;
+    else if (label == QLatin1String("Processing package changes")) phase = ectn_PHASE_PROCESSING_CHANGES;
+    else if (label == QLatin1String("Running post-transaction hooks")) phase = ectn_PHASE_POST_HOOKS;
+    else return true; //Questions and other notes do not change the phase
+
+    startPhase(phase, label, events);
+    return true;
+  }
+
+  //Without progress bars, pacman prints the steps as single lines
+  if (!label.endsWith(QLatin1String("..."))) return false;
+  label.chop(3);
+
+  if (label == QLatin1String("resolving dependencies") || label == QLatin1String("looking for conflicting packages"))
+    phase = ectn_PHASE_RESOLVING;
+  else
+    phase = phaseOfStep(label);
+
+  if (phase == ectn_PHASE_NONE || phase == ectn_PHASE_PROCESSING_CHANGES) return false;
+
+  if (phase != m_phase) startPhase(phase, label, events);
+  return true;
+}
+
+void TransactionProgressParser::startPhase(TransactionPhase phase, const QString &label, QList<TransactionEvent> &events)
+{
+  m_phase = phase;
+  m_downloadedItems.clear();
+  m_downloadTotalSeen = false;
+
+  bool found = false;
+  for (const TransactionPhaseSummary &summary: std::as_const(m_summary))
+  {
+    if (summary.phase == phase)
+    {
+      found = true;
+      break;
+    }
+  }
+
+  if (!found) m_summary.append(TransactionPhaseSummary{phase, label, 0, 0, 0});
+
+  appendEvent(ectn_EVENT_PHASE_STARTED, 0, 0, QString(), 0, label, events);
+}
+
+/*
+ * Progress bars are redrawn many times with the same numbers: only changes become events
+ */
+void TransactionProgressParser::appendEvent(TransactionEventType type, int current, int total, const QString &bytes,
+                                            int percent, const QString &text, QList<TransactionEvent> &events)
+{
+  const TransactionEvent event{type, m_phase, current, total, bytes, percent, text};
+
+  if (m_hasLastEvent && m_lastEvent.type == type && m_lastEvent.phase == m_phase && m_lastEvent.current == current &&
+      m_lastEvent.total == total && m_lastEvent.percent == percent && m_lastEvent.text == text) return;
+
+  m_lastEvent = event;
+  m_hasLastEvent = true;
+  events.append(event);
+}
+
+/*
+ * The summary of the running phase. Warnings printed before any phase are kept in a "pacman" one
+ */
+TransactionPhaseSummary &TransactionProgressParser::currentSummary()
+{
+  for (int i=m_summary.count()-1; i>=0; --i)
+  {
+    if (m_summary.at(i).phase == m_phase) return m_summary[i];
+  }
+
+  m_summary.append(TransactionPhaseSummary{m_phase, QStringLiteral("pacman"), 0, 0, 0});
+  return m_summary.last();
+}
+
+/*
+ * Maps the text of a "(k/n) ..." step to its phase
+ */
+TransactionPhase TransactionProgressParser::phaseOfStep(const QString &step)
+{
+  if (step.startsWith(QLatin1String("checking keys")) || step.startsWith(QLatin1String("checking keyring")) ||
+      step.startsWith(QLatin1String("downloading required keys")))
+    return ectn_PHASE_CHECKING_KEYS;
+  else if (step.startsWith(QLatin1String("checking package integrity")))
+    return ectn_PHASE_CHECKING_INTEGRITY;
+  else if (step.startsWith(QLatin1String("loading package files")))
+    return ectn_PHASE_LOADING_FILES;
+  else if (step.startsWith(QLatin1String("checking for file conflicts")))
+    return ectn_PHASE_CHECKING_CONFLICTS;
+  else if (step.startsWith(QLatin1String("checking available disk space")))
+    return ectn_PHASE_CHECKING_SPACE;
+  else if (step.startsWith(QLatin1String("installing ")) || step.startsWith(QLatin1String("upgrading ")) ||
+           step.startsWith(QLatin1String("reinstalling ")) || step.startsWith(QLatin1String("downgrading ")) ||
+           step.startsWith(QLatin1String("removing ")))
+    return ectn_PHASE_PROCESSING_CHANGES;
+  else
+    return ectn_PHASE_NONE;
+}
@@ -0,0 +1,92 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef TRANSACTIONPROGRESSPARSER_H
+#define TRANSACTIONPROGRESSPARSER_H
+
+#include <QList>
+#include <QSet>
+#include <QString>
+
+enum TransactionPhase { ectn_PHASE_NONE, ectn_PHASE_SYNC_DATABASES, ectn_PHASE_RESOLVING, ectn_PHASE_DOWNLOADING,
+                        ectn_PHASE_CHECKING_KEYS, ectn_PHASE_CHECKING_INTEGRITY, ectn_PHASE_LOADING_FILES,
+                        ectn_PHASE_CHECKING_CONFLICTS, ectn_PHASE_CHECKING_SPACE, ectn_PHASE_PRE_HOOKS,
+                        ectn_PHASE_PROCESSING_CHANGES, ectn_PHASE_POST_HOOKS };
+
+enum TransactionEventType { ectn_EVENT_PHASE_STARTED, ectn_EVENT_PACKAGE_PROGRESS, ectn_EVENT_DOWNLOAD_PROGRESS,
+                            ectn_EVENT_HOOK_RUNNING, ectn_EVENT_WARNING, ectn_EVENT_ERROR };
+
+struct TransactionEvent
+{
+  TransactionEventType type;
+  TransactionPhase phase;
+  int current;     // the k of "(k/n)", or 0
+  int total;       // the n of "(k/n)", or 0
+  QString bytes;   // size column of a download line, as pacman printed it
+  int percent;     // progress of the whole phase, or -1 if unknown
+  QString text;    // phase label, package name, hook description or message
+};
+
+struct TransactionPhaseSummary
+{
+  TransactionPhase phase;
+  QString label;
+  int items;
+  int warnings;
+  int errors;
+};
+
+/*
+ * @brief Turns the text pacman prints during a transaction into typed events
+ *
+ * Output may arrive split anywhere, so the last unterminated line is kept until the next read.
+ * Progress bars are redrawn with '\r', hence both '\r' and '\n' end a line.
+ */
+class TransactionProgressParser
+{
+public:
+  TransactionProgressParser();
+
+  void reset();
+  void parse(const QString& output, QList<TransactionEvent>& events);
+  void flush(QList<TransactionEvent>& events);
+
+  TransactionPhase currentPhase() const { return m_phase; }
+  const QList<TransactionPhaseSummary>& summary() const { return m_summary; }
+
+private:
+  void parseLine(const QString& line, QList<TransactionEvent>& events);
+  bool parsePhaseMarker(const QString& line, QList<TransactionEvent>& events);
+  void startPhase(TransactionPhase phase, const QString& label, QList<TransactionEvent>& events);
+  void appendEvent(TransactionEventType type, int current, int total, const QString& bytes, int percent,
+                   const QString& text, QList<TransactionEvent>& events);
+  TransactionPhaseSummary& currentSummary();
+  static TransactionPhase phaseOfStep(const QString& step);
+
+  QString m_pending;
+  TransactionPhase m_phase;
+  QList<TransactionPhaseSummary> m_summary;
+  QSet<QString> m_downloadedItems;
+  bool m_downloadTotalSeen;
+  TransactionEvent m_lastEvent;
+  bool m_hasLastEvent;
+};
+
+#endif // TRANSACTIONPROGRESSPARSER_H
@@ -0,0 +1,217 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "transactiontimeline.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+TransactionTimeline::TransactionTimeline()
+{
+  reset();
+}
+
+void TransactionTimeline::reset()
+{
+  m_phases.clear();
+  m_items.clear();
+  m_downloadItems.clear();
+  m_sequentialItem = -1;
+  m_overhead = 0;
+  m_end = 0;
+}
+
+/*
+ * Packages and hooks are processed one after the other, so one ends when the next starts.
+ * Downloads run in parallel: each one lasts from its first to its last progress line
+ */
+void TransactionTimeline::addEvent(const TransactionEvent &event, qint64 msecs)
+{
+  switch (event.type)
+  {
+    case ectn_EVENT_PHASE_STARTED:
+    {
+      closeSequentialItem(msecs);
+      m_downloadItems.clear();
+
+      if (m_phases.isEmpty())
+      {
+        //Time spent before pacman printed anything we know about: helper startup, password prompt...
+        if (msecs > 0) m_phases.append(TransactionPhaseTime{ectn_PHASE_NONE, QStringLiteral("pacman"), 0, msecs});
+      }
+      else
+      {
+        m_phases.last().end = msecs;
+      }
+
+      m_phases.append(TransactionPhaseTime{event.phase, event.text, msecs, msecs});
+      return;
+    }
+
+    case ectn_EVENT_PACKAGE_PROGRESS:
+    case ectn_EVENT_HOOK_RUNNING:
+    {
+      if (m_sequentialItem >= 0 && m_items.at(m_sequentialItem).phase == event.phase &&
+          m_items.at(m_sequentialItem).name == event.text)
+      {
+        m_items[m_sequentialItem].end = msecs;
+      }
+      else
+      {
+        closeSequentialItem(msecs);
+        m_items.append(TransactionItemTime{event.phase, event.text, msecs, msecs});
+        m_sequentialItem = m_items.count() - 1;
+      }
+      break;
+    }
+
+    case ectn_EVENT_DOWNLOAD_PROGRESS:
+    {
+      if (event.total > 0) break; //That is the "Total (k/n)" line
+
+      QHash<QString, int>::const_iterator it = m_downloadItems.constFind(event.text);
+      if (it != m_downloadItems.constEnd())
+      {
+        m_items[it.value()].end = msecs;
+      }
+      else
+      {
+        m_items.append(TransactionItemTime{event.phase, event.text, msecs, msecs});
+        m_downloadItems.insert(event.text, m_items.count() - 1);
+      }
+      break;
+    }
+
+    case ectn_EVENT_WARNING:
+    case ectn_EVENT_ERROR:
+      break;
+  }
+
+  if (!m_phases.isEmpty()) m_phases.last().end = msecs;
+}
+
+/*
+ * Called when the process finishes, msecs after it started
+ */
+void TransactionTimeline::finish(qint64 msecs)
+{
+  closeSequentialItem(msecs);
+  if (!m_phases.isEmpty()) m_phases.last().end = msecs;
+  m_end = msecs;
+}
+
+void TransactionTimeline::closeSequentialItem(qint64 msecs)
+{
+  if (m_sequentialItem >= 0) m_items[m_sequentialItem].end = msecs;
+  m_sequentialItem = -1;
+}
+
+/*
+ * One JSON object per line: the transaction, then its phases, then its items
+ */
+QByteArray TransactionTimeline::toJsonLines(const QString &command, qint64 startedAt, int exitCode) const
+{
+  QByteArray res;
+
+  QJsonObject transaction;
+  transaction.insert(QStringLiteral("type"), QStringLiteral("transaction"));
+  transaction.insert(QStringLiteral("command"), command);
+  transaction.insert(QStringLiteral("started"), QDateTime::fromMSecsSinceEpoch(startedAt).toString(Qt::ISODateWithMs));
+  transaction.insert(QStringLiteral("exit_code"), exitCode);
+  transaction.insert(QStringLiteral("duration_ms"), m_end);
+  transaction.insert(QStringLiteral("octopi_overhead_ms"), overhead());
+  res += QJsonDocument(transaction).toJson(QJsonDocument::Compact) + '\n';
+
+  for (const TransactionPhaseTime &phase: m_phases)
+  {
+    QJsonObject obj;
+    obj.insert(QStringLiteral("type"), QStringLiteral("phase"));
+    obj.insert(QStringLiteral("phase"), phaseName(phase.phase));
+    obj.insert(QStringLiteral("label"), phase.label);
+    obj.insert(QStringLiteral("start_ms"), phase.start);
+    obj.insert(QStringLiteral("duration_ms"), phase.end - phase.start);
+    res += QJsonDocument(obj).toJson(QJsonDocument::Compact) + '\n';
+  }
+
+  for (const TransactionItemTime &item: m_items)
+  {
+    QJsonObject obj;
+    obj.insert(QStringLiteral("type"), QStringLiteral("item"));
+    obj.insert(QStringLiteral("phase"), phaseName(item.phase));
+    obj.insert(QStringLiteral("name"), item.name);
+    obj.insert(QStringLiteral("start_ms"), item.start);
+    obj.insert(QStringLiteral("duration_ms"), item.end - item.start);
+    res += QJsonDocument(obj).toJson(QJsonDocument::Compact) + '\n';
+  }
+
+  return res;
+}
+
+/*
+ * Writes the JSON lines to <dirPath>/<start time>.jsonl, then removes all but the latest keepCount logs
+ */
+bool TransactionTimeline::writeLog(const QString &dirPath, const QString &command, qint64 startedAt, int exitCode,
+                                   int keepCount) const
+{
+  QDir logDir(dirPath);
+  if (!logDir.mkpath(QStringLiteral("."))) return false;
+
+  QSaveFile file(logDir.filePath(QDateTime::fromMSecsSinceEpoch(startedAt).toString(
+                                   QStringLiteral("yyyyMMdd-hhmmsszzz")) + QLatin1String(".jsonl")));
+  if (!file.open(QIODevice::WriteOnly)) return false;
+
+  file.write(toJsonLines(command, startedAt, exitCode));
+  if (!file.commit()) return false;
+
+  const QStringList logs = logDir.entryList(QStringList() << QStringLiteral("*.jsonl"), QDir::Files, QDir::Name | QDir::Reversed);
+  for (int i=keepCount; i<logs.count(); ++i)
+  {
+    logDir.remove(logs.at(i));
+  }
+
+  return true;
+}
+
+/*
+ * The name of the phase in the JSON-lines log
+ */
+QString TransactionTimeline::phaseName(TransactionPhase phase)
+{
+  switch (phase)
+  {
+    case ectn_PHASE_NONE: return QStringLiteral("none");
+    case ectn_PHASE_SYNC_DATABASES: return QStringLiteral("sync_databases");
+    case ectn_PHASE_RESOLVING: return QStringLiteral("resolving");
+    case ectn_PHASE_DOWNLOADING: return QStringLiteral("downloading");
+    case ectn_PHASE_CHECKING_KEYS: return QStringLiteral("checking_keys");
+    case ectn_PHASE_CHECKING_INTEGRITY: return QStringLiteral("checking_integrity");
+    case ectn_PHASE_LOADING_FILES: return QStringLiteral("loading_files");
+    case ectn_PHASE_CHECKING_CONFLICTS: return QStringLiteral("checking_conflicts");
+    case ectn_PHASE_CHECKING_SPACE: return QStringLiteral("checking_space");
+    case ectn_PHASE_PRE_HOOKS: return QStringLiteral("pre_hooks");
+    case ectn_PHASE_PROCESSING_CHANGES: return QStringLiteral("processing_changes");
+    case ectn_PHASE_POST_HOOKS: return QStringLiteral("post_hooks");
+  }
+
+  return QString();
+}
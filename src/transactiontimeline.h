@@ -0,0 +1,84 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef TRANSACTIONTIMELINE_H
+#define TRANSACTIONTIMELINE_H
+
+#include "transactionprogressparser.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+struct TransactionPhaseTime
+{
+  TransactionPhase phase;
+  QString label;
+  qint64 start;  // msecs since the transaction started
+  qint64 end;
+};
+
+struct TransactionItemTime
+{
+  TransactionPhase phase;
+  QString name;  // package, database or hook
+  qint64 start;
+  qint64 end;
+};
+
+/*
+ * @brief Times the phases and items of a transaction from TransactionProgressParser's events
+ *
+ * Timestamps are given by the caller, in msecs since the transaction started: PacmanExec uses a
+ * monotonic clock, while recorded output can be replayed with synthetic ones.
+ */
+class TransactionTimeline
+{
+public:
+  TransactionTimeline();
+
+  void reset();
+  void addEvent(const TransactionEvent& event, qint64 msecs);
+  void addOverhead(qint64 nsecs) { m_overhead += nsecs; }
+  void finish(qint64 msecs);
+
+  qint64 duration() const { return m_end; }
+  qint64 overhead() const { return m_overhead / 1000000; }
+  const QList<TransactionPhaseTime>& phases() const { return m_phases; }
+  const QList<TransactionItemTime>& items() const { return m_items; }
+
+  QByteArray toJsonLines(const QString& command, qint64 startedAt, int exitCode) const;
+  bool writeLog(const QString& dirPath, const QString& command, qint64 startedAt, int exitCode, int keepCount) const;
+
+  static QString phaseName(TransactionPhase phase);
+
+private:
+  void closeSequentialItem(qint64 msecs);
+
+  QList<TransactionPhaseTime> m_phases;
+  QList<TransactionItemTime> m_items;
+  QHash<QString, int> m_downloadItems;  // download name -> index in m_items
+  int m_sequentialItem;                 // index in m_items of the package or hook being processed, or -1
+  qint64 m_overhead;                    // nsecs Octopi spent on the output
+  qint64 m_end;
+};
+
+#endif // TRANSACTIONTIMELINE_H
@@ -19,12 +19,12 @@
 */
 
 #include "treeviewpackagesitemdelegate.h"
+#include "constants.h"
 #include "globals.h"
 #include "mainwindow.h"
 #include "uihelper.h"
 
 #include <QtGui>
-#include <QFutureWatcher>
 #include <QTreeWidget>
 #include <QToolTip>
 #include <iostream>
@@ -32,9 +32,39 @@
 
 QPoint gPoint;
 
+/*
+ * Tooltips are computed in a pool of their own with a single thread, so sweeping the mouse
+ * over the list queues requests instead of launching a pacman process for each one.
+ * Every hover bumps the generation: a queued request which is no longer current is dropped
+ * before it runs, and finished tooltips are cached by package name and version.
+ */
+QAtomicInt TreeViewPackagesItemDelegate::s_databaseGeneration;
+
 TreeViewPackagesItemDelegate::TreeViewPackagesItemDelegate(QObject *parent):
-  QStyledItemDelegate(parent)
+  QStyledItemDelegate(parent), m_toolTipCache(ctn_TOOLTIP_CACHE_SIZE),
+  m_pendingToolTipGeneration(-1), m_pendingDatabaseGeneration(-1),
+  m_cacheDatabaseGeneration(s_databaseGeneration.loadAcquire())
+{
+  m_toolTipPool.setMaxThreadCount(1);
+  connect(&m_toolTipWatcher, SIGNAL(finished()), this, SLOT(execToolTip()));
+}
+
+/*
+ * A queued request is dropped and a running one is waited for, as it reads this delegate's generation
+ */
+TreeViewPackagesItemDelegate::~TreeViewPackagesItemDelegate()
+{
+  m_toolTipGeneration.fetchAndAddOrdered(1);
+  m_toolTipPool.clear();
+  m_toolTipPool.waitForDone();
+}
+
+/*
+ * Called whenever the pacman database changes: cached tooltips hold old sizes and descriptions
+ */
+void TreeViewPackagesItemDelegate::invalidateToolTips()
 {
+  s_databaseGeneration.fetchAndAddOrdered(1);
 }
 
 /*
@@ -58,16 +88,13 @@ bool TreeViewPackagesItemDelegate::helpEvent ( QHelpEvent *event, QAbstractItemV
       const PackageRepository::PackageData*const package = MainWindow::returnMainWindow()->getFirstPackageFromRepo(si->name);
       if (!package) return false;
 
-      QFuture<QString> f;
       PkgDesc pkgDesc;
       pkgDesc.name = si->name;
+      pkgDesc.repository = package->repository;
       pkgDesc.description = package->description;
       pkgDesc.isForeign = (package->status == ectn_FOREIGN || package->status == ectn_FOREIGN_OUTDATED);
 
-      disconnect(&g_fwToolTip, SIGNAL(finished()), this, SLOT(execToolTip()));
-      f = QtConcurrent::run(showPackageDescriptionExt, pkgDesc);
-      g_fwToolTip.setFuture(f);
-      connect(&g_fwToolTip, SIGNAL(finished()), this, SLOT(execToolTip()));
+      requestToolTip(gPoint, pkgDesc, package->version);
     }
     else return false;
   }
@@ -94,9 +121,9 @@ bool TreeViewPackagesItemDelegate::helpEvent ( QHelpEvent *event, QAbstractItemV
       const PackageRepository::PackageData*const package = MainWindow::returnMainWindow()->getFirstPackageFromRepo(pkgName);
       if (!package) return false;
 
-      QFuture<QString> f;
       PkgDesc pkgDesc;
       pkgDesc.name = pkgName;
+      pkgDesc.repository = package->repository;
       pkgDesc.description = package->description;
       pkgDesc.isForeign = (package->status == ectn_FOREIGN || package->status == ectn_FOREIGN_OUTDATED);
 
@@ -106,11 +133,7 @@ bool TreeViewPackagesItemDelegate::helpEvent ( QHelpEvent *event, QAbstractItemV
           IconHelper::getIconRemoveItem().pixmap(22, 22).toImage())
       {
         gPoint = tvTransaction->mapToGlobal(event->pos());
-        QFuture<QString> f;
-        disconnect(&g_fwToolTip, SIGNAL(finished()), this, SLOT(execToolTip()));
-        f = QtConcurrent::run(showPackageDescriptionExt, pkgDesc);
-        g_fwToolTip.setFuture(f);
-        connect(&g_fwToolTip, SIGNAL(finished()), this, SLOT(execToolTip()));
+        requestToolTip(gPoint, pkgDesc, package->version);
       }
       else
       {
@@ -122,16 +145,68 @@ bool TreeViewPackagesItemDelegate::helpEvent ( QHelpEvent *event, QAbstractItemV
   return true;
 }
 
+/*
+ * Shows the cached tooltip of the package at once. Otherwise shows its description as a
+ * placeholder and queues the computation of the full tooltip
+ */
+void TreeViewPackagesItemDelegate::requestToolTip(const QPoint &pos, const PkgDesc &pkgDesc, const QString &version)
+{
+  const QPoint toolTipPos(pos.x() + 25, pos.y() + 25);
+  const QString database = pkgDesc.isForeign ? QStringLiteral("local") : QString(QLatin1String("sync/") + pkgDesc.repository);
+  const QString key = database + QLatin1Char('/') + pkgDesc.name + QLatin1Char('/') + version;
+  const int databaseGeneration = s_databaseGeneration.loadAcquire();
+
+  if (m_cacheDatabaseGeneration != databaseGeneration)
+  {
+    m_toolTipCache.clear();
+    m_cacheDatabaseGeneration = databaseGeneration;
+  }
+
+  //Still hovering the same package: let the pending request finish
+  if (key == m_pendingToolTipKey && m_toolTipWatcher.isRunning()) return;
+
+  const int generation = m_toolTipGeneration.fetchAndAddOrdered(1) + 1;
+
+  if (const QString *toolTip = m_toolTipCache.object(key))
+  {
+    m_pendingToolTipKey.clear();
+    if (!toolTip->trimmed().isEmpty()) QToolTip::showText(toolTipPos, *toolTip);
+    return;
+  }
+
+  if (!pkgDesc.description.trimmed().isEmpty())
+  {
+    QToolTip::showText(toolTipPos, getShortPackageDescription(pkgDesc.description));
+  }
+
+  m_pendingToolTipKey = key;
+  m_pendingToolTipGeneration = generation;
+  m_pendingDatabaseGeneration = databaseGeneration;
+
+  m_toolTipWatcher.setFuture(QtConcurrent::run(&m_toolTipPool, [this, pkgDesc, generation]() {
+    if (m_toolTipGeneration.loadAcquire() != generation) return QString();
+    return showPackageDescriptionExt(pkgDesc);
+  }));
+}
+
 /*
  * When the tooltip QFuture method is finished, we show the selected tooltip to the user
  */
 void TreeViewPackagesItemDelegate::execToolTip()
 {
-  if (g_fwToolTip.result().trimmed().isEmpty())
+  if (m_pendingToolTipGeneration != m_toolTipGeneration.loadAcquire())
     return;
 
-  gPoint.setX(gPoint.x() + 25);
-	gPoint.setY(gPoint.y() + 25);
+  const QString toolTip = m_toolTipWatcher.result();
+
+  //A tooltip computed before the database changed is shown, but not kept
+  if (m_pendingDatabaseGeneration == s_databaseGeneration.loadAcquire())
+    m_toolTipCache.insert(m_pendingToolTipKey, new QString(toolTip));
+
+  m_pendingToolTipKey.clear();
+
+  if (toolTip.trimmed().isEmpty())
+    return;
 
-  QToolTip::showText(gPoint, g_fwToolTip.result());
+  QToolTip::showText(QPoint(gPoint.x() + 25, gPoint.y() + 25), toolTip);
 }
@@ -22,22 +22,47 @@
 #define TREEVIEWPACKAGESITEMDELEGATE_H
 
 #include <QStyledItemDelegate>
+#include <QAtomicInt>
+#include <QCache>
+#include <QFutureWatcher>
 #include <QString>
+#include <QThreadPool>
+
+struct PkgDesc;
 
 extern QPoint gPoint;
 
 class TreeViewPackagesItemDelegate : public QStyledItemDelegate
 {
   Q_OBJECT
+
+  friend class TestTreeViewPackagesItemDelegate;
 	
 	public:
     TreeViewPackagesItemDelegate(QObject *parent);
+    virtual ~TreeViewPackagesItemDelegate();
+
+    static void invalidateToolTips();
 		
 	public slots:
     bool helpEvent ( QHelpEvent * event, QAbstractItemView*,
                      const QStyleOptionViewItem&, const QModelIndex &index );
 
 		void execToolTip();
+
+  private:
+    static QAtomicInt s_databaseGeneration; // bumped by invalidateToolTips()
+
+    QThreadPool m_toolTipPool;
+    QCache<QString, QString> m_toolTipCache;
+    QFutureWatcher<QString> m_toolTipWatcher;
+    QAtomicInt m_toolTipGeneration;
+    QString m_pendingToolTipKey;
+    int m_pendingToolTipGeneration;
+    int m_pendingDatabaseGeneration;
+    int m_cacheDatabaseGeneration;
+
+    void requestToolTip(const QPoint& pos, const PkgDesc& pkgDesc, const QString& version);
 };
 
 #endif
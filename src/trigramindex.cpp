@@ -0,0 +1,154 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "trigramindex.h"
+
+#include <algorithm>
+#include <iterator>
+
+/*
+ * This index is used to narrow down description searches before running the regex on them
+ */
+
+TrigramIndex::TrigramIndex(): m_documentCount(0)
+{
+}
+
+void TrigramIndex::clear()
+{
+  m_postings.clear();
+  m_documentCount = 0;
+}
+
+/*
+ * Registers every trigram of text for the document id. Ids must be added in ascending order
+ */
+void TrigramIndex::addDocument(quint32 id, const QString &text)
+{
+  ++m_documentCount;
+  if (text.size() < 3) return;
+
+  const QString folded = text.toCaseFolded();
+  const QChar *data = folded.constData();
+
+  for (int c=0; c+2<folded.size(); ++c)
+  {
+    TPostingList &list = m_postings[trigramKey(data[c], data[c+1], data[c+2])];
+    if (list.empty() || list.back() != id) list.push_back(id);
+  }
+}
+
+/*
+ * Releases the extra capacity of the posting lists after the index has been built
+ */
+void TrigramIndex::squeeze()
+{
+  for (QHash<quint64, TPostingList>::iterator it = m_postings.begin(); it != m_postings.end(); ++it)
+  {
+    it.value().shrink_to_fit();
+  }
+}
+
+/*
+ * Intersects the posting lists of all trigrams of literal, smallest lists first
+ * Returns false if literal is too short to be searched with this index
+ */
+bool TrigramIndex::query(const QString &literal, TPostingList &result) const
+{
+  result.clear();
+  if (literal.size() < 3) return false;
+
+  const QString folded = literal.toCaseFolded();
+  const QChar *data = folded.constData();
+  std::vector<const TPostingList*> lists;
+
+  for (int c=0; c+2<folded.size(); ++c)
+  {
+    QHash<quint64, TPostingList>::const_iterator it = m_postings.constFind(trigramKey(data[c], data[c+1], data[c+2]));
+    if (it == m_postings.constEnd()) return true; //No document has this trigram
+
+    if (std::find(lists.begin(), lists.end(), &it.value()) == lists.end())
+      lists.push_back(&it.value());
+  }
+
+  std::sort(lists.begin(), lists.end(),
+            [](const TPostingList* a, const TPostingList* b) { return a->size() < b->size(); });
+
+  result = *lists.front();
+  TPostingList aux;
+
+  for (size_t c=1; c<lists.size() && !result.empty(); ++c)
+  {
+    aux.clear();
+    std::set_intersection(result.begin(), result.end(), lists[c]->begin(), lists[c]->end(), std::back_inserter(aux));
+    result.swap(aux);
+  }
+
+  return true;
+}
+
+/*
+ * Approximate number of bytes held by the index
+ */
+qint64 TrigramIndex::memoryUsage() const
+{
+  qint64 res = 0;
+
+  for (QHash<quint64, TPostingList>::const_iterator it = m_postings.constBegin(); it != m_postings.constEnd(); ++it)
+  {
+    res += sizeof(quint64) + sizeof(TPostingList) + sizeof(void*) + it.value().capacity() * sizeof(quint32);
+  }
+
+  return res;
+}
+
+/*
+ * If the regex pattern only matches a fixed string, puts that string in literal and returns true
+ */
+bool TrigramIndex::extractLiteral(const QString &pattern, QString &literal)
+{
+  static const QString metaChars = QStringLiteral("^$.|?*+()[]{}");
+  literal.clear();
+  literal.reserve(pattern.size());
+
+  for (int c=0; c<pattern.size(); ++c)
+  {
+    const QChar ch = pattern.at(c);
+
+    if (ch == QLatin1Char('\\'))
+    {
+      //Only escaped punctuation stands for itself ("\+"), while "\d", "\w"... are classes
+      if (c+1 >= pattern.size() || pattern.at(c+1).isLetterOrNumber()) return false;
+      literal += pattern.at(++c);
+    }
+    else if (metaChars.contains(ch))
+    {
+      return false;
+    }
+    else literal += ch;
+  }
+
+  return true;
+}
+
+quint64 TrigramIndex::trigramKey(QChar a, QChar b, QChar c)
+{
+  return (quint64(a.unicode()) << 32) | (quint64(b.unicode()) << 16) | quint64(c.unicode());
+}
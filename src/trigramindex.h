@@ -0,0 +1,60 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <vector>
+#include <QHash>
+#include <QString>
+
+/*
+ * @brief Case insensitive trigram posting lists over a set of documents (package descriptions)
+ *
+ * A query only returns candidates: every document which contains all trigrams of the searched
+ * literal. The caller still has to verify them with the real matcher.
+ */
+class TrigramIndex
+{
+public:
+  typedef std::vector<quint32> TPostingList;
+
+  TrigramIndex();
+
+  void clear();
+  void addDocument(quint32 id, const QString& text);
+  void squeeze();
+
+  bool query(const QString& literal, TPostingList& result) const;
+
+  int documentCount() const { return m_documentCount; }
+  int trigramCount() const { return m_postings.size(); }
+  qint64 memoryUsage() const;
+
+  static bool extractLiteral(const QString& pattern, QString& literal);
+
+private:
+  static quint64 trigramKey(QChar a, QChar b, QChar c);
+
+  QHash<quint64, TPostingList> m_postings; // ids are added in ascending order
+  int m_documentCount;
+};
+
+#endif // TRIGRAMINDEX_H
@@ -46,9 +46,8 @@ QString OctopiTabInfo::formatTabInfo(const PackageRepository::PackageData& packa
 {
   PackageInfoData pid;
 
-  if (package.repository != StrConstants::getForeignRepositoryName() &&
-      (!package.installed() || package.outdated())) {
-    pid = Package::getInformation(package.name);
+  if (!usesLocalInformation(package)) {
+    pid = Package::getInformation(package.name, false, package.version, package.repository);
   }
   else
   {
@@ -218,3 +217,12 @@ QString OctopiTabInfo::formatTabInfo(const PackageRepository::PackageData& packa
 
   return html;
 }
+
+/**
+ * Sync packages are looked up by version, so an outdated one shows its new release
+ */
+bool OctopiTabInfo::usesLocalInformation(const PackageRepository::PackageData& package)
+{
+  return package.repository == StrConstants::getForeignRepositoryName() ||
+      (package.installed() && !package.outdated());
+}
@@ -59,6 +59,13 @@ public:
    */
   static QString formatTabInfo(const PackageRepository::PackageData& package, const QHash<QString, QString>& outdatedAURPackagesNameVersion);
 
+  /**
+   * @brief tells whether the information of package is read from the local database
+   * @param package
+   * @return true for installed (and not outdated) packages and foreign ones
+   */
+  static bool usesLocalInformation(const PackageRepository::PackageData& package);
+
   static const QString anchorBegin;
 };
 
@@ -22,6 +22,8 @@
 //#include "strconstants.h"
 #include "wmhelper.h"
 #include "terminal.h"
+#include "processtable.h"
+#include "helperprotocol.h"
 #include <iostream>
 
 #include <QProcess>
@@ -501,21 +503,24 @@ QByteArray UnixCommand::getPackageContentsUsingPkgfile(const QString &pkgName)
 /*
  * Given a complete file path, returns the package that provides that file
  */
-QString UnixCommand::getPackageByFilePath(const QString &filePath)
+QStringList UnixCommand::getPackagesByFilePath(const QString &filePath)
 {
   QStringList sl;
+  QStringList res;
   sl << QStringLiteral("-Qo");
   sl << filePath;
 
   QString out = QString::fromUtf8(performQuery(sl));
-  QStringList s = out.split(QStringLiteral("\n"), Qt::SkipEmptyParts);
+  const QStringList s = out.split(QStringLiteral("\n"), Qt::SkipEmptyParts);
 
-  if (s.count() >= 1)
+  //A directory is listed once per owner: "/usr/bin/ is owned by filesystem 2023.09.18-1"
+  for (const QString &line: s)
   {
-    QStringList res = s.at(0).split(QStringLiteral(" "), Qt::SkipEmptyParts);
-    return res.at(res.count()-2);
+    QStringList parts = line.split(QStringLiteral(" "), Qt::SkipEmptyParts);
+    if (parts.count() >= 2) res << parts.at(parts.count()-2);
   }
-  else return QLatin1String("");
+
+  return res;
 }
 
 /*
@@ -1129,22 +1134,15 @@ int UnixCommand::cancelProcess(QSharedMemory *sharedMem)
  */
 bool UnixCommand::isAppRunning(const QString &appName, bool justOneInstance)
 {
-  QStringList slParam;
-  QProcess proc;
-  slParam << QStringLiteral("-C");
-  slParam << appName;
-  proc.start(QStringLiteral("ps"), slParam);
-  proc.waitForFinished();
-  QString out = QString::fromUtf8(proc.readAll());
-  proc.close();
+  int count = ProcessTable::count(appName);
 
   if (justOneInstance)
   {
-    return out.count(appName)>0;
+    return count>0;
   }
   else
   {
-    return out.count(appName)>1;
+    return count>1;
   }
 }
 
@@ -1155,20 +1153,9 @@ bool UnixCommand::isOctoToolRunning(const QString &octoToolName)
 {
   bool res=false;
 
-  QProcess proc;
-  QStringList sl;
-  proc.setProcessEnvironment(getProcessEnvironment());
-  sl << QLatin1String("-C");
-  sl << octoToolName;
-  sl << QLatin1String("-o");
-  sl << QLatin1String("command");
-
-  proc.start(QLatin1String("/usr/bin/ps"), sl);
-  proc.waitForFinished();
-  QString out = QString::fromUtf8(proc.readAll().trimmed());
+  //All the command lines glued together, as "ps -C octoToolName -o command" used to be read
+  QString out = ProcessTable::commandLines(octoToolName).join(QString());
   if (out.contains(QLatin1String("|"))) return false;
-  out=out.remove(QStringLiteral("\n"));
-  out=out.remove(QStringLiteral("COMMAND"));
 
   if (octoToolName==QLatin1String("octopi-cachecle"))
   {
@@ -1515,23 +1502,31 @@ QProcessEnvironment UnixCommand::getProcessEnvironment()
 bool UnixCommand::isOctopiHelperRunning()
 {
   bool res=false;
-
-  QProcess proc;
-  proc.setProcessEnvironment(getProcessEnvironment());
   QString octoToolName = ctn_OCTOPI_HELPER_NAME;
-  QStringList sl;
-  sl << QStringLiteral("-C");
-  sl << octoToolName;
-  sl << QStringLiteral("-o");
-  sl << QStringLiteral("command");
-  proc.start(QStringLiteral("ps"), sl);
-  proc.waitForFinished();
 
-  QString out = QString::fromUtf8(proc.readAll().trimmed());
-  if (out.contains(QLatin1String("|"))) return false;
-  out=out.remove(QStringLiteral("\n"));
-  out=out.remove(QStringLiteral("COMMAND"));
-  if ((out == QLatin1String("/usr/lib/octopi/") + octoToolName) || out.contains(QLatin1String("/usr/lib/octopi/") + octoToolName + QLatin1String(" "))) res=true;
+  //The helper asks Octopi about its transaction right after starting, so no cached table here
+  ProcessTable::invalidate();
+  const QStringList lines = ProcessTable::commandLines(octoToolName);
+  for (const QString &line: lines)
+  {
+    if (line.contains(QLatin1String("|"))) return false;
+  }
+
+  const QList<ProcessInfo> processes = ProcessTable::processes();
+  for (const ProcessInfo &process: processes)
+  {
+    if (process.name != octoToolName) continue;
+    const QString line = process.commandLine();
+
+    //A persistent session ("octphelper -session") is a running helper only while it runs a transaction
+    if (line.endsWith(QLatin1String(" -session")))
+    {
+      if (QFile::exists(HelperProtocol::getBusyMarkerPath(process.pid))) res=true;
+      continue;
+    }
+
+    if ((line == QLatin1String("/usr/lib/octopi/") + octoToolName) || line.contains(QLatin1String("/usr/lib/octopi/") + octoToolName + QLatin1String(" "))) res=true;
+  }
 
   return res;
 }
@@ -94,7 +94,7 @@ public:
   static QByteArray getPackageContentsUsingPacman(const QString &pkgName, bool isInstalled);
   static QByteArray getPackageContentsUsingPkgfile(const QString &pkgName);
 
-  static QString getPackageByFilePath(const QString &filePath);
+  static QStringList getPackagesByFilePath(const QString &filePath);
   static QStringList getFilePathSuggestions(const QString &file);
 
   static QByteArray getPackageGroups();
@@ -48,63 +48,27 @@ QString utils::showFullPathOfItem(const QModelIndex &index)
   QString str;
   if (!index.isValid()) return str;
 
-  const QStandardItemModel *sim = qobject_cast<const QStandardItemModel*>( index.model() );
+  QStringList sl;
 
-  if (sim)
+  for (QModelIndex nindex = index; nindex.isValid(); nindex = nindex.parent())
   {
-    QStringList sl;
-    QModelIndex nindex;
-    sl << sim->itemFromIndex( index )->text();
-    nindex = index;
-
-    while (true){
-      nindex = sim->parent( nindex );
-
-      if (nindex != sim->invisibleRootItem()->index())
-        sl << sim->itemFromIndex( nindex )->text();
-
-      else break;
-    }
-
-    str = QDir::separator() + str;
-
-    for ( int i=sl.count()-1; i>=0; i-- ){
-      if ( i < sl.count()-1 ) str += QDir::separator();
-      str += sl[i];
-    }
-
-    QFileInfo fileInfo(str);
-    if (fileInfo.isDir())
-    {
-      str += QDir::separator();
-    }
+    sl << nindex.data().toString();
   }
 
-  return str;
-}
-
-/*
- * Given a filename 'name', searches for it inside a QStandard item model
- * Result is a list containing all QModelIndex occurencies
- */
-QList<QModelIndex> * utils::findFileInTreeView(const QString& name, const QStandardItemModel *sim)
-{
-  QList<QModelIndex> * res = new QList<QModelIndex>();
-  QList<QStandardItem *> foundItems;
+  str = QDir::separator() + str;
 
-  if (name.isEmpty() || sim->rowCount() == 0)
-  {
-    return res;
+  for ( int i=sl.count()-1; i>=0; i-- ){
+    if ( i < sl.count()-1 ) str += QDir::separator();
+    str += sl[i];
   }
 
-  foundItems = sim->findItems(Package::parseSearchString(name), Qt::MatchRegularExpression|Qt::MatchRecursive);
-  for(QStandardItem *item: std::as_const(foundItems))
+  QFileInfo fileInfo(str);
+  if (fileInfo.isDir())
   {
-    //if (item->accessibleDescription().contains("directory")) continue;
-    res->append(item->index());
+    str += QDir::separator();
   }
 
-  return res;
+  return str;
 }
 
 /*
@@ -454,6 +418,32 @@ void utils::positionTextEditCursorAtEnd(QTextEdit *textEdit)
   }
 }
 
+/*
+ * Returns the html used to write the given string to a textbrowser: errors in red and clickable URLs
+ */
+QString utils::formatForTextBrowser(const QString &str, TreatURLLinks treatURLLinks)
+{
+  QString newStr = str;
+
+  if(newStr.contains(QLatin1String("removing ")) ||
+     newStr.contains(QLatin1String("could not ")) ||
+     newStr.contains(QLatin1String("error:"), Qt::CaseInsensitive) ||
+     newStr.contains(QLatin1String("failed")) ||
+     newStr.contains(QLatin1String("is not synced")) ||
+     newStr.contains(QLatin1String("could not be found")) ||
+     newStr.contains(StrConstants::getCommandFinishedWithErrors()))
+  {
+    newStr = QLatin1String("<b><font color=\"#E55451\">") + newStr + QLatin1String("&nbsp;</font></b>"); //RED
+  }
+
+  if(treatURLLinks == ectn_TREAT_URL_LINK)
+  {
+    newStr = Package::makeURLClickable(newStr);
+  }
+
+  return newStr;
+}
+
 /*
  * A helper method which writes the given string to a textbrowser
  */
@@ -462,29 +452,7 @@ void utils::writeToTextBrowser(QTextBrowser* text, const QString &str, TreatURLL
   if (text)
   {
     positionTextEditCursorAtEnd(text);
-
-    QString newStr = str;
-
-    if(newStr.contains(QLatin1String("removing ")) ||
-       newStr.contains(QLatin1String("could not ")) ||
-       newStr.contains(QLatin1String("error:"), Qt::CaseInsensitive) ||
-       newStr.contains(QLatin1String("failed")) ||
-       newStr.contains(QLatin1String("is not synced")) ||
-       newStr.contains(QLatin1String("could not be found")) ||
-       newStr.contains(StrConstants::getCommandFinishedWithErrors()))
-    {
-      newStr = QLatin1String("<b><font color=\"#E55451\">") + newStr + QLatin1String("&nbsp;</font></b>"); //RED
-    }
-
-    if(treatURLLinks == ectn_TREAT_URL_LINK)
-    {
-      text->insertHtml(Package::makeURLClickable(newStr));
-    }
-    else
-    {
-      text->insertHtml(newStr);
-    }
-
+    text->insertHtml(formatForTextBrowser(str, treatURLLinks));
     text->ensureCursorVisible();
   }
 }
@@ -34,7 +34,6 @@ namespace utils{
 
 //TreeView related
 QString showFullPathOfItem( const QModelIndex &index );
-QList<QModelIndex> * findFileInTreeView( const QString& name, const QStandardItemModel *sim);
 
 //RSS related
 QString retrieveDistroNews(bool searchForLatestNews);
@@ -43,6 +42,7 @@ QString parseDistroNews();
 //QTextBrowser related
 bool strInQTextEdit(QTextBrowser *text, const QString& findText);
 void positionTextEditCursorAtEnd(QTextEdit *textEdit);
+QString formatForTextBrowser(const QString &str, TreatURLLinks treatURLLinks = ectn_TREAT_URL_LINK);
 void writeToTextBrowser(QTextBrowser* text, const QString &str, TreatURLLinks treatURLLinks = ectn_TREAT_URL_LINK);
 
 //SearchBar related
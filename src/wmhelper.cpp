@@ -20,6 +20,7 @@
 
 #include "wmhelper.h"
 #include "unixcommand.h"
+#include "processtable.h"
 #include "strconstants.h"
 //#include "settingsmanager.h"
 //#include "terminal.h"
@@ -49,19 +50,7 @@ bool WMHelper::isKDERunning()
  */
 bool WMHelper::isTDERunning()
 {
-  QStringList slParam;
-  QProcess proc;
-  slParam << QStringLiteral("-aux");
-  //slParam << ctn_TDE_DESKTOP;
-
-  proc.start(QStringLiteral("ps"), slParam);
-  proc.waitForStarted();
-  proc.waitForFinished();
-
-  QString out = QString::fromUtf8(proc.readAll());
-  proc.close();
-
-  return out.count(ctn_TDE_DESKTOP)>0;
+  return ProcessTable::hasCommandLineContaining(ctn_TDE_DESKTOP);
 }
 
 /*
@@ -69,18 +58,7 @@ bool WMHelper::isTDERunning()
  */
 bool WMHelper::isGNOMERunning()
 {
-  QStringList slParam;
-  QProcess proc;
-  slParam << QStringLiteral("-aux");
-  //slParam << ctn_GNOME_DESKTOP;
-
-  proc.start(QStringLiteral("ps"), slParam);
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = QString::fromUtf8(proc.readAll());
-  proc.close();
-
-  return out.count(ctn_GNOME_DESKTOP)>0;
+  return ProcessTable::hasCommandLineContaining(ctn_GNOME_DESKTOP);
 }
 
 /*
@@ -88,18 +66,7 @@ bool WMHelper::isGNOMERunning()
  */
 bool WMHelper::isXFCERunning()
 {
-  QStringList slParam;
-  QProcess proc;
-  slParam << QStringLiteral("-aux");
-  //slParam << ctn_XFCE_DESKTOP;
-
-  proc.start(QStringLiteral("ps"), slParam);
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = QString::fromUtf8(proc.readAll());
-  proc.close();
-
-  return out.count(ctn_XFCE_DESKTOP)>0;
+  return ProcessTable::hasCommandLineContaining(ctn_XFCE_DESKTOP);
 }
 
 /*
@@ -107,18 +74,7 @@ bool WMHelper::isXFCERunning()
  */
 bool WMHelper::isLXDERunning()
 {
-  QStringList slParam;
-  QProcess proc;
-  slParam << QStringLiteral("-aux");
-  //slParam << ctn_LXDE_DESKTOP;
-
-  proc.start(QStringLiteral("ps"), slParam);
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = QString::fromUtf8(proc.readAll());
-  proc.close();
-
-  return out.count(ctn_LXDE_DESKTOP)>0;
+  return ProcessTable::hasCommandLineContaining(ctn_LXDE_DESKTOP);
 }
 
 /*
@@ -134,18 +90,7 @@ bool WMHelper::isLXQTRunning()
  */
 bool WMHelper::isOPENBOXRunning()
 {
-  QStringList slParam;
-  QProcess proc;
-  slParam << QStringLiteral("-aux");
-  //slParam << ctn_OPENBOX_DESKTOP;
-
-  proc.start(QStringLiteral("ps"), slParam);
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = QString::fromUtf8(proc.readAll());
-  proc.close();
-
-  return out.count(ctn_OPENBOX_DESKTOP)>0;
+  return ProcessTable::hasCommandLineContaining(ctn_OPENBOX_DESKTOP);
 }
 
 /*
@@ -153,18 +98,7 @@ bool WMHelper::isOPENBOXRunning()
  */
 bool WMHelper::isMATERunning()
 {
-  QStringList slParam;
-  QProcess proc;
-  slParam << QStringLiteral("-aux");
-  //slParam << ctn_MATE_DESKTOP;
-
-  proc.start(QStringLiteral("ps"), slParam);
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = QString::fromUtf8(proc.readAll());
-  proc.close();
-
-  return out.count(ctn_MATE_DESKTOP)>0;
+  return ProcessTable::hasCommandLineContaining(ctn_MATE_DESKTOP);
 }
 
 /*
@@ -172,18 +106,7 @@ bool WMHelper::isMATERunning()
  */
 bool WMHelper::isCinnamonRunning()
 {
-  QStringList slParam;
-  QProcess proc;
-  slParam << QStringLiteral("-aux");
-  //slParam << ctn_CINNAMON_DESKTOP;
-
-  proc.start(QStringLiteral("ps"), slParam);
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = QString::fromUtf8(proc.readAll());
-  proc.close();
-
-  return out.count(ctn_CINNAMON_DESKTOP)>0;
+  return ProcessTable::hasCommandLineContaining(ctn_CINNAMON_DESKTOP);
 }
 
 /*
@@ -191,18 +114,7 @@ bool WMHelper::isCinnamonRunning()
  */
 bool WMHelper::isLuminaRunning()
 {
-  QStringList slParam;
-  QProcess proc;
-  slParam << QStringLiteral("-aux");
-  //slParam << ctn_LUMINA_DESKTOP;
-
-  proc.start(QStringLiteral("ps"), slParam);
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = QString::fromUtf8(proc.readAll());
-  proc.close();
-
-  return out.count(ctn_LUMINA_DESKTOP)>0;
+  return ProcessTable::hasCommandLineContaining(ctn_LUMINA_DESKTOP);
 }
 
 /*
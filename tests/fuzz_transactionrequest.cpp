@@ -0,0 +1,70 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../helper/transactionrequest.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+/*
+ * libFuzzer entry point: feeds TransactionRequest::parse() the bytes a client could send.
+ * Besides crashes, it aborts whenever an accepted request would hand pacman something it
+ * could read as an option or a repository it may not take.
+ *
+ * Run it as: fuzz_transactionrequest tests/fuzz_corpus/transactionrequest
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+  //HelperSession reads the payload just like this
+  const QString contents = QString::fromLatin1(reinterpret_cast<const char *>(data), static_cast<int>(size));
+
+  QList<HelperCommand> commands;
+  int origin;
+  QString badLine;
+
+  if (!TransactionRequest::parse(contents, commands, origin, badLine)) return 0;
+  if (commands.isEmpty()) abort();
+
+  for (const HelperCommand &command: commands)
+  {
+    const bool allowRepository = command.operation == ectn_HELPER_OP_INSTALL;
+    for (const QString &package: command.packages)
+    {
+      if (!TransactionRequest::isValidPackageName(package, allowRepository)) abort();
+    }
+
+    //Only Octopi itself may name packages
+    if (!command.packages.isEmpty() && !(origin & ectn_ORIGIN_OCTOPI)) abort();
+
+    if (!TransactionRequest::needsProcess(command)) continue;
+
+    const QStringList arguments = TransactionRequest::arguments(command);
+    if (!command.packages.isEmpty())
+    {
+      const int separator = arguments.indexOf(QStringLiteral("--"));
+      if (separator < 0 || arguments.mid(separator + 1) != command.packages) abort();
+    }
+
+    TransactionRequest::program(command);
+    TransactionRequest::toString(command);
+  }
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef PACKAGEFIXTURE_H
+#define PACKAGEFIXTURE_H
+
+#include "../src/packagerepository.h"
+
+#include <QList>
+#include <QSet>
+#include <QStringList>
+
+/*
+ * Synthetic sync databases for the tests which need a PackageRepository full of packages
+ *
+ * Package i is "<prefix><stem><i>", in core, extra or multilib. Every 4th one is installed,
+ * every 40th of those is outdated, and every 7th installed one was installed as a dependency
+ */
+namespace PackageFixture
+{
+
+inline QList<PackageListData> makePackages(int count)
+{
+  static const QStringList prefixes{QStringLiteral("lib"), QStringLiteral("python-"), QStringLiteral("perl-"),
+    QStringLiteral("qt6-"), QStringLiteral("kde-"), QStringLiteral("gst-"), QStringLiteral("ruby-"),
+    QStringLiteral("haskell-"), QStringLiteral("r-"), QStringLiteral("go-")};
+  static const QStringList stems{QStringLiteral("requests"), QStringLiteral("xml"), QStringLiteral("audio"),
+    QStringLiteral("video"), QStringLiteral("net"), QStringLiteral("crypto"), QStringLiteral("font"),
+    QStringLiteral("theme"), QStringLiteral("tools"), QStringLiteral("utils"), QStringLiteral("docs"),
+    QStringLiteral("git"), QStringLiteral("image"), QStringLiteral("json"), QStringLiteral("sql"),
+    QStringLiteral("http"), QStringLiteral("ssl"), QStringLiteral("zip"), QStringLiteral("gtk"), QStringLiteral("sdl")};
+  static const QStringList repositories{QStringLiteral("core"), QStringLiteral("extra"), QStringLiteral("extra"),
+    QStringLiteral("extra"), QStringLiteral("multilib")};
+
+  QList<PackageListData> res;
+  res.reserve(count);
+
+  for (int i = 0; i < count; ++i)
+  {
+    const QString &prefix = prefixes.at(i % prefixes.count());
+    const QString &stem = stems.at((i / prefixes.count()) % stems.count());
+
+    PackageStatus status = ectn_NON_INSTALLED;
+    QString outdatedVersion;
+    if (i % 4 == 0)
+    {
+      status = ectn_INSTALLED;
+      if (i % 160 == 0)
+      {
+        status = ectn_OUTDATED;
+        outdatedVersion = QStringLiteral("%1.0-1").arg(i % 9);
+      }
+    }
+
+    const QString installReason = (status == ectn_NON_INSTALLED) ? QString() :
+          (i % 28 == 0) ? QStringLiteral("Installed as a dependency for another package") : QStringLiteral("Explicitly installed");
+
+    res << PackageListData(prefix + stem + QString::number(i), repositories.at(i % repositories.count()),
+                           QStringLiteral("%1.%2-%3").arg(i % 9 + 1).arg(i % 13).arg(i % 3 + 1),
+                           QStringLiteral("The %1 %2 bindings, release %3 of the upstream project").arg(stem, prefix).arg(i),
+                           status, 1024.0 * (i % 500 + 1), 4096.0 * (i % 700 + 1), 1.6e9 + i * 60.0,
+                           (status == ectn_NON_INSTALLED) ? 0.0 : 1.7e9 + i * 30.0,
+                           (i % 3) ? QStringLiteral("GPL-3.0-or-later") : QStringLiteral("MIT"), installReason, outdatedVersion);
+  }
+
+  return res;
+}
+
+/*
+ * Replaces the contents of repository by count synthetic packages
+ */
+inline void fill(PackageRepository &repository, int count)
+{
+  const QList<PackageListData> packages = makePackages(count);
+  repository.setData(&packages, QSet<QString>());
+}
+
+}
+
+#endif // PACKAGEFIXTURE_H
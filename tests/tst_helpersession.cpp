@@ -0,0 +1,346 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../helper/helpersession.h"
+#include "../helper/octopihelper.h"
+#include "../src/constants.h"
+
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <unistd.h>
+
+/*
+ * Stands for pacman: records what the session asks for and finishes when the test says so
+ */
+class FakeCommandExecutor: public CommandExecutor
+{
+  Q_OBJECT
+
+public:
+  QList<HelperCommand> commands;
+  QByteArray input;
+  int startCount = 0;
+  bool running = false;
+  bool cancelled = false;
+
+  void start(const QList<HelperCommand> &c) override
+  {
+    commands = c;
+    ++startCount;
+    running = true;
+    emit started();
+  }
+
+  void write(const QByteArray &data) override { input += data; }
+  void cancel() override { cancelled = true; }
+  bool isRunning() const override { return running; }
+
+  void print(const QByteArray &data) { emit output(data); }
+  void finish(int exitCode)
+  {
+    running = false;
+    emit finished(exitCode);
+  }
+};
+
+/*
+ * Unit tests for HelperSession, driven thru its socket with a fake executor
+ */
+class TestHelperSession : public QObject
+{
+  Q_OBJECT
+
+private:
+  QTemporaryDir m_dir;
+
+  QString socketPath() const { return m_dir.filePath(QStringLiteral("session")); }
+  static bool waitForMessage(QLocalSocket& socket, HelperMessageReader& reader, HelperMessage& message);
+  static void execute(QLocalSocket& socket, const QString& commands);
+  int listen(HelperSession& session, const QString& ownerPath);
+
+private slots:
+  void notifierUpgrades();
+  void notifierCannotRemove();
+  void octopiInstalls();
+  void cleanCacheRefused();
+  void malformedRequestRefused();
+  void secondTransactionRefused();
+  void cancelAndInput();
+  void longOutputIsSplit();
+  void strangerRefused();
+};
+
+bool TestHelperSession::waitForMessage(QLocalSocket &socket, HelperMessageReader &reader, HelperMessage &message)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  while (!reader.readMessage(message))
+  {
+    if (timer.elapsed() > 5000) return false;
+
+    QTest::qWait(10);
+    reader.append(socket.readAll());
+  }
+
+  return true;
+}
+
+void TestHelperSession::execute(QLocalSocket &socket, const QString &commands)
+{
+  socket.write(HelperProtocol::encode(ectn_HELPER_EXECUTE, commands.toLatin1()));
+  socket.flush();
+}
+
+/*
+ * This very process is the owner, so the session accepts the test's socket
+ */
+int TestHelperSession::listen(HelperSession &session, const QString &ownerPath)
+{
+  return session.listenOn(socketPath(), QCoreApplication::applicationPid(), getuid(), ownerPath);
+}
+
+void TestHelperSession::notifierUpgrades()
+{
+  QLocalSocket socket;
+  OctopiHelper helper;
+  FakeCommandExecutor executor;
+  HelperSession session(&helper, &executor);
+  QCOMPARE(listen(session, QStringLiteral("/usr/bin/octopi-notifier")), 0);
+
+  socket.connectToServer(socketPath());
+  QVERIFY(socket.waitForConnected());
+  execute(socket, QStringLiteral("rm /var/lib/pacman/db.lck\npacman -Syu --noconfirm\n"));
+
+  HelperMessageReader reader;
+  HelperMessage message;
+  QVERIFY(waitForMessage(socket, reader, message));
+  QCOMPARE(message.type, ectn_HELPER_STARTED);
+  QCOMPARE(executor.commands.count(), 2);
+  QCOMPARE(executor.commands.at(1).operation, ectn_HELPER_OP_SYSTEM_UPGRADE);
+
+  executor.print(QByteArrayLiteral(":: Starting full system upgrade...\n"));
+  QVERIFY(waitForMessage(socket, reader, message));
+  QCOMPARE(message.type, ectn_HELPER_OUTPUT);
+  QCOMPARE(message.payload, QByteArrayLiteral(":: Starting full system upgrade...\n"));
+
+  executor.finish(0);
+  QVERIFY(waitForMessage(socket, reader, message));
+  QCOMPARE(message.type, ectn_HELPER_FINISHED);
+  QCOMPARE(HelperProtocol::decodeExitCode(message.payload), 0);
+}
+
+/*
+ * Each command is checked on its own, so an upgrade cannot carry a removal along
+ */
+void TestHelperSession::notifierCannotRemove()
+{
+  QLocalSocket socket;
+  OctopiHelper helper;
+  FakeCommandExecutor executor;
+  HelperSession session(&helper, &executor);
+  QCOMPARE(listen(session, QStringLiteral("/usr/bin/octopi-notifier")), 0);
+
+  socket.connectToServer(socketPath());
+  QVERIFY(socket.waitForConnected());
+  execute(socket, QStringLiteral("pacman -Syu --noconfirm\npacman -R --noconfirm vim\n"));
+
+  HelperMessageReader reader;
+  HelperMessage message;
+  QVERIFY(waitForMessage(socket, reader, message));
+  QCOMPARE(message.type, ectn_HELPER_REFUSED);
+  QCOMPARE(HelperProtocol::decodeExitCode(message.payload), ctn_SUSPICIOUS_EXECUTION_METHOD);
+  QCOMPARE(executor.startCount, 0);
+}
+
+void TestHelperSession::octopiInstalls()
+{
+  QLocalSocket socket;
+  OctopiHelper helper;
+  FakeCommandExecutor executor;
+  HelperSession session(&helper, &executor);
+  QCOMPARE(listen(session, QStringLiteral("/usr/bin/octopi")), 0);
+
+  socket.connectToServer(socketPath());
+  QVERIFY(socket.waitForConnected());
+  execute(socket, QStringLiteral("pacman -S --noconfirm extra/vim\n"));
+
+  HelperMessageReader reader;
+  HelperMessage message;
+  QVERIFY(waitForMessage(socket, reader, message));
+  QCOMPARE(message.type, ectn_HELPER_STARTED);
+  QCOMPARE(executor.commands.count(), 1);
+  QCOMPARE(executor.commands.at(0).operation, ectn_HELPER_OP_INSTALL);
+  QCOMPARE(executor.commands.at(0).packages, QStringList() << QStringLiteral("extra/vim"));
+}
+
+/*
+ * Only the cache cleaner cleans the cache, and it never uses a session
+ */
+void TestHelperSession::cleanCacheRefused()
+{
+  QLocalSocket socket;
+  OctopiHelper helper;
+  FakeCommandExecutor executor;
+  HelperSession session(&helper, &executor);
+  QCOMPARE(listen(session, QStringLiteral("/usr/bin/octopi")), 0);
+
+  socket.connectToServer(socketPath());
+  QVERIFY(socket.waitForConnected());
+  execute(socket, QStringLiteral("paccache -r -k 3\n"));
+
+  HelperMessageReader reader;
+  HelperMessage message;
+  QVERIFY(waitForMessage(socket, reader, message));
+  QCOMPARE(message.type, ectn_HELPER_REFUSED);
+  QCOMPARE(executor.startCount, 0);
+}
+
+void TestHelperSession::malformedRequestRefused()
+{
+  QLocalSocket socket;
+  OctopiHelper helper;
+  FakeCommandExecutor executor;
+  HelperSession session(&helper, &executor);
+  QCOMPARE(listen(session, QStringLiteral("/usr/bin/octopi")), 0);
+
+  socket.connectToServer(socketPath());
+  QVERIFY(socket.waitForConnected());
+  execute(socket, QStringLiteral("pacman -R --noconfirm vim; rm -rf /\n"));
+
+  HelperMessageReader reader;
+  HelperMessage message;
+  QVERIFY(waitForMessage(socket, reader, message));
+  QCOMPARE(message.type, ectn_HELPER_REFUSED);
+  QCOMPARE(HelperProtocol::decodeExitCode(message.payload), ctn_SUSPICIOUS_ACTIONS_FILE);
+  QCOMPARE(executor.startCount, 0);
+}
+
+void TestHelperSession::secondTransactionRefused()
+{
+  QLocalSocket socket;
+  OctopiHelper helper;
+  FakeCommandExecutor executor;
+  HelperSession session(&helper, &executor);
+  QCOMPARE(listen(session, QStringLiteral("/usr/bin/octopi")), 0);
+
+  socket.connectToServer(socketPath());
+  QVERIFY(socket.waitForConnected());
+  execute(socket, QStringLiteral("pacman -R --noconfirm vim\n"));
+
+  HelperMessageReader reader;
+  HelperMessage message;
+  QVERIFY(waitForMessage(socket, reader, message));
+  QCOMPARE(message.type, ectn_HELPER_STARTED);
+
+  execute(socket, QStringLiteral("pacman -R --noconfirm nano\n"));
+  QVERIFY(waitForMessage(socket, reader, message));
+  QCOMPARE(message.type, ectn_HELPER_REFUSED);
+  QCOMPARE(HelperProtocol::decodeExitCode(message.payload), ctn_PACMAN_PROCESS_EXECUTING);
+  QCOMPARE(executor.startCount, 1);
+}
+
+void TestHelperSession::cancelAndInput()
+{
+  QLocalSocket socket;
+  OctopiHelper helper;
+  FakeCommandExecutor executor;
+  HelperSession session(&helper, &executor);
+  QCOMPARE(listen(session, QStringLiteral("/usr/bin/octopi")), 0);
+
+  socket.connectToServer(socketPath());
+  QVERIFY(socket.waitForConnected());
+  execute(socket, QStringLiteral("pacman -Syu\n"));
+
+  HelperMessageReader reader;
+  HelperMessage message;
+  QVERIFY(waitForMessage(socket, reader, message));
+  QCOMPARE(message.type, ectn_HELPER_STARTED);
+
+  socket.write(HelperProtocol::encode(ectn_HELPER_INPUT, QByteArrayLiteral("y\n")));
+  socket.write(HelperProtocol::encode(ectn_HELPER_CANCEL));
+  socket.flush();
+
+  QTRY_VERIFY(executor.cancelled);
+  QCOMPARE(executor.input, QByteArrayLiteral("y\n"));
+}
+
+/*
+ * Output bigger than a message goes in as many OUTPUT messages as needed
+ */
+void TestHelperSession::longOutputIsSplit()
+{
+  QLocalSocket socket;
+  OctopiHelper helper;
+  FakeCommandExecutor executor;
+  HelperSession session(&helper, &executor);
+  QCOMPARE(listen(session, QStringLiteral("/usr/bin/octopi")), 0);
+
+  socket.connectToServer(socketPath());
+  QVERIFY(socket.waitForConnected());
+  execute(socket, QStringLiteral("pacman -Syu\n"));
+
+  HelperMessageReader reader;
+  HelperMessage message;
+  QVERIFY(waitForMessage(socket, reader, message));
+  QCOMPARE(message.type, ectn_HELPER_STARTED);
+
+  const QByteArray output(ctn_OCTOPI_HELPER_MAX_MESSAGE_SIZE * 2 + 10, 'x');
+  executor.print(output);
+  executor.finish(0);
+
+  QByteArray received;
+  int outputMessages = 0;
+  while (waitForMessage(socket, reader, message) && message.type == ectn_HELPER_OUTPUT)
+  {
+    received += message.payload;
+    ++outputMessages;
+  }
+
+  QCOMPARE(message.type, ectn_HELPER_FINISHED);
+  QCOMPARE(outputMessages, 3);
+  QCOMPARE(received, output);
+}
+
+/*
+ * Any process other than the owner is dropped, even if it runs as the owner's user
+ */
+void TestHelperSession::strangerRefused()
+{
+  QLocalSocket socket;
+  OctopiHelper helper;
+  FakeCommandExecutor executor;
+  HelperSession session(&helper, &executor);
+  QCOMPARE(session.listenOn(socketPath(), 1, getuid(), QStringLiteral("/usr/bin/octopi")), 0);
+
+  socket.connectToServer(socketPath());
+  QVERIFY(socket.waitForConnected());
+  execute(socket, QStringLiteral("pacman -Syu\n"));
+
+  QTRY_COMPARE(socket.state(), QLocalSocket::UnconnectedState);
+  QCOMPARE(executor.startCount, 0);
+}
+
+QTEST_GUILESS_MAIN(TestHelperSession)
+
+#include "tst_helpersession.moc"
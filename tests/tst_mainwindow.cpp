@@ -0,0 +1,248 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/mainwindow.h"
+#include "../src/packageinfocache.h"
+#include "../src/propertiestabwidget.h"
+#include "../src/settingsmanager.h"
+#include "packagefixture.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextBrowser>
+#include <QtTest>
+
+#include <algorithm>
+#include <vector>
+
+/*
+ * Packages in the fixture repository, and rows stepped through with the arrow keys
+ */
+static const int ctn_FIXTURE_PACKAGES = 1000;
+static const int ctn_STEPPED_ROWS = 200;
+
+/*
+ * How long the fake pacman takes to answer, and the pause between two arrow key presses
+ */
+static const int ctn_PACMAN_DELAY_MS = 20;
+static const int ctn_KEY_INTERVAL_MS = 40;
+
+/*
+ * Lines a transaction writes to the Output tab, and how many of them arrive between two flushes
+ */
+static const int ctn_OUTPUT_LINES = 100000;
+static const int ctn_OUTPUT_LINES_PER_FLUSH = 100;
+
+/*
+ * MainWindow parts which can run without show(), against a fixture repository and a fake pacman
+ *
+ * The fake "pacman" comes first in PATH. It waits ctn_PACMAN_DELAY_MS, logs its arguments and
+ * answers with the version of the fixture package it was asked about
+ */
+class TestMainWindow: public QObject
+{
+  Q_OBJECT
+
+private:
+  QTemporaryDir m_tempDir;
+  MainWindow *m_mainWindow;
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void benchmarkStepThroughRows_data();
+  void benchmarkStepThroughRows();
+  void benchmarkFlushOutput_data();
+  void benchmarkFlushOutput();
+};
+
+void TestMainWindow::initTestCase()
+{
+  QVERIFY(m_tempDir.isValid());
+
+  //Neither the user's settings nor the real pacman
+  qputenv("XDG_CONFIG_HOME", QFile::encodeName(m_tempDir.path() + QLatin1String("/config")));
+  qputenv("HOME", QFile::encodeName(m_tempDir.path()));
+
+  const QList<PackageListData> packages = PackageFixture::makePackages(ctn_FIXTURE_PACKAGES);
+  const QString versions = m_tempDir.path() + QLatin1String("/versions");
+  QFile versionsFile(versions);
+  QVERIFY(versionsFile.open(QIODevice::WriteOnly));
+  for (const PackageListData &package: packages)
+  {
+    versionsFile.write(QString(package.name + QLatin1Char(' ') + package.version + QLatin1Char('\n')).toUtf8());
+  }
+  versionsFile.close();
+
+  const QString binDir = m_tempDir.path() + QLatin1String("/bin");
+  QVERIFY(QDir().mkpath(binDir));
+
+  QFile pacman(binDir + QLatin1String("/pacman"));
+  QVERIFY(pacman.open(QIODevice::WriteOnly));
+  pacman.write(QByteArray("#!/bin/sh\nsleep " + QByteArray::number(ctn_PACMAN_DELAY_MS / 1000.0) + "\n"
+                          "name=\"${2#*/}\"\n"
+                          "version=$(grep \"^$name \" \"" + QFile::encodeName(versions) + "\" | cut -d' ' -f2)\n"
+                          "printf 'Name            : %s\\nVersion         : %s\\nInstalled Size  : 2.00 MiB\\n' "
+                          "\"$name\" \"$version\"\n"));
+  pacman.close();
+  QVERIFY(pacman.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner));
+  qputenv("PATH", QByteArray(QFile::encodeName(binDir) + ':' + qgetenv("PATH")));
+
+  m_mainWindow = new MainWindow();
+  m_mainWindow->initTabInfo();
+  m_mainWindow->initTabOutput();
+  m_mainWindow->m_packageRepo.setData(&packages, QSet<QString>());
+  QCOMPARE(m_mainWindow->m_packageModel->getPackageCount(), ctn_FIXTURE_PACKAGES);
+}
+
+void TestMainWindow::cleanupTestCase()
+{
+  delete m_mainWindow;
+}
+
+void TestMainWindow::benchmarkStepThroughRows_data()
+{
+  QTest::addColumn<bool>("prefetch");
+
+  QTest::newRow("without prefetch") << false;
+  QTest::newRow("with prefetch") << true;
+}
+
+/*
+ * Pressing the down arrow through ctn_STEPPED_ROWS rows with the Info tab open. Each step times
+ * refreshTabInfo, while the neighbours of the new row are prefetched during the pause which follows
+ */
+void TestMainWindow::benchmarkStepThroughRows()
+{
+  QFETCH(bool, prefetch);
+
+  PackageModel *model = m_mainWindow->m_packageModel.get();
+  std::vector<qint64> latencies;
+  latencies.reserve(ctn_STEPPED_ROWS);
+
+  PackageInfoCache::clear();
+
+  QBENCHMARK_ONCE
+  {
+    for (int row = 0; row < ctn_STEPPED_ROWS; ++row)
+    {
+      const PackageRepository::PackageData *package =
+          model->getData(model->index(row, PackageModel::ctn_PACKAGE_NAME_COLUMN, QModelIndex()));
+
+      QElapsedTimer step;
+      step.start();
+      m_mainWindow->refreshTabInfo(package->name);
+      latencies.push_back(step.nsecsElapsed());
+
+      if (prefetch) m_mainWindow->m_packagePrefetcher.prefetch(m_mainWindow->getNeighbourRequests(row));
+      QTest::qWait(ctn_KEY_INTERVAL_MS);
+    }
+  }
+
+  m_mainWindow->m_packagePrefetcher.cancel();
+
+  std::sort(latencies.begin(), latencies.end());
+  qint64 total = 0;
+  for (qint64 latency: latencies) total += latency;
+
+  const qint64 median = latencies.at(latencies.size() / 2);
+  qDebug("refreshTabInfo per step: mean %.2f ms, median %.2f ms, 95th percentile %.2f ms, max %.2f ms",
+         total / 1e6 / latencies.size(), median / 1e6, latencies.at(latencies.size() * 95 / 100) / 1e6,
+         latencies.back() / 1e6);
+
+  //Without prefetching every step waits for pacman. With it, most steps find the package cached
+  if (prefetch)
+    QVERIFY(median < ctn_PACMAN_DELAY_MS * 1000000LL);
+  else
+    QVERIFY(median >= ctn_PACMAN_DELAY_MS * 1000000LL);
+}
+
+void TestMainWindow::benchmarkFlushOutput_data()
+{
+  QTest::addColumn<int>("maxLines");
+
+  QTest::newRow("unlimited") << 0;
+  QTest::newRow("Output_Max_Lines 5000") << 5000;
+}
+
+/*
+ * Feeds ctn_OUTPUT_LINES lines through flushOutput, ctn_OUTPUT_LINES_PER_FLUSH at a time as
+ * m_outputFlushTimer would gather them, and reports the time flushOutput takes on the GUI thread
+ */
+void TestMainWindow::benchmarkFlushOutput()
+{
+  QFETCH(int, maxLines);
+
+  SettingsManager::setOutputMaxLines(maxLines);
+  m_mainWindow->clearTabOutput();
+
+  const qint64 renderTime = m_mainWindow->m_outputRenderTime;
+  const int flushCount = m_mainWindow->m_outputFlushCount;
+  qint64 longestFlush = 0;
+
+  QBENCHMARK_ONCE
+  {
+    for (int line = 0; line < ctn_OUTPUT_LINES; ++line)
+    {
+      m_mainWindow->m_pendingOutput += QStringLiteral("(%1/%2) installing package-%3...<br>")
+          .arg(line + 1).arg(ctn_OUTPUT_LINES).arg(line, 6, 10, QLatin1Char('0'));
+
+      if ((line + 1) % ctn_OUTPUT_LINES_PER_FLUSH == 0)
+      {
+        QElapsedTimer flush;
+        flush.start();
+        m_mainWindow->flushOutput();
+        longestFlush = qMax(longestFlush, flush.nsecsElapsed());
+      }
+    }
+  }
+
+  const int flushes = m_mainWindow->m_outputFlushCount - flushCount;
+  const qint64 total = m_mainWindow->m_outputRenderTime - renderTime;
+  qDebug("flushOutput on the GUI thread: %d flushes, total %.2f ms, mean %.2f ms, max %.2f ms",
+         flushes, total / 1e6, total / 1e6 / flushes, longestFlush / 1e6);
+
+  QCOMPARE(flushes, ctn_OUTPUT_LINES / ctn_OUTPUT_LINES_PER_FLUSH);
+
+  QTextBrowser *text = m_mainWindow->findChild<PropertiesTabWidget*>()->getTextOutput();
+  const QString output = text->toPlainText();
+  QVERIFY(output.contains(QLatin1String("installing package-099999...")));
+
+  if (maxLines == 0)
+  {
+    QCOMPARE(m_mainWindow->m_outputLineCount, ctn_OUTPUT_LINES);
+    QVERIFY(output.contains(QLatin1String("installing package-000000...")));
+  }
+  else
+  {
+    //Trimming keeps both the counter and the document within Output_Max_Lines
+    QVERIFY(m_mainWindow->m_outputLineCount <= maxLines);
+    QVERIFY(output.count(QLatin1Char('\n')) <= maxLines + 1);
+    QVERIFY(!output.contains(QLatin1String("installing package-000000...")));
+  }
+
+  m_mainWindow->clearTabOutput();
+}
+
+QTEST_MAIN(TestMainWindow)
+
+#include "tst_mainwindow.moc"
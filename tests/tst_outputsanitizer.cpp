@@ -0,0 +1,114 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/outputsanitizer.h"
+
+#include <QtTest>
+
+/*
+ * Unit tests and a transcript benchmark for OutputSanitizer
+ */
+class TestOutputSanitizer : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void removeEscapeSequences_data();
+  void removeEscapeSequences();
+  void sanitizePacmanOutput_data();
+  void sanitizePacmanOutput();
+  void benchmarkTranscript();
+};
+
+void TestOutputSanitizer::removeEscapeSequences_data()
+{
+  QTest::addColumn<QString>("input");
+  QTest::addColumn<QString>("expected");
+
+  QTest::newRow("plain text") << QStringLiteral("resolving dependencies...") << QStringLiteral("resolving dependencies...");
+  QTest::newRow("sgr") << QStringLiteral("\033[1;31merror:\033[0m failed") << QStringLiteral("error: failed");
+  QTest::newRow("sgr without esc") << QStringLiteral("[1;32mok[0m") << QStringLiteral("ok");
+  QTest::newRow("osc with bel") << QStringLiteral("\033]0;pacman\007done") << QStringLiteral("done");
+  QTest::newRow("osc with st") << QStringLiteral("\033]0;pacman\033\\done") << QStringLiteral("done");
+  QTest::newRow("charset") << QStringLiteral("\033(Bdone") << QStringLiteral("done");
+  QTest::newRow("two char escape") << QStringLiteral("\033cdone") << QStringLiteral("done");
+  QTest::newRow("cursor movement") << QStringLiteral("\033[2K\033[1Gdone") << QStringLiteral("done");
+  QTest::newRow("unterminated csi") << QStringLiteral("done\033[1;3") << QStringLiteral("done");
+  QTest::newRow("question") << QStringLiteral(":: Proceed with installation? [Y/n]") << QStringLiteral(":: Proceed with installation? [Y/n]");
+  QTest::newRow("progress bar") << QStringLiteral("[######------]  50%") << QStringLiteral("[######------]  50%");
+}
+
+void TestOutputSanitizer::removeEscapeSequences()
+{
+  QFETCH(QString, input);
+  QFETCH(QString, expected);
+
+  QCOMPARE(OutputSanitizer::removeEscapeSequences(input), expected);
+}
+
+void TestOutputSanitizer::sanitizePacmanOutput_data()
+{
+  QTest::addColumn<QString>("input");
+  QTest::addColumn<QString>("expected");
+
+  QTest::newRow("colored line") << QStringLiteral("\033[1mresolving dependencies...\033[0m") << QStringLiteral("resolving dependencies...");
+  QTest::newRow("question") << QStringLiteral(":: Proceed with installation? [Y/n] y") << QString();
+  QTest::newRow("hidden cursor") << QStringLiteral("[?25lchecking keyring...") << QStringLiteral("checking keyring...");
+  QTest::newRow("shown cursor") << QStringLiteral("checking keyring...[?25h") << QStringLiteral("checking keyring...");
+  QTest::newRow("lone parenthesis") << QStringLiteral("(") << QString();
+  QTest::newRow("step") << QStringLiteral("(1/2) upgrading linux") << QStringLiteral("(1/2) upgrading linux");
+}
+
+void TestOutputSanitizer::sanitizePacmanOutput()
+{
+  QFETCH(QString, input);
+  QFETCH(QString, expected);
+
+  QCOMPARE(OutputSanitizer::sanitizePacmanOutput(input), expected);
+}
+
+/*
+ * Replays a colored upgrade transcript of 10k lines, read in 4 KiB chunks like QProcess delivers them
+ */
+void TestOutputSanitizer::benchmarkTranscript()
+{
+  QString transcript;
+  for (int i=1; i<=10000; ++i)
+  {
+    transcript += QStringLiteral("\033[1m(%1/10000)\033[0m upgrading package-%1  \033[?25l[#######-----]  58%\033[?25h\r\n").arg(i);
+  }
+
+  QStringList chunks;
+  for (int i=0; i<transcript.size(); i+=4096) chunks.append(transcript.mid(i, 4096));
+
+  int size = 0;
+  QBENCHMARK
+  {
+    size = 0;
+    for (const QString &chunk: std::as_const(chunks)) size += OutputSanitizer::sanitizePacmanOutput(chunk).size();
+  }
+
+  QVERIFY(size > 0);
+  QVERIFY(size < transcript.size());
+}
+
+QTEST_GUILESS_MAIN(TestOutputSanitizer)
+
+#include "tst_outputsanitizer.moc"
@@ -0,0 +1,168 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/packagebitset.h"
+
+#include <QtTest>
+
+#include <vector>
+
+/*
+ * Unit tests for PackageBitset, checked against a std::vector<bool> holding the same positions
+ */
+class TestPackageBitset : public QObject
+{
+  Q_OBJECT
+
+private:
+  static void fillEvery(int size, int step, int offset, PackageBitset &set, std::vector<bool> &reference);
+  static void compare(const PackageBitset &set, const std::vector<bool> &reference);
+
+private slots:
+  void fill_data();
+  void fill();
+  void andWith_data();
+  void andWith();
+  void nextSetBitAtTheEnd();
+};
+
+/*
+ * Sets every step-th position, starting at offset
+ */
+void TestPackageBitset::fillEvery(int size, int step, int offset, PackageBitset &set, std::vector<bool> &reference)
+{
+  set.fill(size, false);
+  reference.assign(static_cast<size_t>(size), false);
+
+  for (int pos = offset; pos < size; pos += step)
+  {
+    set.set(pos);
+    reference[static_cast<size_t>(pos)] = true;
+  }
+}
+
+/*
+ * Same size, same bits, same count, and nextSetBit() visits exactly the set positions
+ */
+void TestPackageBitset::compare(const PackageBitset &set, const std::vector<bool> &reference)
+{
+  QCOMPARE(set.size(), static_cast<int>(reference.size()));
+
+  int count = 0;
+  for (int pos = 0; pos < set.size(); ++pos)
+  {
+    QCOMPARE(set.test(pos), bool(reference[static_cast<size_t>(pos)]));
+    if (reference[static_cast<size_t>(pos)]) ++count;
+  }
+  QCOMPARE(set.count(), count);
+
+  int visited = 0;
+  int expected = -1;
+  for (int pos = set.nextSetBit(0); pos != -1; pos = set.nextSetBit(pos + 1))
+  {
+    do ++expected; while (!reference[static_cast<size_t>(expected)]);
+    QCOMPARE(pos, expected);
+    ++visited;
+  }
+  QCOMPARE(visited, count);
+}
+
+void TestPackageBitset::fill_data()
+{
+  QTest::addColumn<int>("size");
+  QTest::addColumn<bool>("value");
+
+  const QList<int> sizes{0, 1, 63, 64, 65, 128, 1000};
+  for (int size: sizes)
+  {
+    QTest::addRow("%d cleared", size) << size << false;
+    QTest::addRow("%d set", size) << size << true;
+  }
+}
+
+/*
+ * fill(size, true) must not set the bits past the end of the last word
+ */
+void TestPackageBitset::fill()
+{
+  QFETCH(int, size);
+  QFETCH(bool, value);
+
+  PackageBitset set;
+  set.fill(size, value);
+  compare(set, std::vector<bool>(static_cast<size_t>(size), value));
+}
+
+void TestPackageBitset::andWith_data()
+{
+  QTest::addColumn<int>("size");
+  QTest::addColumn<int>("stepA");
+  QTest::addColumn<int>("stepB");
+
+  QTest::newRow("one word") << 50 << 2 << 3;
+  QTest::newRow("word boundary") << 64 << 4 << 6;
+  QTest::newRow("partial last word") << 1000 << 3 << 7;
+  QTest::newRow("disjoint") << 300 << 2 << 2;
+  QTest::newRow("installed and repository") << 15000 << 4 << 5;
+}
+
+/*
+ * A AND B, against the same AND over the reference. The second set starts at 1 so it is
+ * disjoint from the first one when both steps are even
+ */
+void TestPackageBitset::andWith()
+{
+  QFETCH(int, size);
+  QFETCH(int, stepA);
+  QFETCH(int, stepB);
+
+  PackageBitset a, b;
+  std::vector<bool> referenceA, referenceB;
+  fillEvery(size, stepA, 0, a, referenceA);
+  fillEvery(size, stepB, 1, b, referenceB);
+  compare(a, referenceA);
+  compare(b, referenceB);
+
+  a.andWith(b);
+  for (size_t pos = 0; pos < referenceA.size(); ++pos)
+  {
+    referenceA[pos] = referenceA[pos] && referenceB[pos];
+  }
+
+  compare(a, referenceA);
+  compare(b, referenceB);
+}
+
+void TestPackageBitset::nextSetBitAtTheEnd()
+{
+  PackageBitset set;
+  set.fill(130, false);
+  QCOMPARE(set.nextSetBit(0), -1);
+
+  set.set(129);
+  QCOMPARE(set.nextSetBit(0), 129);
+  QCOMPARE(set.nextSetBit(129), 129);
+  QCOMPARE(set.nextSetBit(130), -1);
+  QCOMPARE(set.nextSetBit(500), -1);
+}
+
+QTEST_GUILESS_MAIN(TestPackageBitset)
+
+#include "tst_packagebitset.moc"
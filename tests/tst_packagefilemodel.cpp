@@ -0,0 +1,216 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/model/packagefilemodel.h"
+#include "../src/package.h"
+
+#include <QRegularExpression>
+#include <QtTest>
+
+/*
+ * PackageFileModel over the file list of a big package (about 60k paths, like a large texlive
+ * or a kernel headers package), as printed by "pacman -Ql"
+ */
+class TestPackageFileModel: public QObject
+{
+  Q_OBJECT
+
+private:
+  QStringList m_fileList;
+  PackageFileModel m_model;
+
+  static QStringList makeFileList();
+  void walk(const QModelIndex &parent, const QRegularExpression &regex, bool matchFullPath, QStringList &matches) const;
+
+private slots:
+  void initTestCase();
+  void everyPathIsInTheTree();
+  void findFiles_data();
+  void findFiles();
+  void benchmarkSetFileList();
+  void benchmarkFindFiles_data();
+  void benchmarkFindFiles();
+};
+
+/*
+ * 200 applications of 10 directories with 29 files each, plus their parents: 60203 sorted paths
+ */
+QStringList TestPackageFileModel::makeFileList()
+{
+  QStringList res;
+  res << QStringLiteral("/usr/") << QStringLiteral("/usr/share/");
+
+  for (int app = 0; app < 200; ++app)
+  {
+    const QString appDir = QStringLiteral("/usr/share/app%1/").arg(app, 3, 10, QLatin1Char('0'));
+    res << appDir;
+
+    for (int sub = 0; sub < 10; ++sub)
+    {
+      const QString subDir = appDir + QStringLiteral("sub%1/").arg(sub);
+      res << subDir;
+
+      for (int file = 0; file < 29; ++file)
+      {
+        res << subDir + QStringLiteral("file%1.txt").arg(file, 2, 10, QLatin1Char('0'));
+      }
+    }
+  }
+
+  res << QStringLiteral("/usr/share/licenses/");
+  res.sort();
+  return res;
+}
+
+/*
+ * Collects the full paths of the rows matched by regex, visiting the tree the way a fully
+ * expanded view shows it
+ */
+void TestPackageFileModel::walk(const QModelIndex &parent, const QRegularExpression &regex, bool matchFullPath,
+                                QStringList &matches) const
+{
+  for (int row = 0; row < m_model.rowCount(parent); ++row)
+  {
+    const QModelIndex index = m_model.index(row, 0, parent);
+    const QString fullPath = m_model.getFullPath(index);
+
+    if (regex.match(matchFullPath ? fullPath : m_model.data(index, Qt::DisplayRole).toString()).hasMatch())
+      matches << fullPath;
+
+    if (m_model.hasChildren(index)) walk(index, regex, matchFullPath, matches);
+  }
+}
+
+void TestPackageFileModel::initTestCase()
+{
+  m_fileList = makeFileList();
+  QCOMPARE(m_fileList.size(), 60203);
+
+  m_model.setFileList(QStringLiteral("bigpackage"), m_fileList);
+}
+
+/*
+ * One node per distinct path, and each of them is reached from the root
+ */
+void TestPackageFileModel::everyPathIsInTheTree()
+{
+  QCOMPARE(m_model.getNodeCount(), m_fileList.size());
+
+  QStringList all;
+  walk(QModelIndex(), QRegularExpression(QStringLiteral(".")), false, all);
+
+  QStringList expected;
+  for (const QString &path: m_fileList)
+  {
+    expected << (path.endsWith(QLatin1Char('/')) ? path.left(path.size() - 1) : path);
+  }
+
+  all.sort();
+  expected.sort();
+  QCOMPARE(all, expected);
+}
+
+void TestPackageFileModel::findFiles_data()
+{
+  QTest::addColumn<QString>("searchText");
+
+  QTest::newRow("file name") << QStringLiteral("file07");
+  QTest::newRow("wildcard") << QStringLiteral("*.txt");
+  QTest::newRow("directory name") << QStringLiteral("sub3");
+  QTest::newRow("full path") << QStringLiteral("app012/sub4/");
+  QTest::newRow("upper case") << QStringLiteral("APP19");
+  QTest::newRow("no match") << QStringLiteral("missing.conf");
+}
+
+/*
+ * The indexes findFiles returns map back to the paths a walk of the tree matches, in the same order,
+ * and each of them is the index the model gives for its row
+ */
+void TestPackageFileModel::findFiles()
+{
+  QFETCH(QString, searchText);
+
+  const QRegularExpression regex(Package::parseSearchString(searchText), QRegularExpression::CaseInsensitiveOption);
+  QStringList expected;
+  walk(QModelIndex(), regex, searchText.contains(QLatin1Char('/')), expected);
+
+  const QModelIndexList found = m_model.findFiles(searchText);
+  QStringList paths;
+
+  for (const QModelIndex &index: found)
+  {
+    QCOMPARE(m_model.index(index.row(), 0, m_model.parent(index)), index);
+    paths << m_model.getFullPath(index);
+  }
+
+  QCOMPARE(paths, expected);
+}
+
+/*
+ * What opening the Files tab of the package costs before anything is painted
+ */
+void TestPackageFileModel::benchmarkSetFileList()
+{
+  PackageFileModel model;
+
+  QBENCHMARK
+  {
+    model.setFileList(QStringLiteral("bigpackage"), m_fileList);
+  }
+
+  QCOMPARE(model.getNodeCount(), m_fileList.size());
+}
+
+void TestPackageFileModel::benchmarkFindFiles_data()
+{
+  QTest::addColumn<QString>("searchText");
+  QTest::addColumn<bool>("firstSearch");
+
+  QTest::newRow("first search") << QStringLiteral("file07") << true;
+  QTest::newRow("file name") << QStringLiteral("file07") << false;
+  QTest::newRow("full path") << QStringLiteral("app012/sub4/") << false;
+}
+
+/*
+ * A search in the Files tab. The first one after setFileList also builds the flat path list
+ */
+void TestPackageFileModel::benchmarkFindFiles()
+{
+  QFETCH(QString, searchText);
+  QFETCH(bool, firstSearch);
+
+  PackageFileModel model;
+  model.setFileList(QStringLiteral("bigpackage"), m_fileList);
+  if (!firstSearch) model.findFiles(searchText);
+
+  QModelIndexList found;
+
+  QBENCHMARK
+  {
+    if (firstSearch) model.setFileList(QStringLiteral("bigpackage"), m_fileList);
+    found = model.findFiles(searchText);
+  }
+
+  QVERIFY(!found.isEmpty());
+}
+
+QTEST_MAIN(TestPackageFileModel)
+
+#include "tst_packagefilemodel.moc"
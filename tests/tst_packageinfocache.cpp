@@ -0,0 +1,208 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/package.h"
+#include "../src/packageinfocache.h"
+#include "packagefixture.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+/*
+ * Packages the scripted navigation walks through
+ */
+static const int ctn_NAVIGATION_PACKAGES = 300;
+
+/*
+ * Package::getInformation through PackageInfoCache, against a fake pacman
+ *
+ * The fake "pacman" comes first in PATH: it logs its arguments, and answers with the repository,
+ * name and version of the fixture package it was asked about
+ */
+class TestPackageInfoCache: public QObject
+{
+  Q_OBJECT
+
+private:
+  QTemporaryDir m_tempDir;
+  QString m_spawnLog;
+  QList<PackageListData> m_packages;
+
+  QStringList spawns() const;
+  static void lookUp(const PackageListData &package);
+  void navigate(const QList<int> &rows) const;
+
+private slots:
+  void initTestCase();
+  void init();
+  void repositoryIsPartOfTheKey();
+  void otherVersionIsFetchedAgain();
+  void localInformationIgnoresRepository();
+  void benchmarkNavigation();
+};
+
+QStringList TestPackageInfoCache::spawns() const
+{
+  QFile log(m_spawnLog);
+  if (!log.open(QIODevice::ReadOnly)) return QStringList();
+
+  return QString::fromUtf8(log.readAll()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+}
+
+/*
+ * What the Info tab asks for the selected package: local information for installed packages,
+ * sync information for the exact version and repository otherwise
+ */
+void TestPackageInfoCache::lookUp(const PackageListData &package)
+{
+  if (package.status == ectn_INSTALLED)
+    Package::getInformation(package.name, true);
+  else
+    Package::getInformation(package.name, false, package.version, package.repository);
+}
+
+void TestPackageInfoCache::navigate(const QList<int> &rows) const
+{
+  for (int row: rows)
+  {
+    lookUp(m_packages.at(row));
+  }
+}
+
+void TestPackageInfoCache::initTestCase()
+{
+  QVERIFY(m_tempDir.isValid());
+
+  //Neither the user's settings nor the real pacman
+  qputenv("XDG_CONFIG_HOME", QFile::encodeName(m_tempDir.path() + QLatin1String("/config")));
+
+  m_packages = PackageFixture::makePackages(ctn_NAVIGATION_PACKAGES);
+  const QString versions = m_tempDir.path() + QLatin1String("/versions");
+  QFile versionsFile(versions);
+  QVERIFY(versionsFile.open(QIODevice::WriteOnly));
+  for (const PackageListData &package: m_packages)
+  {
+    versionsFile.write(QString(package.name + QLatin1Char(' ') + package.version + QLatin1Char('\n')).toUtf8());
+  }
+  versionsFile.close();
+
+  const QString binDir = m_tempDir.path() + QLatin1String("/bin");
+  QVERIFY(QDir().mkpath(binDir));
+  m_spawnLog = m_tempDir.path() + QLatin1String("/spawns.log");
+
+  QFile pacman(binDir + QLatin1String("/pacman"));
+  QVERIFY(pacman.open(QIODevice::WriteOnly));
+  pacman.write(QByteArray("#!/bin/sh\necho \"$@\" >> \"" + QFile::encodeName(m_spawnLog) + "\"\n"
+                          "case \"$2\" in */*) repo=\"${2%%/*}\"; name=\"${2#*/}\" ;; *) repo=local; name=\"$2\" ;; esac\n"
+                          "version=$(grep \"^$name \" \"" + QFile::encodeName(versions) + "\" | cut -d' ' -f2)\n"
+                          "printf 'Repository      : %s\\nName            : %s\\nVersion         : %s\\n"
+                          "Installed Size  : 2.00 MiB\\n' \"$repo\" \"$name\" \"${version:-1.0-1}\"\n"));
+  pacman.close();
+  QVERIFY(pacman.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner));
+  qputenv("PATH", QByteArray(QFile::encodeName(binDir) + ':' + qgetenv("PATH")));
+}
+
+void TestPackageInfoCache::init()
+{
+  QFile::remove(m_spawnLog);
+  PackageInfoCache::clear();
+}
+
+/*
+ * A package in two sync repositories (ex: core and core-testing) has one entry for each
+ */
+void TestPackageInfoCache::repositoryIsPartOfTheKey()
+{
+  QCOMPARE(Package::getInformation(QStringLiteral("foo"), false, QString(), QStringLiteral("core")).version,
+           QStringLiteral("1.0-1"));
+  Package::getInformation(QStringLiteral("foo"), false, QString(), QStringLiteral("core-testing"));
+  Package::getInformation(QStringLiteral("foo"), false);
+  QCOMPARE(spawns(), QStringList({QStringLiteral("-Si core/foo"), QStringLiteral("-Si core-testing/foo"),
+                                  QStringLiteral("-Si foo")}));
+
+  Package::getInformation(QStringLiteral("foo"), false, QString(), QStringLiteral("core"));
+  Package::getInformation(QStringLiteral("foo"), false, QString(), QStringLiteral("core-testing"));
+  Package::getInformation(QStringLiteral("foo"), false);
+  QCOMPARE(spawns().size(), 3);
+}
+
+/*
+ * The version is checked rather than keyed: asking for another one fetches it again
+ */
+void TestPackageInfoCache::otherVersionIsFetchedAgain()
+{
+  Package::getInformation(QStringLiteral("bar"), false, QStringLiteral("1.0-1"), QStringLiteral("extra"));
+  Package::getInformation(QStringLiteral("bar"), false, QStringLiteral("1.0-1"), QStringLiteral("extra"));
+  Package::getInformation(QStringLiteral("bar"), false, QString(), QStringLiteral("extra"));
+  QCOMPARE(spawns().size(), 1);
+
+  Package::getInformation(QStringLiteral("bar"), false, QStringLiteral("2.0-1"), QStringLiteral("extra"));
+  QCOMPARE(spawns().size(), 2);
+}
+
+void TestPackageInfoCache::localInformationIgnoresRepository()
+{
+  Package::getInformation(QStringLiteral("baz"), true, QString(), QStringLiteral("extra"));
+  Package::getInformation(QStringLiteral("baz"), true);
+  QCOMPARE(spawns(), QStringList{QStringLiteral("-Qi baz")});
+}
+
+/*
+ * Browsing the list with the keyboard: down a page, back up, a jump, down again and back
+ * to packages already seen. Reports how many lookups the cache answered
+ */
+void TestPackageInfoCache::benchmarkNavigation()
+{
+  QList<int> script;
+  for (int row = 0; row < 100; ++row) script << row;
+  for (int row = 99; row >= 50; --row) script << row;
+  for (int row = 200; row < 260; ++row) script << row;
+  for (int row = 60; row < 120; ++row) script << row;
+  for (int row = 250; row < ctn_NAVIGATION_PACKAGES; ++row) script << row;
+
+  int hits = 0;
+  int misses = 0;
+
+  QBENCHMARK
+  {
+    PackageInfoCache::clear();
+    const int hitsBefore = PackageInfoCache::getHitCount();
+    const int missesBefore = PackageInfoCache::getMissCount();
+
+    navigate(script);
+
+    hits = PackageInfoCache::getHitCount() - hitsBefore;
+    misses = PackageInfoCache::getMissCount() - missesBefore;
+  }
+
+  //Rows 0-119, 200-299 are distinct packages: every other lookup is a revisit
+  const int distinct = 120 + 100;
+  qDebug("%d lookups: %d hits (%d%%), %d misses, %d KB cached", hits + misses, hits,
+         hits * 100 / (hits + misses), misses, PackageInfoCache::getCostInKB());
+
+  QCOMPARE(hits + misses, script.size());
+  QCOMPARE(misses, distinct);
+}
+
+QTEST_GUILESS_MAIN(TestPackageInfoCache)
+
+#include "tst_packageinfocache.moc"
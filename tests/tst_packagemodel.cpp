@@ -0,0 +1,400 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/model/packagemodel.h"
+#include "../src/model/fuzzymatcher.h"
+#include "packagefixture.h"
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QtTest>
+
+#include <algorithm>
+#include <limits>
+
+/*
+ * Packages in the fixture repository, about the size of the sync databases of a desktop install
+ */
+static const int ctn_FIXTURE_PACKAGES = 15000;
+
+/*
+ * The longest the GUI thread may be kept away from its event loop: one frame at 60 Hz
+ */
+static const int ctn_MAX_EVENT_LOOP_GAP_MS = 16;
+
+/*
+ * PackageModel over a synthetic repository, driven the way MainWindow drives it
+ */
+class TestPackageModel: public QObject
+{
+  Q_OBJECT
+
+private:
+  QTemporaryDir m_configDir;
+  PackageRepository m_repository;
+  PackageModel *m_model;
+
+  QStringList names() const;
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void asyncFilterMatchesSyncFilter();
+  void typingKeepsEventLoopResponsive();
+  void fuzzyRankIgnoresSortOrder();
+  void benchmarkFuzzyScore_data();
+  void benchmarkFuzzyScore();
+  void benchmarkRankPackages_data();
+  void benchmarkRankPackages();
+  void benchmarkFilterPackages_data();
+  void benchmarkFilterPackages();
+  void benchmarkScroll_data();
+  void benchmarkScroll();
+  void benchmarkSwitchView_data();
+  void benchmarkSwitchView();
+};
+
+/*
+ * The names of the rows, as the view shows them
+ */
+QStringList TestPackageModel::names() const
+{
+  QStringList res;
+
+  for (int row = 0; row < m_model->rowCount(QModelIndex()); ++row)
+  {
+    res << m_model->getData(m_model->index(row, PackageModel::ctn_PACKAGE_NAME_COLUMN, QModelIndex()))->name;
+  }
+
+  return res;
+}
+
+void TestPackageModel::initTestCase()
+{
+  QVERIFY(m_configDir.isValid());
+  qputenv("XDG_CONFIG_HOME", QFile::encodeName(m_configDir.path()));
+
+  m_model = new PackageModel(m_repository);
+  m_repository.registerDependency(*m_model);
+  PackageFixture::fill(m_repository, ctn_FIXTURE_PACKAGES);
+
+  QCOMPARE(m_model->getPackageCount(), ctn_FIXTURE_PACKAGES);
+}
+
+void TestPackageModel::cleanupTestCase()
+{
+  delete m_model;
+}
+
+/*
+ * The list applyFilterAsync swaps in is the one applyFilter builds on the spot
+ */
+void TestPackageModel::asyncFilterMatchesSyncFilter()
+{
+  m_model->applyFilter(PackageModel::ctn_PACKAGE_NAME_COLUMN, QStringLiteral("python-req"));
+  const QStringList expected = names();
+  QVERIFY(!expected.isEmpty());
+
+  m_model->applyFilter(QStringLiteral(""));
+  QCOMPARE(m_model->getPackageCount(), ctn_FIXTURE_PACKAGES);
+
+  QSignalSpy applied(m_model, SIGNAL(filterApplied()));
+  m_model->applyFilterAsync(QStringLiteral("python-req"));
+  QVERIFY(applied.wait());
+  QCOMPARE(names(), expected);
+
+  m_model->applyFilter(QStringLiteral(""));
+}
+
+/*
+ * Types a description search at 20 keystrokes per second, the way the debounced search box
+ * calls applyFilterAsync, and measures the longest time the event loop went without running
+ */
+void TestPackageModel::typingKeepsEventLoopResponsive()
+{
+  const QString text = QStringLiteral("bindings, release 1234 of");
+  m_model->applyFilter(PackageModel::ctn_PACKAGE_DESCRIPTION_FILTER_NO_COLUMN, QStringLiteral(""));
+
+  QElapsedTimer clock;
+  qint64 lastTick = -1;
+  qint64 maxGap = 0;
+  qint64 maxCall = 0;
+
+  //Runs as often as the event loop allows, so a gap between two runs is time the GUI was blocked
+  QTimer heartbeat;
+  heartbeat.setTimerType(Qt::PreciseTimer);
+  heartbeat.setInterval(1);
+  connect(&heartbeat, &QTimer::timeout, [&]() {
+    const qint64 now = clock.nsecsElapsed();
+    if (lastTick >= 0) maxGap = qMax(maxGap, now - lastTick);
+    lastTick = now;
+  });
+
+  int typed = 0;
+  QTimer keyboard;
+  keyboard.setTimerType(Qt::PreciseTimer);
+  keyboard.setInterval(50);
+  connect(&keyboard, &QTimer::timeout, [&]() {
+    ++typed;
+    QElapsedTimer call;
+    call.start();
+    m_model->applyFilterAsync(text.left(typed));
+    maxCall = qMax(maxCall, call.nsecsElapsed());
+    if (typed == text.size()) keyboard.stop();
+  });
+
+  QSignalSpy applied(m_model, SIGNAL(filterApplied()));
+  clock.start();
+  heartbeat.start();
+  keyboard.start();
+
+  QTRY_VERIFY_WITH_TIMEOUT(!keyboard.isActive(), 10000);
+  QTRY_VERIFY_WITH_TIMEOUT(!applied.isEmpty() && m_model->getPackageCount() == 1, 10000);
+  heartbeat.stop();
+
+  qDebug("%d keystrokes: longest applyFilterAsync call %.2f ms, longest event loop gap %.2f ms",
+         typed, maxCall / 1e6, maxGap / 1e6);
+
+  QVERIFY(maxCall <= ctn_MAX_EVENT_LOOP_GAP_MS * 1000000LL);
+  QVERIFY(maxGap <= ctn_MAX_EVENT_LOOP_GAP_MS * 1000000LL);
+
+  m_model->applyFilter(PackageModel::ctn_PACKAGE_NAME_COLUMN, QStringLiteral(""));
+}
+
+/*
+ * The name column holds the ranking while the fuzzy filter is active, so sorting it descending changes nothing
+ */
+void TestPackageModel::fuzzyRankIgnoresSortOrder()
+{
+  m_model->setFuzzySearch(true);
+  m_model->applyFilter(PackageModel::ctn_PACKAGE_NAME_COLUMN, QStringLiteral("pyreq"));
+  const QStringList ranked = names();
+  QVERIFY(ranked.size() > 1);
+  QVERIFY(ranked.constFirst().startsWith(QLatin1String("python-requests")));
+
+  m_model->sort(PackageModel::ctn_PACKAGE_NAME_COLUMN, Qt::DescendingOrder);
+  QCOMPARE(names(), ranked);
+
+  //Any other column is still sorted both ways
+  m_model->sort(PackageModel::ctn_PACKAGE_SIZE_COLUMN, Qt::AscendingOrder);
+  QStringList ascending = names();
+  m_model->sort(PackageModel::ctn_PACKAGE_SIZE_COLUMN, Qt::DescendingOrder);
+  std::reverse(ascending.begin(), ascending.end());
+  QCOMPARE(names(), ascending);
+
+  m_model->sort(PackageModel::ctn_PACKAGE_NAME_COLUMN, Qt::AscendingOrder);
+  m_model->setFuzzySearch(false);
+  m_model->applyFilter(QStringLiteral(""));
+}
+
+void TestPackageModel::benchmarkFuzzyScore_data()
+{
+  QTest::addColumn<QString>("pattern");
+
+  QTest::newRow("short") << QStringLiteral("req");
+  QTest::newRow("subsequence") << QStringLiteral("pyreq");
+  QTest::newRow("long") << QStringLiteral("pythonrequests");
+}
+
+/*
+ * Scoring every package of the repository once: what each keystroke costs before ranking
+ */
+void TestPackageModel::benchmarkFuzzyScore()
+{
+  QFETCH(QString, pattern);
+
+  const FuzzyMatcher matcher(pattern);
+  const QList<PackageRepository::PackageData*> &packages = m_repository.getPackageList();
+  int matches = 0;
+
+  QBENCHMARK
+  {
+    matches = 0;
+    for (const PackageRepository::PackageData *package: packages)
+    {
+      if (m_model->fuzzyScore(matcher, package) > 0) ++matches;
+    }
+  }
+
+  QVERIFY(matches > 0);
+}
+
+void TestPackageModel::benchmarkRankPackages_data()
+{
+  benchmarkFuzzyScore_data();
+}
+
+/*
+ * One keystroke of the fuzzy search over the whole repository, which must stay under 10 ms
+ */
+void TestPackageModel::benchmarkRankPackages()
+{
+  QFETCH(QString, pattern);
+
+  m_model->setFuzzySearch(true);
+  m_model->applyFilter(PackageModel::ctn_PACKAGE_NAME_COLUMN, pattern);
+  const int generation = m_model->m_filterGeneration.loadAcquire();
+  QList<PackageRepository::PackageData*> result;
+
+  QBENCHMARK
+  {
+    result.clear();
+    m_model->rankPackages(m_repository.getPackageList(), result, generation);
+  }
+
+  QCOMPARE(result.size(), m_model->getPackageCount());
+
+  m_model->setFuzzySearch(false);
+  m_model->applyFilter(QStringLiteral(""));
+}
+
+void TestPackageModel::benchmarkFilterPackages_data()
+{
+  QTest::addColumn<int>("packages");
+  QTest::addColumn<bool>("parallel");
+
+  const QList<int> sizes{1000, 5000, 15000, 50000};
+  for (int packages: sizes)
+  {
+    QTest::addRow("%d sequential", packages) << packages << false;
+    QTest::addRow("%d parallel", packages) << packages << true;
+  }
+}
+
+/*
+ * A regex name filter over repositories of growing size, in the GUI thread and in the thread pool.
+ * Where the parallel rows overtake the sequential ones is the right m_parallelFilterThreshold
+ */
+void TestPackageModel::benchmarkFilterPackages()
+{
+  QFETCH(int, packages);
+  QFETCH(bool, parallel);
+
+  PackageRepository repository;
+  PackageModel model(repository);
+  repository.registerDependency(model);
+  PackageFixture::fill(repository, packages);
+
+  model.m_parallelFilterThreshold = std::numeric_limits<int>::max();
+  model.applyFilter(PackageModel::ctn_PACKAGE_NAME_COLUMN, QStringLiteral("^(python|perl)-.*(xml|json)"));
+  const int generation = model.m_filterGeneration.loadAcquire();
+  const QList<PackageRepository::PackageData*> expected = model.filterPackages(generation);
+  QVERIFY(!expected.isEmpty());
+
+  model.m_parallelFilterThreshold = parallel ? 0 : std::numeric_limits<int>::max();
+  QList<PackageRepository::PackageData*> result;
+
+  QBENCHMARK
+  {
+    result = model.filterPackages(generation);
+  }
+
+  QCOMPARE(result, expected);
+}
+
+void TestPackageModel::benchmarkScroll_data()
+{
+  QTest::addColumn<bool>("cached");
+
+  QTest::newRow("cold") << false;
+  QTest::newRow("cached") << true;
+}
+
+/*
+ * What the view asks while the whole list scrolls past: every role of every cell, with the
+ * display strings built on the way (cold) or already built by a previous pass (cached)
+ */
+void TestPackageModel::benchmarkScroll()
+{
+  QFETCH(bool, cached);
+
+  static const QList<int> roles{Qt::DisplayRole, Qt::DecorationRole, Qt::ToolTipRole, Qt::StatusTipRole};
+  const int rows = m_model->rowCount(QModelIndex());
+  const int columns = m_model->columnCount(QModelIndex());
+  QCOMPARE(rows, ctn_FIXTURE_PACKAGES);
+  //The size and date columns are the ones with display strings
+  QCOMPARE(columns, PackageModel::ctn_PACKAGE_INSTALL_REASON_COLUMN + 1);
+
+  auto scroll = [this, rows, columns]() {
+    int cells = 0;
+    for (int row = 0; row < rows; ++row)
+    {
+      for (int column = 0; column < columns; ++column)
+      {
+        const QModelIndex index = m_model->index(row, column, QModelIndex());
+        for (int role: roles)
+        {
+          if (m_model->data(index, role).isValid()) ++cells;
+        }
+      }
+    }
+    return cells;
+  };
+
+  const int expected = scroll();
+  int cells = 0;
+
+  QBENCHMARK
+  {
+    if (!cached) m_model->m_displayStringsGeneration = -1;
+    cells = scroll();
+  }
+
+  QCOMPARE(cells, expected);
+}
+
+void TestPackageModel::benchmarkSwitchView_data()
+{
+  QTest::addColumn<int>("view");
+  QTest::addColumn<QString>("repository");
+  QTest::addColumn<int>("expected");
+
+  //Every 4th fixture package is installed, every 160th is outdated and every 5th one is in core
+  QTest::newRow("installed") << int(ectn_INSTALLED_PKGS) << QString() << ctn_FIXTURE_PACKAGES / 4;
+  QTest::newRow("outdated") << int(ectn_OUTDATED_PKGS) << QString() << (ctn_FIXTURE_PACKAGES + 159) / 160;
+  QTest::newRow("non installed") << int(ectn_NON_INSTALLED_PKGS) << QString() << ctn_FIXTURE_PACKAGES - ctn_FIXTURE_PACKAGES / 4;
+  QTest::newRow("installed in core") << int(ectn_INSTALLED_PKGS) << QStringLiteral("core") << ctn_FIXTURE_PACKAGES / 20;
+  QTest::newRow("all") << int(ectn_ALL_PKGS) << QString() << ctn_FIXTURE_PACKAGES;
+}
+
+/*
+ * Picking an entry of the View menu, which rebuilds the list from the repository's bitsets
+ */
+void TestPackageModel::benchmarkSwitchView()
+{
+  QFETCH(int, view);
+  QFETCH(QString, repository);
+  QFETCH(int, expected);
+
+  QBENCHMARK
+  {
+    m_model->applyFilter(static_cast<ViewOptions>(view), repository, QString());
+  }
+
+  QCOMPARE(m_model->getPackageCount(), expected);
+
+  m_model->applyFilter(ectn_ALL_PKGS, QString(), QString());
+}
+
+QTEST_MAIN(TestPackageModel)
+
+#include "tst_packagemodel.moc"
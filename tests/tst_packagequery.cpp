@@ -0,0 +1,217 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/model/packagequery.h"
+#include "packagefixture.h"
+
+#include <QtTest>
+
+#include <memory>
+#include <vector>
+
+Q_DECLARE_METATYPE(QueryTextField)
+
+static const double ctn_MIB = 1024.0 * 1024.0;
+
+/*
+ * PackageQuery against a handful of packages written by hand, and a synthetic repository
+ */
+class TestPackageQuery: public QObject
+{
+  Q_OBJECT
+
+private:
+  std::vector<std::unique_ptr<PackageRepository::PackageData> > m_packages;
+
+  void addPackage(const QString &name, const QString &repository, const QString &description, PackageStatus status,
+                  double downloadMiB, double installedMiB, const QString &installReason = QString());
+  QStringList matching(const PackageQuery &query) const;
+
+private slots:
+  void initTestCase();
+  void isQuery_data();
+  void isQuery();
+  void matches_data();
+  void matches();
+  void evaluationOrder_data();
+  void evaluationOrder();
+  void benchmarkQuery();
+};
+
+void TestPackageQuery::addPackage(const QString &name, const QString &repository, const QString &description,
+                                  PackageStatus status, double downloadMiB, double installedMiB, const QString &installReason)
+{
+  //An outdated package is one whose installed version is older than the one in the sync database
+  const QString outdatedVersion = (status == ectn_OUTDATED) ? QStringLiteral("1.0-1") : QString();
+
+  m_packages.emplace_back(new PackageRepository::PackageData(
+    PackageListData(name, repository, QStringLiteral("2.0-1"), description, status, downloadMiB * ctn_MIB,
+                    installedMiB * ctn_MIB, 0.0, 0.0, QStringLiteral("MIT"), installReason, outdatedVersion), true, false));
+}
+
+QStringList TestPackageQuery::matching(const PackageQuery &query) const
+{
+  QStringList res;
+
+  for (const std::unique_ptr<PackageRepository::PackageData> &package: m_packages)
+  {
+    if (query.matches(package.get())) res << package->name;
+  }
+
+  return res;
+}
+
+void TestPackageQuery::initTestCase()
+{
+  addPackage(QStringLiteral("wayfire"), QStringLiteral("extra"), QStringLiteral("3D Wayland compositor"),
+             ectn_INSTALLED, 10, 60, QStringLiteral("Installed as a dependency for another package"));
+  addPackage(QStringLiteral("sway"), QStringLiteral("extra"),
+             QStringLiteral("Tiling Wayland compositor and replacement for the i3 window manager"), ectn_NON_INSTALLED, 2, 5);
+  addPackage(QStringLiteral("python-pywayland"), QStringLiteral("extra"), QStringLiteral("Python binding to the wayland library"),
+             ectn_INSTALLED, 1, 2, QStringLiteral("Installed as a dependency for another package"));
+  addPackage(QStringLiteral("linux"), QStringLiteral("core"), QStringLiteral("The Linux kernel and modules"),
+             ectn_OUTDATED, 120, 140, QStringLiteral("Explicitly installed"));
+  addPackage(QStringLiteral("firefox"), QStringLiteral("extra"), QStringLiteral("Standalone web browser from mozilla.org"),
+             ectn_INSTALLED, 70, 250, QStringLiteral("Explicitly installed"));
+  addPackage(QStringLiteral("lib32-glibc"), QStringLiteral("multilib"), QStringLiteral("GNU C Library (32-bit)"),
+             ectn_NON_INSTALLED, 3, 15);
+}
+
+void TestPackageQuery::isQuery_data()
+{
+  QTest::addColumn<QString>("text");
+  QTest::addColumn<bool>("query");
+
+  QTest::newRow("plain word") << QStringLiteral("python") << false;
+  QTest::newRow("name with dash") << QStringLiteral("python-requests") << false;
+  QTest::newRow("unknown key") << QStringLiteral("foo:bar") << false;
+  QTest::newRow("lone dash") << QStringLiteral("- python") << false;
+  QTest::newRow("repository") << QStringLiteral("repo:extra") << true;
+  QTest::newRow("negated word") << QStringLiteral("wayland -python") << true;
+  QTest::newRow("size") << QStringLiteral("size>50M") << true;
+  QTest::newRow("quoted description") << QStringLiteral("desc:\"wayland compositor\"") << true;
+}
+
+void TestPackageQuery::isQuery()
+{
+  QFETCH(QString, text);
+  QFETCH(bool, query);
+
+  QCOMPARE(PackageQuery::isQuery(text), query);
+}
+
+void TestPackageQuery::matches_data()
+{
+  QTest::addColumn<QString>("text");
+  QTest::addColumn<QueryTextField>("field");
+  QTest::addColumn<QStringList>("expected");
+
+  QTest::newRow("repo:") << QStringLiteral("repo:extra") << ectn_QUERY_NAME
+    << QStringList{QStringLiteral("wayfire"), QStringLiteral("sway"), QStringLiteral("python-pywayland"), QStringLiteral("firefox")};
+  QTest::newRow("repo: ignores case") << QStringLiteral("repo:EXTRA installed:no") << ectn_QUERY_NAME
+    << QStringList{QStringLiteral("sway")};
+  QTest::newRow("installed:") << QStringLiteral("installed:yes") << ectn_QUERY_NAME
+    << QStringList{QStringLiteral("wayfire"), QStringLiteral("python-pywayland"), QStringLiteral("linux"), QStringLiteral("firefox")};
+  QTest::newRow("installed") << QStringLiteral("installed") << ectn_QUERY_NAME
+    << QStringList{QStringLiteral("wayfire"), QStringLiteral("python-pywayland"), QStringLiteral("linux"), QStringLiteral("firefox")};
+  QTest::newRow("size>50M") << QStringLiteral("size>50M") << ectn_QUERY_NAME
+    << QStringList{QStringLiteral("wayfire"), QStringLiteral("linux"), QStringLiteral("firefox")};
+  QTest::newRow("dsize<=10MiB") << QStringLiteral("dsize<=10MiB installed") << ectn_QUERY_NAME
+    << QStringList{QStringLiteral("wayfire"), QStringLiteral("python-pywayland")};
+  QTest::newRow("outdated") << QStringLiteral("outdated") << ectn_QUERY_NAME
+    << QStringList{QStringLiteral("linux")};
+  QTest::newRow("outdated:no") << QStringLiteral("outdated:no repo:core") << ectn_QUERY_NAME
+    << QStringList();
+  QTest::newRow("quoted desc:") << QStringLiteral("desc:\"wayland compositor\"") << ectn_QUERY_NAME
+    << QStringList{QStringLiteral("wayfire"), QStringLiteral("sway")};
+  QTest::newRow("negated word") << QStringLiteral("desc:\"wayland compositor\" -fire") << ectn_QUERY_NAME
+    << QStringList{QStringLiteral("sway")};
+  QTest::newRow("negated key") << QStringLiteral("wayland -desc:compositor") << ectn_QUERY_DESCRIPTION
+    << QStringList{QStringLiteral("python-pywayland")};
+  QTest::newRow("negated status") << QStringLiteral("-installed repo:multilib") << ectn_QUERY_NAME
+    << QStringList{QStringLiteral("lib32-glibc")};
+  QTest::newRow("negated size") << QStringLiteral("-size>=1G") << ectn_QUERY_NAME
+    << QStringList{QStringLiteral("wayfire"), QStringLiteral("sway"), QStringLiteral("python-pywayland"), QStringLiteral("linux"),
+                   QStringLiteral("firefox"), QStringLiteral("lib32-glibc")};
+  QTest::newRow("reason:") << QStringLiteral("reason:explicit -linux") << ectn_QUERY_NAME
+    << QStringList{QStringLiteral("firefox")};
+  QTest::newRow("default field") << QStringLiteral("explicit -repo:core") << ectn_QUERY_INSTALL_REASON
+    << QStringList{QStringLiteral("firefox")};
+}
+
+void TestPackageQuery::matches()
+{
+  QFETCH(QString, text);
+  QFETCH(QueryTextField, field);
+  QFETCH(QStringList, expected);
+
+  const PackageQuery query(text, field);
+  QCOMPARE(matching(query), expected);
+}
+
+void TestPackageQuery::evaluationOrder_data()
+{
+  QTest::addColumn<QString>("text");
+  QTest::addColumn<QString>("order");
+
+  QTest::newRow("cheapest first") << QStringLiteral("desc:\"wayland compositor\" -python repo:extra size>50M installed")
+    << QStringLiteral("installed:yes size>52428800 repo:extra desc:\"wayland compositor\" -name:python");
+  QTest::newRow("written order among equals") << QStringLiteral("name:b outdated name:a -installed:no")
+    << QStringLiteral("outdated:yes -installed:no name:b name:a");
+  QTest::newRow("default field") << QStringLiteral("compositor dsize<1K") << QStringLiteral("dsize<1024 name:compositor");
+}
+
+/*
+ * Status tests come first, then sizes, repositories and finally text searches, so a string is
+ * only searched in the packages which passed everything else
+ */
+void TestPackageQuery::evaluationOrder()
+{
+  QFETCH(QString, text);
+  QFETCH(QString, order);
+
+  QCOMPARE(PackageQuery(text, ectn_QUERY_NAME).toString(), order);
+}
+
+/*
+ * A query whose cheap terms reject most packages, over the synthetic repository
+ */
+void TestPackageQuery::benchmarkQuery()
+{
+  PackageRepository repository;
+  PackageFixture::fill(repository, 15000);
+  const PackageQuery query(QStringLiteral("repo:core installed size>1M desc:bindings -requests"), ectn_QUERY_NAME);
+  int matches = 0;
+
+  QBENCHMARK
+  {
+    matches = 0;
+    for (const PackageRepository::PackageData *package: repository.getPackageList())
+    {
+      if (query.matches(package)) ++matches;
+    }
+  }
+
+  QVERIFY(matches > 0);
+}
+
+QTEST_GUILESS_MAIN(TestPackageQuery)
+
+#include "tst_packagequery.moc"
@@ -0,0 +1,188 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/pacmanexec.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+
+/*
+ * Number of packages removed by the replayed transaction
+ */
+static const int ctn_REMOVED_PACKAGES = 400;
+
+/*
+ * PacmanExec parsing a replayed removal, against a fixture local database
+ *
+ * A fake "pacman" which logs its arguments comes first in PATH, so every pacman process
+ * the parser starts is counted
+ */
+class TestPacmanExec: public QObject
+{
+  Q_OBJECT
+
+private:
+  QTemporaryDir m_tempDir;
+  QString m_spawnLog;
+
+  QString localDatabasePath() const;
+  int spawnCount() const;
+  QStringList removalTranscript() const;
+
+private slots:
+  void initTestCase();
+  void removalSpawnsNoPacman();
+  void removalOfUnknownNames();
+};
+
+QString TestPacmanExec::localDatabasePath() const
+{
+  return m_tempDir.path() + QLatin1String("/local");
+}
+
+int TestPacmanExec::spawnCount() const
+{
+  QFile log(m_spawnLog);
+  if (!log.open(QIODevice::ReadOnly)) return 0;
+
+  return log.readAll().count('\n');
+}
+
+/*
+ * What "pacman -R" prints for ctn_REMOVED_PACKAGES packages, one line per read
+ */
+QStringList TestPacmanExec::removalTranscript() const
+{
+  QStringList res;
+  res << QStringLiteral("checking dependencies...\n")
+      << QStringLiteral("\nPackages (%1) ").arg(ctn_REMOVED_PACKAGES + 1) + QStringLiteral("lib32-foo-2.1.3-2 ...\n")
+      << QStringLiteral("\nTotal Removed Size:  812.40 MiB\n\n")
+      << QStringLiteral(":: Running pre-transaction hooks...\n")
+      << QStringLiteral(":: Processing package changes...\n")
+      << QStringLiteral("(%1/%2) removing lib32-foo\n").arg(1).arg(ctn_REMOVED_PACKAGES + 1);
+
+  for (int i = 0; i < ctn_REMOVED_PACKAGES; ++i)
+  {
+    res << QStringLiteral("(%1/%2) removing pkg%3\n").arg(i + 2).arg(ctn_REMOVED_PACKAGES + 1).arg(i);
+  }
+
+  res << QStringLiteral(":: Running post-transaction hooks...\n");
+  return res;
+}
+
+void TestPacmanExec::initTestCase()
+{
+  QVERIFY(m_tempDir.isValid());
+
+  //Neither the user's settings nor the real pacman
+  qputenv("XDG_CONFIG_HOME", QFile::encodeName(m_tempDir.path() + QLatin1String("/config")));
+
+  const QString binDir = m_tempDir.path() + QLatin1String("/bin");
+  QVERIFY(QDir().mkpath(binDir));
+  m_spawnLog = m_tempDir.path() + QLatin1String("/spawns.log");
+
+  QFile pacman(binDir + QLatin1String("/pacman"));
+  QVERIFY(pacman.open(QIODevice::WriteOnly));
+  pacman.write(QByteArray("#!/bin/sh\necho \"$@\" >> \"" + QFile::encodeName(m_spawnLog) + "\"\n"));
+  pacman.close();
+  QVERIFY(pacman.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner));
+  qputenv("PATH", QByteArray(QFile::encodeName(binDir) + ':' + qgetenv("PATH")));
+
+  QVERIFY(QDir().mkpath(localDatabasePath() + QLatin1String("/lib32-foo-2.1.3-2")));
+  for (int i = 0; i < ctn_REMOVED_PACKAGES; ++i)
+  {
+    QVERIFY(QDir().mkpath(localDatabasePath() + QStringLiteral("/pkg%1-1.0-1").arg(i)));
+  }
+}
+
+/*
+ * Every "removing" line is shown in red, while pacman deletes the database entries as it goes,
+ * and not a single pacman process is started to tell whether those are real packages
+ */
+void TestPacmanExec::removalSpawnsNoPacman()
+{
+  PacmanExec exec;
+  exec.m_localDatabasePath = localDatabasePath();
+  exec.m_commandExecuting = ectn_REMOVE;
+  exec.snapshotInstalledPackages();
+
+  QSignalSpy printed(&exec, SIGNAL(textToPrintExt(QString)));
+  const int spawnsBefore = spawnCount();
+
+  const QStringList transcript = removalTranscript();
+  for (const QString &line: transcript)
+  {
+    //What pacman has already removed is gone from the local database
+    static const QRegularExpression reRemoving(QStringLiteral("removing (pkg\\d+)"));
+    const QRegularExpressionMatch match = reRemoving.match(line);
+    if (match.hasMatch())
+    {
+      QDir(localDatabasePath() + QLatin1Char('/') + match.captured(1) + QLatin1String("-1.0-1")).removeRecursively();
+    }
+
+    exec.onHelperOutput(line);
+  }
+
+  QCOMPARE(spawnCount(), spawnsBefore);
+
+  QSet<QString> removed;
+  for (const QList<QVariant> &arguments: std::as_const(printed))
+  {
+    static const QRegularExpression reRemoved(QStringLiteral("#E55451\">(?:\\(\\d+/\\d+\\) )?removing (\\S+)</font>"));
+    const QRegularExpressionMatch match = reRemoved.match(arguments.at(0).toString());
+    if (match.hasMatch()) removed.insert(match.captured(1));
+  }
+
+  QCOMPARE(removed.count(), ctn_REMOVED_PACKAGES + 1);
+  QVERIFY(removed.contains(QStringLiteral("lib32-foo")));
+  QVERIFY(removed.contains(QStringLiteral("pkg0")));
+  QVERIFY(removed.contains(QStringLiteral("pkg%1").arg(ctn_REMOVED_PACKAGES - 1)));
+}
+
+/*
+ * Garbled "removing" lines name no installed package, so they are dropped, still without pacman
+ */
+void TestPacmanExec::removalOfUnknownNames()
+{
+  PacmanExec exec;
+  exec.m_localDatabasePath = localDatabasePath();
+  exec.m_commandExecuting = ectn_REMOVE;
+  exec.snapshotInstalledPackages();
+
+  QSignalSpy printed(&exec, SIGNAL(textToPrintExt(QString)));
+  const int spawnsBefore = spawnCount();
+
+  exec.onHelperOutput(QStringLiteral("(1/2) removing ghost\n"));
+  exec.onHelperOutput(QStringLiteral("(2/2) removing lib32-foo\n"));
+
+  QCOMPARE(spawnCount(), spawnsBefore);
+
+  QStringList texts;
+  for (const QList<QVariant> &arguments: std::as_const(printed)) texts << arguments.at(0).toString();
+  QVERIFY(!texts.join(QLatin1Char('\n')).contains(QLatin1String("removing ghost")));
+  QVERIFY(texts.join(QLatin1Char('\n')).contains(QLatin1String("removing lib32-foo")));
+}
+
+QTEST_GUILESS_MAIN(TestPacmanExec)
+
+#include "tst_pacmanexec.moc"
@@ -0,0 +1,176 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/processtable.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <algorithm>
+
+/*
+ * ProcessTable read from a fake /proc, laid out like the kernel's
+ */
+class TestProcessTable: public QObject
+{
+  Q_OBJECT
+
+private:
+  QTemporaryDir m_procRoot;
+
+  void addProcess(const QString &entry, const QByteArray &comm, const QByteArray &cmdline);
+  ProcessInfo find(const QList<ProcessInfo> &list, qint64 pid);
+
+private slots:
+  void initTestCase();
+  void onlyNumericDirectories();
+  void nameAndArguments();
+  void kernelThread();
+  void commandLine();
+  void realProc();
+  void benchmarkScan();
+};
+
+/*
+ * Creates procRoot/entry with the given comm and cmdline files (a null one is not created)
+ */
+void TestProcessTable::addProcess(const QString &entry, const QByteArray &comm, const QByteArray &cmdline)
+{
+  const QString path = m_procRoot.path() + QLatin1Char('/') + entry;
+  QVERIFY(QDir().mkpath(path));
+
+  if (!comm.isNull())
+  {
+    QFile file(path + QLatin1String("/comm"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(comm);
+  }
+
+  if (!cmdline.isNull())
+  {
+    QFile file(path + QLatin1String("/cmdline"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(cmdline);
+  }
+}
+
+ProcessInfo TestProcessTable::find(const QList<ProcessInfo> &list, qint64 pid)
+{
+  for (const ProcessInfo &info: list)
+  {
+    if (info.pid == pid) return info;
+  }
+
+  return ProcessInfo{-1, QString(), QStringList()};
+}
+
+void TestProcessTable::initTestCase()
+{
+  QVERIFY(m_procRoot.isValid());
+
+  addProcess(QStringLiteral("1"), QByteArrayLiteral("systemd\n"),
+             QByteArray("/sbin/init\0splash\0", 18));
+  addProcess(QStringLiteral("2"), QByteArrayLiteral("kthreadd\n"), QByteArray(""));
+  addProcess(QStringLiteral("4242"), QByteArrayLiteral("pacman\n"),
+             QByteArray("pacman\0-S\0--noconfirm\0--\0octopi\0", 32));
+  addProcess(QStringLiteral("4243"), QByteArrayLiteral("octopi-helper\n"),
+             QByteArray("/usr/lib/octopi/octopi-helper\0-ts\0", 34));
+  //Not a process, and a process that exited before its comm was read
+  addProcess(QStringLiteral("self"), QByteArrayLiteral("tst_processtable\n"), QByteArray("tst\0", 4));
+  addProcess(QStringLiteral("sys"), QByteArray(), QByteArray());
+  addProcess(QStringLiteral("4244"), QByteArray(), QByteArray("gone\0", 5));
+}
+
+void TestProcessTable::onlyNumericDirectories()
+{
+  const QList<ProcessInfo> list = ProcessTable::scan(m_procRoot.path());
+
+  QList<qint64> pids;
+  for (const ProcessInfo &info: list) pids.append(info.pid);
+  std::sort(pids.begin(), pids.end());
+
+  QCOMPARE(pids, (QList<qint64>{1, 2, 4242, 4243}));
+}
+
+void TestProcessTable::nameAndArguments()
+{
+  const QList<ProcessInfo> list = ProcessTable::scan(m_procRoot.path());
+
+  const ProcessInfo pacman = find(list, 4242);
+  QCOMPARE(pacman.name, QStringLiteral("pacman"));
+  QCOMPARE(pacman.arguments, (QStringList{QStringLiteral("pacman"), QStringLiteral("-S"), QStringLiteral("--noconfirm"),
+                                          QStringLiteral("--"), QStringLiteral("octopi")}));
+
+  const ProcessInfo helper = find(list, 4243);
+  QCOMPARE(helper.name, QStringLiteral("octopi-helper"));
+  QCOMPARE(helper.arguments, (QStringList{QStringLiteral("/usr/lib/octopi/octopi-helper"), QStringLiteral("-ts")}));
+}
+
+void TestProcessTable::kernelThread()
+{
+  const ProcessInfo kthreadd = find(ProcessTable::scan(m_procRoot.path()), 2);
+
+  QCOMPARE(kthreadd.name, QStringLiteral("kthreadd"));
+  QVERIFY(kthreadd.arguments.isEmpty());
+  QCOMPARE(kthreadd.commandLine(), QStringLiteral("[kthreadd]"));
+}
+
+void TestProcessTable::commandLine()
+{
+  const QList<ProcessInfo> list = ProcessTable::scan(m_procRoot.path());
+
+  QCOMPARE(find(list, 1).commandLine(), QStringLiteral("/sbin/init splash"));
+  QCOMPARE(find(list, 4242).commandLine(), QStringLiteral("pacman -S --noconfirm -- octopi"));
+}
+
+/*
+ * The cached table of the real /proc holds this very process
+ */
+void TestProcessTable::realProc()
+{
+  if (!QFile::exists(QStringLiteral("/proc/self/comm"))) QSKIP("No /proc here");
+
+  ProcessTable::invalidate();
+  const ProcessInfo self = find(ProcessTable::processes(), QCoreApplication::applicationPid());
+
+  QCOMPARE(self.pid, QCoreApplication::applicationPid());
+  QVERIFY(!self.arguments.isEmpty());
+  QVERIFY(ProcessTable::count(self.name) >= 1);
+  QVERIFY(ProcessTable::hasCommandLineContaining(self.arguments.constFirst()));
+}
+
+/*
+ * What one scan of the real /proc costs, instead of spawning "ps"
+ */
+void TestProcessTable::benchmarkScan()
+{
+  if (!QFile::exists(QStringLiteral("/proc/self/comm"))) QSKIP("No /proc here");
+
+  QBENCHMARK
+  {
+    ProcessTable::scan(QStringLiteral("/proc"));
+  }
+}
+
+QTEST_GUILESS_MAIN(TestProcessTable)
+
+#include "tst_processtable.moc"
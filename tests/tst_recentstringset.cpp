@@ -0,0 +1,141 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/recentstringset.h"
+
+#include <QtTest>
+
+/*
+ * Unit tests for RecentStringSet, the window PacmanExec uses to drop output it already printed
+ */
+class TestRecentStringSet : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void ignoresDuplicates();
+  void forgetsOldestString();
+  void reinsertingDoesNotRenew();
+  void clear();
+  void staysBounded();
+  void replayDropsRepeatedLines();
+};
+
+void TestRecentStringSet::ignoresDuplicates()
+{
+  RecentStringSet set(4);
+  set.insert(QStringLiteral("a"));
+  set.insert(QStringLiteral("b"));
+  set.insert(QStringLiteral("a"));
+
+  QCOMPARE(set.count(), 2);
+  QVERIFY(set.contains(QStringLiteral("a")));
+  QVERIFY(set.contains(QStringLiteral("b")));
+  QVERIFY(!set.contains(QStringLiteral("c")));
+}
+
+void TestRecentStringSet::forgetsOldestString()
+{
+  RecentStringSet set(3);
+  set.insert(QStringLiteral("a"));
+  set.insert(QStringLiteral("b"));
+  set.insert(QStringLiteral("c"));
+  set.insert(QStringLiteral("d"));
+
+  QCOMPARE(set.count(), 3);
+  QVERIFY(!set.contains(QStringLiteral("a")));
+  QVERIFY(set.contains(QStringLiteral("b")));
+  QVERIFY(set.contains(QStringLiteral("c")));
+  QVERIFY(set.contains(QStringLiteral("d")));
+}
+
+/*
+ * Strings are forgotten in the order they were first inserted, seeing them again does not keep them longer
+ */
+void TestRecentStringSet::reinsertingDoesNotRenew()
+{
+  RecentStringSet set(2);
+  set.insert(QStringLiteral("a"));
+  set.insert(QStringLiteral("b"));
+  set.insert(QStringLiteral("a"));
+  set.insert(QStringLiteral("c"));
+
+  QVERIFY(!set.contains(QStringLiteral("a")));
+  QVERIFY(set.contains(QStringLiteral("b")));
+  QVERIFY(set.contains(QStringLiteral("c")));
+}
+
+void TestRecentStringSet::clear()
+{
+  RecentStringSet set(2);
+  set.insert(QStringLiteral("a"));
+  set.clear();
+
+  QCOMPARE(set.count(), 0);
+  QVERIFY(!set.contains(QStringLiteral("a")));
+
+  set.insert(QStringLiteral("a"));
+  QVERIFY(set.contains(QStringLiteral("a")));
+}
+
+void TestRecentStringSet::staysBounded()
+{
+  RecentStringSet set(4096);
+  for (int i=0; i<100000; ++i) set.insert(QString::number(i));
+
+  QCOMPARE(set.count(), set.capacity());
+  QVERIFY(set.contains(QString::number(99999)));
+  QVERIFY(!set.contains(QString::number(100000 - set.capacity() - 1)));
+}
+
+/*
+ * Replays an AUR build log the way PacmanExec prints it: a line is printed unless it is in the window
+ */
+void TestRecentStringSet::replayDropsRepeatedLines()
+{
+  //Progress lines are redrawn, so the same text arrives several times in a row
+  QStringList log;
+  for (int i=0; i<1000; ++i)
+  {
+    log << QStringLiteral("compiling file-%1.o").arg(i) << QStringLiteral("compiling file-%1.o").arg(i) <<
+           QStringLiteral("compiling file-%1.o").arg(i);
+  }
+
+  RecentStringSet set(16);
+  int printed = 0;
+  for (const QString &line: std::as_const(log))
+  {
+    if (set.contains(line)) continue;
+
+    set.insert(line);
+    ++printed;
+  }
+
+  QCOMPARE(printed, 1000);
+  QCOMPARE(set.count(), 16);
+
+  //Once 16 newer strings pushed it out, a line is printed again
+  QVERIFY(!set.contains(QStringLiteral("compiling file-0.o")));
+  QVERIFY(set.contains(QStringLiteral("compiling file-999.o")));
+}
+
+QTEST_GUILESS_MAIN(TestRecentStringSet)
+
+#include "tst_recentstringset.moc"
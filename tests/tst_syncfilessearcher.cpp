@@ -0,0 +1,296 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/syncfilessearcher.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <archive.h>
+#include <archive_entry.h>
+
+Q_DECLARE_METATYPE(SyncFilesQueryType)
+
+/*
+ * A package of a fixture .files database: "<pkgname>-<pkgver>-<pkgrel>" and its files, directories included
+ */
+struct FixturePackage
+{
+  QString directory;
+  QStringList files;
+};
+
+/*
+ * SyncFilesSearcher against .files databases written with libarchive, the way pacman -Fy gets them
+ */
+class TestSyncFilesSearcher: public QObject
+{
+  Q_OBJECT
+
+private:
+  QTemporaryDir m_cacheDir;
+  QTemporaryDir m_syncDir;
+
+  static bool writeFilesDatabase(const QString &path, const QList<FixturePackage> &packages);
+  static QStringList describe(const QList<SyncFileMatch> &matches);
+  QString indexFilePath(const QString &repository) const;
+
+private slots:
+  void initTestCase();
+  void queryType_data();
+  void queryType();
+  void search_data();
+  void search();
+  void emptyQuery();
+  void indexIsCached();
+  void newDatabaseIsReindexed();
+  void benchmarkSearch();
+};
+
+/*
+ * Writes a gzipped tar holding a "desc" and a "files" entry per package
+ */
+bool TestSyncFilesSearcher::writeFilesDatabase(const QString &path, const QList<FixturePackage> &packages)
+{
+  struct archive *archive = archive_write_new();
+  archive_write_add_filter_gzip(archive);
+  archive_write_set_format_pax_restricted(archive);
+
+  if (archive_write_open_filename(archive, QFile::encodeName(path).constData()) != ARCHIVE_OK)
+  {
+    archive_write_free(archive);
+    return false;
+  }
+
+  bool ok = true;
+
+  for (const FixturePackage &package: packages)
+  {
+    const QByteArray directory = package.directory.toUtf8();
+    const QByteArray desc = "%NAME%\n" + directory + "\n\n";
+    const QByteArray files = "%FILES%\n" + package.files.join(QLatin1Char('\n')).toUtf8() + "\n\n";
+    const QList<QPair<QByteArray, QByteArray> > entries{
+      qMakePair(QByteArray(directory + "/desc"), desc),
+      qMakePair(QByteArray(directory + "/files"), files)};
+
+    for (const QPair<QByteArray, QByteArray> &item: entries)
+    {
+      struct archive_entry *entry = archive_entry_new();
+      archive_entry_set_pathname(entry, item.first.constData());
+      archive_entry_set_size(entry, item.second.size());
+      archive_entry_set_filetype(entry, AE_IFREG);
+      archive_entry_set_perm(entry, 0644);
+
+      ok = ok && archive_write_header(archive, entry) == ARCHIVE_OK &&
+          archive_write_data(archive, item.second.constData(), static_cast<size_t>(item.second.size())) == static_cast<la_ssize_t>(item.second.size());
+      archive_entry_free(entry);
+    }
+  }
+
+  ok = (archive_write_close(archive) == ARCHIVE_OK) && ok;
+  archive_write_free(archive);
+  return ok;
+}
+
+/*
+ * Each match as "repository/package:path"
+ */
+QStringList TestSyncFilesSearcher::describe(const QList<SyncFileMatch> &matches)
+{
+  QStringList res;
+
+  for (const SyncFileMatch &match: matches)
+  {
+    res << match.repository + QLatin1Char('/') + match.package + QLatin1Char(':') + match.path;
+  }
+
+  return res;
+}
+
+QString TestSyncFilesSearcher::indexFilePath(const QString &repository) const
+{
+  return m_cacheDir.path() + QLatin1String("/octopi/sync_files/") + repository + QLatin1String(".idx");
+}
+
+void TestSyncFilesSearcher::initTestCase()
+{
+  QVERIFY(m_cacheDir.isValid());
+  QVERIFY(m_syncDir.isValid());
+
+  //The indexes are saved in GenericCacheLocation, which must not be the user's
+  qputenv("XDG_CACHE_HOME", QFile::encodeName(m_cacheDir.path()));
+  QCOMPARE(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation), m_cacheDir.path());
+
+  QVERIFY(writeFilesDatabase(m_syncDir.filePath(QStringLiteral("core.files")), {
+    {QStringLiteral("bash-5.2.026-2"), {QStringLiteral("usr/"), QStringLiteral("usr/bin/"), QStringLiteral("usr/bin/bash"),
+                                        QStringLiteral("usr/bin/bashbug"), QStringLiteral("usr/bin/sh")}},
+    {QStringLiteral("coreutils-9.5-1"), {QStringLiteral("usr/"), QStringLiteral("usr/bin/"), QStringLiteral("usr/bin/ls"),
+                                         QStringLiteral("usr/share/ls/"), QStringLiteral("usr/share/ls/README")}}}));
+  QVERIFY(writeFilesDatabase(m_syncDir.filePath(QStringLiteral("extra.files")), {
+    {QStringLiteral("python-pip-24.0-2"), {QStringLiteral("usr/bin/pip"), QStringLiteral("usr/bin/pip3")}},
+    {QStringLiteral("busybox-1.36.1-2"), {QStringLiteral("usr/bin/busybox"), QStringLiteral("usr/bin/ls")}},
+    {QStringLiteral("lsd-1.1.2-1"), {QStringLiteral("usr/bin/lsd")}}}));
+
+  //Only *.files databases are read
+  QFile db(m_syncDir.filePath(QStringLiteral("core.db")));
+  QVERIFY(db.open(QIODevice::WriteOnly));
+  db.write("not an archive");
+}
+
+void TestSyncFilesSearcher::queryType_data()
+{
+  QTest::addColumn<QString>("query");
+  QTest::addColumn<SyncFilesQueryType>("type");
+
+  QTest::newRow("name") << QStringLiteral("bash") << ectn_BASENAME_QUERY;
+  QTest::newRow("name with dot") << QStringLiteral("libc.so.6") << ectn_BASENAME_QUERY;
+  QTest::newRow("relative path") << QStringLiteral("usr/bin/bash") << ectn_EXACT_PATH_QUERY;
+  QTest::newRow("absolute path") << QStringLiteral("/usr/bin/bash") << ectn_EXACT_PATH_QUERY;
+  QTest::newRow("anchored regex") << QStringLiteral("^/usr/bin/ba") << ectn_REGEX_QUERY;
+  QTest::newRow("regex path") << QStringLiteral("/usr/bin/pip[0-9]") << ectn_REGEX_QUERY;
+}
+
+void TestSyncFilesSearcher::queryType()
+{
+  QFETCH(QString, query);
+  QFETCH(SyncFilesQueryType, type);
+
+  QCOMPARE(SyncFilesSearcher::getQueryType(query), type);
+}
+
+void TestSyncFilesSearcher::search_data()
+{
+  QTest::addColumn<QString>("query");
+  QTest::addColumn<QStringList>("expected");
+
+  QTest::newRow("basename") << QStringLiteral("bash")
+                            << QStringList{QStringLiteral("core/bash:/usr/bin/bash")};
+  QTest::newRow("basename in two repositories") << QStringLiteral("ls")
+                            << QStringList{QStringLiteral("core/coreutils:/usr/bin/ls"), QStringLiteral("extra/busybox:/usr/bin/ls")};
+  QTest::newRow("trailing slash") << QStringLiteral("ls/")
+                            << QStringList();
+  QTest::newRow("relative path") << QStringLiteral("usr/bin/sh")
+                            << QStringList{QStringLiteral("core/bash:/usr/bin/sh")};
+  QTest::newRow("absolute path") << QStringLiteral("/usr/share/ls/README")
+                            << QStringList{QStringLiteral("core/coreutils:/usr/share/ls/README")};
+  QTest::newRow("directories are not matched") << QStringLiteral("/usr/bin/")
+                            << QStringList();
+  QTest::newRow("package with dashes") << QStringLiteral("pip3")
+                            << QStringList{QStringLiteral("extra/python-pip:/usr/bin/pip3")};
+  QTest::newRow("regex") << QStringLiteral("^/usr/bin/ba")
+                            << QStringList{QStringLiteral("core/bash:/usr/bin/bash"), QStringLiteral("core/bash:/usr/bin/bashbug")};
+  QTest::newRow("regex over repositories") << QStringLiteral("/ls.?$")
+                            << QStringList{QStringLiteral("core/coreutils:/usr/bin/ls"), QStringLiteral("extra/busybox:/usr/bin/ls"),
+                                           QStringLiteral("extra/lsd:/usr/bin/lsd")};
+  QTest::newRow("invalid regex") << QStringLiteral("usr/bin/(")
+                            << QStringList();
+  QTest::newRow("nothing") << QStringLiteral("zsh")
+                            << QStringList();
+}
+
+void TestSyncFilesSearcher::search()
+{
+  QFETCH(QString, query);
+  QFETCH(QStringList, expected);
+
+  QCOMPARE(describe(SyncFilesSearcher::searchDirectory(m_syncDir.path(), query)), expected);
+}
+
+void TestSyncFilesSearcher::emptyQuery()
+{
+  QVERIFY(SyncFilesSearcher::searchDirectory(m_syncDir.path(), QString()).isEmpty());
+}
+
+/*
+ * Once built, an index answers from memory and from disk the same way the archive did
+ */
+void TestSyncFilesSearcher::indexIsCached()
+{
+  const QStringList expected = describe(SyncFilesSearcher::searchDirectory(m_syncDir.path(), QStringLiteral("ls")));
+  QVERIFY(QFile::exists(indexFilePath(QStringLiteral("core"))));
+  QVERIFY(QFile::exists(indexFilePath(QStringLiteral("extra"))));
+
+  QCOMPARE(describe(SyncFilesSearcher::searchDirectory(m_syncDir.path(), QStringLiteral("ls"))), expected);
+
+  SyncFilesSearcher::invalidate();
+  QCOMPARE(describe(SyncFilesSearcher::searchDirectory(m_syncDir.path(), QStringLiteral("ls"))), expected);
+}
+
+/*
+ * What "pacman -Fy" does: a new database, with a new modification time, replaces the index
+ */
+void TestSyncFilesSearcher::newDatabaseIsReindexed()
+{
+  QTemporaryDir syncDir;
+  QVERIFY(syncDir.isValid());
+  const QString database = syncDir.filePath(QStringLiteral("testing.files"));
+
+  QVERIFY(writeFilesDatabase(database, {{QStringLiteral("zsh-5.9-5"), {QStringLiteral("usr/bin/zsh")}}}));
+  QCOMPARE(describe(SyncFilesSearcher::searchDirectory(syncDir.path(), QStringLiteral("zsh"))),
+           QStringList{QStringLiteral("testing/zsh:/usr/bin/zsh")});
+
+  const QDateTime lastModified = QFileInfo(database).lastModified();
+  QVERIFY(writeFilesDatabase(database, {{QStringLiteral("zsh-5.9-6"), {QStringLiteral("usr/bin/zsh5")}}}));
+  QFile file(database);
+  QVERIFY(file.open(QIODevice::ReadWrite));
+  QVERIFY(file.setFileTime(lastModified.addSecs(10), QFileDevice::FileModificationTime));
+  file.close();
+
+  QVERIFY(SyncFilesSearcher::searchDirectory(syncDir.path(), QStringLiteral("zsh")).isEmpty());
+  QCOMPARE(describe(SyncFilesSearcher::searchDirectory(syncDir.path(), QStringLiteral("zsh5"))),
+           QStringList{QStringLiteral("testing/zsh:/usr/bin/zsh5")});
+}
+
+/*
+ * A basename search over a repository about the size of extra, once its index is built
+ */
+void TestSyncFilesSearcher::benchmarkSearch()
+{
+  QTemporaryDir syncDir;
+  QVERIFY(syncDir.isValid());
+
+  QList<FixturePackage> packages;
+  for (int i = 0; i < 3000; ++i)
+  {
+    FixturePackage package{QStringLiteral("package%1-1.0-1").arg(i), QStringList()};
+    for (int j = 0; j < 100; ++j)
+    {
+      package.files << QStringLiteral("usr/share/package%1/data/file%2.dat").arg(i).arg(j);
+    }
+    package.files << QStringLiteral("usr/bin/package%1").arg(i);
+    packages << package;
+  }
+
+  QVERIFY(writeFilesDatabase(syncDir.filePath(QStringLiteral("bench.files")), packages));
+  QCOMPARE(SyncFilesSearcher::searchDirectory(syncDir.path(), QStringLiteral("package1234")).size(), 1);
+
+  QBENCHMARK
+  {
+    SyncFilesSearcher::searchDirectory(syncDir.path(), QStringLiteral("package1234"));
+  }
+}
+
+QTEST_GUILESS_MAIN(TestSyncFilesSearcher)
+
+#include "tst_syncfilessearcher.moc"
@@ -0,0 +1,310 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/transactionprogressparser.h"
+
+#include <QtTest>
+
+/*
+ * Unit tests for TransactionProgressParser, fed with transcripts of what pacman prints
+ */
+class TestTransactionProgressParser : public QObject
+{
+  Q_OBJECT
+
+private:
+  static QString upgradeTranscript();
+  static QStringList describe(const QList<TransactionEvent>& events);
+
+private slots:
+  void phaseMarker();
+  void lineSplitBetweenReads();
+  void redrawnProgressBar();
+  void downloadsWithTotal();
+  void warningsAndErrors();
+  void hooks();
+  void singleLineSteps();
+  void flushPendingLine();
+  void transcriptSummary();
+  void chunking_data();
+  void chunking();
+};
+
+/*
+ * A "pacman -Syu" with progress bars, as QProcess reads it
+ */
+QString TestTransactionProgressParser::upgradeTranscript()
+{
+  const QStringList lines = QStringList() <<
+    QStringLiteral(":: Synchronizing package databases...") <<
+    QStringLiteral(" core is up to date") <<
+    QStringLiteral(" extra                8.0 MiB  2.00 MiB/s 00:04 [######################] 100%") <<
+    QStringLiteral(":: Starting full system upgrade...") <<
+    QStringLiteral("resolving dependencies...") <<
+    QStringLiteral("looking for conflicting packages...") <<
+    QString() <<
+    QStringLiteral("Packages (2) linux-6.1-1  vim-9.0-1") <<
+    QString() <<
+    QStringLiteral("Total Download Size:   130.00 MiB") <<
+    QString() <<
+    QStringLiteral(":: Proceed with installation? [Y/n] ") <<
+    QStringLiteral(":: Retrieving packages...") <<
+    QStringLiteral(" linux-6.1-1-x86_64  120.0 MiB  10.0 MiB/s 00:12 [######################] 100%") <<
+    QStringLiteral(" vim-9.0-1-x86_64     10.0 MiB  10.0 MiB/s 00:01 [######################] 100%") <<
+    QStringLiteral(" Total (2/2)         130.0 MiB  10.0 MiB/s 00:13 [######################] 100%") <<
+    QStringLiteral("(2/2) checking keys in keyring                     [######################] 100%") <<
+    QStringLiteral("(2/2) checking package integrity                   [######################] 100%") <<
+    QStringLiteral("(2/2) loading package files                        [######################] 100%") <<
+    QStringLiteral("(2/2) checking for file conflicts                  [######################] 100%") <<
+    QStringLiteral("(2/2) checking available disk space                [######################] 100%") <<
+    QStringLiteral(":: Processing package changes...") <<
+    QStringLiteral("(1/2) upgrading linux                              [######------------]  33%\r"
+                   "(1/2) upgrading linux                              [######################] 100%") <<
+    QStringLiteral("(2/2) upgrading vim                                [######################] 100%") <<
+    QStringLiteral("warning: /etc/vimrc installed as /etc/vimrc.pacnew") <<
+    QStringLiteral(":: Running post-transaction hooks...") <<
+    QStringLiteral("(1/2) Updating linux initcpios...") <<
+    QStringLiteral("(2/2) Arming ConditionNeedsUpdate...");
+
+  return lines.join(QLatin1Char('\n')) + QLatin1Char('\n');
+}
+
+/*
+ * One line per event, so whole event lists can be compared
+ */
+QStringList TestTransactionProgressParser::describe(const QList<TransactionEvent> &events)
+{
+  QStringList res;
+
+  for (const TransactionEvent &event: events)
+  {
+    res.append(QStringLiteral("%1 %2 %3/%4 %5 %6% %7").arg(static_cast<int>(event.type)).arg(static_cast<int>(event.phase)).arg(event.current).
+               arg(event.total).arg(event.bytes).arg(event.percent).arg(event.text));
+  }
+
+  return res;
+}
+
+void TestTransactionProgressParser::phaseMarker()
+{
+  TransactionProgressParser parser;
+  QList<TransactionEvent> events;
+  parser.parse(QStringLiteral(":: Synchronizing package databases...\n"), events);
+
+  QCOMPARE(events.count(), 1);
+  QCOMPARE(events.at(0).type, ectn_EVENT_PHASE_STARTED);
+  QCOMPARE(events.at(0).phase, ectn_PHASE_SYNC_DATABASES);
+  QCOMPARE(events.at(0).text, QStringLiteral("Synchronizing package databases"));
+  QCOMPARE(parser.currentPhase(), ectn_PHASE_SYNC_DATABASES);
+}
+
+void TestTransactionProgressParser::lineSplitBetweenReads()
+{
+  TransactionProgressParser parser;
+  QList<TransactionEvent> events;
+  parser.parse(QStringLiteral("(1/2) upgr"), events);
+  QVERIFY(events.isEmpty());
+
+  parser.parse(QStringLiteral("ading linux\n"), events);
+  QCOMPARE(events.count(), 2);
+  QCOMPARE(events.at(0).type, ectn_EVENT_PHASE_STARTED);
+  QCOMPARE(events.at(0).phase, ectn_PHASE_PROCESSING_CHANGES);
+  QCOMPARE(events.at(1).type, ectn_EVENT_PACKAGE_PROGRESS);
+  QCOMPARE(events.at(1).current, 1);
+  QCOMPARE(events.at(1).total, 2);
+  QCOMPARE(events.at(1).percent, 0);
+  QCOMPARE(events.at(1).text, QStringLiteral("linux"));
+}
+
+/*
+ * Redrawing the same numbers gives no new event, and the percentage covers the whole phase
+ */
+void TestTransactionProgressParser::redrawnProgressBar()
+{
+  TransactionProgressParser parser;
+  QList<TransactionEvent> events;
+  parser.parse(QStringLiteral("(1/2) upgrading linux [####----]  40%\r"
+                              "(1/2) upgrading linux [####----]  40%\r"
+                              "(1/2) upgrading linux [########] 100%\n"), events);
+
+  QCOMPARE(events.count(), 3);
+  QCOMPARE(events.at(1).percent, 20);
+  QCOMPARE(events.at(1).text, QStringLiteral("linux"));
+  QCOMPARE(events.at(2).percent, 50);
+}
+
+void TestTransactionProgressParser::downloadsWithTotal()
+{
+  TransactionProgressParser parser;
+  QList<TransactionEvent> events;
+  parser.parse(QStringLiteral(":: Retrieving packages...\n"
+                              " linux-6.1-1-x86_64  60.0 MiB  10.0 MiB/s 00:06 [###-----]  50%\n"
+                              " Total (0/2)         60.0 MiB  10.0 MiB/s 00:06 [###-----]  46%\n"
+                              " linux-6.1-1-x86_64 120.0 MiB  10.0 MiB/s 00:12 [########] 100%\n"), events);
+
+  QCOMPARE(events.count(), 4);
+  QCOMPARE(events.at(1).type, ectn_EVENT_DOWNLOAD_PROGRESS);
+  QCOMPARE(events.at(1).text, QStringLiteral("linux-6.1-1-x86_64"));
+  QCOMPARE(events.at(1).bytes, QStringLiteral("60.0 MiB"));
+  QCOMPARE(events.at(1).percent, 50);
+
+  QCOMPARE(events.at(2).text, QStringLiteral("Total"));
+  QCOMPARE(events.at(2).current, 0);
+  QCOMPARE(events.at(2).total, 2);
+  QCOMPARE(events.at(2).percent, 46);
+
+  //Once pacman printed a "Total" line, a single download does not move the bar
+  QCOMPARE(events.at(3).percent, -1);
+  QCOMPARE(parser.summary().last().items, 2);
+}
+
+void TestTransactionProgressParser::warningsAndErrors()
+{
+  TransactionProgressParser parser;
+  QList<TransactionEvent> events;
+  parser.parse(QStringLiteral("warning: vim-9.0-1 is up to date -- skipping\n"
+                              "error: failed to commit transaction (conflicting files)\n"), events);
+
+  QCOMPARE(events.count(), 2);
+  QCOMPARE(events.at(0).type, ectn_EVENT_WARNING);
+  QCOMPARE(events.at(0).text, QStringLiteral("vim-9.0-1 is up to date -- skipping"));
+  QCOMPARE(events.at(1).type, ectn_EVENT_ERROR);
+  QCOMPARE(events.at(1).text, QStringLiteral("failed to commit transaction (conflicting files)"));
+
+  //Printed before any phase, they are kept in a "pacman" summary
+  QCOMPARE(parser.summary().count(), 1);
+  QCOMPARE(parser.summary().at(0).label, QStringLiteral("pacman"));
+  QCOMPARE(parser.summary().at(0).warnings, 1);
+  QCOMPARE(parser.summary().at(0).errors, 1);
+}
+
+void TestTransactionProgressParser::hooks()
+{
+  TransactionProgressParser parser;
+  QList<TransactionEvent> events;
+  parser.parse(QStringLiteral(":: Running post-transaction hooks...\n"
+                              "(1/3) Reloading system manager configuration...\n"), events);
+
+  QCOMPARE(events.count(), 2);
+  QCOMPARE(events.at(0).phase, ectn_PHASE_POST_HOOKS);
+  QCOMPARE(events.at(1).type, ectn_EVENT_HOOK_RUNNING);
+  QCOMPARE(events.at(1).current, 1);
+  QCOMPARE(events.at(1).total, 3);
+  QCOMPARE(events.at(1).percent, 33);
+  QCOMPARE(events.at(1).text, QStringLiteral("Reloading system manager configuration"));
+}
+
+/*
+ * Without progress bars (or when the output is not a terminal) pacman prints the steps as plain lines
+ */
+void TestTransactionProgressParser::singleLineSteps()
+{
+  TransactionProgressParser parser;
+  QList<TransactionEvent> events;
+  parser.parse(QStringLiteral("checking keyring...\n"
+                              "checking package integrity...\n"
+                              "checking package integrity...\n"), events);
+
+  QCOMPARE(events.count(), 2);
+  QCOMPARE(events.at(0).phase, ectn_PHASE_CHECKING_KEYS);
+  QCOMPARE(events.at(0).text, QStringLiteral("checking keyring"));
+  QCOMPARE(events.at(1).phase, ectn_PHASE_CHECKING_INTEGRITY);
+}
+
+void TestTransactionProgressParser::flushPendingLine()
+{
+  TransactionProgressParser parser;
+  QList<TransactionEvent> events;
+  parser.parse(QStringLiteral("error: boom"), events);
+  QVERIFY(events.isEmpty());
+
+  parser.flush(events);
+  QCOMPARE(events.count(), 1);
+  QCOMPARE(events.at(0).type, ectn_EVENT_ERROR);
+  QCOMPARE(events.at(0).text, QStringLiteral("boom"));
+}
+
+void TestTransactionProgressParser::transcriptSummary()
+{
+  TransactionProgressParser parser;
+  QList<TransactionEvent> events;
+  parser.parse(upgradeTranscript(), events);
+  parser.flush(events);
+
+  const QList<TransactionPhase> phases = QList<TransactionPhase>() << ectn_PHASE_SYNC_DATABASES <<
+    ectn_PHASE_RESOLVING << ectn_PHASE_DOWNLOADING << ectn_PHASE_CHECKING_KEYS << ectn_PHASE_CHECKING_INTEGRITY <<
+    ectn_PHASE_LOADING_FILES << ectn_PHASE_CHECKING_CONFLICTS << ectn_PHASE_CHECKING_SPACE <<
+    ectn_PHASE_PROCESSING_CHANGES << ectn_PHASE_POST_HOOKS;
+  const QList<int> items = QList<int>() << 2 << 0 << 2 << 2 << 2 << 2 << 2 << 2 << 2 << 2;
+
+  const QList<TransactionPhaseSummary> &summary = parser.summary();
+  QCOMPARE(summary.count(), phases.count());
+
+  for (int i=0; i<summary.count(); ++i)
+  {
+    QCOMPARE(summary.at(i).phase, phases.at(i));
+    QCOMPARE(summary.at(i).items, items.at(i));
+    QCOMPARE(summary.at(i).warnings, summary.at(i).phase == ectn_PHASE_PROCESSING_CHANGES ? 1 : 0);
+    QCOMPARE(summary.at(i).errors, 0);
+  }
+
+  QCOMPARE(summary.at(8).label, QStringLiteral("Processing package changes"));
+
+  const TransactionEvent &last = events.last();
+  QCOMPARE(last.type, ectn_EVENT_HOOK_RUNNING);
+  QCOMPARE(last.current, 2);
+  QCOMPARE(last.percent, 100);
+  QCOMPARE(last.text, QStringLiteral("Arming ConditionNeedsUpdate"));
+}
+
+void TestTransactionProgressParser::chunking_data()
+{
+  QTest::addColumn<int>("chunkSize");
+
+  QTest::newRow("1") << 1;
+  QTest::newRow("3") << 3;
+  QTest::newRow("17") << 17;
+  QTest::newRow("4096") << 4096;
+}
+
+/*
+ * Wherever the reads split the output, the events are the same
+ */
+void TestTransactionProgressParser::chunking()
+{
+  QFETCH(int, chunkSize);
+  const QString transcript = upgradeTranscript();
+
+  TransactionProgressParser whole;
+  QList<TransactionEvent> expected;
+  whole.parse(transcript, expected);
+  whole.flush(expected);
+
+  TransactionProgressParser parser;
+  QList<TransactionEvent> events;
+  for (int i=0; i<transcript.size(); i+=chunkSize) parser.parse(transcript.mid(i, chunkSize), events);
+  parser.flush(events);
+
+  QCOMPARE(describe(events), describe(expected));
+}
+
+QTEST_GUILESS_MAIN(TestTransactionProgressParser)
+
+#include "tst_transactionprogressparser.moc"
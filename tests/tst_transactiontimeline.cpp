@@ -0,0 +1,229 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/transactiontimeline.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtTest>
+
+/*
+ * Unit tests for TransactionTimeline and its JSON-lines log, replaying recorded pacman output
+ */
+class TestTransactionTimeline : public QObject
+{
+  Q_OBJECT
+
+private:
+  static void replay(const QStringList& lines, qint64 step, TransactionTimeline& timeline);
+  static QList<QJsonObject> readJsonLines(const QByteArray& data);
+  static QStringList upgradeLines();
+
+private slots:
+  void phasesAndItems();
+  void jsonLines();
+  void writeLog();
+  void writeLogKeepsLatest();
+  void benchmarkReplay();
+};
+
+/*
+ * Feeds lines to a parser and its events to timeline, with a synthetic clock moving step msecs per line
+ */
+void TestTransactionTimeline::replay(const QStringList &lines, qint64 step, TransactionTimeline &timeline)
+{
+  TransactionProgressParser parser;
+  qint64 msecs = 0;
+
+  for (const QString &line: lines)
+  {
+    QList<TransactionEvent> events;
+    parser.parse(line + QLatin1Char('\n'), events);
+    for (const TransactionEvent &event: std::as_const(events)) timeline.addEvent(event, msecs);
+    msecs += step;
+  }
+
+  timeline.finish(msecs);
+}
+
+QList<QJsonObject> TestTransactionTimeline::readJsonLines(const QByteArray &data)
+{
+  QList<QJsonObject> res;
+  const QList<QByteArray> lines = data.split('\n');
+
+  for (const QByteArray &line: lines)
+  {
+    if (line.isEmpty()) continue;
+
+    const QJsonDocument doc = QJsonDocument::fromJson(line);
+    if (doc.isObject()) res.append(doc.object());
+  }
+
+  return res;
+}
+
+QStringList TestTransactionTimeline::upgradeLines()
+{
+  return QStringList() <<
+    QStringLiteral(":: Retrieving packages...") <<
+    QStringLiteral(" linux-x86_64   60.0 MiB  10.0 MiB/s 00:06 [###-----]  50%") <<
+    QStringLiteral(" vim-x86_64     10.0 MiB  10.0 MiB/s 00:01 [########] 100%") <<
+    QStringLiteral(" linux-x86_64  120.0 MiB  10.0 MiB/s 00:12 [########] 100%") <<
+    QStringLiteral(":: Processing package changes...") <<
+    QStringLiteral("(1/2) upgrading linux [####----]  40%") <<
+    QStringLiteral("(1/2) upgrading linux [########] 100%") <<
+    QStringLiteral("(2/2) upgrading vim   [########] 100%") <<
+    QStringLiteral(":: Running post-transaction hooks...") <<
+    QStringLiteral("(1/1) Arming ConditionNeedsUpdate...");
+}
+
+void TestTransactionTimeline::phasesAndItems()
+{
+  TransactionTimeline timeline;
+  replay(upgradeLines(), 100, timeline);
+
+  QCOMPARE(timeline.duration(), qint64(1000));
+
+  const QList<TransactionPhaseTime> &phases = timeline.phases();
+  QCOMPARE(phases.count(), 3);
+  QCOMPARE(phases.at(0).phase, ectn_PHASE_DOWNLOADING);
+  QCOMPARE(phases.at(0).start, qint64(0));
+  QCOMPARE(phases.at(0).end, qint64(400));
+  QCOMPARE(phases.at(1).phase, ectn_PHASE_PROCESSING_CHANGES);
+  QCOMPARE(phases.at(1).end, qint64(800));
+  QCOMPARE(phases.at(2).phase, ectn_PHASE_POST_HOOKS);
+  QCOMPARE(phases.at(2).end, qint64(1000));
+
+  //Downloads last from their first to their last line, packages and hooks until the next one starts
+  const QList<TransactionItemTime> &items = timeline.items();
+  QCOMPARE(items.count(), 5);
+  QCOMPARE(items.at(0).name, QStringLiteral("linux-x86_64"));
+  QCOMPARE(items.at(0).end - items.at(0).start, qint64(200));
+  QCOMPARE(items.at(1).name, QStringLiteral("vim-x86_64"));
+  QCOMPARE(items.at(1).end - items.at(1).start, qint64(0));
+  QCOMPARE(items.at(2).name, QStringLiteral("linux"));
+  QCOMPARE(items.at(2).start, qint64(500));
+  QCOMPARE(items.at(2).end, qint64(700));
+  QCOMPARE(items.at(3).name, QStringLiteral("vim"));
+  QCOMPARE(items.at(3).end, qint64(800));
+  QCOMPARE(items.at(4).phase, ectn_PHASE_POST_HOOKS);
+  QCOMPARE(items.at(4).name, QStringLiteral("Arming ConditionNeedsUpdate"));
+  QCOMPARE(items.at(4).end, qint64(1000));
+}
+
+void TestTransactionTimeline::jsonLines()
+{
+  TransactionTimeline timeline;
+  replay(upgradeLines(), 100, timeline);
+
+  const QList<QJsonObject> lines = readJsonLines(timeline.toJsonLines(QStringLiteral("system_upgrade"), 0, 1));
+  QCOMPARE(lines.count(), 1 + 3 + 5);
+
+  const QJsonObject transaction = lines.at(0);
+  QCOMPARE(transaction.value(QStringLiteral("type")).toString(), QStringLiteral("transaction"));
+  QCOMPARE(transaction.value(QStringLiteral("command")).toString(), QStringLiteral("system_upgrade"));
+  QCOMPARE(transaction.value(QStringLiteral("exit_code")).toInt(), 1);
+  QCOMPARE(transaction.value(QStringLiteral("duration_ms")).toInt(), 1000);
+
+  const QJsonObject phase = lines.at(2);
+  QCOMPARE(phase.value(QStringLiteral("type")).toString(), QStringLiteral("phase"));
+  QCOMPARE(phase.value(QStringLiteral("phase")).toString(), QStringLiteral("processing_changes"));
+  QCOMPARE(phase.value(QStringLiteral("start_ms")).toInt(), 400);
+  QCOMPARE(phase.value(QStringLiteral("duration_ms")).toInt(), 400);
+
+  const QJsonObject item = lines.last();
+  QCOMPARE(item.value(QStringLiteral("type")).toString(), QStringLiteral("item"));
+  QCOMPARE(item.value(QStringLiteral("phase")).toString(), QStringLiteral("post_hooks"));
+  QCOMPARE(item.value(QStringLiteral("name")).toString(), QStringLiteral("Arming ConditionNeedsUpdate"));
+  QCOMPARE(item.value(QStringLiteral("duration_ms")).toInt(), 100);
+}
+
+void TestTransactionTimeline::writeLog()
+{
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  TransactionTimeline timeline;
+  replay(upgradeLines(), 100, timeline);
+
+  const qint64 startedAt = QDateTime(QDate(2024, 1, 2), QTime(3, 4, 5, 6)).toMSecsSinceEpoch();
+  const QString logDir = dir.filePath(QStringLiteral("transactions"));
+  QVERIFY(timeline.writeLog(logDir, QStringLiteral("install"), startedAt, 0, 100));
+
+  QFile log(logDir + QLatin1String("/20240102-030405006.jsonl"));
+  QVERIFY(log.open(QIODevice::ReadOnly));
+  QCOMPARE(log.readAll(), timeline.toJsonLines(QStringLiteral("install"), startedAt, 0));
+}
+
+void TestTransactionTimeline::writeLogKeepsLatest()
+{
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  const QStringList oldLogs = QStringList() << QStringLiteral("20230101-000000000.jsonl") <<
+    QStringLiteral("20230102-000000000.jsonl") << QStringLiteral("20230103-000000000.jsonl") << QStringLiteral("notes.txt");
+  for (const QString &name: oldLogs)
+  {
+    QFile file(dir.filePath(name));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+  }
+
+  TransactionTimeline timeline;
+  const qint64 startedAt = QDateTime(QDate(2024, 1, 2), QTime(3, 4, 5, 6)).toMSecsSinceEpoch();
+  QVERIFY(timeline.writeLog(dir.path(), QStringLiteral("remove"), startedAt, 0, 2));
+
+  const QStringList files = QDir(dir.path()).entryList(QDir::Files, QDir::Name);
+  QCOMPARE(files, QStringList() << QStringLiteral("20230103-000000000.jsonl") <<
+           QStringLiteral("20240102-030405006.jsonl") << QStringLiteral("notes.txt"));
+}
+
+/*
+ * Replays a 2000 package upgrade through the parser and the timeline, as PacmanExec does while pacman runs
+ */
+void TestTransactionTimeline::benchmarkReplay()
+{
+  QStringList lines;
+  lines << QStringLiteral(":: Retrieving packages...");
+  for (int i=1; i<=2000; ++i)
+  {
+    lines << QStringLiteral(" package-%1-x86_64  1.0 MiB  10.0 MiB/s 00:01 [########] 100%").arg(i);
+  }
+  lines << QStringLiteral(":: Processing package changes...");
+  for (int i=1; i<=2000; ++i)
+  {
+    lines << QStringLiteral("(%1/2000) upgrading package-%1 [####----]  50%").arg(i) <<
+             QStringLiteral("(%1/2000) upgrading package-%1 [########] 100%").arg(i);
+  }
+
+  int items = 0;
+  QBENCHMARK
+  {
+    TransactionTimeline timeline;
+    replay(lines, 1, timeline);
+    items = timeline.items().count();
+  }
+
+  QCOMPARE(items, 4000);
+}
+
+QTEST_GUILESS_MAIN(TestTransactionTimeline)
+
+#include "tst_transactiontimeline.moc"
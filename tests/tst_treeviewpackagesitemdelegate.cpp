@@ -0,0 +1,213 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/treeviewpackagesitemdelegate.h"
+#include "../src/globals.h"
+#include "../src/mainwindow.h"
+#include "../src/packageinfocache.h"
+#include "packagefixture.h"
+
+#include <QDir>
+#include <QFile>
+#include <QHelpEvent>
+#include <QSemaphore>
+#include <QTemporaryDir>
+#include <QToolTip>
+#include <QTreeView>
+#include <QtTest>
+
+/*
+ * Number of rows swept by the mouse in a single burst
+ */
+static const int ctn_HOVERED_ROWS = 20;
+
+/*
+ * Package tooltips requested by a burst of mouse hovers over the package list
+ *
+ * A fake "pacman" which logs its arguments comes first in PATH, so every tooltip which
+ * reaches pacman is counted. The single tooltip thread is held busy while the hovers arrive,
+ * the way a slow pacman call would hold it
+ */
+class TestTreeViewPackagesItemDelegate: public QObject
+{
+  Q_OBJECT
+
+private:
+  QTemporaryDir m_tempDir;
+  QString m_spawnLog;
+  MainWindow *m_mainWindow;
+  QTreeView *m_treeView;
+  TreeViewPackagesItemDelegate *m_delegate;
+  QSemaphore m_toolTipThreadGate;
+
+  QStringList spawns() const;
+  const PackageRepository::PackageData* package(int row) const;
+  QString fullToolTip(int row) const;
+  void hover(int row);
+  void holdToolTipThread();
+  void releaseToolTipThread();
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void init();
+  void burstRunsOnlyTheLastRequest();
+  void cacheHitShowsAtOnce();
+};
+
+QStringList TestTreeViewPackagesItemDelegate::spawns() const
+{
+  QFile log(m_spawnLog);
+  if (!log.open(QIODevice::ReadOnly)) return QStringList();
+
+  return QString::fromUtf8(log.readAll()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+}
+
+const PackageRepository::PackageData* TestTreeViewPackagesItemDelegate::package(int row) const
+{
+  return m_mainWindow->m_packageModel->getData(m_mainWindow->m_packageModel->index(row, 0, QModelIndex()));
+}
+
+/*
+ * The tooltip computed for row, from the "Installed Size" the fake pacman prints
+ */
+QString TestTreeViewPackagesItemDelegate::fullToolTip(int row) const
+{
+  return getShortPackageDescription(package(row)->description) + QString::fromUtf8(" → ") + QStringLiteral("2.00 MiB");
+}
+
+void TestTreeViewPackagesItemDelegate::hover(int row)
+{
+  const QModelIndex index = m_mainWindow->m_packageModel->index(row, PackageModel::ctn_PACKAGE_NAME_COLUMN, QModelIndex());
+  const QPoint pos(10, 10 + row);
+  QHelpEvent event(QEvent::ToolTip, pos, m_treeView->mapToGlobal(pos));
+
+  QVERIFY(m_delegate->helpEvent(&event, m_treeView, QStyleOptionViewItem(), index));
+}
+
+/*
+ * Requests queue behind a job which waits for releaseToolTipThread()
+ */
+void TestTreeViewPackagesItemDelegate::holdToolTipThread()
+{
+  m_delegate->m_toolTipPool.start([this]() { m_toolTipThreadGate.acquire(); });
+}
+
+void TestTreeViewPackagesItemDelegate::releaseToolTipThread()
+{
+  m_toolTipThreadGate.release();
+  m_delegate->m_toolTipPool.waitForDone();
+}
+
+void TestTreeViewPackagesItemDelegate::initTestCase()
+{
+  QVERIFY(m_tempDir.isValid());
+
+  //Neither the user's settings nor the real pacman
+  qputenv("XDG_CONFIG_HOME", QFile::encodeName(m_tempDir.path() + QLatin1String("/config")));
+
+  const QString binDir = m_tempDir.path() + QLatin1String("/bin");
+  QVERIFY(QDir().mkpath(binDir));
+  m_spawnLog = m_tempDir.path() + QLatin1String("/spawns.log");
+
+  QFile pacman(binDir + QLatin1String("/pacman"));
+  QVERIFY(pacman.open(QIODevice::WriteOnly));
+  pacman.write(QByteArray("#!/bin/sh\necho \"$@\" >> \"" + QFile::encodeName(m_spawnLog) + "\"\n"
+                          "printf 'Name            : %s\\nInstalled Size  : 2.00 MiB\\n' \"$2\"\n"));
+  pacman.close();
+  QVERIFY(pacman.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner));
+  qputenv("PATH", QByteArray(QFile::encodeName(binDir) + ':' + qgetenv("PATH")));
+
+  //The delegate looks packages up in the main window's repository
+  m_mainWindow = new MainWindow();
+  PackageFixture::fill(m_mainWindow->m_packageRepo, 1000);
+  QCOMPARE(MainWindow::returnMainWindow(), m_mainWindow);
+
+  m_treeView = new QTreeView();
+  m_treeView->setObjectName(QStringLiteral("tvPackages"));
+  m_treeView->setModel(m_mainWindow->m_packageModel.get());
+  m_delegate = new TreeViewPackagesItemDelegate(m_treeView);
+  m_treeView->setItemDelegate(m_delegate);
+  QVERIFY(m_mainWindow->m_packageModel->getPackageCount() > ctn_HOVERED_ROWS);
+}
+
+void TestTreeViewPackagesItemDelegate::cleanupTestCase()
+{
+  delete m_treeView;
+  delete m_mainWindow;
+}
+
+void TestTreeViewPackagesItemDelegate::init()
+{
+  QFile::remove(m_spawnLog);
+  PackageInfoCache::clear();
+  TreeViewPackagesItemDelegate::invalidateToolTips();
+}
+
+/*
+ * Sweeping the mouse over many rows while the tooltip thread is busy runs pacman once, for the
+ * last row: every older request sees a newer generation and is dropped before it starts
+ */
+void TestTreeViewPackagesItemDelegate::burstRunsOnlyTheLastRequest()
+{
+  holdToolTipThread();
+
+  for (int row = 0; row < ctn_HOVERED_ROWS; ++row)
+  {
+    hover(row);
+    //The description is shown as a placeholder until the full tooltip is ready
+    QCOMPARE(QToolTip::text(), getShortPackageDescription(package(row)->description));
+  }
+
+  releaseToolTipThread();
+  QTRY_COMPARE(QToolTip::text(), fullToolTip(ctn_HOVERED_ROWS - 1));
+
+  const PackageRepository::PackageData *last = package(ctn_HOVERED_ROWS - 1);
+  QCOMPARE(spawns(), QStringList{QLatin1String("-Si ") + last->repository + QLatin1Char('/') + last->name});
+}
+
+/*
+ * A cached tooltip is shown as soon as its row is hovered, and the stale request it
+ * overtook never reaches pacman nor replaces it on screen
+ */
+void TestTreeViewPackagesItemDelegate::cacheHitShowsAtOnce()
+{
+  hover(0);
+  QTRY_COMPARE(QToolTip::text(), fullToolTip(0));
+  QTRY_VERIFY(!m_delegate->m_toolTipWatcher.isRunning());
+  QCOMPARE(spawns().size(), 1);
+
+  holdToolTipThread();
+  hover(1);
+  QCOMPARE(QToolTip::text(), getShortPackageDescription(package(1)->description));
+
+  hover(0);
+  QCOMPARE(QToolTip::text(), fullToolTip(0));
+
+  releaseToolTipThread();
+  QTRY_VERIFY(!m_delegate->m_toolTipWatcher.isRunning());
+  QCoreApplication::processEvents();
+  QCOMPARE(QToolTip::text(), fullToolTip(0));
+  QCOMPARE(spawns().size(), 1);
+}
+
+QTEST_MAIN(TestTreeViewPackagesItemDelegate)
+
+#include "tst_treeviewpackagesitemdelegate.moc"
@@ -0,0 +1,243 @@
+/*
+* This file is part of Octopi, an open-source GUI for pacman.
+* Copyright (C) 2013 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../src/trigramindex.h"
+
+#include <QRegularExpression>
+#include <QtTest>
+
+#include <algorithm>
+
+/*
+ * Descriptions in the fixture corpus, about the size of the sync databases of a desktop install
+ */
+static const int ctn_FIXTURE_DESCRIPTIONS = 15000;
+
+/*
+ * Unit tests and benchmarks of TrigramIndex over a corpus of synthetic package descriptions
+ */
+class TestTrigramIndex: public QObject
+{
+  Q_OBJECT
+
+private:
+  QStringList m_descriptions;
+
+  static QStringList makeDescriptions(int count);
+  static void build(const QStringList &descriptions, TrigramIndex &index);
+
+private slots:
+  void initTestCase();
+  void shortLiteralsAreNotSearched();
+  void candidatesContainRegexMatches_data();
+  void candidatesContainRegexMatches();
+  void extractLiteral_data();
+  void extractLiteral();
+  void benchmarkBuild_data();
+  void benchmarkBuild();
+  void benchmarkQuery_data();
+  void benchmarkQuery();
+};
+
+/*
+ * Descriptions made of words found in real ones, with a few accented and upper case words
+ */
+QStringList TestTrigramIndex::makeDescriptions(int count)
+{
+  static const QStringList subjects{QStringLiteral("Library"), QStringLiteral("Python bindings"), QStringLiteral("Tool"),
+    QStringLiteral("Plugin"), QStringLiteral("Daemon"), QStringLiteral("Font family"), QStringLiteral("Theme"),
+    QStringLiteral("Command line utility"), QStringLiteral("Wayland compositor"), QStringLiteral("GTK widget toolkit")};
+  static const QStringList objects{QStringLiteral("XML parsing"), QStringLiteral("audio decoding"),
+    QStringLiteral("network management"), QStringLiteral("image manipulation"), QStringLiteral("JSON serialization"),
+    QStringLiteral("the Linux kernel"), QStringLiteral("Qt applications"), QStringLiteral("cryptography"),
+    QStringLiteral("Übersetzungen"), QStringLiteral("SQL databases"), QStringLiteral("HTTP/2 servers")};
+
+  QStringList res;
+  res.reserve(count);
+
+  for (int i = 0; i < count; ++i)
+  {
+    res << QStringLiteral("%1 for %2 (version %3)").arg(subjects.at(i % subjects.size()),
+                                                         objects.at((i / subjects.size()) % objects.size())).arg(i);
+  }
+
+  return res;
+}
+
+void TestTrigramIndex::build(const QStringList &descriptions, TrigramIndex &index)
+{
+  index.clear();
+
+  for (int id = 0; id < descriptions.size(); ++id)
+  {
+    index.addDocument(static_cast<quint32>(id), descriptions.at(id));
+  }
+
+  index.squeeze();
+}
+
+void TestTrigramIndex::initTestCase()
+{
+  m_descriptions = makeDescriptions(ctn_FIXTURE_DESCRIPTIONS);
+}
+
+void TestTrigramIndex::shortLiteralsAreNotSearched()
+{
+  TrigramIndex index;
+  build(m_descriptions, index);
+
+  TrigramIndex::TPostingList result;
+  QVERIFY(!index.query(QStringLiteral("qt"), result));
+  QVERIFY(result.empty());
+  QVERIFY(index.query(QStringLiteral("Qt "), result));
+  QVERIFY(!result.empty());
+}
+
+void TestTrigramIndex::candidatesContainRegexMatches_data()
+{
+  QTest::addColumn<QString>("literal");
+
+  QTest::newRow("word") << QStringLiteral("wayland");
+  QTest::newRow("upper case") << QStringLiteral("WAYLAND COMPOSITOR");
+  QTest::newRow("across words") << QStringLiteral("ings for XML");
+  QTest::newRow("accented") << QStringLiteral("übersetzung");
+  QTest::newRow("punctuation") << QStringLiteral("http/2");
+  QTest::newRow("number") << QStringLiteral("version 1234)");
+  QTest::newRow("repeated trigram") << QStringLiteral("aaaaaa");
+  QTest::newRow("no match") << QStringLiteral("zyxwv");
+}
+
+/*
+ * Every description the case insensitive regex matches is a candidate: the index may only
+ * add false positives, which the real matcher drops afterwards
+ */
+void TestTrigramIndex::candidatesContainRegexMatches()
+{
+  QFETCH(QString, literal);
+
+  TrigramIndex index;
+  build(m_descriptions, index);
+  QCOMPARE(index.documentCount(), m_descriptions.size());
+
+  TrigramIndex::TPostingList candidates;
+  QVERIFY(index.query(literal, candidates));
+  QVERIFY(std::is_sorted(candidates.begin(), candidates.end()));
+  QVERIFY(std::adjacent_find(candidates.begin(), candidates.end()) == candidates.end());
+
+  const QRegularExpression re(QRegularExpression::escape(literal), QRegularExpression::CaseInsensitiveOption);
+  int matches = 0;
+
+  for (int id = 0; id < m_descriptions.size(); ++id)
+  {
+    if (!re.match(m_descriptions.at(id)).hasMatch()) continue;
+
+    ++matches;
+    QVERIFY2(std::binary_search(candidates.begin(), candidates.end(), static_cast<quint32>(id)),
+             qPrintable(m_descriptions.at(id)));
+  }
+
+  QVERIFY(static_cast<int>(candidates.size()) >= matches);
+}
+
+void TestTrigramIndex::extractLiteral_data()
+{
+  QTest::addColumn<QString>("pattern");
+  QTest::addColumn<bool>("literal");
+  QTest::addColumn<QString>("expected");
+
+  QTest::newRow("plain") << QStringLiteral("wayland compositor") << true << QStringLiteral("wayland compositor");
+  QTest::newRow("escaped punctuation") << QStringLiteral("c\\+\\+ library") << true << QStringLiteral("c++ library");
+  QTest::newRow("class") << QStringLiteral("version \\d+") << false << QString();
+  QTest::newRow("alternation") << QStringLiteral("xml|json") << false << QString();
+  QTest::newRow("anchor") << QStringLiteral("^library") << false << QString();
+  QTest::newRow("trailing backslash") << QStringLiteral("library\\") << false << QString();
+}
+
+void TestTrigramIndex::extractLiteral()
+{
+  QFETCH(QString, pattern);
+  QFETCH(bool, literal);
+  QFETCH(QString, expected);
+
+  QString res;
+  QCOMPARE(TrigramIndex::extractLiteral(pattern, res), literal);
+  if (literal) QCOMPARE(res, expected);
+}
+
+void TestTrigramIndex::benchmarkBuild_data()
+{
+  QTest::addColumn<int>("documents");
+
+  QTest::newRow("15000") << 15000;
+  QTest::newRow("50000") << 50000;
+}
+
+/*
+ * Building the index is part of every package list load, so it must stay a small share of it
+ */
+void TestTrigramIndex::benchmarkBuild()
+{
+  QFETCH(int, documents);
+
+  const QStringList descriptions = makeDescriptions(documents);
+  TrigramIndex index;
+
+  QBENCHMARK
+  {
+    build(descriptions, index);
+  }
+
+  qDebug("%d descriptions: %d trigrams, %lld KB", index.documentCount(), index.trigramCount(),
+         index.memoryUsage() / 1024);
+  QCOMPARE(index.documentCount(), documents);
+}
+
+void TestTrigramIndex::benchmarkQuery_data()
+{
+  QTest::addColumn<QString>("literal");
+
+  QTest::newRow("common") << QStringLiteral("library");
+  QTest::newRow("rare") << QStringLiteral("cryptography");
+  QTest::newRow("long") << QStringLiteral("python bindings for json serialization");
+  QTest::newRow("no match") << QStringLiteral("zyxwv");
+}
+
+/*
+ * One keystroke of a description search, before the candidates are verified
+ */
+void TestTrigramIndex::benchmarkQuery()
+{
+  QFETCH(QString, literal);
+
+  TrigramIndex index;
+  build(m_descriptions, index);
+  TrigramIndex::TPostingList candidates;
+
+  QBENCHMARK
+  {
+    index.query(literal, candidates);
+  }
+
+  qDebug("%d candidates", static_cast<int>(candidates.size()));
+}
+
+QTEST_GUILESS_MAIN(TestTrigramIndex)
+
+#include "tst_trigramindex.moc"